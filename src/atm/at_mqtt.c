@@ -30,6 +30,7 @@
 #define MAL_MC_MAX_MSG_LEN     CONFIG_MQTT_MESSAGE_MAXLEN
 
 #define MAL_MC_DEFAULT_TIMEOUT   (8000)
+#define MAL_MC_REACTOR_POLL_MS   (20)
 
 #define mal_emerg(...)             do{HAL_Printf(__VA_ARGS__);HAL_Printf("\r\n");}while(0)
 #define mal_crit(...)              do{HAL_Printf(__VA_ARGS__);HAL_Printf("\r\n");}while(0)
@@ -1142,6 +1143,28 @@ int wrapper_mqtt_subscribe(void *client,
     return wrapper_mqtt_subscribe_sync(client, topic_filter, qos, topic_handle_func, pcontext, MAL_TIMEOUT_DEFAULT);
 }
 
+int wrapper_mqtt_subscribe_multi(void *client, iotx_mutli_sub_info_t *sub_info, int count, int timeout_ms)
+{
+    int idx, granted = 0;
+
+    if (NULL == client || NULL == sub_info || count <= 0) {
+        mal_err(" paras error");
+        return NULL_VALUE_ERROR;
+    }
+
+    /* AT module subscribes one topic a time */
+    for (idx = 0; idx < count; idx++) {
+        sub_info[idx].granted = -1;
+        if (wrapper_mqtt_subscribe_sync(client, sub_info[idx].topicFilter, sub_info[idx].qos,
+                                        sub_info[idx].messageHandler, sub_info[idx].pcontext, timeout_ms) >= 0) {
+            sub_info[idx].granted = sub_info[idx].qos;
+            granted++;
+        }
+    }
+
+    return granted;
+}
+
 int wrapper_mqtt_unsubscribe(void *client, const char *topicFilter)
 {
     int rc = FAIL_RETURN;
@@ -1221,6 +1244,151 @@ int wrapper_mqtt_publish(void *client, const char *topicName, iotx_mqtt_topic_in
     return (int)msg_id;
 }
 
+int wrapper_mqtt_publish_batch(void *client, iotx_mqtt_topic_info_pt topic_msgs, int count)
+{
+    int idx = 0;
+    int rc = FAIL_RETURN;
+
+    if (NULL == client || NULL == topic_msgs || count <= 0) {
+        return NULL_VALUE_ERROR;
+    }
+
+    /* AT module takes one publish per command, nothing to coalesce */
+    for (idx = 0; idx < count; idx++) {
+        rc = wrapper_mqtt_publish(client, topic_msgs[idx].ptopic, &topic_msgs[idx]);
+        if (rc < 0) {
+            break;
+        }
+    }
+
+    return (idx > 0) ? idx : rc;
+}
+
+int wrapper_mqtt_get_pub_window(void *client, int *inflight, int *window_size)
+{
+    if (NULL == client || NULL == inflight || NULL == window_size) {
+        return NULL_VALUE_ERROR;
+    }
+
+    /* QoS1 acknowledgement is handled by AT module */
+    *inflight = 0;
+    *window_size = 0;
+    return SUCCESS_RETURN;
+}
+
+int wrapper_mqtt_get_stats(void *client, iotx_mqtt_stats_t *stats)
+{
+    if (NULL == client || NULL == stats) {
+        return NULL_VALUE_ERROR;
+    }
+
+    /* traffic is carried by AT module, nothing is counted here */
+    memset(stats, 0, sizeof(iotx_mqtt_stats_t));
+    return SUCCESS_RETURN;
+}
+
+int wrapper_mqtt_set_stats_dump(void *client, uint32_t interval_ms, iotx_mqtt_stats_dump_fpt dump, void *pcontext)
+{
+    if (NULL == client) {
+        return NULL_VALUE_ERROR;
+    }
+
+    return FAIL_RETURN;
+}
+
+#ifdef MQTT_TOPIC_ALIAS
+int wrapper_mqtt_set_topic_alias(void *client, uint16_t alias_max)
+{
+    if (NULL == client) {
+        return NULL_VALUE_ERROR;
+    }
+
+    /* topic is passed to AT module as a whole */
+    return FAIL_RETURN;
+}
+#endif
+
+int wrapper_mqtt_set_backoff(void *client, const iotx_mqtt_backoff_param_t *param)
+{
+    if (NULL == client) {
+        return NULL_VALUE_ERROR;
+    }
+
+    /* reconnect is scheduled by AT module */
+    return FAIL_RETURN;
+}
+
+int wrapper_mqtt_set_keepalive(void *client, const iotx_mqtt_keepalive_param_t *param)
+{
+    if (NULL == client) {
+        return NULL_VALUE_ERROR;
+    }
+
+    /* PINGREQ is sent by AT module */
+    return FAIL_RETURN;
+}
+
+int wrapper_mqtt_link_up(void *client)
+{
+    if (NULL == client) {
+        return NULL_VALUE_ERROR;
+    }
+
+    /* AT module watches its own link, nothing to wake up here */
+    return SUCCESS_RETURN;
+}
+
+#ifdef MQTT_OFFLINE_QUEUE
+int wrapper_mqtt_set_offline_queue(void *client, const iotx_mqtt_offline_param_t *param)
+{
+    if (NULL == client) {
+        return NULL_VALUE_ERROR;
+    }
+
+    /* AT module keeps no publish while disconnected */
+    return FAIL_RETURN;
+}
+#endif
+
+#ifdef MQTT_DISPATCH
+int wrapper_mqtt_set_dispatch(void *client, const iotx_mqtt_dispatch_param_t *param)
+{
+    if (NULL == client) {
+        return NULL_VALUE_ERROR;
+    }
+
+    /* PUBLISH is handed over by AT module in its own thread */
+    return FAIL_RETURN;
+}
+#endif
+
+#ifdef MQTT_STREAM_RECV
+int wrapper_mqtt_set_stream_recv(void *client, uint32_t chunk_size, iotx_mqtt_stream_fpt handler, void *pcontext)
+{
+    if (NULL == client) {
+        return NULL_VALUE_ERROR;
+    }
+
+    /* AT module hands over PUBLISH only as a whole */
+    return FAIL_RETURN;
+}
+#endif
+
+#ifdef MQTT_REACTOR
+int wrapper_mqtt_nwk_status(void *client, iotx_mqtt_nwk_param_t *param, int *connecting, uint32_t *timeout_ms)
+{
+    if (NULL == client || NULL == param || NULL == connecting || NULL == timeout_ms) {
+        return NULL_VALUE_ERROR;
+    }
+
+    /* no descriptor to watch, what AT module received is picked up by yield */
+    param->fd = (uintptr_t)(-1);
+    *connecting = 0;
+    *timeout_ms = MAL_MC_REACTOR_POLL_MS;
+    return SUCCESS_RETURN;
+}
+#endif
+
 int wrapper_mqtt_release(void **client)
 {
     iotx_mc_client_t *pClient;
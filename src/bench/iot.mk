@@ -0,0 +1,10 @@
+HDR_REFS        := src/infra
+
+DEPENDS         += wrappers
+LDFLAGS         += -liot_sdk -liot_hal -liot_tls
+
+DEPENDS         += external_libs/mbedtls
+
+SRCS_json-bench         := json_bench.c
+
+$(call Append_Conditional, TARGET, json-bench, INFRA_CJSON _PLATFORM_IS_LINUX_, BUILD_AOS NO_EXECUTABLES)
@@ -0,0 +1,296 @@
+/*
+ * Copyright (C) 2015-2018 Alibaba Group Holding Limited
+ */
+
+/*
+ * Microbenchmark of JSON parsers over alink payloads: downstream requests shaped like the ones dm_msg parses,
+ * a large property post and the TSL of model.json. For each payload it times the structural scan against a
+ * byte by byte loop, lite_cjson_parse, lookups by key and, with FEATURE_INFRA_JSON_PARSER, json_get_value_by_name.
+ *
+ *   json-bench [-n iterations] [-f TSL file, model.json by default]
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "infra_types.h"
+#include "infra_cjson.h"
+#include "infra_json_scan.h"
+#ifdef INFRA_JSON_PARSER
+    #include "infra_json_parser.h"
+#endif
+
+void HAL_Printf(const char *fmt, ...);
+
+#define BENCH_TRACE(fmt, ...)  \
+    do { \
+        HAL_Printf(fmt, ##__VA_ARGS__); \
+        HAL_Printf("%s", "\r\n"); \
+    } while(0)
+
+#define BENCH_POST_ITEMS        (64)
+
+typedef struct {
+    const char     *name;
+    char           *text;
+    int             len;
+    const char     *lookup;     /* path looked up with lite_cjson_object_item */
+    char           *top_key;    /* key looked up with json_get_value_by_name */
+} bench_payload_t;
+
+static const char bench_property_set[] =
+    "{\"method\":\"thing.service.property.set\",\"id\":\"1695023442\",\"params\":"
+    "{\"LightStatus\":1,\"LightAdjustLevel\":80,\"LightAlias\":\"living room \\\"north\\\" lamp\","
+    "\"WorkMode\":{\"mode\":2,\"schedule\":[{\"on\":\"07:30\",\"off\":\"08:15\"},{\"on\":\"19:00\",\"off\":\"23:30\"}]},"
+    "\"ColorTemperature\":4200},\"version\":\"1.0.0\"}";
+
+static const char bench_service_request[] =
+    "{\"method\":\"thing.service.SetTimer\",\"id\":\"1695023443\",\"params\":"
+    "{\"TimerList\":[{\"Enable\":true,\"Hour\":7,\"Minute\":30,\"Repeat\":\"1,2,3,4,5\",\"Action\":{\"LightStatus\":1}},"
+    "{\"Enable\":false,\"Hour\":23,\"Minute\":0,\"Repeat\":\"0,6\",\"Action\":{\"LightStatus\":0}}],"
+    "\"TimeZone\":\"Asia/Shanghai\",\"Note\":\"weekday wake up, weekend lights out\"},\"version\":\"1.0.0\"}";
+
+static const char bench_ota_request[] =
+    "{\"code\":\"1000\",\"data\":{\"size\":432945,\"version\":\"2.0.0\","
+    "\"url\":\"https://iotx-ota.oss-cn-shanghai.aliyuncs.com/ota/a1h88DsZIaY/example/firmware_v2.0.0.bin"
+    "?Expires=1695109842&OSSAccessKeyId=cS8uRRy54RszYWna&Signature=6ae2TjE4K9nQ0Xwz1MmVfN5Ykp8%3D\","
+    "\"signMethod\":\"Md5\",\"sign\":\"93230c3bde425a9d7984a594ac55ea1e\",\"md5\":\"93230c3bde425a9d7984a594ac55ea1e\"},"
+    "\"id\":1695023444,\"message\":\"success\"}";
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static char *bench_dup(const char *text, int *len)
+{
+    char *copy = NULL;
+
+    *len = strlen(text);
+    copy = malloc(*len + 1);
+    if (copy != NULL) {
+        memcpy(copy, text, *len + 1);
+    }
+    return copy;
+}
+
+/* property post of a gateway flushing BENCH_POST_ITEMS history samples at once */
+static char *bench_make_post(int *len)
+{
+    int size = 160 + BENCH_POST_ITEMS * 240, pos = 0, i;
+    char *text = malloc(size);
+
+    if (text == NULL) {
+        return NULL;
+    }
+    pos += snprintf(text + pos, size - pos,
+                    "{\"id\":\"1695023445\",\"version\":\"1.0\",\"method\":\"thing.event.property.history.post\","
+                    "\"params\":[");
+    for (i = 0; i < BENCH_POST_ITEMS; i++) {
+        pos += snprintf(text + pos, size - pos,
+                        "%s{\"identity\":{\"productKey\":\"a1h88DsZIaY\",\"deviceName\":\"lamp_%03d\"},"
+                        "\"properties\":[{\"LightStatus\":{\"value\":%d,\"time\":%d}},"
+                        "{\"LightAdjustLevel\":{\"value\":%d,\"time\":%d}}]}",
+                        i ? "," : "", i, i & 1, 1695000000 + i, i % 100, 1695000000 + i);
+    }
+    pos += snprintf(text + pos, size - pos, "],\"sys\":{\"ack\":0}}");
+    *len = pos;
+    return text;
+}
+
+static char *bench_load(const char *path, int *len)
+{
+    FILE *fp = fopen(path, "rb");
+    char *text = NULL;
+    long size = 0;
+
+    if (fp == NULL) {
+        return NULL;
+    }
+    if (fseek(fp, 0, SEEK_END) == 0 && (size = ftell(fp)) > 0 && fseek(fp, 0, SEEK_SET) == 0 &&
+        (text = malloc(size + 1)) != NULL) {
+        if (fread(text, 1, size, fp) != (size_t)size) {
+            free(text);
+            text = NULL;
+        } else {
+            text[size] = '\0';
+            *len = (int)size;
+        }
+    }
+    fclose(fp);
+    return text;
+}
+
+static int bench_count_bytewise(const char *text, int len)
+{
+    int count = 0, i;
+
+    for (i = 0; i < len; i++) {
+        switch (text[i]) {
+            case '\"':
+            case '{':
+            case '}':
+            case '[':
+            case ']':
+            case ':':
+            case ',':
+                count++;
+                break;
+            default:
+                break;
+        }
+    }
+    return count;
+}
+
+static int bench_count_scan(const char *text, int len)
+{
+    const char *end = text + len;
+    int count = 0;
+
+    while ((text = infra_json_scan_structural(text, end)) < end) {
+        count++;
+        text++;
+    }
+    return count;
+}
+
+static void bench_report(const char *what, uint64_t ns, int iterations, int len)
+{
+    double per = (double)ns / iterations;
+
+    BENCH_TRACE("  %-20s %10.1f ns/op %9.1f MB/s", what, per, len * 1000.0 / per);
+}
+
+static int bench_run(bench_payload_t *payload, int iterations)
+{
+    lite_cjson_t root, item;
+    volatile int sink = 0;
+    uint64_t start;
+    int i, expect;
+
+    BENCH_TRACE("%s: %d bytes", payload->name, payload->len);
+
+    expect = bench_count_bytewise(payload->text, payload->len);
+    if (bench_count_scan(payload->text, payload->len) != expect) {
+        BENCH_TRACE("  scan disagrees with byte loop");
+        return -1;
+    }
+    if (lite_cjson_parse(payload->text, payload->len, &root) != 0) {
+        BENCH_TRACE("  not valid JSON");
+        return -1;
+    }
+    if (lite_cjson_object_item(&root, payload->lookup, strlen(payload->lookup), &item) != 0) {
+        BENCH_TRACE("  %s not found", payload->lookup);
+        return -1;
+    }
+
+    start = bench_now_ns();
+    for (i = 0; i < iterations; i++) {
+        sink += bench_count_bytewise(payload->text, payload->len);
+    }
+    bench_report("count bytewise", bench_now_ns() - start, iterations, payload->len);
+
+    start = bench_now_ns();
+    for (i = 0; i < iterations; i++) {
+        sink += bench_count_scan(payload->text, payload->len);
+    }
+    bench_report("count scan", bench_now_ns() - start, iterations, payload->len);
+
+    start = bench_now_ns();
+    for (i = 0; i < iterations; i++) {
+        sink += lite_cjson_parse(payload->text, payload->len, &root);
+    }
+    bench_report("lite_cjson_parse", bench_now_ns() - start, iterations, payload->len);
+
+    start = bench_now_ns();
+    for (i = 0; i < iterations; i++) {
+        sink += lite_cjson_object_item(&root, payload->lookup, strlen(payload->lookup), &item);
+    }
+    bench_report("lite_cjson lookup", bench_now_ns() - start, iterations, payload->len);
+
+#ifdef INFRA_JSON_PARSER
+    {
+        int value_len = 0, value_type = 0;
+
+        start = bench_now_ns();
+        for (i = 0; i < iterations; i++) {
+            sink += (json_get_value_by_name(payload->text, payload->len, payload->top_key,
+                                            &value_len, &value_type) != NULL);
+        }
+        bench_report("json_get_value", bench_now_ns() - start, iterations, payload->len);
+    }
+#endif
+
+    return sink < 0;
+}
+
+int main(int argc, char *argv[])
+{
+    bench_payload_t payloads[5];
+    const char *tsl_path = "model.json";
+    int iterations = 20000, count = 0, res = 0, opt, i;
+
+    while ((opt = getopt(argc, argv, "n:f:h")) != -1) {
+        switch (opt) {
+            case 'n':
+                iterations = atoi(optarg);
+                break;
+            case 'f':
+                tsl_path = optarg;
+                break;
+            default:
+                BENCH_TRACE("usage: %s [-n iterations] [-f TSL file]", argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (iterations <= 0) {
+        iterations = 1;
+    }
+
+    memset(payloads, 0, sizeof(payloads));
+    payloads[count].name = "property set";
+    payloads[count].text = bench_dup(bench_property_set, &payloads[count].len);
+    payloads[count].lookup = "params.ColorTemperature";
+    payloads[count++].top_key = "version";
+
+    payloads[count].name = "service request";
+    payloads[count].text = bench_dup(bench_service_request, &payloads[count].len);
+    payloads[count].lookup = "params.TimerList[1].Action.LightStatus";
+    payloads[count++].top_key = "version";
+
+    payloads[count].name = "ota notify";
+    payloads[count].text = bench_dup(bench_ota_request, &payloads[count].len);
+    payloads[count].lookup = "data.md5";
+    payloads[count++].top_key = "message";
+
+    payloads[count].name = "history post";
+    payloads[count].text = bench_make_post(&payloads[count].len);
+    payloads[count].lookup = "sys.ack";
+    payloads[count++].top_key = "sys";
+
+    payloads[count].text = bench_load(tsl_path, &payloads[count].len);
+    if (payloads[count].text != NULL) {
+        payloads[count].name = tsl_path;
+        payloads[count].lookup = "events";
+        payloads[count++].top_key = "events";
+    } else {
+        BENCH_TRACE("%s not readable, TSL skipped", tsl_path);
+    }
+
+    BENCH_TRACE("scanner: %s, iterations: %d", infra_json_scan_impl(), iterations);
+    for (i = 0; i < count; i++) {
+        if (payloads[i].text == NULL || bench_run(&payloads[i], iterations) != 0) {
+            res = 1;
+        }
+        free(payloads[i].text);
+    }
+
+    return res;
+}
+
@@ -74,7 +74,9 @@ int dm_client_subscribe_all(char product_key[IOTX_PRODUCT_KEY_LEN + 1], char dev
 {
     int res = 0, index = 0, fail_count = 0;
     int number = sizeof(g_dm_client_uri_map) / sizeof(dm_client_uri_map_t);
+    int sub_num = 0, pending = 0;
     char *uri = NULL;
+    iotx_cm_sub_info_t *sub_list = NULL;
     uint8_t local_sub = 0;
 #ifdef SUB_PERSISTENCE_ENABLED
     char device_key[IOTX_PRODUCT_KEY_LEN + IOTX_DEVICE_NAME_LEN + 4] = {0};
@@ -117,20 +119,21 @@ int dm_client_subscribe_all(char product_key[IOTX_PRODUCT_KEY_LEN + 1], char dev
     }
 #endif
 
+    sub_list = (iotx_cm_sub_info_t *)DM_malloc(number * sizeof(iotx_cm_sub_info_t));
+    if (sub_list == NULL) {
+        return DM_MEMORY_NOT_ENOUGH;
+    }
+    memset(sub_list, 0, number * sizeof(iotx_cm_sub_info_t));
+
     for (; index < number; index++) {
         if ((g_dm_client_uri_map[index].dev_type & dev_type) == 0) {
             continue;
         }
         dm_log_info("index: %d", index);
 
-        if (fail_count >= IOTX_DM_CLIENT_SUB_RETRY_MAX_COUNTS) {
-            fail_count = 0;
-            continue;
-        }
         res = dm_utils_service_name((char *)g_dm_client_uri_map[index].uri_prefix, (char *)g_dm_client_uri_map[index].uri_name,
                                     product_key, device_name, &uri);
         if (res < SUCCESS_RETURN) {
-            index--;
             continue;
         }
 
@@ -140,17 +143,35 @@ int dm_client_subscribe_all(char product_key[IOTX_PRODUCT_KEY_LEN + 1], char dev
             continue;
         }
 
-        res = dm_client_subscribe(uri, (iotx_cm_data_handle_cb)g_dm_client_uri_map[index].callback, &local_sub);
-        if (res < SUCCESS_RETURN) {
-            index--;
-            fail_count++;
-            DM_free(uri);
-            continue;
+        sub_list[sub_num].topic = uri;
+        sub_list[sub_num].topic_handle_func = (iotx_cm_data_handle_cb)g_dm_client_uri_map[index].callback;
+        sub_num++;
+    }
+
+    /* topics are packed into a few SUBSCRIBE, the ones not granted are moved to front and retried together */
+    pending = sub_num;
+    for (fail_count = 0; pending > 0 && fail_count < IOTX_DM_CLIENT_SUB_RETRY_MAX_COUNTS; fail_count++) {
+        int failed = 0;
+
+        dm_client_subscribe_multi(sub_list, pending, &local_sub);
+        for (index = 0; index < pending; index++) {
+            if (sub_list[index].result != SUCCESS_RETURN) {
+                iotx_cm_sub_info_t sub_info = sub_list[failed];
+                sub_list[failed++] = sub_list[index];
+                sub_list[index] = sub_info;
+            }
         }
+        pending = failed;
+    }
+    if (pending > 0) {
+        dm_log_err("%d topics of %s.%s are not subscribed", pending, product_key, device_name);
+    }
 
-        fail_count = 0;
-        DM_free(uri);
+    for (index = 0; index < sub_num; index++) {
+        DM_free(sub_list[index].topic);
     }
+    DM_free(sub_list);
+
 #ifdef SUB_PERSISTENCE_ENABLED
     local_sub = 1;
     HAL_Kv_Set(device_key, &local_sub, 1, 1);
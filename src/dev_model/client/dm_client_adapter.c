@@ -91,6 +91,36 @@ int dm_client_subscribe(char *uri, iotx_cm_data_handle_cb callback, void *contex
     return SUCCESS_RETURN;
 }
 
+int dm_client_subscribe_multi(iotx_cm_sub_info_t *sub_list, int count, void *context)
+{
+    int res = 0;
+    uint8_t local_sub = 0;
+    dm_client_ctx_t *ctx = dm_client_get_ctx();
+    iotx_cm_ext_params_t sub_params;
+
+    memset(&sub_params, 0, sizeof(iotx_cm_ext_params_t));
+    if (context != NULL) {
+        local_sub = *((uint8_t *)context);
+    }
+
+    if (local_sub == 1) {
+        sub_params.ack_type = IOTX_CM_MESSAGE_SUB_LOCAL;
+        sub_params.sync_mode = IOTX_CM_ASYNC;
+    } else {
+        sub_params.ack_type = IOTX_CM_MESSAGE_NO_ACK;
+        sub_params.sync_mode = IOTX_CM_SYNC;
+    }
+
+    /* packets carrying the topics are sent back to back, their SUBACK are waited for together */
+    sub_params.sync_timeout = IOTX_DM_CLIENT_SUB_TIMEOUT_MS;
+    sub_params.ack_cb = NULL;
+
+    res = iotx_cm_sub_multi(ctx->fd, &sub_params, sub_list, count);
+    dm_log_info("Subscribe Multi Result: %d of %d", res, count);
+
+    return res;
+}
+
 int dm_client_unsubscribe(char *uri)
 {
     int res = 0;
@@ -145,6 +145,9 @@ int iotx_dm_connect(_IN_ iotx_dm_init_params_t *init_params)
     if (init_params->event_callback != NULL) {
         ctx->event_callback = init_params->event_callback;
     }
+    if (init_params->event_typed_callback != NULL) {
+        ctx->event_typed_callback = init_params->event_typed_callback;
+    }
 
     res = dm_client_connect(IOTX_DM_CLIENT_CONNECT_TIMEOUT_MS);
     if (res != SUCCESS_RETURN) {
@@ -272,13 +275,23 @@ void iotx_dm_dispatch(void)
         if (dm_ipc_msg_next(&data) == SUCCESS_RETURN) {
             dm_ipc_msg_t *msg = (dm_ipc_msg_t *)data;
 
-            if (ctx->event_callback) {
-                ctx->event_callback(msg->type, msg->data);
+            if (msg->event && ctx->event_typed_callback) {
+                ctx->event_typed_callback(msg->event);
+            } else if (ctx->event_callback) {
+                if (msg->event) {
+                    msg->data = dm_msg_event_to_string(msg->event);
+                }
+                if (msg->event == NULL || msg->data != NULL) {
+                    ctx->event_callback(msg->type, msg->data);
+                }
             }
 
             if (msg->data) {
                 DM_free(msg->data);
             }
+            if (msg->event) {
+                DM_free(msg->event);
+            }
             DM_free(msg);
             data = NULL;
         } else {
@@ -393,9 +406,7 @@ int iotx_dm_log_post(_IN_ int devid, _IN_ char *payload, _IN_ int payload_len)
 int iotx_dm_post_event(_IN_ int devid, _IN_ char *identifier, _IN_ int identifier_len, _IN_ char *payload,
                        _IN_ int payload_len)
 {
-    int res = 0, method_len = 0;
-    const char *method_fmt = "thing.event.%.*s.post";
-    char *method = NULL;
+    int res = 0;
 
     if (devid < 0 || identifier == NULL || identifier_len == 0 || payload == NULL || payload_len <= 0) {
         return DM_INVALID_PARAMETER;
@@ -403,23 +414,12 @@ int iotx_dm_post_event(_IN_ int devid, _IN_ char *identifier, _IN_ int identifie
 
     _dm_api_lock();
 
-    method_len = strlen(method_fmt) + strlen(identifier) + 1;
-    method = DM_malloc(method_len);
-    if (method == NULL) {
-        _dm_api_unlock();
-        return DM_MEMORY_NOT_ENOUGH;
-    }
-    memset(method, 0, method_len);
-    HAL_Snprintf(method, method_len, method_fmt, identifier_len, identifier);
-
-    res = dm_mgr_upstream_thing_event_post(devid, identifier, identifier_len, method, payload, payload_len);
+    res = dm_mgr_upstream_thing_event_post(devid, identifier, identifier_len, NULL, payload, payload_len);
     if (res < SUCCESS_RETURN) {
-        DM_free(method);
         _dm_api_unlock();
         return FAIL_RETURN;
     }
 
-    DM_free(method);
     _dm_api_unlock();
     return res;
 }
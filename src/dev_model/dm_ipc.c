@@ -65,6 +65,9 @@ void dm_ipc_deinit(void)
         if (del_msg->data) {
             DM_free(del_msg->data);
         }
+        if (del_msg->event) {
+            DM_free(del_msg->event);
+        }
         DM_free(del_msg);
         del_msg = NULL;
 
@@ -12,6 +12,7 @@
 typedef struct {
     iotx_dm_event_types_t type;
     char *data;
+    iotx_dm_event_t *event;         /* typed form instead of @data, rendered to @data for legacy consumers */
 } dm_ipc_msg_t;
 
 typedef struct {
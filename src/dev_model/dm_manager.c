@@ -29,6 +29,59 @@ static void _dm_mgr_mutex_unlock(void)
     }
 }
 
+/* a lookup waits only while the device list is being changed */
+static void _dm_mgr_read_lock(void)
+{
+    dm_mgr_ctx *ctx = _dm_mgr_get_ctx();
+
+    _dm_mgr_mutex_lock();
+    while (ctx->writing) {
+        _dm_mgr_mutex_unlock();
+        HAL_SleepMs(1);
+        _dm_mgr_mutex_lock();
+    }
+    ctx->readers++;
+    _dm_mgr_mutex_unlock();
+}
+
+static void _dm_mgr_read_unlock(void)
+{
+    dm_mgr_ctx *ctx = _dm_mgr_get_ctx();
+
+    _dm_mgr_mutex_lock();
+    ctx->readers--;
+    _dm_mgr_mutex_unlock();
+}
+
+/* new lookups are held off first, then the ones in progress are waited for */
+static void _dm_mgr_write_lock(void)
+{
+    dm_mgr_ctx *ctx = _dm_mgr_get_ctx();
+
+    _dm_mgr_mutex_lock();
+    while (ctx->writing) {
+        _dm_mgr_mutex_unlock();
+        HAL_SleepMs(1);
+        _dm_mgr_mutex_lock();
+    }
+    ctx->writing = 1;
+    while (ctx->readers > 0) {
+        _dm_mgr_mutex_unlock();
+        HAL_SleepMs(1);
+        _dm_mgr_mutex_lock();
+    }
+    _dm_mgr_mutex_unlock();
+}
+
+static void _dm_mgr_write_unlock(void)
+{
+    dm_mgr_ctx *ctx = _dm_mgr_get_ctx();
+
+    _dm_mgr_mutex_lock();
+    ctx->writing = 0;
+    _dm_mgr_mutex_unlock();
+}
+
 static int _dm_mgr_next_devid(void)
 {
     dm_mgr_ctx *ctx = _dm_mgr_get_ctx();
@@ -36,19 +89,156 @@ static int _dm_mgr_next_devid(void)
     return ctx->global_devid++;
 }
 
+/* FNV-1a over product key, '\0' and device name */
+static unsigned int _dm_mgr_pkdn_hash(_IN_ const char *product_key, _IN_ const char *device_name)
+{
+    unsigned int hash = 2166136261u;
+
+    while (*product_key != '\0') {
+        hash = (hash ^ (unsigned char) * product_key++) * 16777619u;
+    }
+    hash *= 16777619u;
+    while (*device_name != '\0') {
+        hash = (hash ^ (unsigned char) * device_name++) * 16777619u;
+    }
+
+    return hash;
+}
+
+static void _dm_mgr_index_add(_IN_ dm_mgr_ctx *ctx, _IN_ dm_mgr_dev_node_t *node)
+{
+    int bucket = 0;
+
+    bucket = node->devid & (ctx->index_size - 1);
+    node->devid_next = ctx->devid_index[bucket];
+    ctx->devid_index[bucket] = node;
+
+    bucket = node->pkdn_hash & (ctx->index_size - 1);
+    node->pkdn_next = ctx->pkdn_index[bucket];
+    ctx->pkdn_index[bucket] = node;
+}
+
+static void _dm_mgr_index_del(_IN_ dm_mgr_ctx *ctx, _IN_ dm_mgr_dev_node_t *node)
+{
+    dm_mgr_dev_node_t **link = NULL;
+
+    link = &ctx->devid_index[node->devid & (ctx->index_size - 1)];
+    while (*link != NULL && *link != node) {
+        link = &(*link)->devid_next;
+    }
+    if (*link != NULL) {
+        *link = node->devid_next;
+    }
+
+    link = &ctx->pkdn_index[node->pkdn_hash & (ctx->index_size - 1)];
+    while (*link != NULL && *link != node) {
+        link = &(*link)->pkdn_next;
+    }
+    if (*link != NULL) {
+        *link = node->pkdn_next;
+    }
+}
+
+/* both indexes share one allocation of 2 * index_size buckets */
+static int _dm_mgr_index_resize(_IN_ dm_mgr_ctx *ctx, _IN_ int index_size)
+{
+    dm_mgr_dev_node_t **buckets = NULL;
+    dm_mgr_dev_node_t *search_node = NULL;
+
+    buckets = DM_malloc(2 * index_size * sizeof(dm_mgr_dev_node_t *));
+    if (buckets == NULL) {
+        return DM_MEMORY_NOT_ENOUGH;
+    }
+    memset(buckets, 0, 2 * index_size * sizeof(dm_mgr_dev_node_t *));
+
+    if (ctx->devid_index != NULL) {
+        DM_free(ctx->devid_index);
+    }
+    ctx->devid_index = buckets;
+    ctx->pkdn_index = buckets + index_size;
+    ctx->index_size = index_size;
+
+    list_for_each_entry(search_node, &ctx->dev_list, linked_list, dm_mgr_dev_node_t) {
+        _dm_mgr_index_add(ctx, search_node);
+    }
+
+    return SUCCESS_RETURN;
+}
+
+/* call with the write lock held */
+static void _dm_mgr_link_dev(_IN_ dm_mgr_ctx *ctx, _IN_ dm_mgr_dev_node_t *node)
+{
+    node->pkdn_hash = _dm_mgr_pkdn_hash(node->product_key, node->device_name);
+    INIT_LIST_HEAD(&node->linked_list);
+    list_add_tail(&node->linked_list, &ctx->dev_list);
+    ctx->dev_count++;
+
+    /* chains stay short while there are no more devices than buckets, when growing fails they only get longer */
+    if (ctx->dev_count <= ctx->index_size || _dm_mgr_index_resize(ctx, ctx->index_size * 2) != SUCCESS_RETURN) {
+        _dm_mgr_index_add(ctx, node);
+    }
+}
+
+/* call with the write lock held */
+static void _dm_mgr_unlink_dev(_IN_ dm_mgr_ctx *ctx, _IN_ dm_mgr_dev_node_t *node)
+{
+    _dm_mgr_index_del(ctx, node);
+    list_del(&node->linked_list);
+    ctx->dev_count--;
+}
+
+static dm_mgr_dev_node_t *_dm_mgr_index_find_devid(_IN_ dm_mgr_ctx *ctx, _IN_ int devid)
+{
+    dm_mgr_dev_node_t *search_node = NULL;
+
+    if (ctx->devid_index == NULL) {
+        return NULL;
+    }
+
+    search_node = ctx->devid_index[devid & (ctx->index_size - 1)];
+    while (search_node != NULL && search_node->devid != devid) {
+        search_node = search_node->devid_next;
+    }
+
+    return search_node;
+}
+
+static dm_mgr_dev_node_t *_dm_mgr_index_find_pkdn(_IN_ dm_mgr_ctx *ctx, _IN_ const char *product_key,
+        _IN_ const char *device_name)
+{
+    unsigned int hash = 0;
+    dm_mgr_dev_node_t *search_node = NULL;
+
+    if (ctx->pkdn_index == NULL) {
+        return NULL;
+    }
+
+    hash = _dm_mgr_pkdn_hash(product_key, device_name);
+    search_node = ctx->pkdn_index[hash & (ctx->index_size - 1)];
+    while (search_node != NULL && (search_node->pkdn_hash != hash ||
+                                   strcmp(search_node->product_key, product_key) != 0 ||
+                                   strcmp(search_node->device_name, device_name) != 0)) {
+        search_node = search_node->pkdn_next;
+    }
+
+    return search_node;
+}
+
 static int _dm_mgr_search_dev_by_devid(_IN_ int devid, _OU_ dm_mgr_dev_node_t **node)
 {
     dm_mgr_ctx *ctx = _dm_mgr_get_ctx();
     dm_mgr_dev_node_t *search_node = NULL;
 
-    list_for_each_entry(search_node, &ctx->dev_list, linked_list, dm_mgr_dev_node_t) {
-        if (search_node->devid == devid) {
-            /* dm_log_debug("Device Found, devid: %d", devid); */
-            if (node) {
-                *node = search_node;
-            }
-            return SUCCESS_RETURN;
+    _dm_mgr_read_lock();
+    search_node = _dm_mgr_index_find_devid(ctx, devid);
+    _dm_mgr_read_unlock();
+
+    if (search_node != NULL) {
+        /* dm_log_debug("Device Found, devid: %d", devid); */
+        if (node) {
+            *node = search_node;
         }
+        return SUCCESS_RETURN;
     }
 
     dm_log_debug("Device Not Found, devid: %d", devid);
@@ -61,17 +251,16 @@ static int _dm_mgr_search_dev_by_pkdn(_IN_ char product_key[IOTX_PRODUCT_KEY_LEN
     dm_mgr_ctx *ctx = _dm_mgr_get_ctx();
     dm_mgr_dev_node_t *search_node = NULL;
 
-    list_for_each_entry(search_node, &ctx->dev_list, linked_list, dm_mgr_dev_node_t) {
-        if ((strlen(search_node->product_key) == strlen(product_key)) &&
-            (memcmp(search_node->product_key, product_key, strlen(product_key)) == 0) &&
-            (strlen(search_node->device_name) == strlen(device_name)) &&
-            (memcmp(search_node->device_name, device_name, strlen(device_name)) == 0)) {
-            /* dm_log_debug("Device Found, Product Key: %s, Device Name: %s", product_key, device_name); */
-            if (node) {
-                *node = search_node;
-            }
-            return SUCCESS_RETURN;
+    _dm_mgr_read_lock();
+    search_node = _dm_mgr_index_find_pkdn(ctx, product_key, device_name);
+    _dm_mgr_read_unlock();
+
+    if (search_node != NULL) {
+        /* dm_log_debug("Device Found, Product Key: %s, Device Name: %s", product_key, device_name); */
+        if (node) {
+            *node = search_node;
         }
+        return SUCCESS_RETURN;
     }
 
     dm_log_debug("Device Not Found, Product Key: %s, Device Name: %s", product_key, device_name);
@@ -81,7 +270,6 @@ static int _dm_mgr_search_dev_by_pkdn(_IN_ char product_key[IOTX_PRODUCT_KEY_LEN
 static int _dm_mgr_insert_dev(_IN_ int devid, _IN_ int dev_type, char product_key[IOTX_PRODUCT_KEY_LEN + 1],
                               char device_name[IOTX_DEVICE_NAME_LEN + 1])
 {
-    int res = 0;
     dm_mgr_ctx *ctx = _dm_mgr_get_ctx();
     dm_mgr_dev_node_t *node = NULL;
 
@@ -90,11 +278,6 @@ static int _dm_mgr_insert_dev(_IN_ int devid, _IN_ int dev_type, char product_ke
         return DM_INVALID_PARAMETER;
     }
 
-    res = _dm_mgr_search_dev_by_devid(devid, NULL);
-    if (res == SUCCESS_RETURN) {
-        return FAIL_RETURN;
-    }
-
     node = DM_malloc(sizeof(dm_mgr_dev_node_t));
     if (node == NULL) {
         return DM_MEMORY_NOT_ENOUGH;
@@ -105,9 +288,15 @@ static int _dm_mgr_insert_dev(_IN_ int devid, _IN_ int dev_type, char product_ke
     node->dev_type = dev_type;
     memcpy(node->product_key, product_key, strlen(product_key));
     memcpy(node->device_name, device_name, strlen(device_name));
-    INIT_LIST_HEAD(&node->linked_list);
 
-    list_add_tail(&node->linked_list, &ctx->dev_list);
+    _dm_mgr_write_lock();
+    if (_dm_mgr_index_find_devid(ctx, devid) != NULL) {
+        _dm_mgr_write_unlock();
+        DM_free(node);
+        return FAIL_RETURN;
+    }
+    _dm_mgr_link_dev(ctx, node);
+    _dm_mgr_write_unlock();
 
     return SUCCESS_RETURN;
 }
@@ -125,6 +314,14 @@ static void _dm_mgr_destroy_devlist(void)
 #endif
         DM_free(del_node);
     }
+    ctx->dev_count = 0;
+
+    if (ctx->devid_index != NULL) {
+        DM_free(ctx->devid_index);
+    }
+    ctx->devid_index = NULL;
+    ctx->pkdn_index = NULL;
+    ctx->index_size = 0;
 }
 
 #ifdef DEPRECATED_LINKKIT
@@ -172,6 +369,9 @@ int dm_mgr_init(void)
 
     /* Init Device List */
     INIT_LIST_HEAD(&ctx->dev_list);
+    if (_dm_mgr_index_resize(ctx, CONFIG_DM_MGR_INDEX_SIZE) != SUCCESS_RETURN) {
+        goto ERROR;
+    }
 
     /* Local Node */
     HAL_GetProductKey(product_key);
@@ -188,6 +388,9 @@ int dm_mgr_init(void)
     return SUCCESS_RETURN;
 
 ERROR:
+    if (ctx->devid_index) {
+        DM_free(ctx->devid_index);
+    }
     if (ctx->mutex) {
         HAL_MutexDestroy(ctx->mutex);
     }
@@ -199,9 +402,9 @@ int dm_mgr_deinit(void)
 {
     dm_mgr_ctx *ctx = _dm_mgr_get_ctx();
 
-    _dm_mgr_mutex_lock();
+    _dm_mgr_write_lock();
     _dm_mgr_destroy_devlist();
-    _dm_mgr_mutex_unlock();
+    _dm_mgr_write_unlock();
 
     if (ctx->mutex) {
         HAL_MutexDestroy(ctx->mutex);
@@ -234,7 +437,7 @@ int dm_mgr_device_create(_IN_ int dev_type, _IN_ char product_key[IOTX_PRODUCT_K
 {
     int res = 0;
     dm_mgr_ctx *ctx = _dm_mgr_get_ctx();
-    dm_mgr_dev_node_t *node = NULL;
+    dm_mgr_dev_node_t *node = NULL, *search_node = NULL;
 
     if (product_key == NULL || device_name == NULL ||
         strlen(product_key) >= IOTX_PRODUCT_KEY_LEN + 1 ||
@@ -260,7 +463,6 @@ int dm_mgr_device_create(_IN_ int dev_type, _IN_ char product_key[IOTX_PRODUCT_K
     }
     memset(node, 0, sizeof(dm_mgr_dev_node_t));
 
-    node->devid = _dm_mgr_next_devid();
     node->dev_type = dev_type;
 #if defined(DEPRECATED_LINKKIT)
     node->dev_shadow = NULL;
@@ -272,9 +474,21 @@ int dm_mgr_device_create(_IN_ int dev_type, _IN_ char product_key[IOTX_PRODUCT_K
         memcpy(node->device_secret, device_secret, strlen(device_secret));
     }
     node->dev_status = IOTX_DM_DEV_STATUS_AUTHORIZED;
-    INIT_LIST_HEAD(&node->linked_list);
 
-    list_add_tail(&node->linked_list, &ctx->dev_list);
+    _dm_mgr_write_lock();
+    /* created by another thread since the search above */
+    search_node = _dm_mgr_index_find_pkdn(ctx, product_key, device_name);
+    if (search_node != NULL) {
+        _dm_mgr_write_unlock();
+        DM_free(node);
+        if (devid) {
+            *devid = search_node->devid;
+        }
+        return SUCCESS_RETURN;
+    }
+    node->devid = _dm_mgr_next_devid();
+    _dm_mgr_link_dev(ctx, node);
+    _dm_mgr_write_unlock();
 
     if (devid) {
         *devid = node->devid;
@@ -285,23 +499,26 @@ int dm_mgr_device_create(_IN_ int dev_type, _IN_ char product_key[IOTX_PRODUCT_K
 
 int dm_mgr_device_destroy(_IN_ int devid)
 {
-    int res = 0;
+    dm_mgr_ctx *ctx = _dm_mgr_get_ctx();
     dm_mgr_dev_node_t *node = NULL;
 
     if (devid < 0) {
         return DM_INVALID_PARAMETER;
     }
 
-    res = _dm_mgr_search_dev_by_devid(devid, &node);
-    if (res != SUCCESS_RETURN) {
+    if (devid == IOTX_DM_LOCAL_NODE_DEVID) {
         return FAIL_RETURN;
     }
 
-    if (node->devid == IOTX_DM_LOCAL_NODE_DEVID) {
+    _dm_mgr_write_lock();
+    node = _dm_mgr_index_find_devid(ctx, devid);
+    if (node == NULL) {
+        _dm_mgr_write_unlock();
+        dm_log_debug("Device Not Found, devid: %d", devid);
         return FAIL_RETURN;
     }
-
-    list_del(&node->linked_list);
+    _dm_mgr_unlink_dev(ctx, node);
+    _dm_mgr_write_unlock();
 
 #if defined(DEPRECATED_LINKKIT)
     if (node->dev_shadow) {
@@ -320,15 +537,9 @@ int dm_mgr_device_destroy(_IN_ int devid)
 
 int dm_mgr_device_number(void)
 {
-    int index = 0;
     dm_mgr_ctx *ctx = _dm_mgr_get_ctx();
-    dm_mgr_dev_node_t *search_node = NULL;
 
-    list_for_each_entry(search_node, &ctx->dev_list, linked_list, dm_mgr_dev_node_t) {
-        index++;
-    }
-
-    return index;
+    return ctx->dev_count;
 }
 
 int dm_mgr_get_devid_by_index(_IN_ int index, _OU_ int *devid)
@@ -341,39 +552,39 @@ int dm_mgr_get_devid_by_index(_IN_ int index, _OU_ int *devid)
         return DM_INVALID_PARAMETER;
     }
 
+    _dm_mgr_read_lock();
     list_for_each_entry(search_node, &ctx->dev_list, linked_list, dm_mgr_dev_node_t) {
         if (search_index == index) {
             *devid = search_node->devid;
+            _dm_mgr_read_unlock();
             return SUCCESS_RETURN;
         }
         search_index++;
     }
+    _dm_mgr_read_unlock();
 
     return FAIL_RETURN;
 }
 
 int dm_mgr_get_next_devid(_IN_ int devid, _OU_ int *devid_next)
 {
+    int res = FAIL_RETURN;
     dm_mgr_ctx *ctx = _dm_mgr_get_ctx();
     dm_mgr_dev_node_t *search_node = NULL;
-    dm_mgr_dev_node_t *next_node = NULL;
 
     if (devid < 0 || devid_next == NULL) {
         return DM_INVALID_PARAMETER;
     }
 
-    list_for_each_entry(next_node, &ctx->dev_list, linked_list, dm_mgr_dev_node_t) {
-        if (search_node && search_node->devid == devid) {
-            *devid_next = next_node->devid;
-            return SUCCESS_RETURN;
-        }
-
-        if (next_node->devid == devid) {
-            search_node = next_node;
-        }
+    _dm_mgr_read_lock();
+    search_node = _dm_mgr_index_find_devid(ctx, devid);
+    if (search_node != NULL && search_node->linked_list.next != &ctx->dev_list) {
+        *devid_next = list_entry(search_node->linked_list.next, dm_mgr_dev_node_t, linked_list)->devid;
+        res = SUCCESS_RETURN;
     }
+    _dm_mgr_read_unlock();
 
-    return FAIL_RETURN;
+    return res;
 }
 
 int dm_mgr_search_device_by_devid(_IN_ int devid, _OU_ char product_key[IOTX_PRODUCT_KEY_LEN + 1],
@@ -1325,33 +1536,33 @@ int dm_mgr_upstream_thing_log_post(_IN_ int devid, _IN_ char *payload, _IN_ int
 
 
 
+/* method is "thing.event.{identifier}.post" when NULL */
 int dm_mgr_upstream_thing_event_post(_IN_ int devid, _IN_ char *identifier, _IN_ int identifier_len, _IN_ char *method,
                                      _IN_ char *payload, _IN_ int payload_len)
 {
-    int res = 0, service_name_len = 0;
-    char *service_name = NULL;
+    int res = 0;
+    const char *method_fmt = "thing.event.%.*s.post";
     dm_msg_request_t request;
     int event_post_reply = 0;
 
     if (devid < 0 || identifier == NULL || identifier_len <= 0 ||
-        method == NULL || payload == NULL || payload_len <= 0) {
+        payload == NULL || payload_len <= 0) {
         return DM_INVALID_PARAMETER;
     }
 
-    service_name_len = strlen(DM_URI_THING_EVENT_POST) + identifier_len + 1;
-    service_name = DM_malloc(service_name_len);
-    if (service_name == NULL) {
-        return DM_MEMORY_NOT_ENOUGH;
-    }
-    memset(service_name, 0, service_name_len);
-    HAL_Snprintf(service_name, service_name_len, DM_URI_THING_EVENT_POST, identifier_len, identifier);
-
     memset(&request, 0, sizeof(dm_msg_request_t));
-    res = _dm_mgr_upstream_request_assemble(iotx_report_id(), devid, DM_URI_SYS_PREFIX, service_name,
+    res = _dm_mgr_upstream_request_assemble(iotx_report_id(), devid, DM_URI_SYS_PREFIX, DM_URI_THING_EVENT_POST,
                                             payload, payload_len, method, &request);
     if (res != SUCCESS_RETURN) {
         return FAIL_RETURN;
     }
+    request.service_arg = identifier;
+    request.service_arg_len = identifier_len;
+    if (method == NULL) {
+        request.method = method_fmt;
+        request.method_arg = identifier;
+        request.method_arg_len = identifier_len;
+    }
 
     /* Callback */
     request.callback = dm_client_thing_event_post_reply;
@@ -1373,7 +1584,6 @@ int dm_mgr_upstream_thing_event_post(_IN_ int devid, _IN_ char *identifier, _IN_
     if (res == SUCCESS_RETURN) {
         res = request.msgid;
     }
-    DM_free(service_name);
 
     return res;
 }
@@ -1582,8 +1792,7 @@ int dm_mgr_upstream_thing_service_response(_IN_ int devid, _IN_ char *msgid, _IN
         _IN_ iotx_dm_error_code_t code,
         _IN_ char *identifier, _IN_ int identifier_len, _IN_ char *payload, _IN_ int payload_len, void *ctx)
 {
-    int res = 0, service_name_len = 0;
-    char *service_name = NULL;
+    int res = 0;
     dm_msg_request_payload_t request;
     dm_msg_response_t response;
 
@@ -1595,29 +1804,21 @@ int dm_mgr_upstream_thing_service_response(_IN_ int devid, _IN_ char *msgid, _IN
         return DM_INVALID_PARAMETER;
     }
 
-    /* Service Name */
-    service_name_len = strlen(DM_URI_THING_SERVICE_RESPONSE) + identifier_len + 1;
-    service_name = DM_malloc(service_name_len);
-    if (service_name == NULL) {
-        return DM_MEMORY_NOT_ENOUGH;
-    }
-    memset(service_name, 0, service_name_len);
-    HAL_Snprintf(service_name, service_name_len, DM_URI_THING_SERVICE_RESPONSE, identifier_len, identifier);
-
-    res = _dm_mgr_upstream_response_assemble(devid, msgid, msgid_len, DM_URI_SYS_PREFIX, service_name, code, &request,
-            &response);
+    res = _dm_mgr_upstream_response_assemble(devid, msgid, msgid_len, DM_URI_SYS_PREFIX, DM_URI_THING_SERVICE_RESPONSE,
+            code, &request, &response);
     if (res != SUCCESS_RETURN) {
         return FAIL_RETURN;
     }
+    response.service_arg = identifier;
+    response.service_arg_len = identifier_len;
 
-    dm_log_debug("Current Service Name: %s", service_name);
+    dm_log_debug("Current Service Name: %.*s", identifier_len, identifier);
     if (ctx != NULL) {
         dm_msg_response(DM_MSG_DEST_LOCAL, &request, &response, payload, payload_len, ctx);
     } else {
         dm_msg_response(DM_MSG_DEST_CLOUD, &request, &response, payload, payload_len, ctx);
     }
 
-    DM_free(service_name);
     return SUCCESS_RETURN;
 }
 
@@ -1676,9 +1877,8 @@ int dm_mgr_upstream_thing_property_get_response(_IN_ int devid, _IN_ char *msgid
 int dm_mgr_upstream_rrpc_response(_IN_ int devid, _IN_ char *msgid, _IN_ int msgid_len, _IN_ iotx_dm_error_code_t code,
                                   _IN_ char *rrpcid, _IN_ int rrpcid_len, _IN_ char *payload, _IN_ int payload_len)
 {
-    int res = 0, service_name_len = 0;
+    int res = 0;
     const char *rrpc_response_service_name = "rrpc/response/%.*s";
-    char *service_name = NULL;
     dm_msg_request_payload_t request;
     dm_msg_response_t response;
 
@@ -1690,26 +1890,17 @@ int dm_mgr_upstream_rrpc_response(_IN_ int devid, _IN_ char *msgid, _IN_ int msg
         return DM_INVALID_PARAMETER;
     }
 
-    /* Service Name */
-    service_name_len = strlen(rrpc_response_service_name) + rrpcid_len + 1;
-    service_name = DM_malloc(service_name_len);
-    if (service_name == NULL) {
-        return DM_MEMORY_NOT_ENOUGH;
-    }
-    memset(service_name, 0, service_name_len);
-    HAL_Snprintf(service_name, service_name_len, rrpc_response_service_name, rrpcid_len, rrpcid);
-
-    res = _dm_mgr_upstream_response_assemble(devid, msgid, msgid_len, DM_URI_SYS_PREFIX, service_name, code, &request,
-            &response);
+    res = _dm_mgr_upstream_response_assemble(devid, msgid, msgid_len, DM_URI_SYS_PREFIX, rrpc_response_service_name, code,
+            &request, &response);
     if (res != SUCCESS_RETURN) {
         return FAIL_RETURN;
     }
+    response.service_arg = rrpcid;
+    response.service_arg_len = rrpcid_len;
 
-    dm_log_debug("Current Service Name: %s", service_name);
+    dm_log_debug("Current RRPC ID: %.*s", rrpcid_len, rrpcid);
     dm_msg_response(DM_MSG_DEST_ALL, &request, &response, payload, payload_len, NULL);
 
-    DM_free(service_name);
-
     return SUCCESS_RETURN;
 }
 #endif
@@ -1758,15 +1949,18 @@ static int dm_mgr_deprecated_search_devid_by_node(_IN_ dm_mgr_dev_node_t *node,
     dm_mgr_ctx *ctx = _dm_mgr_get_ctx();
     dm_mgr_dev_node_t *search_node = NULL;
 
+    _dm_mgr_read_lock();
     list_for_each_entry(search_node, &ctx->dev_list, linked_list, dm_mgr_dev_node_t) {
         if (search_node == node) {
             /* dm_log_debug("Device Found, node: %p", node); */
             if (devid) {
                 *devid = search_node->devid;
             }
+            _dm_mgr_read_unlock();
             return SUCCESS_RETURN;
         }
     }
+    _dm_mgr_read_unlock();
 
     dm_log_debug("Device Not Found, node: %p", node);
     return FAIL_RETURN;
@@ -2326,8 +2520,8 @@ int dm_mgr_deprecated_assemble_service_output(_IN_ int devid, _IN_ char *identif
 int dm_mgr_deprecated_upstream_thing_service_response(_IN_ int devid, _IN_ int msgid, _IN_ iotx_dm_error_code_t code,
         _IN_ char *identifier, _IN_ int identifier_len, _IN_ char *payload, _IN_ int payload_len)
 {
-    int res = 0, service_name_len = 0;
-    char *msgid_str = NULL, *service_name = NULL;
+    int res = 0;
+    char msgid_str[DM_UTILS_UINT32_STRLEN + 1] = {0};
     dm_msg_request_payload_t request;
     dm_msg_response_t response;
 
@@ -2340,35 +2534,19 @@ int dm_mgr_deprecated_upstream_thing_service_response(_IN_ int devid, _IN_ int m
     }
 
     /* Response Msg ID */
-    res = dm_utils_itoa(msgid, &msgid_str);
-    if (res != SUCCESS_RETURN) {
-        return FAIL_RETURN;
-    }
-    request.id.value = msgid_str;
-    request.id.value_length = strlen(msgid_str);
-
-    /* Service Name */
-    service_name_len = strlen(DM_URI_THING_SERVICE_RESPONSE) + identifier_len + 1;
-    service_name = DM_malloc(service_name_len);
-    if (service_name == NULL) {
-        DM_free(msgid_str);
-        return DM_MEMORY_NOT_ENOUGH;
-    }
-    memset(service_name, 0, service_name_len);
-    HAL_Snprintf(service_name, service_name_len, DM_URI_THING_SERVICE_RESPONSE, identifier_len, identifier);
+    HAL_Snprintf(msgid_str, sizeof(msgid_str), "%d", msgid);
 
-    res = _dm_mgr_upstream_response_assemble(devid, msgid_str, strlen(msgid_str), DM_URI_SYS_PREFIX, service_name, code,
-            &request,
-            &response);
+    res = _dm_mgr_upstream_response_assemble(devid, msgid_str, strlen(msgid_str), DM_URI_SYS_PREFIX,
+            DM_URI_THING_SERVICE_RESPONSE, code, &request, &response);
     if (res != SUCCESS_RETURN) {
         return FAIL_RETURN;
     }
+    response.service_arg = identifier;
+    response.service_arg_len = identifier_len;
 
-    dm_log_debug("Current Service Name: %s", service_name);
+    dm_log_debug("Current Service Name: %.*s", identifier_len, identifier);
     dm_msg_response(DM_MSG_DEST_ALL, &request, &response, payload, payload_len, NULL);
 
-    DM_free(msgid_str);
-    DM_free(service_name);
     return SUCCESS_RETURN;
 }
 #endif
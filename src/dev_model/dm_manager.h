@@ -9,7 +9,7 @@
 
 #include "iotx_dm_internal.h"
 
-typedef struct {
+typedef struct dm_mgr_dev_node_st {
     int devid;
     int dev_type;
 #if defined(DEPRECATED_LINKKIT)
@@ -22,11 +22,26 @@ typedef struct {
     iotx_dm_dev_avail_t status;
     iotx_dm_dev_status_t dev_status;
     struct list_head linked_list;
+    struct dm_mgr_dev_node_st *devid_next;  /* next in devid_index bucket */
+    struct dm_mgr_dev_node_st *pkdn_next;   /* next in pkdn_index bucket */
+    unsigned int pkdn_hash;
 } dm_mgr_dev_node_t;
 
+/*
+ * Devices are kept in dev_list, in creation order, and indexed by devid and
+ * by product key + device name in two hash tables of index_size buckets.
+ * mutex only guards readers and writing: lookups run side by side, a change
+ * of the list waits for them and keeps new ones out until it is done.
+ */
 typedef struct {
     void *mutex;
+    int readers;
+    int writing;
     int global_devid;
+    int dev_count;
+    int index_size;
+    dm_mgr_dev_node_t **devid_index;
+    dm_mgr_dev_node_t **pkdn_index;
     struct list_head dev_list;
 } dm_mgr_ctx;
 
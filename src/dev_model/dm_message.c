@@ -11,17 +11,50 @@ static dm_msg_ctx_t *_dm_msg_get_ctx(void)
     return &g_dm_msg_ctx;
 }
 
+static void _dm_msg_mutex_lock(void)
+{
+    dm_msg_ctx_t *ctx = _dm_msg_get_ctx();
+    if (ctx->mutex) {
+        HAL_MutexLock(ctx->mutex);
+    }
+}
+
+static void _dm_msg_mutex_unlock(void)
+{
+    dm_msg_ctx_t *ctx = _dm_msg_get_ctx();
+    if (ctx->mutex) {
+        HAL_MutexUnlock(ctx->mutex);
+    }
+}
+
 int dm_msg_init(void)
 {
     dm_msg_ctx_t *ctx = _dm_msg_get_ctx();
     memset(ctx, 0, sizeof(dm_msg_ctx_t));
 
+    /* not every sender holds the dm api lock, the writers have their own */
+    ctx->mutex = HAL_MutexCreate();
+    if (ctx->mutex == NULL) {
+        return DM_MEMORY_NOT_ENOUGH;
+    }
+
     return SUCCESS_RETURN;
 }
 
 int dm_msg_deinit(void)
 {
+    int idx = 0;
     dm_msg_ctx_t *ctx = _dm_msg_get_ctx();
+
+    _dm_msg_mutex_lock();
+    for (idx = 0; idx < CONFIG_DM_MSG_WRITER_NUM; idx++) {
+        dm_utils_writer_release(&ctx->writer[idx], 0);
+    }
+    _dm_msg_mutex_unlock();
+
+    if (ctx->mutex) {
+        HAL_MutexDestroy(ctx->mutex);
+    }
     memset(ctx, 0, sizeof(dm_msg_ctx_t));
 
     return SUCCESS_RETURN;
@@ -50,6 +83,155 @@ int _dm_msg_send_to_user(iotx_dm_event_types_t type, char *message)
     return SUCCESS_RETURN;
 }
 
+/* event with @data_len bytes behind it for its strings, @cursor is where the first one goes */
+static iotx_dm_event_t *_dm_msg_event_new(iotx_dm_event_types_t type, int devid, int data_len, char **cursor)
+{
+    iotx_dm_event_t *event = NULL;
+
+    event = DM_malloc(sizeof(iotx_dm_event_t) + data_len);
+    if (event == NULL) {
+        return NULL;
+    }
+    memset(event, 0, sizeof(iotx_dm_event_t));
+    event->type = type;
+    event->devid = devid;
+    *cursor = (char *)(event + 1);
+
+    return event;
+}
+
+static const char *_dm_msg_event_put(char **cursor, const char *value, int value_len)
+{
+    char *dst = *cursor;
+
+    memcpy(dst, value, value_len);
+    dst[value_len] = '\0';
+    *cursor += value_len + 1;
+
+    return dst;
+}
+
+int _dm_msg_send_event_to_user(iotx_dm_event_t *event)
+{
+    int res = 0;
+    dm_ipc_msg_t *dipc_msg = NULL;
+
+    dipc_msg = DM_malloc(sizeof(dm_ipc_msg_t));
+    if (dipc_msg == NULL) {
+        return DM_MEMORY_NOT_ENOUGH;
+    }
+    memset(dipc_msg, 0, sizeof(dm_ipc_msg_t));
+
+    dipc_msg->type = event->type;
+    dipc_msg->event = event;
+
+    res = dm_ipc_msg_insert((void *)dipc_msg);
+    if (res != SUCCESS_RETURN) {
+        DM_free(dipc_msg);
+        return FAIL_RETURN;
+    }
+
+    return SUCCESS_RETURN;
+}
+
+#if !defined(DEVICE_MODEL_RAWDATA_SOLO)
+#ifndef DEPRECATED_LINKKIT
+#ifdef LOG_REPORT_TO_CLOUD
+    const char DM_MSG_PROPERTY_SET_FMT[] DM_READ_ONLY = "{\"devid\":%d,\"payload\":%.*s,\"msgid\":%.*s}";
+#else
+    const char DM_MSG_PROPERTY_SET_FMT[] DM_READ_ONLY = "{\"devid\":%d,\"payload\":%.*s}";
+#endif
+const char DM_MSG_THING_PROPERTY_GET_FMT[] DM_READ_ONLY =
+            "{\"id\":\"%.*s\",\"devid\":%d,\"payload\":%.*s,\"ctx\":\"%s\"}";
+const char DM_MSG_SERVICE_REQUEST_FMT[] DM_READ_ONLY =
+            "{\"id\":\"%.*s\",\"devid\":%d,\"serviceid\":\"%.*s\",\"payload\":%.*s,\"ctx\":\"%s\"}";
+#endif
+const char DM_MSG_EVENT_RRPC_REQUEST_FMT[] DM_READ_ONLY =
+            "{\"id\":\"%.*s\",\"devid\":%d,\"serviceid\":\"%.*s\",\"rrpcid\":\"%.*s\",\"payload\":%.*s}";
+#endif
+
+/* JSON text of typed event, which is what event_callback got before typed events */
+char *dm_msg_event_to_string(const iotx_dm_event_t *event)
+{
+    int message_len = 0;
+    char *message = NULL;
+    uintptr_t ctx_addr_num = 0;
+    char ctx_addr_str[sizeof(uintptr_t) * 2 + 1] = {0};
+
+    switch (event->type) {
+#if !defined(DEVICE_MODEL_RAWDATA_SOLO)
+#ifndef DEPRECATED_LINKKIT
+        case IOTX_DM_EVENT_PROPERTY_SET: {
+            message_len = strlen(DM_MSG_PROPERTY_SET_FMT) + DM_UTILS_UINT32_STRLEN + event->u.property_set.payload_len +
+                          event->u.property_set.msgid_len + 1;
+            message = DM_malloc(message_len);
+            if (message == NULL) {
+                return NULL;
+            }
+#ifdef LOG_REPORT_TO_CLOUD
+            HAL_Snprintf(message, message_len, DM_MSG_PROPERTY_SET_FMT, event->devid, event->u.property_set.payload_len,
+                         event->u.property_set.payload, event->u.property_set.msgid_len, event->u.property_set.msgid);
+#else
+            HAL_Snprintf(message, message_len, DM_MSG_PROPERTY_SET_FMT, event->devid, event->u.property_set.payload_len,
+                         event->u.property_set.payload);
+#endif
+        }
+        break;
+        case IOTX_DM_EVENT_PROPERTY_GET: {
+            ctx_addr_num = (uintptr_t)event->u.property_get.ctx;
+            infra_hex2str((unsigned char *)&ctx_addr_num, sizeof(uintptr_t), ctx_addr_str);
+
+            message_len = strlen(DM_MSG_THING_PROPERTY_GET_FMT) + event->u.property_get.id_len + DM_UTILS_UINT32_STRLEN +
+                          event->u.property_get.payload_len + strlen(ctx_addr_str) + 1;
+            message = DM_malloc(message_len);
+            if (message == NULL) {
+                return NULL;
+            }
+            HAL_Snprintf(message, message_len, DM_MSG_THING_PROPERTY_GET_FMT, event->u.property_get.id_len,
+                         event->u.property_get.id, event->devid, event->u.property_get.payload_len,
+                         event->u.property_get.payload, ctx_addr_str);
+        }
+        break;
+        case IOTX_DM_EVENT_THING_SERVICE_REQUEST: {
+            ctx_addr_num = (uintptr_t)event->u.service_request.ctx;
+            infra_hex2str((unsigned char *)&ctx_addr_num, sizeof(uintptr_t), ctx_addr_str);
+
+            message_len = strlen(DM_MSG_SERVICE_REQUEST_FMT) + event->u.service_request.id_len + DM_UTILS_UINT32_STRLEN +
+                          event->u.service_request.serviceid_len + event->u.service_request.payload_len +
+                          strlen(ctx_addr_str) + 1;
+            message = DM_malloc(message_len);
+            if (message == NULL) {
+                return NULL;
+            }
+            HAL_Snprintf(message, message_len, DM_MSG_SERVICE_REQUEST_FMT, event->u.service_request.id_len,
+                         event->u.service_request.id, event->devid, event->u.service_request.serviceid_len,
+                         event->u.service_request.serviceid, event->u.service_request.payload_len,
+                         event->u.service_request.payload, ctx_addr_str);
+        }
+        break;
+#endif
+        case IOTX_DM_EVENT_RRPC_REQUEST: {
+            message_len = strlen(DM_MSG_EVENT_RRPC_REQUEST_FMT) + event->u.rrpc_request.id_len + DM_UTILS_UINT32_STRLEN +
+                          event->u.rrpc_request.serviceid_len + event->u.rrpc_request.rrpcid_len +
+                          event->u.rrpc_request.payload_len + 1;
+            message = DM_malloc(message_len);
+            if (message == NULL) {
+                return NULL;
+            }
+            HAL_Snprintf(message, message_len, DM_MSG_EVENT_RRPC_REQUEST_FMT, event->u.rrpc_request.id_len,
+                         event->u.rrpc_request.id, event->devid, event->u.rrpc_request.serviceid_len,
+                         event->u.rrpc_request.serviceid, event->u.rrpc_request.rrpcid_len, event->u.rrpc_request.rrpcid,
+                         event->u.rrpc_request.payload_len, event->u.rrpc_request.payload);
+        }
+        break;
+#endif
+        default:
+            break;
+    }
+
+    return message;
+}
+
 const char DM_MSG_SEND_MSG_TIMEOUT_FMT[] DM_READ_ONLY = "{\"id\":%d,\"code\":%d,\"devid\":%d}";
 int dm_msg_send_msg_timeout_to_user(int msg_id, int devid, iotx_dm_event_types_t type)
 {
@@ -110,12 +292,15 @@ int dm_msg_uri_parse_pkdn(_IN_ char *uri, _IN_ int uri_len, _IN_ int start_deli,
 int dm_msg_request_parse(_IN_ char *payload, _IN_ int payload_len, _OU_ dm_msg_request_payload_t *request)
 {
     lite_cjson_t lite;
+    lite_cjson_index_t index;
+    lite_cjson_token_t tokens[CONFIG_DM_JSON_INDEX_TOKENS];
 
     if (payload == NULL || payload_len <= 0 || request == NULL) {
         return DM_INVALID_PARAMETER;
     }
 
-    if (dm_utils_json_parse(payload, payload_len, cJSON_Object, &lite) != SUCCESS_RETURN ||
+    if (dm_utils_json_parse_index(payload, payload_len, cJSON_Object, &index, tokens, CONFIG_DM_JSON_INDEX_TOKENS,
+                                  &lite) != SUCCESS_RETURN ||
         dm_utils_json_object_item(&lite, DM_MSG_KEY_ID, strlen(DM_MSG_KEY_ID), cJSON_String, &request->id) != SUCCESS_RETURN ||
         dm_utils_json_object_item(&lite, DM_MSG_KEY_VERSION, strlen(DM_MSG_KEY_VERSION), cJSON_String,
                                   &request->version) != SUCCESS_RETURN ||
@@ -126,6 +311,9 @@ int dm_msg_request_parse(_IN_ char *payload, _IN_ int payload_len, _OU_ dm_msg_r
         return FAIL_RETURN;
     }
 
+    /* the index is on stack, lookups under items handed out scan their text */
+    request->id.index = request->version.index = request->method.index = request->params.index = NULL;
+
     dm_log_debug("Current Request Message ID: %.*s", request->id.value_length, request->id.value);
     dm_log_debug("Current Request Message Version: %.*s", request->version.value_length, request->version.value);
     dm_log_debug("Current Request Message Method: %.*s", request->method.value_length, request->method.value);
@@ -137,12 +325,15 @@ int dm_msg_request_parse(_IN_ char *payload, _IN_ int payload_len, _OU_ dm_msg_r
 int dm_msg_response_parse(_IN_ char *payload, _IN_ int payload_len, _OU_ dm_msg_response_payload_t *response)
 {
     lite_cjson_t lite, lite_message;
+    lite_cjson_index_t index;
+    lite_cjson_token_t tokens[CONFIG_DM_JSON_INDEX_TOKENS];
 
     if (payload == NULL || payload_len <= 0 || response == NULL) {
         return DM_INVALID_PARAMETER;
     }
 
-    if (dm_utils_json_parse(payload, payload_len, cJSON_Object, &lite) != SUCCESS_RETURN ||
+    if (dm_utils_json_parse_index(payload, payload_len, cJSON_Object, &index, tokens, CONFIG_DM_JSON_INDEX_TOKENS,
+                                  &lite) != SUCCESS_RETURN ||
         dm_utils_json_object_item(&lite, DM_MSG_KEY_ID, strlen(DM_MSG_KEY_ID), cJSON_String, &response->id) != SUCCESS_RETURN ||
         dm_utils_json_object_item(&lite, DM_MSG_KEY_CODE, strlen(DM_MSG_KEY_CODE), cJSON_Number,
                                   &response->code) != SUCCESS_RETURN ||
@@ -161,61 +352,135 @@ int dm_msg_response_parse(_IN_ char *payload, _IN_ int payload_len, _OU_ dm_msg_
         dm_log_debug("Current Request Message Desc: %.*s", response->message.value_length, response->message.value);
     }
 
+    /* the index is on stack, lookups under items handed out scan their text */
+    response->id.index = response->code.index = response->data.index = response->message.index = NULL;
+
     return SUCCESS_RETURN;
 }
 
-const char DM_MSG_REQUEST[] DM_READ_ONLY = "{\"id\":\"%d\",\"version\":\"%s\",\"params\":%.*s,\"method\":\"%s\"}";
+/* prefix formatted with product key and device name, then name formatted with arg when there is one */
+static int _dm_msg_write_uri(dm_utils_writer_t *writer, const char *prefix, const char *name, const char *arg,
+                             int arg_len, char *product_key, char *device_name)
+{
+    if (prefix == NULL && name == NULL) {
+        return DM_INVALID_PARAMETER;
+    }
+
+    if (prefix != NULL) {
+        dm_utils_writer_format(writer, prefix, product_key, device_name);
+    }
+    if (name != NULL && arg != NULL) {
+        dm_utils_writer_format(writer, name, arg_len, arg);
+    } else if (name != NULL) {
+        dm_utils_writer_raw(writer, name, strlen(name));
+    }
+
+    return writer->error;
+}
+
+/*
+ * Writers are only taken and returned under the lock, a message is written and
+ * published without it. When all of them are busy @temp is used instead.
+ */
+static dm_utils_writer_t *_dm_msg_writer_take(dm_utils_writer_t *temp)
+{
+    int idx = 0;
+    dm_msg_ctx_t *ctx = _dm_msg_get_ctx();
+    dm_utils_writer_t *writer = temp;
+
+    _dm_msg_mutex_lock();
+    for (idx = 0; idx < CONFIG_DM_MSG_WRITER_NUM; idx++) {
+        if (ctx->writer_busy[idx] == 0) {
+            ctx->writer_busy[idx] = 1;
+            writer = &ctx->writer[idx];
+            break;
+        }
+    }
+    _dm_msg_mutex_unlock();
+
+    dm_utils_writer_reset(writer);
+    return writer;
+}
+
+static void _dm_msg_writer_give(dm_utils_writer_t *writer, dm_utils_writer_t *temp)
+{
+    dm_msg_ctx_t *ctx = _dm_msg_get_ctx();
+
+    if (writer == temp) {
+        dm_utils_writer_release(writer, 0);
+        return;
+    }
+
+    dm_utils_writer_release(writer, (writer->error != SUCCESS_RETURN) ? 0 : CONFIG_DM_MSG_WRITER_KEEP);
+
+    _dm_msg_mutex_lock();
+    ctx->writer_busy[writer - ctx->writer] = 0;
+    _dm_msg_mutex_unlock();
+}
+
+const char DM_MSG_REQUEST[] DM_READ_ONLY = "{\"id\":\"%d\",\"version\":\"%s\",\"params\":%.*s,\"method\":";
 int dm_msg_request(dm_msg_dest_type_t type, _IN_ dm_msg_request_t *request)
 {
-    int res = 0, payload_len = 0;
-    char *payload = NULL, *uri = NULL;
+    int res = 0, uri_len = 0;
+    char *uri = NULL, *payload = NULL;
+    dm_utils_writer_t temp, *writer = NULL;
     lite_cjson_t lite;
 
     if (request == NULL || request->params == NULL || request->method == NULL) {
         return DM_INVALID_PARAMETER;
     }
 
-    /* Request URI */
-    res = dm_utils_service_name(request->service_prefix, request->service_name,
-                                request->product_key, request->device_name, &uri);
-    if (res != SUCCESS_RETURN) {
+    /* params are pasted as they are, the rest of the message is written well-formed */
+    memset(&lite, 0, sizeof(lite_cjson_t));
+    res = lite_cjson_parse(request->params, request->params_len, &lite);
+    if (res < SUCCESS_RETURN) {
+        dm_log_info("Wrong JSON Format, Params: %.*s", request->params_len, request->params);
         return FAIL_RETURN;
     }
 
-    payload_len = strlen(DM_MSG_REQUEST) + 10 + strlen(DM_MSG_VERSION) + request->params_len + strlen(
-                              request->method) + 1;
-    payload = DM_malloc(payload_len);
-    if (payload == NULL) {
-        DM_free(uri);
-        return DM_MEMORY_NOT_ENOUGH;
+    memset(&temp, 0, sizeof(dm_utils_writer_t));
+    writer = _dm_msg_writer_take(&temp);
+
+    /* URI and payload share one buffer: "uri\0payload\0" */
+    _dm_msg_write_uri(writer, request->service_prefix, request->service_name, request->service_arg,
+                      request->service_arg_len, request->product_key, request->device_name);
+    dm_utils_writer_raw(writer, "", 1);
+    uri_len = writer->len;
+
+    dm_utils_writer_format(writer, DM_MSG_REQUEST, request->msgid, DM_MSG_VERSION,
+                           request->params_len, request->params);
+    dm_utils_writer_raw(writer, "\"", 1);
+    writer->escape = 1;
+    if (request->method_arg != NULL) {
+        dm_utils_writer_format(writer, request->method, request->method_arg_len, request->method_arg);
+    } else {
+        dm_utils_writer_raw(writer, request->method, strlen(request->method));
     }
-    memset(payload, 0, payload_len);
-    HAL_Snprintf(payload, payload_len, DM_MSG_REQUEST, request->msgid,
-                 DM_MSG_VERSION, request->params_len, request->params, request->method);
+    writer->escape = 0;
+    dm_utils_writer_raw(writer, "\"}", 2);
 
-    memset(&lite, 0, sizeof(lite_cjson_t));
-    res = lite_cjson_parse(payload, payload_len, &lite);
-    if (res < SUCCESS_RETURN) {
-        dm_log_info("Wrong JSON Format, URI: %s, Payload: %s", uri, payload);
-        DM_free(uri);
-        DM_free(payload);
-        return FAIL_RETURN;
+    if (writer->error != SUCCESS_RETURN) {
+        res = writer->error;
+        _dm_msg_writer_give(writer, &temp);
+        return (res == DM_MEMORY_NOT_ENOUGH) ? (res) : (FAIL_RETURN);
     }
+    uri = writer->buf;
+    payload = writer->buf + uri_len;
 
     dm_log_info("DM Send Message, URI: %s, Payload: %s", uri, payload);
 
     if (type & DM_MSG_DEST_CLOUD) {
-        dm_client_publish(uri, (unsigned char *)payload, strlen(payload), request->callback);
+        dm_client_publish(uri, (unsigned char *)payload, writer->len - uri_len, request->callback);
     }
 
 #ifdef ALCS_ENABLED
     if (type & DM_MSG_DEST_LOCAL) {
-        dm_server_send(uri, (unsigned char *)payload, strlen(payload), NULL);
+        dm_server_send(uri, (unsigned char *)payload, writer->len - uri_len, NULL);
     }
 #endif
 
-    DM_free(uri);
-    DM_free(payload);
+    _dm_msg_writer_give(writer, &temp);
+
     return SUCCESS_RETURN;
 }
 
@@ -223,66 +488,66 @@ const char DM_MSG_RESPONSE_WITH_DATA[] DM_READ_ONLY = "{\"id\":\"%.*s\",\"code\"
 int dm_msg_response(dm_msg_dest_type_t type, _IN_ dm_msg_request_payload_t *request, _IN_ dm_msg_response_t *response,
                     _IN_ char *data, _IN_ int data_len, _IN_ void *user_data)
 {
-    int res = 0, payload_len = 0;
+    int res = 0, uri_len = 0;
     char *uri = NULL, *payload = NULL;
+    dm_utils_writer_t temp, *writer = NULL;
     lite_cjson_t lite;
 
     if (request == NULL || response == NULL || data == NULL || data_len <= 0) {
         return DM_INVALID_PARAMETER;
     }
 
-    /* Response URI */
-    res = dm_utils_service_name(response->service_prefix, response->service_name,
-                                response->product_key, response->device_name, &uri);
-    if (res != SUCCESS_RETURN) {
+    memset(&lite, 0, sizeof(lite_cjson_t));
+    res = lite_cjson_parse(data, data_len, &lite);
+    if (res < SUCCESS_RETURN) {
+        dm_log_info("Wrong JSON Format, Data: %.*s", data_len, data);
         return FAIL_RETURN;
     }
 
-    /* Response Payload */
-    payload_len = strlen(DM_MSG_RESPONSE_WITH_DATA) + request->id.value_length + DM_UTILS_UINT32_STRLEN + data_len + 1;
-    payload = DM_malloc(payload_len);
-    if (payload == NULL) {
-        DM_free(uri);
-        return DM_MEMORY_NOT_ENOUGH;
-    }
-    memset(payload, 0, payload_len);
-    HAL_Snprintf(payload, payload_len, DM_MSG_RESPONSE_WITH_DATA,
-                 request->id.value_length, request->id.value, response->code, data_len, data);
+    memset(&temp, 0, sizeof(dm_utils_writer_t));
+    writer = _dm_msg_writer_take(&temp);
 
-    memset(&lite, 0, sizeof(lite_cjson_t));
-    res = lite_cjson_parse(payload, payload_len, &lite);
-    if (res < SUCCESS_RETURN) {
-        dm_log_info("Wrong JSON Format, URI: %s, Payload: %s", uri, payload);
-        DM_free(uri);
-        DM_free(payload);
-        return FAIL_RETURN;
+    /* URI and payload share one buffer: "uri\0payload\0" */
+    _dm_msg_write_uri(writer, response->service_prefix, response->service_name, response->service_arg,
+                      response->service_arg_len, response->product_key, response->device_name);
+    dm_utils_writer_raw(writer, "", 1);
+    uri_len = writer->len;
+
+    dm_utils_writer_format(writer, DM_MSG_RESPONSE_WITH_DATA,
+                           request->id.value_length, request->id.value, response->code, data_len, data);
+
+    if (writer->error != SUCCESS_RETURN) {
+        res = writer->error;
+        _dm_msg_writer_give(writer, &temp);
+        return (res == DM_MEMORY_NOT_ENOUGH) ? (res) : (FAIL_RETURN);
     }
+    uri = writer->buf;
+    payload = writer->buf + uri_len;
 
     dm_log_info("Send URI: %s, Payload: %s", uri, payload);
 
     if (type & DM_MSG_DEST_CLOUD) {
-        dm_client_publish(uri, (unsigned char *)payload, strlen(payload), NULL);
+        dm_client_publish(uri, (unsigned char *)payload, writer->len - uri_len, NULL);
     }
 
 #ifdef ALCS_ENABLED
     if (type & DM_MSG_DEST_LOCAL) {
         char *end = NULL;
         do {
-            if (strlen(uri) < 6) {
+            if (uri_len - 1 < 6) {
                 break;
             }
-            end = uri + strlen(uri) - 6;
+            end = uri + uri_len - 1 - 6;
             if (strstr(end, "_reply") != 0) {
                 *end = '\0';
             }
-            dm_server_send(uri, (unsigned char *)payload, strlen(payload), user_data);
+            dm_server_send(uri, (unsigned char *)payload, writer->len - uri_len, user_data);
         } while (0);
 
     }
 #endif
 
-    DM_free(uri);
-    DM_free(payload);
+    _dm_msg_writer_give(writer, &temp);
 
     return SUCCESS_RETURN;
 }
@@ -378,87 +643,75 @@ int dm_msg_thing_model_up_raw_reply(_IN_ char product_key[IOTX_PRODUCT_KEY_LEN +
 
 #if !defined(DEVICE_MODEL_RAWDATA_SOLO)
 #ifndef DEPRECATED_LINKKIT
-#ifdef LOG_REPORT_TO_CLOUD
-    const char DM_MSG_PROPERTY_SET_FMT[] DM_READ_ONLY = "{\"devid\":%d,\"payload\":%.*s,\"msgid\":%.*s}";
-#else
-    const char DM_MSG_PROPERTY_SET_FMT[] DM_READ_ONLY = "{\"devid\":%d,\"payload\":%.*s}";
-#endif
 int dm_msg_property_set(int devid, dm_msg_request_payload_t *request)
 {
-    int res = 0, message_len = 0;
-    char *message = NULL;
+    int res = 0;
+    char *cursor = NULL;
+    iotx_dm_event_t *event = NULL;
 
-    message_len = strlen(DM_MSG_PROPERTY_SET_FMT) + DM_UTILS_UINT32_STRLEN + request->params.value_length + 1;
-    message = DM_malloc(message_len);
-    if (message == NULL) {
+    if (!lite_cjson_is_object(&request->params)) {
+        return DM_INVALID_PARAMETER;
+    }
+
+    event = _dm_msg_event_new(IOTX_DM_EVENT_PROPERTY_SET, devid,
+                              request->id.value_length + request->params.value_length + 2, &cursor);
+    if (event == NULL) {
         return DM_MEMORY_NOT_ENOUGH;
     }
-    memset(message, 0, message_len);
-#ifdef LOG_REPORT_TO_CLOUD
-    HAL_Snprintf(message, message_len, DM_MSG_PROPERTY_SET_FMT, devid, request->params.value_length, request->params.value,
-                 request->id.value_length, request->id.value);
-#else
-    HAL_Snprintf(message, message_len, DM_MSG_PROPERTY_SET_FMT, devid, request->params.value_length, request->params.value);
-#endif
-    res = _dm_msg_send_to_user(IOTX_DM_EVENT_PROPERTY_SET, message);
+    event->u.property_set.msgid = _dm_msg_event_put(&cursor, request->id.value, request->id.value_length);
+    event->u.property_set.msgid_len = request->id.value_length;
+    event->u.property_set.payload = _dm_msg_event_put(&cursor, request->params.value, request->params.value_length);
+    event->u.property_set.payload_len = request->params.value_length;
+
+    res = _dm_msg_send_event_to_user(event);
     if (res != SUCCESS_RETURN) {
-        DM_free(message);
+        DM_free(event);
         return FAIL_RETURN;
     }
     return SUCCESS_RETURN;
 }
 
-const char DM_MSG_THING_PROPERTY_GET_FMT[] DM_READ_ONLY =
-            "{\"id\":\"%.*s\",\"devid\":%d,\"payload\":%.*s,\"ctx\":\"%s\"}";
 int dm_msg_property_get(_IN_ int devid, _IN_ dm_msg_request_payload_t *request, _IN_ void *ctx)
 {
-    int res = 0, message_len = 0;
-    uintptr_t ctx_addr_num = (uintptr_t)ctx;
-    char *ctx_addr_str = NULL, *message = NULL;
+    int res = 0;
+    char *cursor = NULL;
+    iotx_dm_event_t *event = NULL;
 
-    ctx_addr_str = DM_malloc(sizeof(uintptr_t) * 2 + 1);
-    if (ctx_addr_str == NULL) {
-        return DM_MEMORY_NOT_ENOUGH;
+    if (!lite_cjson_is_array(&request->params)) {
+        return DM_INVALID_PARAMETER;
     }
-    memset(ctx_addr_str, 0, sizeof(uintptr_t) * 2 + 1);
-
-    /*  dm_log_debug("ctx: %p", ctx);
-     dm_log_debug("ctx_addr_num: %0x016llX", ctx_addr_num); */
-    infra_hex2str((unsigned char *)&ctx_addr_num, sizeof(uintptr_t), ctx_addr_str);
-    /* dm_log_debug("ctx_addr_str: %s", ctx_addr_str); */
 
-    message_len = strlen(DM_MSG_THING_PROPERTY_GET_FMT) + request->id.value_length + DM_UTILS_UINT32_STRLEN +
-                  request->params.value_length + strlen(ctx_addr_str) + 1;
-    message = DM_malloc(message_len);
-    if (message == NULL) {
-        DM_free(ctx_addr_str);
+    event = _dm_msg_event_new(IOTX_DM_EVENT_PROPERTY_GET, devid,
+                              request->id.value_length + request->params.value_length + 2, &cursor);
+    if (event == NULL) {
         return DM_MEMORY_NOT_ENOUGH;
     }
-    memset(message, 0, message_len);
-    HAL_Snprintf(message, message_len, DM_MSG_THING_PROPERTY_GET_FMT, request->id.value_length, request->id.value, devid,
-                 request->params.value_length, request->params.value, ctx_addr_str);
+    event->u.property_get.id = _dm_msg_event_put(&cursor, request->id.value, request->id.value_length);
+    event->u.property_get.id_len = request->id.value_length;
+    event->u.property_get.payload = _dm_msg_event_put(&cursor, request->params.value, request->params.value_length);
+    event->u.property_get.payload_len = request->params.value_length;
+    event->u.property_get.ctx = ctx;
 
-    DM_free(ctx_addr_str);
-
-    res = _dm_msg_send_to_user(IOTX_DM_EVENT_PROPERTY_GET, message);
+    res = _dm_msg_send_event_to_user(event);
     if (res != SUCCESS_RETURN) {
-        DM_free(message);
+        DM_free(event);
         return FAIL_RETURN;
     }
 
     return SUCCESS_RETURN;
 }
 
-const char DM_MSG_SERVICE_REQUEST_FMT[] DM_READ_ONLY =
-            "{\"id\":\"%.*s\",\"devid\":%d,\"serviceid\":\"%.*s\",\"payload\":%.*s,\"ctx\":\"%s\"}";
 int dm_msg_thing_service_request(_IN_ char product_key[IOTX_PRODUCT_KEY_LEN + 1],
                                  _IN_ char device_name[IOTX_DEVICE_NAME_LEN + 1],
                                  char *identifier, int identifier_len, dm_msg_request_payload_t *request,  _IN_ void *ctx)
 {
-    int res = 0, devid = 0, message_len = 0;
-    char *message = NULL;
-    uintptr_t ctx_addr_num = (uintptr_t)ctx;
-    char *ctx_addr_str = NULL;
+    int res = 0, devid = 0;
+    char *cursor = NULL;
+    iotx_dm_event_t *event = NULL;
+
+    if (!lite_cjson_is_object(&request->params)) {
+        return DM_INVALID_PARAMETER;
+    }
 
     res = dm_mgr_search_device_by_pkdn(product_key, device_name, &devid);
     if (res != SUCCESS_RETURN) {
@@ -472,30 +725,22 @@ int dm_msg_thing_service_request(_IN_ char product_key[IOTX_PRODUCT_KEY_LEN + 1]
     }
 #endif
 
-    ctx_addr_str = DM_malloc(sizeof(uintptr_t) * 2 + 1);
-    if (ctx_addr_str == NULL) {
+    event = _dm_msg_event_new(IOTX_DM_EVENT_THING_SERVICE_REQUEST, devid,
+                              request->id.value_length + identifier_len + request->params.value_length + 3, &cursor);
+    if (event == NULL) {
         return DM_MEMORY_NOT_ENOUGH;
     }
-    memset(ctx_addr_str, 0, sizeof(uintptr_t) * 2 + 1);
-    infra_hex2str((unsigned char *)&ctx_addr_num, sizeof(uintptr_t), ctx_addr_str);
+    event->u.service_request.id = _dm_msg_event_put(&cursor, request->id.value, request->id.value_length);
+    event->u.service_request.id_len = request->id.value_length;
+    event->u.service_request.serviceid = _dm_msg_event_put(&cursor, identifier, identifier_len);
+    event->u.service_request.serviceid_len = identifier_len;
+    event->u.service_request.payload = _dm_msg_event_put(&cursor, request->params.value, request->params.value_length);
+    event->u.service_request.payload_len = request->params.value_length;
+    event->u.service_request.ctx = ctx;
 
-    message_len = strlen(DM_MSG_SERVICE_REQUEST_FMT) + request->id.value_length + DM_UTILS_UINT32_STRLEN + identifier_len +
-                  request->params.value_length + strlen(ctx_addr_str)  + 1;
-    message = DM_malloc(message_len);
-    if (message == NULL) {
-        DM_free(ctx_addr_str);
-        return DM_MEMORY_NOT_ENOUGH;
-    }
-
-    memset(message, 0, message_len);
-    HAL_Snprintf(message, message_len, DM_MSG_SERVICE_REQUEST_FMT, request->id.value_length, request->id.value, devid,
-                 identifier_len, identifier,
-                 request->params.value_length, request->params.value, ctx_addr_str);
-
-    DM_free(ctx_addr_str);
-    res = _dm_msg_send_to_user(IOTX_DM_EVENT_THING_SERVICE_REQUEST, message);
+    res = _dm_msg_send_event_to_user(event);
     if (res != SUCCESS_RETURN) {
-        DM_free(message);
+        DM_free(event);
         return FAIL_RETURN;
     }
 
@@ -503,15 +748,18 @@ int dm_msg_thing_service_request(_IN_ char product_key[IOTX_PRODUCT_KEY_LEN + 1]
 }
 #endif
 
-const char DM_MSG_EVENT_RRPC_REQUEST_FMT[] DM_READ_ONLY =
-            "{\"id\":\"%.*s\",\"devid\":%d,\"serviceid\":\"%.*s\",\"rrpcid\":\"%.*s\",\"payload\":%.*s}";
 int dm_msg_rrpc_request(_IN_ char product_key[IOTX_PRODUCT_KEY_LEN + 1],
                         _IN_ char device_name[IOTX_DEVICE_NAME_LEN + 1],
                         char *rrpcid, int rrpcid_len, dm_msg_request_payload_t *request)
 {
-    int res = 0, devid = 0, message_len = 0;
+    int res = 0, devid = 0;
     int service_offset = 0, serviceid_len = 0;
-    char *serviceid = NULL, *message = NULL;
+    char *serviceid = NULL, *cursor = NULL;
+    iotx_dm_event_t *event = NULL;
+
+    if (!lite_cjson_is_object(&request->params)) {
+        return DM_INVALID_PARAMETER;
+    }
 
     /* Get Devid */
     res = dm_mgr_search_device_by_pkdn(product_key, device_name, &devid);
@@ -529,21 +777,23 @@ int dm_msg_rrpc_request(_IN_ char product_key[IOTX_PRODUCT_KEY_LEN + 1],
     /* dm_log_info("Current RRPC Service ID: %.*s", serviceid_len, serviceid); */
 
     /* Send Message To User */
-    message_len = strlen(DM_MSG_EVENT_RRPC_REQUEST_FMT) + request->id.value_length + DM_UTILS_UINT32_STRLEN + serviceid_len
-                  + rrpcid_len +
-                  request->params.value_length + 1;
-    message = DM_malloc(message_len);
-    if (message == NULL) {
+    event = _dm_msg_event_new(IOTX_DM_EVENT_RRPC_REQUEST, devid,
+                              request->id.value_length + serviceid_len + rrpcid_len + request->params.value_length + 4, &cursor);
+    if (event == NULL) {
         return DM_MEMORY_NOT_ENOUGH;
     }
-    memset(message, 0, message_len);
-    HAL_Snprintf(message, message_len, DM_MSG_EVENT_RRPC_REQUEST_FMT, request->id.value_length, request->id.value, devid,
-                 serviceid_len, serviceid, rrpcid_len, rrpcid,
-                 request->params.value_length, request->params.value);
+    event->u.rrpc_request.id = _dm_msg_event_put(&cursor, request->id.value, request->id.value_length);
+    event->u.rrpc_request.id_len = request->id.value_length;
+    event->u.rrpc_request.serviceid = _dm_msg_event_put(&cursor, serviceid, serviceid_len);
+    event->u.rrpc_request.serviceid_len = serviceid_len;
+    event->u.rrpc_request.rrpcid = _dm_msg_event_put(&cursor, rrpcid, rrpcid_len);
+    event->u.rrpc_request.rrpcid_len = rrpcid_len;
+    event->u.rrpc_request.payload = _dm_msg_event_put(&cursor, request->params.value, request->params.value_length);
+    event->u.rrpc_request.payload_len = request->params.value_length;
 
-    res = _dm_msg_send_to_user(IOTX_DM_EVENT_RRPC_REQUEST, message);
+    res = _dm_msg_send_event_to_user(event);
     if (res != SUCCESS_RETURN) {
-        DM_free(message);
+        DM_free(event);
         return FAIL_RETURN;
     }
 
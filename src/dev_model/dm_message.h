@@ -65,17 +65,23 @@ typedef struct {
     int devid;
     const char *service_prefix;
     const char *service_name;
+    const char *service_arg;    /* taken by %.*s of service_name when not NULL */
+    int service_arg_len;
     char product_key[IOTX_PRODUCT_KEY_LEN + 1];
     char device_name[IOTX_DEVICE_NAME_LEN + 1];
     char *params;
     int params_len;
-    char *method;
+    const char *method;
+    const char *method_arg;     /* taken by %.*s of method when not NULL */
+    int method_arg_len;
     iotx_cm_data_handle_cb callback;
 } dm_msg_request_t;
 
 typedef struct {
     const char *service_prefix;
     const char *service_name;
+    const char *service_arg;    /* taken by %.*s of service_name when not NULL */
+    int service_arg_len;
     char product_key[IOTX_PRODUCT_KEY_LEN + 1];
     char device_name[IOTX_DEVICE_NAME_LEN + 1];
     iotx_dm_error_code_t code;
@@ -83,12 +89,17 @@ typedef struct {
 
 typedef struct {
     int id;
+    void *mutex;
+    dm_utils_writer_t writer[CONFIG_DM_MSG_WRITER_NUM];    /* URI and payload of upstream messages being sent */
+    uint8_t writer_busy[CONFIG_DM_MSG_WRITER_NUM];
 } dm_msg_ctx_t;
 
 
 int dm_msg_init(void);
 int dm_msg_deinit(void);
 int _dm_msg_send_to_user(iotx_dm_event_types_t type, char *message);
+int _dm_msg_send_event_to_user(iotx_dm_event_t *event);
+char *dm_msg_event_to_string(const iotx_dm_event_t *event);
 int dm_msg_send_msg_timeout_to_user(int msg_id, int devid, iotx_dm_event_types_t type);
 int dm_msg_uri_parse_pkdn(_IN_ char *uri, _IN_ int uri_len, _IN_ int start_deli, _IN_ int end_deli,
                           _OU_ char product_key[IOTX_PRODUCT_KEY_LEN + 1], _OU_ char device_name[IOTX_DEVICE_NAME_LEN + 1]);
@@ -4,6 +4,7 @@
 
 
 
+#include <stdarg.h>
 #include "iotx_dm_internal.h"
 
 int dm_utils_copy_direct(_IN_ void *input, _IN_ int input_len, _OU_ void **output, _IN_ int output_len)
@@ -379,6 +380,31 @@ int dm_utils_json_parse(_IN_ const char *payload, _IN_ int payload_len, _IN_ int
     return SUCCESS_RETURN;
 }
 
+/* items found under @lite refer to @index and @tokens, so they are only used while those are */
+int dm_utils_json_parse_index(_IN_ const char *payload, _IN_ int payload_len, _IN_ int type, _IN_ lite_cjson_index_t *index,
+                              _IN_ lite_cjson_token_t *tokens, _IN_ int token_max, _OU_ lite_cjson_t *lite)
+{
+    int res = 0;
+
+    if (payload == NULL || payload_len <= 0 || type < 0 || index == NULL || tokens == NULL || lite == NULL) {
+        return DM_INVALID_PARAMETER;
+    }
+    memset(lite, 0, sizeof(lite_cjson_t));
+
+    res = lite_cjson_parse_index(payload, payload_len, index, tokens, token_max, lite);
+    if (res != SUCCESS_RETURN) {
+        memset(lite, 0, sizeof(lite_cjson_t));
+        return FAIL_RETURN;
+    }
+
+    if (type != cJSON_Invalid && lite->type != type) {
+        memset(lite, 0, sizeof(lite_cjson_t));
+        return FAIL_RETURN;
+    }
+
+    return SUCCESS_RETURN;
+}
+
 int dm_utils_json_object_item(_IN_ lite_cjson_t *lite, _IN_ const char *key, _IN_ int key_len, _IN_ int type,
                               _OU_ lite_cjson_t *lite_item)
 {
@@ -409,6 +435,200 @@ int dm_utils_json_object_item(_IN_ lite_cjson_t *lite, _IN_ const char *key, _IN
     return SUCCESS_RETURN;
 }
 
+/* make room for str_len more bytes and the '\0' after them */
+static int _dm_utils_writer_reserve(dm_utils_writer_t *writer, int str_len)
+{
+    int size = 0;
+    char *buf = NULL;
+
+    if (writer->error != SUCCESS_RETURN) {
+        return writer->error;
+    }
+    if (writer->len + str_len + 1 <= writer->size) {
+        return SUCCESS_RETURN;
+    }
+
+    size = (writer->size > 0) ? (writer->size) : (DM_UTILS_WRITER_MIN_SIZE);
+    while (size < writer->len + str_len + 1) {
+        size *= 2;
+    }
+    buf = DM_malloc(size);
+    if (buf == NULL) {
+        writer->error = DM_MEMORY_NOT_ENOUGH;
+        return writer->error;
+    }
+    if (writer->buf != NULL) {
+        memcpy(buf, writer->buf, writer->len);
+        DM_free(writer->buf);
+    }
+    writer->buf = buf;
+    writer->size = size;
+
+    return SUCCESS_RETURN;
+}
+
+void dm_utils_writer_reset(_IN_ dm_utils_writer_t *writer)
+{
+    writer->len = 0;
+    writer->escape = 0;
+    writer->error = SUCCESS_RETURN;
+    if (writer->buf != NULL) {
+        writer->buf[0] = '\0';
+    }
+}
+
+static int _dm_utils_writer_copy(dm_utils_writer_t *writer, const char *str, int str_len)
+{
+    if (_dm_utils_writer_reserve(writer, str_len) != SUCCESS_RETURN) {
+        return writer->error;
+    }
+
+    memcpy(writer->buf + writer->len, str, str_len);
+    writer->len += str_len;
+    writer->buf[writer->len] = '\0';
+
+    return SUCCESS_RETURN;
+}
+
+static int _dm_utils_writer_escaped(dm_utils_writer_t *writer, const char *str, int str_len)
+{
+    const char hex[] = "0123456789abcdef";
+    char escaped[6] = {'\\', 0, '0', '0', 0, 0};
+    int index = 0, start = 0, escaped_len = 0;
+    unsigned char c = 0;
+
+    for (index = 0; index < str_len; index++) {
+        c = (unsigned char)str[index];
+        if (c >= 0x20 && c != '\"' && c != '\\') {
+            continue;
+        }
+        escaped_len = 2;
+        switch (c) {
+            case '\"':
+            case '\\':
+                escaped[1] = c;
+                break;
+            case '\b':
+                escaped[1] = 'b';
+                break;
+            case '\f':
+                escaped[1] = 'f';
+                break;
+            case '\n':
+                escaped[1] = 'n';
+                break;
+            case '\r':
+                escaped[1] = 'r';
+                break;
+            case '\t':
+                escaped[1] = 't';
+                break;
+            default:
+                escaped[1] = 'u';
+                escaped[4] = hex[c >> 4];
+                escaped[5] = hex[c & 0x0F];
+                escaped_len = 6;
+                break;
+        }
+        _dm_utils_writer_copy(writer, str + start, index - start);
+        _dm_utils_writer_copy(writer, escaped, escaped_len);
+        start = index + 1;
+    }
+
+    return _dm_utils_writer_copy(writer, str + start, str_len - start);
+}
+
+int dm_utils_writer_raw(_IN_ dm_utils_writer_t *writer, _IN_ const char *str, _IN_ int str_len)
+{
+    if (writer->escape) {
+        return _dm_utils_writer_escaped(writer, str, str_len);
+    }
+
+    return _dm_utils_writer_copy(writer, str, str_len);
+}
+
+int dm_utils_writer_int(_IN_ dm_utils_writer_t *writer, _IN_ int value)
+{
+    char digits[DM_UTILS_UINT32_STRLEN + 1];
+    unsigned int magnitude = (value < 0) ? (0u - (unsigned int)value) : ((unsigned int)value);
+    int pos = sizeof(digits);
+
+    do {
+        digits[--pos] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0) {
+        digits[--pos] = '-';
+    }
+
+    return dm_utils_writer_raw(writer, digits + pos, sizeof(digits) - pos);
+}
+
+int dm_utils_writer_string(_IN_ dm_utils_writer_t *writer, _IN_ const char *str, _IN_ int str_len)
+{
+    dm_utils_writer_raw(writer, "\"", 1);
+    writer->escape = 1;
+    dm_utils_writer_raw(writer, str, str_len);
+    writer->escape = 0;
+
+    return dm_utils_writer_raw(writer, "\"", 1);
+}
+
+/* understands %s, %.*s, %d and %%, as used by URI and message templates */
+int dm_utils_writer_format(_IN_ dm_utils_writer_t *writer, _IN_ const char *fmt, ...)
+{
+    va_list args;
+    const char *start = fmt, *str = NULL, *end = NULL;
+    int str_len = 0;
+
+    va_start(args, fmt);
+    while (*fmt != '\0') {
+        if (*fmt != '%') {
+            fmt++;
+            continue;
+        }
+        dm_utils_writer_raw(writer, start, fmt - start);
+        if (fmt[1] == 's') {
+            str = va_arg(args, const char *);
+            dm_utils_writer_raw(writer, str, strlen(str));
+            fmt += 2;
+        } else if (fmt[1] == '.' && fmt[2] == '*' && fmt[3] == 's') {
+            /* like printf, stops at a '\0' within the given length */
+            str_len = va_arg(args, int);
+            str = va_arg(args, const char *);
+            end = memchr(str, '\0', str_len);
+            dm_utils_writer_raw(writer, str, (end != NULL) ? (end - str) : (str_len));
+            fmt += 4;
+        } else if (fmt[1] == 'd') {
+            dm_utils_writer_int(writer, va_arg(args, int));
+            fmt += 2;
+        } else if (fmt[1] == '%' || fmt[1] == '\0') {
+            dm_utils_writer_raw(writer, "%", 1);
+            fmt += (fmt[1] == '%') ? (2) : (1);
+        } else {
+            /* not understood, copied as it is */
+            dm_utils_writer_raw(writer, fmt, 2);
+            fmt += 2;
+        }
+        start = fmt;
+    }
+    dm_utils_writer_raw(writer, start, fmt - start);
+    va_end(args);
+
+    return writer->error;
+}
+
+/* buffer is freed once it grew beyond keep_size, so one large message does not hold on to its size */
+void dm_utils_writer_release(_IN_ dm_utils_writer_t *writer, _IN_ int keep_size)
+{
+    if (writer->buf != NULL && writer->size > keep_size) {
+        DM_free(writer->buf);
+        writer->buf = NULL;
+        writer->size = 0;
+    }
+    dm_utils_writer_reset(writer);
+}
+
 void *dm_utils_malloc(unsigned int size)
 {
 #ifdef INFRA_MEM_STATS
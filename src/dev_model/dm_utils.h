@@ -44,8 +44,33 @@ int dm_utils_service_name(const char *prefix, const char *name, char product_key
                           char device_name[IOTX_DEVICE_NAME_LEN + 1], char **service_name);
 int dm_utils_uri_add_prefix(const char *prefix, char *uri, char **new_uri);
 int dm_utils_json_parse(const char *payload, int payload_len, int type, lite_cjson_t *lite);
+int dm_utils_json_parse_index(const char *payload, int payload_len, int type, lite_cjson_index_t *index,
+                              lite_cjson_token_t *tokens, int token_max, lite_cjson_t *lite);
 int dm_utils_json_object_item(lite_cjson_t *lite, const char *key, int key_len, int type,
                               lite_cjson_t *lite_item);
+/* first buffer of a writer, doubled whenever a write does not fit */
+#define DM_UTILS_WRITER_MIN_SIZE (128)
+
+/*
+ * Text written in one pass into a buffer that grows as needed and is kept
+ * between messages. buf[len] is always '\0'. A failed allocation is kept in
+ * error and later writes do nothing, so it can be checked once at the end.
+ * With escape set, what is written is escaped for a JSON string.
+ */
+typedef struct {
+    char *buf;
+    int size;
+    int len;
+    int escape;
+    int error;
+} dm_utils_writer_t;
+
+void dm_utils_writer_reset(dm_utils_writer_t *writer);
+int dm_utils_writer_raw(dm_utils_writer_t *writer, const char *str, int str_len);
+int dm_utils_writer_int(dm_utils_writer_t *writer, int value);
+int dm_utils_writer_string(dm_utils_writer_t *writer, const char *str, int str_len);
+int dm_utils_writer_format(dm_utils_writer_t *writer, const char *fmt, ...);
+void dm_utils_writer_release(dm_utils_writer_t *writer, int keep_size);
 void *dm_utils_malloc(unsigned int size);
 void dm_utils_free(void *ptr);
 #endif
@@ -27,7 +27,6 @@
 #define IOTX_LINKKIT_KEY_ID          "id"
 #define IOTX_LINKKIT_KEY_CODE        "code"
 #define IOTX_LINKKIT_KEY_DEVID       "devid"
-#define IOTX_LINKKIT_KEY_SERVICEID   "serviceid"
 #define IOTX_LINKKIT_KEY_PROPERTYID  "propertyid"
 #define IOTX_LINKKIT_KEY_EVENTID     "eventid"
 #define IOTX_LINKKIT_KEY_PAYLOAD     "payload"
@@ -39,8 +38,6 @@
 #define IOTX_LINKKIT_KEY_URL         "url"
 #define IOTX_LINKKIT_KEY_VERSION     "version"
 #define IOTX_LINKKIT_KEY_UTC         "utc"
-#define IOTX_LINKKIT_KEY_RRPCID      "rrpcid"
-#define IOTX_LINKKIT_KEY_CTX         "ctx"
 #define IOTX_LINKKIT_KEY_TOPO        "topo"
 #define IOTX_LINKKIT_KEY_PRODUCT_KEY "productKey"
 #define IOTX_LINKKIT_KEY_TIME        "time"
@@ -231,39 +228,31 @@ static void _iotx_linkkit_event_callback(iotx_dm_event_types_t type, char *paylo
 {
     int res = 0;
     void *callback;
-#ifdef LOG_REPORT_TO_CLOUD
-    lite_cjson_t msg_id;
-#endif
-    lite_cjson_t lite, lite_item_id, lite_item_devid, lite_item_serviceid, lite_item_payload, lite_item_ctx;
-    lite_cjson_t lite_item_code, lite_item_eventid, lite_item_utc, lite_item_rrpcid, lite_item_topo;
+    lite_cjson_t lite, lite_item_id, lite_item_devid, lite_item_payload;
+    lite_cjson_t lite_item_code, lite_item_eventid, lite_item_utc, lite_item_topo;
     lite_cjson_t lite_item_pk, lite_item_time;
     lite_cjson_t lite_item_version, lite_item_configid, lite_item_configsize, lite_item_gettype, lite_item_sign,
                  lite_item_signmethod, lite_item_url;
+    lite_cjson_index_t lite_index;
+    lite_cjson_token_t lite_tokens[CONFIG_DM_JSON_INDEX_TOKENS];
 
     dm_log_info("Receive Message Type: %d", type);
     if (payload) {
         dm_log_info("Receive Message: %s", payload);
-        res = dm_utils_json_parse(payload, strlen(payload), cJSON_Invalid, &lite);
+        res = dm_utils_json_parse_index(payload, strlen(payload), cJSON_Invalid, &lite_index, lite_tokens,
+                                        CONFIG_DM_JSON_INDEX_TOKENS, &lite);
         if (res != SUCCESS_RETURN) {
             return;
         }
-#ifdef LOG_REPORT_TO_CLOUD
-        dm_utils_json_object_item(&lite, "msgid", 5, cJSON_Invalid, &msg_id);
-#endif
         dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_ID, strlen(IOTX_LINKKIT_KEY_ID), cJSON_Invalid, &lite_item_id);
         dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_DEVID, strlen(IOTX_LINKKIT_KEY_DEVID), cJSON_Invalid,
                                   &lite_item_devid);
-        dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_SERVICEID, strlen(IOTX_LINKKIT_KEY_SERVICEID), cJSON_Invalid,
-                                  &lite_item_serviceid);
         dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_PAYLOAD, strlen(IOTX_LINKKIT_KEY_PAYLOAD), cJSON_Invalid,
                                   &lite_item_payload);
-        dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_CTX, strlen(IOTX_LINKKIT_KEY_CTX), cJSON_Invalid, &lite_item_ctx);
         dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_CODE, strlen(IOTX_LINKKIT_KEY_CODE), cJSON_Invalid, &lite_item_code);
         dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_EVENTID, strlen(IOTX_LINKKIT_KEY_EVENTID), cJSON_Invalid,
                                   &lite_item_eventid);
         dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_UTC, strlen(IOTX_LINKKIT_KEY_UTC), cJSON_Invalid, &lite_item_utc);
-        dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_RRPCID, strlen(IOTX_LINKKIT_KEY_RRPCID), cJSON_Invalid,
-                                  &lite_item_rrpcid);
         dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_TOPO, strlen(IOTX_LINKKIT_KEY_TOPO), cJSON_Invalid,
                                   &lite_item_topo);
         dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_PRODUCT_KEY, strlen(IOTX_LINKKIT_KEY_PRODUCT_KEY), cJSON_Invalid,
@@ -374,97 +363,6 @@ static void _iotx_linkkit_event_callback(iotx_dm_event_types_t type, char *paylo
         }
         break;
 #if !defined(DEVICE_MODEL_RAWDATA_SOLO)
-        case IOTX_DM_EVENT_THING_SERVICE_REQUEST: {
-            int response_len = 0;
-            char *request = NULL, *response = NULL;
-
-            uintptr_t property_get_ctx_num = 0;
-            void *property_get_ctx = NULL;
-
-            if (payload == NULL || lite_item_id.type != cJSON_String || lite_item_devid.type != cJSON_Number ||
-                lite_item_serviceid.type != cJSON_String || lite_item_payload.type != cJSON_Object) {
-                return;
-            }
-
-            dm_log_debug("Current Id: %.*s", lite_item_id.value_length, lite_item_id.value);
-            dm_log_debug("Current Devid: %d", lite_item_devid.value_int);
-            dm_log_debug("Current ServiceID: %.*s", lite_item_serviceid.value_length, lite_item_serviceid.value);
-            dm_log_debug("Current Payload: %.*s", lite_item_payload.value_length, lite_item_payload.value);
-            dm_log_debug("Current Ctx: %.*s", lite_item_ctx.value_length, lite_item_ctx.value);
-
-            LITE_hexstr_convert(lite_item_ctx.value, lite_item_ctx.value_length, (unsigned char *)&property_get_ctx_num,
-                                sizeof(uintptr_t));
-            property_get_ctx = (void *)property_get_ctx_num;
-
-            request = IMPL_LINKKIT_MALLOC(lite_item_payload.value_length + 1);
-            if (request == NULL) {
-                dm_log_err("Not Enough Memory");
-                return;
-            }
-            memset(request, 0, lite_item_payload.value_length + 1);
-            memcpy(request, lite_item_payload.value, lite_item_payload.value_length);
-
-            callback = iotx_event_callback(ITE_SERVICE_REQUEST);
-            if (callback) {
-                res = ((int (*)(const int, const char *, const int, const char *, const int, char **,
-                                int *))callback)(lite_item_devid.value_int, lite_item_serviceid.value,
-                                                 lite_item_serviceid.value_length, request, lite_item_payload.value_length, &response, &response_len);
-                if (response != NULL && response_len > 0) {
-                    /* service response exist */
-                    iotx_dm_error_code_t code = (res == 0) ? (IOTX_DM_ERR_CODE_SUCCESS) : (IOTX_DM_ERR_CODE_REQUEST_ERROR);
-                    iotx_dm_send_service_response(lite_item_devid.value_int, lite_item_id.value, lite_item_id.value_length, code,
-                                                  lite_item_serviceid.value,
-                                                  lite_item_serviceid.value_length,
-                                                  response, response_len, property_get_ctx);
-                    HAL_Free(response);
-                }
-            }
-#ifdef ALCS_ENABLED
-            if (property_get_ctx) {
-                dm_server_free_context(property_get_ctx);
-            }
-#endif
-            IMPL_LINKKIT_FREE(request);
-        }
-        break;
-        case IOTX_DM_EVENT_PROPERTY_SET: {
-            char *property_payload = NULL;
-
-            if (payload == NULL || lite_item_devid.type != cJSON_Number || lite_item_payload.type != cJSON_Object) {
-                return;
-            }
-
-            dm_log_debug("Current Devid: %d", lite_item_devid.value_int);
-            dm_log_debug("Current Payload: %.*s", lite_item_payload.value_length, lite_item_payload.value);
-
-            property_payload = IMPL_LINKKIT_MALLOC(lite_item_payload.value_length + 1);
-            if (property_payload == NULL) {
-                dm_log_err("No Enough Memory");
-                return;
-            }
-            memset(property_payload, 0, lite_item_payload.value_length + 1);
-            memcpy(property_payload, lite_item_payload.value, lite_item_payload.value_length);
-#ifdef LOG_REPORT_TO_CLOUD
-            if (SUCCESS_RETURN == check_target_msg(msg_id.value, msg_id.value_length)) {
-                report_sample = 1;
-                send_permance_info(msg_id.value, msg_id.value_length, "3", 1);
-            }
-#endif
-            callback = iotx_event_callback(ITE_PROPERTY_SET);
-            if (callback) {
-                ((int (*)(const int, const char *, const int))callback)(lite_item_devid.value_int, property_payload,
-                        lite_item_payload.value_length);
-            }
-#ifdef LOG_REPORT_TO_CLOUD
-            if (1 == report_sample) {
-                send_permance_info(NULL, 0, "5", 2);
-                report_sample = 0;
-            }
-#endif
-
-            IMPL_LINKKIT_FREE(property_payload);
-        }
-        break;
 #ifdef DEVICE_MODEL_SHADOW
         case IOTX_DM_EVENT_PROPERTY_DESIRED_GET_REPLY: {
             char *property_data = NULL;
@@ -496,53 +394,6 @@ static void _iotx_linkkit_event_callback(iotx_dm_event_types_t type, char *paylo
         }
         break;
 #endif
-        case IOTX_DM_EVENT_PROPERTY_GET: {
-            int response_len = 0;
-            char *request = NULL, *response = NULL;
-            uintptr_t property_get_ctx_num = 0;
-            void *property_get_ctx = NULL;
-
-            if (payload == NULL || lite_item_id.type != cJSON_String || lite_item_devid.type != cJSON_Number ||
-                lite_item_payload.type != cJSON_Array) {
-                return;
-            }
-
-            dm_log_debug("Current Id: %.*s", lite_item_id.value_length, lite_item_id.value);
-            dm_log_debug("Current Devid: %d", lite_item_devid.value_int);
-            dm_log_debug("Current Payload: %.*s", lite_item_payload.value_length, lite_item_payload.value);
-            dm_log_debug("Current Ctx: %.*s", lite_item_ctx.value_length, lite_item_ctx.value);
-
-            LITE_hexstr_convert(lite_item_ctx.value, lite_item_ctx.value_length, (unsigned char *)&property_get_ctx_num,
-                                sizeof(uintptr_t));
-            property_get_ctx = (void *)property_get_ctx_num;
-            dm_log_debug("property_get_ctx_num: %0x016llX", (unsigned int)property_get_ctx_num);
-            dm_log_debug("property_get_ctx: %p", property_get_ctx);
-
-            request = IMPL_LINKKIT_MALLOC(lite_item_payload.value_length + 1);
-            if (request == NULL) {
-                dm_log_err("No Enough Memory");
-                return;
-            }
-            memset(request, 0, lite_item_payload.value_length + 1);
-            memcpy(request, lite_item_payload.value, lite_item_payload.value_length);
-
-            callback = iotx_event_callback(ITE_PROPERTY_GET);
-            if (callback) {
-                res = ((int (*)(const int, const char *, const int, char **, int *))callback)(lite_item_devid.value_int, request,
-                        lite_item_payload.value_length, &response, &response_len);
-
-                if (response != NULL && response_len > 0) {
-                    /* property get response exist */
-                    iotx_dm_error_code_t code = (res == 0) ? (IOTX_DM_ERR_CODE_SUCCESS) : (IOTX_DM_ERR_CODE_REQUEST_ERROR);
-                    iotx_dm_send_property_get_response(lite_item_devid.value_int, lite_item_id.value, lite_item_id.value_length, code,
-                                                       response, response_len, property_get_ctx);
-                    HAL_Free(response);
-                }
-            }
-
-            IMPL_LINKKIT_FREE(request);
-        }
-        break;
         case IOTX_DM_EVENT_EVENT_PROPERTY_POST_REPLY:
         case IOTX_DM_EVENT_DEVICEINFO_UPDATE_REPLY:
 #ifdef DEVICE_MODEL_SHADOW
@@ -654,49 +505,6 @@ static void _iotx_linkkit_event_callback(iotx_dm_event_types_t type, char *paylo
             IMPL_LINKKIT_FREE(utc_payload);
         }
         break;
-        case IOTX_DM_EVENT_RRPC_REQUEST: {
-            int rrpc_response_len = 0;
-            char *rrpc_request = NULL, *rrpc_response = NULL;
-
-            if (payload == NULL || lite_item_id.type != cJSON_String || lite_item_devid.type != cJSON_Number ||
-                lite_item_serviceid.type != cJSON_String || lite_item_rrpcid.type != cJSON_String
-                || lite_item_payload.type != cJSON_Object) {
-                return;
-            }
-
-            dm_log_debug("Current Id: %.*s", lite_item_id.value_length, lite_item_id.value);
-            dm_log_debug("Current Devid: %d", lite_item_devid.value_int);
-            dm_log_debug("Current ServiceID: %.*s", lite_item_serviceid.value_length, lite_item_serviceid.value);
-            dm_log_debug("Current RRPC ID: %.*s", lite_item_rrpcid.value_length, lite_item_rrpcid.value);
-            dm_log_debug("Current Payload: %.*s", lite_item_payload.value_length, lite_item_payload.value);
-
-            rrpc_request = IMPL_LINKKIT_MALLOC(lite_item_payload.value_length + 1);
-            if (rrpc_request == NULL) {
-                dm_log_err("Not Enough Memory");
-                return;
-            }
-            memset(rrpc_request, 0, lite_item_payload.value_length + 1);
-            memcpy(rrpc_request, lite_item_payload.value, lite_item_payload.value_length);
-
-            callback = iotx_event_callback(ITE_SERVICE_REQUEST);
-            if (callback) {
-                res = ((int (*)(const int, const char *, const int, const char *, const int, char **,
-                                int *))callback)(lite_item_devid.value_int, lite_item_serviceid.value,
-                                                 lite_item_serviceid.value_length,
-                                                 rrpc_request, lite_item_payload.value_length, &rrpc_response, &rrpc_response_len);
-                if (rrpc_response != NULL && rrpc_response_len > 0) {
-                    iotx_dm_error_code_t code = (res == 0) ? (IOTX_DM_ERR_CODE_SUCCESS) : (IOTX_DM_ERR_CODE_REQUEST_ERROR);
-                    iotx_dm_send_rrpc_response(lite_item_devid.value_int, lite_item_id.value, lite_item_id.value_length, code,
-                                               lite_item_rrpcid.value,
-                                               lite_item_rrpcid.value_length,
-                                               rrpc_response, rrpc_response_len);
-                    HAL_Free(rrpc_response);
-                }
-            }
-
-            IMPL_LINKKIT_FREE(rrpc_request);
-        }
-        break;
 #endif
         case IOTX_DM_EVENT_FOTA_NEW_FIRMWARE: {
             char *version = NULL;
@@ -877,6 +685,131 @@ static void _iotx_linkkit_event_callback(iotx_dm_event_types_t type, char *paylo
     }
 }
 
+/* requests which come as typed events, their strings are NUL terminated and handed to user without copy */
+static void _iotx_linkkit_event_typed_callback(const iotx_dm_event_t *event)
+{
+    int res = 0;
+    void *callback;
+
+    dm_log_info("Receive Message Type: %d", event->type);
+
+    switch (event->type) {
+#if !defined(DEVICE_MODEL_RAWDATA_SOLO)
+        case IOTX_DM_EVENT_THING_SERVICE_REQUEST: {
+            int response_len = 0;
+            char *response = NULL;
+
+            dm_log_debug("Current Id: %.*s", event->u.service_request.id_len, event->u.service_request.id);
+            dm_log_debug("Current Devid: %d", event->devid);
+            dm_log_debug("Current ServiceID: %.*s", event->u.service_request.serviceid_len,
+                         event->u.service_request.serviceid);
+            dm_log_debug("Current Payload: %.*s", event->u.service_request.payload_len, event->u.service_request.payload);
+
+            callback = iotx_event_callback(ITE_SERVICE_REQUEST);
+            if (callback) {
+                res = ((int (*)(const int, const char *, const int, const char *, const int, char **,
+                                int *))callback)(event->devid, event->u.service_request.serviceid,
+                                                 event->u.service_request.serviceid_len, event->u.service_request.payload,
+                                                 event->u.service_request.payload_len, &response, &response_len);
+                if (response != NULL && response_len > 0) {
+                    /* service response exist */
+                    iotx_dm_error_code_t code = (res == 0) ? (IOTX_DM_ERR_CODE_SUCCESS) : (IOTX_DM_ERR_CODE_REQUEST_ERROR);
+                    iotx_dm_send_service_response(event->devid, (char *)event->u.service_request.id,
+                                                  event->u.service_request.id_len, code,
+                                                  (char *)event->u.service_request.serviceid,
+                                                  event->u.service_request.serviceid_len,
+                                                  response, response_len, event->u.service_request.ctx);
+                    HAL_Free(response);
+                }
+            }
+#ifdef ALCS_ENABLED
+            if (event->u.service_request.ctx) {
+                dm_server_free_context(event->u.service_request.ctx);
+            }
+#endif
+        }
+        break;
+        case IOTX_DM_EVENT_PROPERTY_SET: {
+            dm_log_debug("Current Devid: %d", event->devid);
+            dm_log_debug("Current Payload: %.*s", event->u.property_set.payload_len, event->u.property_set.payload);
+
+#ifdef LOG_REPORT_TO_CLOUD
+            if (SUCCESS_RETURN == check_target_msg(event->u.property_set.msgid, event->u.property_set.msgid_len)) {
+                report_sample = 1;
+                send_permance_info((char *)event->u.property_set.msgid, event->u.property_set.msgid_len, "3", 1);
+            }
+#endif
+            callback = iotx_event_callback(ITE_PROPERTY_SET);
+            if (callback) {
+                ((int (*)(const int, const char *, const int))callback)(event->devid, event->u.property_set.payload,
+                        event->u.property_set.payload_len);
+            }
+#ifdef LOG_REPORT_TO_CLOUD
+            if (1 == report_sample) {
+                send_permance_info(NULL, 0, "5", 2);
+                report_sample = 0;
+            }
+#endif
+        }
+        break;
+        case IOTX_DM_EVENT_PROPERTY_GET: {
+            int response_len = 0;
+            char *response = NULL;
+
+            dm_log_debug("Current Id: %.*s", event->u.property_get.id_len, event->u.property_get.id);
+            dm_log_debug("Current Devid: %d", event->devid);
+            dm_log_debug("Current Payload: %.*s", event->u.property_get.payload_len, event->u.property_get.payload);
+            dm_log_debug("property_get_ctx: %p", event->u.property_get.ctx);
+
+            callback = iotx_event_callback(ITE_PROPERTY_GET);
+            if (callback) {
+                res = ((int (*)(const int, const char *, const int, char **, int *))callback)(event->devid,
+                        event->u.property_get.payload, event->u.property_get.payload_len, &response, &response_len);
+
+                if (response != NULL && response_len > 0) {
+                    /* property get response exist */
+                    iotx_dm_error_code_t code = (res == 0) ? (IOTX_DM_ERR_CODE_SUCCESS) : (IOTX_DM_ERR_CODE_REQUEST_ERROR);
+                    iotx_dm_send_property_get_response(event->devid, (char *)event->u.property_get.id,
+                                                       event->u.property_get.id_len, code,
+                                                       response, response_len, event->u.property_get.ctx);
+                    HAL_Free(response);
+                }
+            }
+        }
+        break;
+        case IOTX_DM_EVENT_RRPC_REQUEST: {
+            int rrpc_response_len = 0;
+            char *rrpc_response = NULL;
+
+            dm_log_debug("Current Id: %.*s", event->u.rrpc_request.id_len, event->u.rrpc_request.id);
+            dm_log_debug("Current Devid: %d", event->devid);
+            dm_log_debug("Current ServiceID: %.*s", event->u.rrpc_request.serviceid_len, event->u.rrpc_request.serviceid);
+            dm_log_debug("Current RRPC ID: %.*s", event->u.rrpc_request.rrpcid_len, event->u.rrpc_request.rrpcid);
+            dm_log_debug("Current Payload: %.*s", event->u.rrpc_request.payload_len, event->u.rrpc_request.payload);
+
+            callback = iotx_event_callback(ITE_SERVICE_REQUEST);
+            if (callback) {
+                res = ((int (*)(const int, const char *, const int, const char *, const int, char **,
+                                int *))callback)(event->devid, event->u.rrpc_request.serviceid,
+                                                 event->u.rrpc_request.serviceid_len, event->u.rrpc_request.payload,
+                                                 event->u.rrpc_request.payload_len, &rrpc_response, &rrpc_response_len);
+                if (rrpc_response != NULL && rrpc_response_len > 0) {
+                    iotx_dm_error_code_t code = (res == 0) ? (IOTX_DM_ERR_CODE_SUCCESS) : (IOTX_DM_ERR_CODE_REQUEST_ERROR);
+                    iotx_dm_send_rrpc_response(event->devid, (char *)event->u.rrpc_request.id, event->u.rrpc_request.id_len,
+                                               code, (char *)event->u.rrpc_request.rrpcid, event->u.rrpc_request.rrpcid_len,
+                                               rrpc_response, rrpc_response_len);
+                    HAL_Free(rrpc_response);
+                }
+            }
+        }
+        break;
+#endif
+        default: {
+        }
+        break;
+    }
+}
+
 static int _iotx_linkkit_master_open(iotx_linkkit_dev_meta_info_t *meta_info)
 {
     int res = 0;
@@ -958,6 +891,7 @@ static int _iotx_linkkit_master_connect(void)
 
     memset(&dm_init_params, 0, sizeof(iotx_dm_init_params_t));
     dm_init_params.event_callback = _iotx_linkkit_event_callback;
+    dm_init_params.event_typed_callback = _iotx_linkkit_event_typed_callback;
 
     res = iotx_dm_connect(&dm_init_params);
     if (res != SUCCESS_RETURN) {
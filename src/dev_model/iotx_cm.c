@@ -171,6 +171,38 @@ int iotx_cm_sub(int fd, iotx_cm_ext_params_t *ext, const char *topic,
     return sub_func(ext, topic, topic_handle_func, pcontext);
 }
 
+/* subscribe a group of topics, return number of topics subscribed */
+int iotx_cm_sub_multi(int fd, iotx_cm_ext_params_t *ext, iotx_cm_sub_info_t *sub_list, int count)
+{
+    iotx_cm_sub_fp sub_func;
+    iotx_cm_sub_multi_fp sub_multi_func;
+    int idx, subed = 0;
+
+    if (_fd_is_valid(fd) == -1 || sub_list == NULL || count <= 0) {
+        cm_err(ERR_INVALID_PARAMS);
+        return -1;
+    }
+
+    HAL_MutexLock(fd_lock);
+    sub_func = _cm_fd[fd]->sub_func;
+    sub_multi_func = _cm_fd[fd]->sub_multi_func;
+    HAL_MutexUnlock(fd_lock);
+    if (sub_multi_func != NULL) {
+        return sub_multi_func(ext, sub_list, count);
+    }
+
+    /* connection not able to carry many topics in one request subscribes them one by one */
+    for (idx = 0; idx < count; idx++) {
+        sub_list[idx].result = sub_func(ext, sub_list[idx].topic, sub_list[idx].topic_handle_func, NULL);
+        if (sub_list[idx].result >= 0) {
+            sub_list[idx].result = SUCCESS_RETURN;
+            subed++;
+        }
+    }
+
+    return subed;
+}
+
 int iotx_cm_unsub(int fd, const char *topic)
 {
     iotx_cm_unsub_fp unsub_func;
@@ -203,6 +235,26 @@ int iotx_cm_pub(int fd, iotx_cm_ext_params_t *ext, const char *topic, const char
     return pub_func(ext, topic, payload, payload_len);
 }
 
+int iotx_cm_get_stats(int fd, iotx_cm_stats_t *stats)
+{
+    iotx_cm_stats_fp stats_func;
+
+    if (_fd_is_valid(fd) == -1 || stats == NULL) {
+        cm_err(ERR_INVALID_PARAMS);
+        return -1;
+    }
+
+    HAL_MutexLock(fd_lock);
+    stats_func = _cm_fd[fd]->stats_func;
+    HAL_MutexUnlock(fd_lock);
+    if (stats_func == NULL) {
+        return -1;
+    }
+
+    memset(stats, 0, sizeof(iotx_cm_stats_t));
+    return stats_func(stats);
+}
+
 int iotx_cm_close(int fd)
 {
     iotx_cm_close_fp close_func;
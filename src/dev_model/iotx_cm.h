@@ -10,6 +10,11 @@
 
 #define CM_MAX_FD_NUM             3
 #define CM_DEFAULT_YIELD_TIMEOUT  200
+
+/* MQTT connections opened by one CM fd, devices are spread over them by hash of productKey/deviceName */
+#ifndef CONFIG_CM_MQTT_POOL_SIZE
+    #define CONFIG_CM_MQTT_POOL_SIZE  (1)
+#endif
 /* message confirmation type */
 typedef enum {
     /* non ACK */
@@ -117,6 +122,17 @@ typedef struct {
 #endif
 } iotx_cm_init_param_t;
 
+/* statistics of a CM fd, summed up over its underlying connections */
+typedef struct {
+    uint32_t                      conn_num;                 /* connections opened */
+    uint32_t                      conn_online;              /* connections currently connected */
+    uint32_t                      pub_count;                /* messages published */
+    uint32_t                      pub_fail;                 /* messages failed to publish */
+    uint32_t                      recv_count;               /* messages received */
+    uint32_t                      disconnect_count;
+    uint32_t                      reconnect_count;
+} iotx_cm_stats_t;
+
 typedef struct {
     iotx_cm_ack_types_t           ack_type;
     iotx_cm_sync_mode_types_t     sync_mode;
@@ -125,12 +141,21 @@ typedef struct {
     void                          *cb_context;
 } iotx_cm_ext_params_t;
 
+/* topic of a multi-topic subscribe */
+typedef struct {
+    const char                    *topic;
+    iotx_cm_data_handle_cb        topic_handle_func;
+    int                           result;                   /* [out] SUCCESS_RETURN when subscribed */
+} iotx_cm_sub_info_t;
+
 int iotx_cm_open(iotx_cm_init_param_t *params);
 int iotx_cm_connect(int fd, uint32_t timeout);
 int iotx_cm_yield(int fd, unsigned int timeout);
 int iotx_cm_sub(int fd, iotx_cm_ext_params_t *ext, const char *topic,
                 iotx_cm_data_handle_cb topic_handle_func, void *pcontext);
+int iotx_cm_sub_multi(int fd, iotx_cm_ext_params_t *ext, iotx_cm_sub_info_t *sub_list, int count);
 int iotx_cm_unsub(int fd, const char *topic);
 int iotx_cm_pub(int fd, iotx_cm_ext_params_t *ext, const char *topic, const char *payload, unsigned int payload_len);
 int iotx_cm_close(int fd);
+int iotx_cm_get_stats(int fd, iotx_cm_stats_t *stats);
 #endif /* _LINKKIT_CM_H_ */
@@ -46,10 +46,12 @@ typedef int (*iotx_cm_connect_fp)(uint32_t timeout);
 typedef int (*iotx_cm_yield_fp)(unsigned int timeout);
 typedef int (*iotx_cm_sub_fp)(iotx_cm_ext_params_t *params, const char *topic,
                               iotx_cm_data_handle_cb topic_handle_func, void *pcontext);
+typedef int (*iotx_cm_sub_multi_fp)(iotx_cm_ext_params_t *params, iotx_cm_sub_info_t *sub_list, int count);
 typedef int (*iotx_cm_unsub_fp)(const char *topic);
 typedef int (*iotx_cm_pub_fp)(iotx_cm_ext_params_t *params, const char *topic, const char *payload,
                               unsigned int payload_len);
 typedef int (*iotx_cm_close_fp)();
+typedef int (*iotx_cm_stats_fp)(iotx_cm_stats_t *stats);
 
 
 typedef struct iotx_connection_st {
@@ -60,10 +62,12 @@ typedef struct iotx_connection_st {
     iotx_cm_protocol_types_t         protocol_type;
     iotx_cm_connect_fp               connect_func;
     iotx_cm_sub_fp                   sub_func;
+    iotx_cm_sub_multi_fp             sub_multi_func;
     iotx_cm_unsub_fp                 unsub_func;
     iotx_cm_pub_fp                   pub_func;
     iotx_cm_yield_fp                 yield_func;
     iotx_cm_close_fp                 close_func;
+    iotx_cm_stats_fp                 stats_func;
     iotx_cm_event_handle_cb          event_handler;
     void                             *cb_data;
 
@@ -3,6 +3,11 @@
 #if defined(MQTT_COMM_ENABLED) || defined(MAL_ENABLED)
 
 static iotx_cm_connection_t *_mqtt_conncection = NULL;
+static iotx_cm_mqtt_conn_t _mqtt_conn_pool[CM_MQTT_CONN_NUM];
+#if CM_MQTT_CONN_NUM > 1
+static char _mqtt_product_key[IOTX_PRODUCT_KEY_LEN + 1];
+static char _mqtt_device_name[IOTX_DEVICE_NAME_LEN + 1];
+#endif
 static void iotx_cloud_conn_mqtt_event_handle(void *pcontext, void *pclient, iotx_mqtt_event_msg_pt msg);
 static int  _mqtt_connect(uint32_t timeout);
 static int _mqtt_publish(iotx_cm_ext_params_t *params, const char *topic, const char *payload,
@@ -10,10 +15,53 @@ static int _mqtt_publish(iotx_cm_ext_params_t *params, const char *topic, const
 static int _mqtt_sub(iotx_cm_ext_params_t *params, const char *topic,
                      iotx_cm_data_handle_cb topic_handle_func, void *pcontext);
 static iotx_mqtt_qos_t _get_mqtt_qos(iotx_cm_ack_types_t ack_type);
+static int _mqtt_sub_multi(iotx_cm_ext_params_t *params, iotx_cm_sub_info_t *sub_list, int count);
 static int _mqtt_unsub(const char *topic);
 static int _mqtt_close();
+static int _mqtt_stats(iotx_cm_stats_t *stats);
 static void _set_common_handlers();
 
+static void _mqtt_conn_pool_deinit(void)
+{
+    int idx;
+
+    for (idx = 0; idx < CM_MQTT_CONN_NUM; idx++) {
+        if (_mqtt_conn_pool[idx].lock != NULL) {
+            HAL_MutexDestroy(_mqtt_conn_pool[idx].lock);
+        }
+    }
+    memset(_mqtt_conn_pool, 0, sizeof(_mqtt_conn_pool));
+}
+
+static int _mqtt_conn_pool_init(void)
+{
+    int idx;
+
+    memset(_mqtt_conn_pool, 0, sizeof(_mqtt_conn_pool));
+    for (idx = 0; idx < CM_MQTT_CONN_NUM; idx++) {
+        _mqtt_conn_pool[idx].lock = HAL_MutexCreate();
+        if (_mqtt_conn_pool[idx].lock == NULL) {
+            _mqtt_conn_pool_deinit();
+            return FAIL_RETURN;
+        }
+    }
+
+    return SUCCESS_RETURN;
+}
+
+/* bump @counter of @conn if not NULL, and set its online state if @online is 0 or 1 */
+static void _mqtt_conn_update(iotx_cm_mqtt_conn_t *conn, uint32_t *counter, int online)
+{
+    HAL_MutexLock(conn->lock);
+    if (online >= 0) {
+        conn->online = (uint8_t)online;
+    }
+    if (counter != NULL) {
+        (*counter)++;
+    }
+    HAL_MutexUnlock(conn->lock);
+}
+
 iotx_cm_connection_t *iotx_cm_open_mqtt(iotx_cm_init_param_t *params)
 {
     iotx_mqtt_param_t *mqtt_param = NULL;
@@ -29,6 +77,10 @@ iotx_cm_connection_t *iotx_cm_open_mqtt(iotx_cm_init_param_t *params)
         goto failed;
     }
     memset(_mqtt_conncection, 0, sizeof(iotx_cm_connection_t));
+    if (_mqtt_conn_pool_init() != SUCCESS_RETURN) {
+        cm_err("mqtt connection pool init failed!");
+        goto failed;
+    }
 
     mqtt_param = (iotx_mqtt_param_t *)cm_malloc(sizeof(iotx_mqtt_param_t));
     if (mqtt_param == NULL) {
@@ -64,22 +116,124 @@ failed:
     if (mqtt_param != NULL) {
         cm_free(mqtt_param);
     }
+    _mqtt_conn_pool_deinit();
+
+    return NULL;
+}
+
+
+static iotx_cm_mqtt_conn_t *_mqtt_conn_of_client(void *pclient)
+{
+    int idx;
+
+    for (idx = 0; idx < CM_MQTT_CONN_NUM; idx++) {
+        if (_mqtt_conn_pool[idx].client != NULL && _mqtt_conn_pool[idx].client == pclient) {
+            return &_mqtt_conn_pool[idx];
+        }
+    }
 
     return NULL;
 }
 
+#if CM_MQTT_CONN_NUM > 1
+static int _mqtt_level_is(const char *level, uint32_t level_len, const char *name)
+{
+    return (level_len == strlen(name) && memcmp(level, name, level_len) == 0);
+}
+
+static int _mqtt_level_has_wildcard(const char *level, uint32_t level_len)
+{
+    return (memchr(level, '+', level_len) != NULL || memchr(level, '#', level_len) != NULL);
+}
+#endif
+
+/*
+ * Pick the connection of device whose productKey/deviceName are in @topic, as "/sys/{pk}/{dn}/...",
+ * "/ext/{xx}/{pk}/{dn}/...", "/shadow/{xx}/{pk}/{dn}" or "/{pk}/{dn}/...", so that all of a device's
+ * messages go through the same one. The device itself, topic filters with wildcard in these levels and
+ * devices whose connection has failed to open stay on the first connection.
+ */
+static iotx_cm_mqtt_conn_t *_mqtt_conn_of_topic(const char *topic)
+{
+#if CM_MQTT_CONN_NUM > 1
+    const char *level[4];
+    uint32_t level_len[4];
+    const char *pos = topic;
+    const char *sep = NULL;
+    int level_num = 0;
+    int pk_level = 0;
+    uint32_t hash = 2166136261u;
+    uint32_t i;
+    iotx_cm_mqtt_conn_t *conn = NULL;
+
+    if (topic == NULL) {
+        return &_mqtt_conn_pool[0];
+    }
+
+    while (level_num < 4 && *pos == '/') {
+        pos++;
+        sep = strchr(pos, '/');
+        level[level_num] = pos;
+        level_len[level_num] = (sep != NULL) ? (uint32_t)(sep - pos) : (uint32_t)strlen(pos);
+        level_num++;
+        if (sep == NULL) {
+            break;
+        }
+        pos = sep;
+    }
+
+    if (level_num > 0 && _mqtt_level_is(level[0], level_len[0], "sys")) {
+        pk_level = 1;
+    } else if (level_num > 0 && (_mqtt_level_is(level[0], level_len[0], "ext") ||
+                                 _mqtt_level_is(level[0], level_len[0], "shadow"))) {
+        pk_level = 2;
+    }
+    if (level_num < pk_level + 2 ||
+        _mqtt_level_has_wildcard(level[pk_level], level_len[pk_level]) ||
+        _mqtt_level_has_wildcard(level[pk_level + 1], level_len[pk_level + 1])) {
+        return &_mqtt_conn_pool[0];
+    }
+    if (_mqtt_level_is(level[pk_level], level_len[pk_level], _mqtt_product_key) &&
+        _mqtt_level_is(level[pk_level + 1], level_len[pk_level + 1], _mqtt_device_name)) {
+        return &_mqtt_conn_pool[0];
+    }
+
+    /* FNV-1a of "{pk}/{dn}" */
+    for (i = 0; i < level_len[pk_level] + 1 + level_len[pk_level + 1]; i++) {
+        hash ^= (unsigned char)level[pk_level][i];
+        hash *= 16777619u;
+    }
+
+    conn = &_mqtt_conn_pool[hash % CM_MQTT_CONN_NUM];
+    if (conn->client != NULL) {
+        return conn;
+    }
+#endif
+    return &_mqtt_conn_pool[0];
+}
 
 static void iotx_cloud_conn_mqtt_event_handle(void *pcontext, void *pclient, iotx_mqtt_event_msg_pt msg)
 {
     uintptr_t packet_id = (uintptr_t)msg->msg;
+    iotx_cm_mqtt_conn_t *conn = NULL;
+
     if (_mqtt_conncection == NULL) {
         return;
     }
 
+    conn = _mqtt_conn_of_client(pclient);
     switch (msg->event_type) {
 
         case IOTX_MQTT_EVENT_DISCONNECT: {
             iotx_cm_event_msg_t event;
+            if (conn != NULL) {
+                _mqtt_conn_update(conn, &conn->disconnect_count, 0);
+            }
+            if (conn != NULL && conn != &_mqtt_conn_pool[0]) {
+                /* connection of the pool reconnects by itself, cloud is still reachable via the first one */
+                cm_info("pool connection %d disconnected", (int)(conn - _mqtt_conn_pool));
+                break;
+            }
             cm_info("disconnected,fd = %d", _mqtt_conncection->fd);
             event.type = IOTX_CM_EVENT_CLOUD_DISCONNECT;
             event.msg = NULL;
@@ -91,6 +245,13 @@ static void iotx_cloud_conn_mqtt_event_handle(void *pcontext, void *pclient, iot
 
         case IOTX_MQTT_EVENT_RECONNECT: {
             iotx_cm_event_msg_t event;
+            if (conn != NULL) {
+                _mqtt_conn_update(conn, &conn->reconnect_count, 1);
+            }
+            if (conn != NULL && conn != &_mqtt_conn_pool[0]) {
+                cm_info("pool connection %d reconnected", (int)(conn - _mqtt_conn_pool));
+                break;
+            }
             cm_info("connected,fd = %d", _mqtt_conncection->fd);
             event.type = IOTX_CM_EVENT_CLOUD_CONNECTED;
             event.msg = NULL;
@@ -177,6 +338,9 @@ static void iotx_cloud_conn_mqtt_event_handle(void *pcontext, void *pclient, iot
 #ifndef DEVICE_MODEL_ALINK2
             char *topic = NULL;
 #endif
+            if (conn != NULL) {
+                _mqtt_conn_update(conn, &conn->recv_count, -1);
+            }
             if (topic_handle_func == NULL) {
                 cm_warning("bypass %d bytes on [%.*s]", topic_info->payload_len, topic_info->topic_len, topic_info->ptopic);
                 return;
@@ -210,6 +374,26 @@ static void iotx_cloud_conn_mqtt_event_handle(void *pcontext, void *pclient, iot
     }
 }
 
+/* open the rest connections of pool, whose devices are left to the first connection if failed */
+static void _mqtt_open_pool(void)
+{
+#if CM_MQTT_CONN_NUM > 1
+    int idx;
+
+    for (idx = 1; idx < CM_MQTT_CONN_NUM; idx++) {
+        if (_mqtt_conn_pool[idx].client != NULL) {
+            continue;
+        }
+        _mqtt_conn_pool[idx].client = IOT_MQTT_Construct_Conn((iotx_mqtt_param_t *)_mqtt_conncection->open_params, idx);
+        if (_mqtt_conn_pool[idx].client == NULL) {
+            cm_warning("pool connection %d open failed", idx);
+            continue;
+        }
+        _mqtt_conn_update(&_mqtt_conn_pool[idx], NULL, 1);
+    }
+#endif
+}
+
 extern sdk_impl_ctx_t g_sdk_impl_ctx;
 static int  _mqtt_connect(uint32_t timeout)
 {
@@ -236,6 +420,10 @@ static int  _mqtt_connect(uint32_t timeout)
     if (strlen(product_key) == 0 || strlen(device_name) == 0) {
         return FAIL_RETURN;
     }
+#if CM_MQTT_CONN_NUM > 1
+    memcpy(_mqtt_product_key, product_key, sizeof(_mqtt_product_key));
+    memcpy(_mqtt_device_name, device_name, sizeof(_mqtt_device_name));
+#endif
 
     iotx_time_init(&timer);
     utils_time_countdown_ms(&timer, timeout);
@@ -263,6 +451,9 @@ static int  _mqtt_connect(uint32_t timeout)
         if (pclient != NULL) {
             iotx_cm_event_msg_t event;
             _mqtt_conncection->context = pclient;
+            _mqtt_conn_pool[0].client = pclient;
+            _mqtt_conn_update(&_mqtt_conn_pool[0], NULL, 1);
+            _mqtt_open_pool();
             event.type = IOTX_CM_EVENT_CLOUD_CONNECTED;
             event.msg = NULL;
 
@@ -287,6 +478,8 @@ static int  _mqtt_connect(uint32_t timeout)
 static int _mqtt_publish(iotx_cm_ext_params_t *ext, const char *topic, const char *payload, unsigned int payload_len)
 {
     int qos = 0;
+    int ret;
+    iotx_cm_mqtt_conn_t *conn = NULL;
 
     if (_mqtt_conncection == NULL) {
         return NULL_VALUE_ERROR;
@@ -295,16 +488,44 @@ static int _mqtt_publish(iotx_cm_ext_params_t *ext, const char *topic, const cha
     if (ext != NULL) {
         qos = (int)_get_mqtt_qos(ext->ack_type);
     }
-    return IOT_MQTT_Publish_Simple(_mqtt_conncection->context, topic, qos, (void *)payload, payload_len);
+
+    conn = _mqtt_conn_of_topic(topic);
+    ret = IOT_MQTT_Publish_Simple(conn->client, topic, qos, (void *)payload, payload_len);
+    _mqtt_conn_update(conn, (ret < 0) ? &conn->pub_fail : &conn->pub_count, -1);
+
+    return ret;
 }
 
 static int _mqtt_yield(uint32_t timeout)
 {
+    int idx;
+    int num = 0;
+    int ret = 0;
+
     if (_mqtt_conncection == NULL) {
         return NULL_VALUE_ERROR;
     }
 
-    return IOT_MQTT_Yield(_mqtt_conncection->context, timeout);
+    for (idx = 0; idx < CM_MQTT_CONN_NUM; idx++) {
+        if (_mqtt_conn_pool[idx].client != NULL) {
+            num++;
+        }
+    }
+    if (num == 0) {
+        return IOT_MQTT_Yield(_mqtt_conncection->context, timeout);
+    }
+
+    /* share the time among connections, so yield takes as long as it does with only one */
+    for (idx = 0; idx < CM_MQTT_CONN_NUM; idx++) {
+        if (_mqtt_conn_pool[idx].client != NULL) {
+            int rc = IOT_MQTT_Yield(_mqtt_conn_pool[idx].client, timeout / num);
+            if (idx == 0) {
+                ret = rc;
+            }
+        }
+    }
+
+    return ret;
 }
 
 static int _mqtt_sub(iotx_cm_ext_params_t *ext, const char *topic,
@@ -331,14 +552,14 @@ static int _mqtt_sub(iotx_cm_ext_params_t *ext, const char *topic,
     }
 
     if (sync != 0) {
-        ret = IOT_MQTT_Subscribe_Sync(_mqtt_conncection->context,
+        ret = IOT_MQTT_Subscribe_Sync(_mqtt_conn_of_topic(topic)->client,
                                       topic,
                                       qos,
                                       iotx_cloud_conn_mqtt_event_handle,
                                       (void *)topic_handle_func,
                                       timeout);
     } else {
-        ret = IOT_MQTT_Subscribe(_mqtt_conncection->context,
+        ret = IOT_MQTT_Subscribe(_mqtt_conn_of_topic(topic)->client,
                                  topic,
                                  qos,
                                  iotx_cloud_conn_mqtt_event_handle,
@@ -348,6 +569,73 @@ static int _mqtt_sub(iotx_cm_ext_params_t *ext, const char *topic,
     return ret;
 }
 
+/* topics are grouped by the connection they belong to, each group is subscribed by a few SUBSCRIBE */
+static int _mqtt_sub_multi(iotx_cm_ext_params_t *ext, iotx_cm_sub_info_t *sub_list, int count)
+{
+    int qos = 0;
+    int timeout = 0;
+    int idx, conn_idx, num, subed = 0;
+    int *index = NULL;
+    iotx_mutli_sub_info_t *sub_info = NULL;
+
+    if (_mqtt_conncection == NULL || sub_list == NULL || count <= 0) {
+        return NULL_VALUE_ERROR;
+    }
+
+    if (ext != NULL) {
+        if (ext->sync_mode != IOTX_CM_ASYNC) {
+            timeout = ext->sync_timeout;
+        }
+        qos = (int)_get_mqtt_qos(ext->ack_type);
+    }
+
+    sub_info = (iotx_mutli_sub_info_t *)cm_malloc(count * (sizeof(iotx_mutli_sub_info_t) + sizeof(int)));
+    if (sub_info == NULL) {
+        return ERROR_MALLOC;
+    }
+    index = (int *)(sub_info + count);
+
+    for (idx = 0; idx < count; idx++) {
+        sub_list[idx].result = FAIL_RETURN;
+    }
+
+    for (conn_idx = 0; conn_idx < CM_MQTT_CONN_NUM; conn_idx++) {
+        if (_mqtt_conn_pool[conn_idx].client == NULL) {
+            continue;
+        }
+
+        num = 0;
+        for (idx = 0; idx < count; idx++) {
+            if (sub_list[idx].topic == NULL || sub_list[idx].topic_handle_func == NULL ||
+                _mqtt_conn_of_topic(sub_list[idx].topic) != &_mqtt_conn_pool[conn_idx]) {
+                continue;
+            }
+            memset(&sub_info[num], 0, sizeof(iotx_mutli_sub_info_t));
+            sub_info[num].topicFilter = sub_list[idx].topic;
+            sub_info[num].qos = (iotx_mqtt_qos_t)qos;
+            sub_info[num].messageHandler = iotx_cloud_conn_mqtt_event_handle;
+            sub_info[num].pcontext = (void *)sub_list[idx].topic_handle_func;
+            index[num++] = idx;
+        }
+        if (num == 0) {
+            continue;
+        }
+
+        if (IOT_MQTT_Subscribe_Multi(_mqtt_conn_pool[conn_idx].client, sub_info, num, timeout) < 0) {
+            continue;
+        }
+        for (idx = 0; idx < num; idx++) {
+            if (sub_info[idx].granted >= 0) {
+                sub_list[index[idx]].result = SUCCESS_RETURN;
+                subed++;
+            }
+        }
+    }
+
+    cm_free(sub_info);
+    return subed;
+}
+
 static int _mqtt_unsub(const char *topic)
 {
     int ret;
@@ -356,7 +644,7 @@ static int _mqtt_unsub(const char *topic)
         return NULL_VALUE_ERROR;
     }
 
-    ret = IOT_MQTT_Unsubscribe(_mqtt_conncection->context, topic);
+    ret = IOT_MQTT_Unsubscribe(_mqtt_conn_of_topic(topic)->client, topic);
 
     if (ret < 0) {
         return -1;
@@ -367,10 +655,19 @@ static int _mqtt_unsub(const char *topic)
 
 static int _mqtt_close()
 {
+    int idx;
+
     if (_mqtt_conncection == NULL) {
         return NULL_VALUE_ERROR;
     }
 
+    for (idx = 1; idx < CM_MQTT_CONN_NUM; idx++) {
+        if (_mqtt_conn_pool[idx].client != NULL) {
+            IOT_MQTT_Destroy(&_mqtt_conn_pool[idx].client);
+        }
+    }
+    _mqtt_conn_pool_deinit();
+
     cm_free(_mqtt_conncection->open_params);
     IOT_MQTT_Destroy(&_mqtt_conncection->context);
     cm_free(_mqtt_conncection);
@@ -378,6 +675,34 @@ static int _mqtt_close()
     return 0;
 }
 
+static int _mqtt_stats(iotx_cm_stats_t *stats)
+{
+    int idx;
+
+    if (_mqtt_conncection == NULL) {
+        return NULL_VALUE_ERROR;
+    }
+
+    for (idx = 0; idx < CM_MQTT_CONN_NUM; idx++) {
+        iotx_cm_mqtt_conn_t *conn = &_mqtt_conn_pool[idx];
+
+        if (conn->client == NULL) {
+            continue;
+        }
+        stats->conn_num++;
+        HAL_MutexLock(conn->lock);
+        stats->conn_online += conn->online;
+        stats->pub_count += conn->pub_count;
+        stats->pub_fail += conn->pub_fail;
+        stats->recv_count += conn->recv_count;
+        stats->disconnect_count += conn->disconnect_count;
+        stats->reconnect_count += conn->reconnect_count;
+        HAL_MutexUnlock(conn->lock);
+    }
+
+    return 0;
+}
+
 static iotx_mqtt_qos_t _get_mqtt_qos(iotx_cm_ack_types_t ack_type)
 {
     switch (ack_type) {
@@ -401,10 +726,12 @@ static void _set_common_handlers()
     if (_mqtt_conncection != NULL) {
         _mqtt_conncection->connect_func = _mqtt_connect;
         _mqtt_conncection->sub_func = _mqtt_sub;
+        _mqtt_conncection->sub_multi_func = _mqtt_sub_multi;
         _mqtt_conncection->unsub_func = _mqtt_unsub;
         _mqtt_conncection->pub_func = _mqtt_publish;
         _mqtt_conncection->yield_func = (iotx_cm_yield_fp)_mqtt_yield;
         _mqtt_conncection->close_func = _mqtt_close;
+        _mqtt_conncection->stats_func = _mqtt_stats;
     }
 }
 
@@ -19,6 +19,24 @@ typedef struct {
     dlist_t linked_list;
 } mqtt_sub_node_t;
 
+#ifdef PLATFORM_HAS_DYNMEM
+    #define CM_MQTT_CONN_NUM    CONFIG_CM_MQTT_POOL_SIZE
+#else
+    #define CM_MQTT_CONN_NUM    (1)
+#endif
+
+/* one MQTT connection of the pool, the first one is the default MQTT client and serves the device itself */
+typedef struct {
+    void *client;
+    void *lock;                 /* guards the state and counters below, which are updated by publishing and yielding threads */
+    uint8_t online;
+    uint32_t pub_count;
+    uint32_t pub_fail;
+    uint32_t recv_count;
+    uint32_t disconnect_count;
+    uint32_t reconnect_count;
+} iotx_cm_mqtt_conn_t;
+
 iotx_cm_connection_t *iotx_cm_open_mqtt(iotx_cm_init_param_t *params);
 
 
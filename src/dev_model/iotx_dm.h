@@ -100,6 +100,53 @@ typedef enum {
 
 typedef void (*iotx_dm_event_callback)(iotx_dm_event_types_t type, char *payload);
 
+/*
+ * Downstream request delivered as fields rather than JSON text, @type tells which member of @u is set.
+ * Strings are NUL terminated copies out of the MQTT payload, kept in the same allocation as the event,
+ * so they are valid during the callback only.
+ */
+typedef struct {
+    iotx_dm_event_types_t type;
+    int devid;
+    union {
+        struct {
+            const char *msgid;          /* IOTX_DM_EVENT_PROPERTY_SET */
+            int msgid_len;
+            const char *payload;
+            int payload_len;
+        } property_set;
+        struct {
+            const char *id;             /* IOTX_DM_EVENT_PROPERTY_GET */
+            int id_len;
+            const char *payload;
+            int payload_len;
+            void *ctx;
+        } property_get;
+        struct {
+            const char *id;             /* IOTX_DM_EVENT_THING_SERVICE_REQUEST */
+            int id_len;
+            const char *serviceid;
+            int serviceid_len;
+            const char *payload;
+            int payload_len;
+            void *ctx;
+        } service_request;
+        struct {
+            const char *id;             /* IOTX_DM_EVENT_RRPC_REQUEST */
+            int id_len;
+            const char *serviceid;
+            int serviceid_len;
+            const char *rrpcid;
+            int rrpcid_len;
+            const char *payload;
+            int payload_len;
+        } rrpc_request;
+    } u;
+} iotx_dm_event_t;
+
+/* events with a typed form go here when set, others and all events of legacy consumers go to event_callback */
+typedef void (*iotx_dm_event_typed_callback)(const iotx_dm_event_t *event);
+
 typedef enum {
     IOTX_DM_DEVICE_SECRET_PRODUCT,
     IOTX_DM_DEVICE_SECRET_DEVICE,
@@ -135,6 +182,7 @@ typedef struct {
     iotx_dm_device_secret_types_t secret_type;
     iotx_dm_cloud_domain_types_t domain_type;
     iotx_dm_event_callback event_callback;
+    iotx_dm_event_typed_callback event_typed_callback;
 } iotx_dm_init_params_t;
 
 typedef enum {
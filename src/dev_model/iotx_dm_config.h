@@ -33,4 +33,24 @@
     #define CONFIG_MSGCACHE_QUEUE_MAXLEN    (50)
 #endif
 
+/* initial buckets of the device indexes, a power of 2, doubled as devices are added */
+#ifndef CONFIG_DM_MGR_INDEX_SIZE
+    #define CONFIG_DM_MGR_INDEX_SIZE        (16)
+#endif
+
+/* bytes of upstream message buffer kept for the next message, a larger one is freed once sent */
+#ifndef CONFIG_DM_MSG_WRITER_KEEP
+    #define CONFIG_DM_MSG_WRITER_KEEP       (1024)
+#endif
+
+/* upstream messages written and sent at the same time with kept buffers, one more uses a temporary buffer */
+#ifndef CONFIG_DM_MSG_WRITER_NUM
+    #define CONFIG_DM_MSG_WRITER_NUM        (2)
+#endif
+
+/* tokens indexed on stack when a message is parsed for lookups, nested values beyond are scanned */
+#ifndef CONFIG_DM_JSON_INDEX_TOKENS
+    #define CONFIG_DM_JSON_INDEX_TOKENS     (16)
+#endif
+
 #endif
\ No newline at end of file
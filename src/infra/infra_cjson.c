@@ -15,6 +15,7 @@
 #include <ctype.h>
 
 #include "infra_cjson.h"
+#include "infra_json_scan.h"
 #include "infra_types.h"
 
 typedef struct {
@@ -22,6 +23,7 @@ typedef struct {
     int length;
     int offset;
     int depth; /* How deeply nested (in arrays/objects) is the input at the current offset. */
+    lite_cjson_index_t *index; /* tokens are recorded into when not NULL */
 } parse_buffer;
 
 /* check if the given size is left to read in a given parse buffer (starting with 1) */
@@ -37,6 +39,82 @@ static int parse_value(lite_cjson_t *const item, parse_buffer *const input_buffe
 static int parse_string(lite_cjson_t *const item, parse_buffer *const input_buffer);
 static int parse_array(lite_cjson_t *const item, parse_buffer *const input_buffer);
 static int parse_object(lite_cjson_t *const item, parse_buffer *const input_buffer);
+static int parse_number(lite_cjson_t *const item, parse_buffer *const input_buffer);
+
+/* take the next token of index, -1 when not indexing or the index is full */
+static int index_reserve(parse_buffer *const input_buffer)
+{
+    lite_cjson_index_t *index = input_buffer->index;
+
+    if (index == NULL) {
+        return -1;
+    }
+    if (index->token_count >= index->token_max) {
+        index->overflow = 1;
+        return -1;
+    }
+
+    return index->token_count++;
+}
+
+static unsigned int index_hash(const char *key, int key_len)
+{
+    unsigned int hash = 5381;
+
+    while (key_len-- > 0) {
+        hash = hash * 33 + (unsigned char) * key++;
+    }
+
+    return hash;
+}
+
+/* fill the token of @item once it is parsed, children of a container which did not all fit are dropped */
+static void index_fill(parse_buffer *const input_buffer, int token, lite_cjson_t *const item, int is_key)
+{
+    lite_cjson_index_t *index = input_buffer->index;
+    lite_cjson_token_t *tok = NULL;
+
+    if (index == NULL || token < 0) {
+        return;
+    }
+
+    tok = &index->tokens[token];
+    tok->type = item->type;
+    tok->offset = (int)(item->value - index->src);
+    tok->length = item->value_length;
+    tok->size = (item->type == cJSON_Array || item->type == cJSON_Object) ? item->size : 0;
+    tok->hash = is_key ? index_hash(item->value, item->value_length) : 0;
+    if (index->overflow && tok->size > 0) {
+        tok->type |= LITE_CJSON_TOKEN_SHALLOW;
+        index->token_count = token + 1;
+        index->overflow = 0;
+    }
+    tok->end = index->token_count;
+}
+
+/* item of a token, which keeps the index unless its children are not in it */
+static void index_item(lite_cjson_index_t *index, int token, lite_cjson_t *lite)
+{
+    lite_cjson_token_t *tok = &index->tokens[token];
+    parse_buffer buffer;
+
+    memset(lite, 0, sizeof(lite_cjson_t));
+    lite->type = tok->type & 0xFF;
+    lite->value = (char *)index->src + tok->offset;
+    lite->value_length = tok->length;
+    lite->size = tok->size;
+    if (!(tok->type & LITE_CJSON_TOKEN_SHALLOW)) {
+        lite->index = index;
+        lite->token = token;
+    }
+
+    if (lite->type == cJSON_Number) {
+        memset(&buffer, 0, sizeof(parse_buffer));
+        buffer.content = (const unsigned char *)lite->value;
+        buffer.length = lite->value_length;
+        parse_number(lite, &buffer);
+    }
+}
 
 /* Utility to jump whitespace and cr/lf */
 static parse_buffer *buffer_skip_whitespace(parse_buffer *const buffer)
@@ -213,6 +291,7 @@ static int parse_object(lite_cjson_t *const item, parse_buffer *const input_buff
     lite_cjson_t current_item_key;
     lite_cjson_t current_item_value;
     int start_pos = input_buffer->offset;
+    int key_token = -1;
     item->size = 0;
 
     if (input_buffer->depth >= LITE_CJSON_NESTING_LIMIT) {
@@ -246,9 +325,11 @@ static int parse_object(lite_cjson_t *const item, parse_buffer *const input_buff
         /* parse the name of the child */
         input_buffer->offset++;
         buffer_skip_whitespace(input_buffer);
+        key_token = index_reserve(input_buffer);
         if (parse_string(&current_item_key, input_buffer) != 0) {
             goto fail; /* faile to parse name */
         }
+        index_fill(input_buffer, key_token, &current_item_key, 1);
         buffer_skip_whitespace(input_buffer);
 
         if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':')) {
@@ -308,17 +389,21 @@ static int parse_string(lite_cjson_t *const item, parse_buffer *const input_buff
         /* calculate approximate size of the output (overestimate) */
         /* int allocation_length = 0; */
         int skipped_bytes = 0;
-        while (((int)(input_end - input_buffer->content) < input_buffer->length) && (*input_end != '\"')) {
+        const char *content_end = (const char *)input_buffer->content + input_buffer->length;
+
+        /* hop from one quote or backslash to the next instead of walking each byte */
+        for (;;) {
+            input_end = (const unsigned char *)infra_json_scan_string((const char *)input_end, content_end);
+            if (((int)(input_end - input_buffer->content) >= input_buffer->length) || (*input_end == '\"')) {
+                break;
+            }
             /* is escape sequence */
-            if (input_end[0] == '\\') {
-                if ((int)(input_end + 1 - input_buffer->content) >= input_buffer->length) {
-                    /* prevent buffer overflow when last input character is a backslash */
-                    goto fail;
-                }
-                skipped_bytes++;
-                input_end++;
+            if ((int)(input_end + 1 - input_buffer->content) >= input_buffer->length) {
+                /* prevent buffer overflow when last input character is a backslash */
+                goto fail;
             }
-            input_end++;
+            skipped_bytes++;
+            input_end += 2;
         }
         if (((int)(input_end - input_buffer->content) >= input_buffer->length) || (*input_end != '\"')) {
             /* printf("end error\n"); */
@@ -412,8 +497,49 @@ fail:
     return -1;
 }
 
+/*
+ * Step over one value of text that has been parsed already, for the lookups
+ * to pass the members they are not after without describing them. Only the
+ * structural characters are visited, strings are hopped over as a whole.
+ */
+static int skip_value(parse_buffer *const input_buffer)
+{
+    const char *start = (const char *)input_buffer->content;
+    const char *end = start + input_buffer->length;
+    const char *pos = (const char *)buffer_at_offset(input_buffer);
+    int depth = 0;
+
+    while ((pos = infra_json_scan_structural(pos, end)) < end) {
+        if (*pos == '\"') {
+            while ((pos = infra_json_scan_string(pos + 1, end)) < end - 1 && *pos == '\\') {
+                pos++;
+            }
+            if (pos >= end || *pos != '\"') {
+                return -1;
+            }
+        } else if (*pos == '{' || *pos == '[') {
+            depth++;
+        } else if (depth == 0) {
+            /* number or literal, ended by what follows it */
+            break;
+        } else if (*pos == '}' || *pos == ']') {
+            depth--;
+        }
+        pos++;
+        if (depth == 0) {
+            break;
+        }
+    }
+    if (pos >= end && depth != 0) {
+        return -1;
+    }
+
+    input_buffer->offset = (int)(pos - start);
+    return 0;
+}
+
 /* Parser core - when encountering text, process appropriately. */
-static int parse_value(lite_cjson_t *const lite, parse_buffer *const input_buffer)
+static int parse_value_text(lite_cjson_t *const lite, parse_buffer *const input_buffer)
 {
     if ((input_buffer == NULL) || (input_buffer->content == NULL)) {
         return -1; /* no input */
@@ -474,6 +600,21 @@ static int parse_value(lite_cjson_t *const lite, parse_buffer *const input_buffe
     return -1;
 }
 
+static int parse_value(lite_cjson_t *const lite, parse_buffer *const input_buffer)
+{
+    int token = -1;
+
+    if (input_buffer != NULL) {
+        token = index_reserve(input_buffer);
+    }
+    if (parse_value_text(lite, input_buffer) != 0) {
+        return -1;
+    }
+    index_fill(input_buffer, token, lite, 0);
+
+    return 0;
+}
+
 int lite_cjson_parse(const char *src, int src_len, lite_cjson_t *lite)
 {
     parse_buffer buffer;
@@ -487,6 +628,40 @@ int lite_cjson_parse(const char *src, int src_len, lite_cjson_t *lite)
     buffer.length = src_len;
     buffer.offset = 0;
 
+    lite->index = NULL;
+    lite->token = 0;
+    if (parse_value(lite, buffer_skip_whitespace(skip_utf8_bom(&buffer))) != 0) {
+        lite->type = cJSON_Invalid;
+        lite->value = NULL;
+        lite->value_length = 0;
+        return -1;
+    }
+
+    return 0;
+}
+
+int lite_cjson_parse_index(const char *src, int src_len, lite_cjson_index_t *index,
+                           lite_cjson_token_t *tokens, int token_max, lite_cjson_t *lite)
+{
+    parse_buffer buffer;
+
+    if (!lite || !src || !index || !tokens || src_len <= 0 || token_max <= 0) {
+        return -1;
+    }
+
+    memset(index, 0, sizeof(lite_cjson_index_t));
+    index->src = src;
+    index->tokens = tokens;
+    index->token_max = token_max;
+
+    memset(&buffer, 0, sizeof(parse_buffer));
+    buffer.content = (const unsigned char *)src;
+    buffer.length = src_len;
+    buffer.offset = 0;
+    buffer.index = index;
+
+    lite->index = NULL;
+    lite->token = 0;
     if (parse_value(lite, buffer_skip_whitespace(skip_utf8_bom(&buffer))) != 0) {
         lite->type = cJSON_Invalid;
         lite->value = NULL;
@@ -494,6 +669,11 @@ int lite_cjson_parse(const char *src, int src_len, lite_cjson_t *lite)
         return -1;
     }
 
+    /* root is token 0, which has nothing to walk when its children did not fit */
+    if (index->token_count > 0 && !(tokens[0].type & LITE_CJSON_TOKEN_SHALLOW)) {
+        lite->index = index;
+    }
+
     return 0;
 }
 
@@ -574,6 +754,16 @@ int lite_cjson_array_item(lite_cjson_t *lite, int index, lite_cjson_t *lite_item
         return -1;
     }
 
+    if (lite->index) {
+        int token = lite->token + 1;
+
+        for (iter_index = 0; iter_index < index; iter_index++) {
+            token = lite->index->tokens[token].end;
+        }
+        index_item(lite->index, token, lite_item);
+        return 0;
+    }
+
     memset(&buffer, 0, sizeof(parse_buffer));
     buffer.content = (const unsigned char *)lite->value;
     buffer.length = lite->value_length;
@@ -608,18 +798,17 @@ int lite_cjson_array_item(lite_cjson_t *lite, int index, lite_cjson_t *lite_item
         /* parse next value */
         p_buffer->offset++;
         buffer_skip_whitespace(p_buffer);
-        if (parse_value(&current_item, p_buffer) != 0) {
-            return -1; /* failed to parse value */
-        }
-        buffer_skip_whitespace(p_buffer);
-
-        /* printf("current item index: %d, type: %d, length: %d, value: %.*s\n", */
-        /* iter_index+1, current_item.type, current_item.value_length, current_item.value_length, current_item.value); */
-
         if (iter_index == index) {
+            if (parse_value(&current_item, p_buffer) != 0) {
+                return -1; /* failed to parse value */
+            }
             memcpy(lite_item, &current_item, sizeof(lite_cjson_t));
             return 0;
         }
+        if (skip_value(p_buffer) != 0) {
+            return -1;
+        }
+        buffer_skip_whitespace(p_buffer);
 
         iter_index++;
     } while (can_access_at_index(p_buffer, 0) && (buffer_at_offset(p_buffer)[0] == ','));
@@ -640,6 +829,22 @@ static int _lite_cjson_object_item(lite_cjson_t *lite, const char *key, int key_
         return -1;
     };
 
+    if (lite->index) {
+        lite_cjson_token_t *tokens = lite->index->tokens;
+        unsigned int hash = index_hash(key, key_len);
+        int token = lite->token + 1;
+
+        for (index = 0; index < lite->size; index++) {
+            if (tokens[token].hash == hash && tokens[token].length == key_len &&
+                memcmp(lite->index->src + tokens[token].offset, key, key_len) == 0) {
+                index_item(lite->index, token + 1, lite_item);
+                return 0;
+            }
+            token = tokens[token + 1].end;
+        }
+        return -1;
+    }
+
     memset(&buffer, 0, sizeof(parse_buffer));
     buffer.content = (const unsigned char *)lite->value;
     buffer.length = lite->value_length;
@@ -682,25 +887,24 @@ static int _lite_cjson_object_item(lite_cjson_t *lite, const char *key, int key_
             return -1; /* invalid object */
         }
 
-        /* parse the value */
+        /* parse the value, only when it is the one asked for */
         p_buffer->offset++;
         buffer_skip_whitespace(p_buffer);
-        if (parse_value(&current_item_value, p_buffer) != 0) {
-            return -1; /* failed to parse value */
-        }
-        buffer_skip_whitespace(p_buffer);
-
-        /* printf("Current Object [Index: %d], [Key Length: %d, Key Value: %.*s], [Value Length: %d, Value: %.*s]\n", */
-        /* index + 1, current_item_key.value_length,current_item_key.value_length,current_item_key.value, */
-        /* current_item_value.value_length,current_item_value.value_length,current_item_value.value); */
         index++;
 
         /* printf("key: %s, ken_len: %d\n",key,key_len); */
         if ((current_item_key.value_length == key_len) &&
             memcmp(current_item_key.value, key, key_len) == 0) {
+            if (parse_value(&current_item_value, p_buffer) != 0) {
+                return -1; /* failed to parse value */
+            }
             memcpy(lite_item, &current_item_value, sizeof(lite_cjson_t));
             return 0;
         }
+        if (skip_value(p_buffer) != 0) {
+            return -1;
+        }
+        buffer_skip_whitespace(p_buffer);
     } while (can_access_at_index(p_buffer, 0) && (buffer_at_offset(p_buffer)[0] == ','));
 
     return -1;
@@ -847,6 +1051,21 @@ int lite_cjson_object_item_by_index(lite_cjson_t *lite, int index, lite_cjson_t
         return -1;
     };
 
+    if (lite->index) {
+        int token = lite->token + 1;
+
+        for (item_index = 0; item_index < index; item_index++) {
+            token = lite->index->tokens[token + 1].end;
+        }
+        if (lite_item_key) {
+            index_item(lite->index, token, lite_item_key);
+        }
+        if (lite_item_value) {
+            index_item(lite->index, token + 1, lite_item_value);
+        }
+        return 0;
+    }
+
     memset(&buffer, 0, sizeof(parse_buffer));
     buffer.content = (const unsigned char *)lite->value;
     buffer.length = lite->value_length;
@@ -890,30 +1109,25 @@ int lite_cjson_object_item_by_index(lite_cjson_t *lite, int index, lite_cjson_t
         /* parse the value */
         p_buffer->offset++;
         buffer_skip_whitespace(p_buffer);
+        if (item_index != index) {
+            if (skip_value(p_buffer) != 0) {
+                return -1;
+            }
+            buffer_skip_whitespace(p_buffer);
+            item_index++;
+            continue;
+        }
         if (parse_value(&current_item_value, p_buffer) != 0) {
             return -1; /* failed to parse value */
         }
-        buffer_skip_whitespace(p_buffer);
 
-        /* printf("Current Object [Index: %d], [Key Length: %d, Key Value: %.*s], [Value Length: %d, Value: %.*s]\n", */
-        /* index + 1, current_item_key.value_length,current_item_key.value_length,current_item_key.value, */
-        /* current_item_value.value_length,current_item_value.value_length,current_item_value.value); */
-
-        /* printf("index:%d, key: %.*s, value: %.*s\n",index, */
-        /* current_item_key.value_length,current_item_key.value, */
-        /* current_item_value.value_length,current_item_value.value); */
-
-        if (item_index == index) {
-            if (lite_item_key) {
-                memcpy(lite_item_key, &current_item_key, sizeof(lite_cjson_t));
-            }
-            if (lite_item_value) {
-                memcpy(lite_item_value, &current_item_value, sizeof(lite_cjson_t));
-            }
-            return 0;
+        if (lite_item_key) {
+            memcpy(lite_item_key, &current_item_key, sizeof(lite_cjson_t));
         }
-
-        item_index++;
+        if (lite_item_value) {
+            memcpy(lite_item_value, &current_item_value, sizeof(lite_cjson_t));
+        }
+        return 0;
     } while (can_access_at_index(p_buffer, 0) && (buffer_at_offset(p_buffer)[0] == ','));
 
     return -1;
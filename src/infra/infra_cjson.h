@@ -34,10 +34,43 @@ typedef struct lite_cjson_st {
 
     double value_double;
     int value_int;
+
+    /* The index the item was found by, NULL when lookups under the item scan its text. */
+    struct lite_cjson_index_st *index;
+    int token;
 } lite_cjson_t;
 
+/* One token of the index built by lite_cjson_parse_index(), keys of an object are followed by their values. */
+typedef struct {
+    int type;           /* cJSON type, with LITE_CJSON_TOKEN_SHALLOW when its children did not fit the index */
+    int offset;         /* value offset in source text */
+    int length;
+    int size;           /* children of array or object */
+    int end;            /* token after the item and its children, which is its next sibling */
+    unsigned int hash;  /* hash of the key, for key tokens */
+} lite_cjson_token_t;
+
+#define LITE_CJSON_TOKEN_SHALLOW (1 << 8)
+
+typedef struct lite_cjson_index_st {
+    const char *src;
+    lite_cjson_token_t *tokens;
+    int token_max;
+    int token_count;
+    int overflow;
+} lite_cjson_index_t;
+
 int lite_cjson_parse(const char *src, int src_len, lite_cjson_t *lite);
 
+/*
+ * Parse as lite_cjson_parse() does, and index tokens of all values into @tokens in the same pass, so that
+ * lite_cjson_array_item() and lite_cjson_object_item*() on @lite and items found under it walk the index
+ * rather than scan the text again. Containers whose children do not fit are kept in the index without them,
+ * lookups under those scan as before. @index and @tokens must be kept as long as the items are used.
+ */
+int lite_cjson_parse_index(const char *src, int src_len, lite_cjson_index_t *index,
+                           lite_cjson_token_t *tokens, int token_max, lite_cjson_t *lite);
+
 int lite_cjson_is_false(lite_cjson_t *lite);
 int lite_cjson_is_true(lite_cjson_t *lite);
 int lite_cjson_is_null(lite_cjson_t *lite);
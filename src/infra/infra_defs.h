@@ -65,6 +65,9 @@ typedef enum IOT_RETURN_CODES {
     ERROR_NET_CONN = -301,
     ERROR_NET_UNKNOWN_HOST = -300,
 
+    MQTT_DISPATCH_QUEUE_FULL = -50,
+    MQTT_OFFLINE_QUEUE_FULL = -49,
+    MQTT_PUB_WINDOW_FULL = -48,
     MQTT_SUBHANDLE_LIST_LEN_TOO_SHORT = -47,
     MQTT_OFFLINE_LIST_LEN_TOO_SHORT = -46,
     MQTT_TOPIC_LEN_TOO_SHORT = -45,
@@ -12,6 +12,7 @@
 
 #include "infra_types.h"
 #include "infra_json_parser.h"
+#include "infra_json_scan.h"
 
 void *HAL_Malloc(uint32_t size);
 void HAL_Free(void *ptr);
@@ -102,8 +103,17 @@ char *json_get_next_object(int type, char *str, char *str_end, char **key, int *
     }
 
     while (p_cPos && *p_cPos && p_cPos < str_end && iValueType > JNONE) {
+        if (iValueType == JSTRING || iValueType == JOBJECT || iValueType == JARRAY) {
+            /* jump to the next byte the cases below act on */
+            p_cPos = (char *)(iValueType == JSTRING ? infra_json_scan_string(p_cPos, str_end)
+                              : infra_json_scan_structural(p_cPos, str_end));
+            if (p_cPos >= str_end) {
+                break;
+            }
+        }
+
         if (iValueType == JBOOLEAN) {
-            int     len = strlen(p_cValue);
+            int     len = str_end - p_cValue;
 
             if ((*p_cValue == 't' || *p_cValue == 'T') && len >= 4
                 && (!strncmp(p_cValue, "true", 4)
@@ -118,6 +128,7 @@ char *json_get_next_object(int type, char *str, char *str_end, char **key, int *
                 p_cPos = p_cValue + iValueLen;
                 break;
             }
+            break;
         } else if (iValueType == JNUMBER) {
             if ((*p_cPos < '0' || *p_cPos > '9') && (*p_cPos != '.') && (*p_cPos != '+') \
                 && (*p_cPos != '-') && ((*p_cPos != 'e')) && (*p_cPos != 'E')) {
@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2015-2018 Alibaba Group Holding Limited
+ */
+#include "infra_config.h"
+
+#if defined(INFRA_CJSON) || defined(INFRA_JSON_PARSER)
+
+#include <string.h>
+
+#include "infra_json_scan.h"
+
+#if defined(__GNUC__) && defined(__AVX2__)
+    #define SCAN_AVX2
+#endif
+#if defined(__GNUC__) && defined(__SSE2__)
+    #define SCAN_SSE2
+    #include <immintrin.h>
+#elif defined(__GNUC__) && (defined(__ARM_NEON) || defined(__ARM_NEON__)) && \
+      (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    #define SCAN_NEON
+    #include <arm_neon.h>
+#endif
+
+/*
+ * Word at a time fallback: a byte b of w is zero when the borrow of (b - 1)
+ * reaches its top bit while b itself did not have it set. The test is only
+ * exact for "any byte", the hit is then located byte by byte.
+ */
+#define SCAN_ONES           ((unsigned long)-1 / 0xFF)
+#define SCAN_HIGHS          (SCAN_ONES * 0x80)
+#define SCAN_HAS_ZERO(w)    (((w) - SCAN_ONES) & ~(w) & SCAN_HIGHS)
+#define SCAN_HAS_BYTE(w, c) SCAN_HAS_ZERO((w) ^ (SCAN_ONES * (unsigned char)(c)))
+
+/* '[' and ']' fold onto '{' and '}' once 0x20 is set, nothing else does */
+#define SCAN_IS_STRUCTURAL(c) ((c) == '\"' || (c) == ',' || (c) == ':' || \
+                               ((c) | 0x20) == '{' || ((c) | 0x20) == '}')
+
+static const char *_scan_string_scalar(const char *str, const char *end)
+{
+    unsigned long w;
+
+    while (end - str >= (int)sizeof(w)) {
+        memcpy(&w, str, sizeof(w));
+        if (SCAN_HAS_BYTE(w, '\"') | SCAN_HAS_BYTE(w, '\\')) {
+            break;
+        }
+        str += sizeof(w);
+    }
+    while (str < end && *str != '\"' && *str != '\\') {
+        str++;
+    }
+
+    return str;
+}
+
+static const char *_scan_structural_scalar(const char *str, const char *end)
+{
+    unsigned long w, f;
+
+    while (end - str >= (int)sizeof(w)) {
+        memcpy(&w, str, sizeof(w));
+        f = w | (SCAN_ONES * 0x20);
+        if (SCAN_HAS_BYTE(w, '\"') | SCAN_HAS_BYTE(w, ',') | SCAN_HAS_BYTE(w, ':') |
+            SCAN_HAS_BYTE(f, '{') | SCAN_HAS_BYTE(f, '}')) {
+            break;
+        }
+        str += sizeof(w);
+    }
+    while (str < end && !SCAN_IS_STRUCTURAL((unsigned char)*str)) {
+        str++;
+    }
+
+    return str;
+}
+
+#ifdef SCAN_NEON
+/* narrow the 0x00/0xFF lanes to one nibble each, lane i at bits 4i..4i+3 */
+static const char *_scan_neon_hit(const char *str, uint8x16_t hit)
+{
+    uint64_t bits = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hit), 4)), 0);
+
+    return bits ? str + (__builtin_ctzll(bits) >> 2) : NULL;
+}
+#endif
+
+const char *infra_json_scan_string(const char *str, const char *end)
+{
+#ifdef SCAN_AVX2
+    {
+        const __m256i quote = _mm256_set1_epi8('\"');
+        const __m256i slash = _mm256_set1_epi8('\\');
+
+        while (end - str >= 32) {
+            __m256i v = _mm256_loadu_si256((const __m256i *)str);
+            unsigned int mask = (unsigned int)_mm256_movemask_epi8(
+                                            _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, slash)));
+            if (mask) {
+                return str + __builtin_ctz(mask);
+            }
+            str += 32;
+        }
+    }
+#endif
+#ifdef SCAN_SSE2
+    {
+        const __m128i quote = _mm_set1_epi8('\"');
+        const __m128i slash = _mm_set1_epi8('\\');
+
+        while (end - str >= 16) {
+            __m128i v = _mm_loadu_si128((const __m128i *)str);
+            unsigned int mask = (unsigned int)_mm_movemask_epi8(
+                                            _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, slash)));
+            if (mask) {
+                return str + __builtin_ctz(mask);
+            }
+            str += 16;
+        }
+    }
+#endif
+#ifdef SCAN_NEON
+    {
+        const uint8x16_t quote = vdupq_n_u8('\"');
+        const uint8x16_t slash = vdupq_n_u8('\\');
+        const char *hit;
+
+        while (end - str >= 16) {
+            uint8x16_t v = vld1q_u8((const uint8_t *)str);
+            if ((hit = _scan_neon_hit(str, vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, slash)))) != NULL) {
+                return hit;
+            }
+            str += 16;
+        }
+    }
+#endif
+
+    return _scan_string_scalar(str, end);
+}
+
+const char *infra_json_scan_structural(const char *str, const char *end)
+{
+#ifdef SCAN_AVX2
+    {
+        const __m256i quote = _mm256_set1_epi8('\"');
+        const __m256i comma = _mm256_set1_epi8(',');
+        const __m256i colon = _mm256_set1_epi8(':');
+        const __m256i fold = _mm256_set1_epi8(0x20);
+        const __m256i open = _mm256_set1_epi8('{');
+        const __m256i close = _mm256_set1_epi8('}');
+
+        while (end - str >= 32) {
+            __m256i v = _mm256_loadu_si256((const __m256i *)str);
+            __m256i f = _mm256_or_si256(v, fold);
+            __m256i hit = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, comma)),
+                                          _mm256_or_si256(_mm256_cmpeq_epi8(v, colon),
+                                                  _mm256_or_si256(_mm256_cmpeq_epi8(f, open), _mm256_cmpeq_epi8(f, close))));
+            unsigned int mask = (unsigned int)_mm256_movemask_epi8(hit);
+            if (mask) {
+                return str + __builtin_ctz(mask);
+            }
+            str += 32;
+        }
+    }
+#endif
+#ifdef SCAN_SSE2
+    {
+        const __m128i quote = _mm_set1_epi8('\"');
+        const __m128i comma = _mm_set1_epi8(',');
+        const __m128i colon = _mm_set1_epi8(':');
+        const __m128i fold = _mm_set1_epi8(0x20);
+        const __m128i open = _mm_set1_epi8('{');
+        const __m128i close = _mm_set1_epi8('}');
+
+        while (end - str >= 16) {
+            __m128i v = _mm_loadu_si128((const __m128i *)str);
+            __m128i f = _mm_or_si128(v, fold);
+            __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, comma)),
+                                       _mm_or_si128(_mm_cmpeq_epi8(v, colon),
+                                               _mm_or_si128(_mm_cmpeq_epi8(f, open), _mm_cmpeq_epi8(f, close))));
+            unsigned int mask = (unsigned int)_mm_movemask_epi8(hit);
+            if (mask) {
+                return str + __builtin_ctz(mask);
+            }
+            str += 16;
+        }
+    }
+#endif
+#ifdef SCAN_NEON
+    {
+        const uint8x16_t quote = vdupq_n_u8('\"');
+        const uint8x16_t comma = vdupq_n_u8(',');
+        const uint8x16_t colon = vdupq_n_u8(':');
+        const uint8x16_t fold = vdupq_n_u8(0x20);
+        const uint8x16_t open = vdupq_n_u8('{');
+        const uint8x16_t close = vdupq_n_u8('}');
+        const char *hit;
+
+        while (end - str >= 16) {
+            uint8x16_t v = vld1q_u8((const uint8_t *)str);
+            uint8x16_t f = vorrq_u8(v, fold);
+            uint8x16_t any = vorrq_u8(vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, comma)),
+                                      vorrq_u8(vceqq_u8(v, colon), vorrq_u8(vceqq_u8(f, open), vceqq_u8(f, close))));
+            if ((hit = _scan_neon_hit(str, any)) != NULL) {
+                return hit;
+            }
+            str += 16;
+        }
+    }
+#endif
+
+    return _scan_structural_scalar(str, end);
+}
+
+const char *infra_json_scan_impl(void)
+{
+#if defined(SCAN_AVX2)
+    return "avx2";
+#elif defined(SCAN_SSE2)
+    return "sse2";
+#elif defined(SCAN_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+#endif
+
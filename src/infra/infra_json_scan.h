@@ -0,0 +1,29 @@
+/*
+ * Copyright (C) 2015-2018 Alibaba Group Holding Limited
+ */
+
+
+
+
+#ifndef _INFRA_JSON_SCAN_H_
+#define _INFRA_JSON_SCAN_H_
+
+/*
+ * Character scanners shared by infra_cjson and infra_json_parser. Each one
+ * returns the first matching byte of [str, end), or end when there is none,
+ * testing 32 (AVX2), 16 (SSE2/NEON) or sizeof(long) (scalar) bytes a stride.
+ * The stride is picked at compile time from the target the toolchain builds
+ * for; there is no run time CPU detection.
+ */
+
+/* first '"' or '\\', i.e. where a string body ends or needs unescaping */
+const char *infra_json_scan_string(const char *str, const char *end);
+
+/* first '"', '{', '}', '[', ']', ':' or ',' */
+const char *infra_json_scan_structural(const char *str, const char *end);
+
+/* "avx2", "sse2", "neon" or "scalar" */
+const char *infra_json_scan_impl(void);
+
+#endif
+
@@ -11,6 +11,8 @@
 #include "infra_net.h"
 #include "wrappers_defs.h"
 
+uint64_t HAL_UptimeMs(void);
+
 #ifdef INFRA_LOG
     #include "infra_log.h"
     #define net_err(...)      log_err("infra_net", __VA_ARGS__)
@@ -174,6 +176,12 @@ uintptr_t HAL_TCP_Establish(const char *host, uint16_t port);
 int HAL_TCP_Destroy(uintptr_t fd);
 int32_t HAL_TCP_Write(uintptr_t fd, const char *buf, uint32_t len, uint32_t timeout_ms);
 int32_t HAL_TCP_Read(uintptr_t fd, char *buf, uint32_t len, uint32_t timeout_ms);
+#ifdef HAL_TCP_WRITEV
+int32_t HAL_TCP_Writev(uintptr_t fd, const hal_iovec_t *iov, int iovcnt, uint32_t timeout_ms);
+#endif
+#ifdef HAL_TCP_READSOME
+int32_t HAL_TCP_ReadSome(uintptr_t fd, char *buf, uint32_t len, uint32_t timeout_ms);
+#endif
 void *HAL_Malloc(uint32_t size);
 void HAL_Free(void *ptr);
 
@@ -183,12 +191,48 @@ static int read_tcp(utils_network_pt pNetwork, char *buffer, uint32_t len, uint3
     return HAL_TCP_Read(pNetwork->handle, buffer, len, timeout_ms);
 }
 
+#ifdef HAL_TCP_READSOME
+static int read_some_tcp(utils_network_pt pNetwork, char *buffer, uint32_t min_len, uint32_t max_len,
+                         uint32_t timeout_ms)
+{
+    int         ret = 0;
+    uint32_t    recv = 0;
+    uint64_t    t_end = HAL_UptimeMs() + timeout_ms;
+    uint64_t    t_now = 0;
+
+    while (recv < min_len) {
+        t_now = HAL_UptimeMs();
+        if (recv > 0 && t_now >= t_end) {
+            break;
+        }
+
+        ret = HAL_TCP_ReadSome(pNetwork->handle, buffer + recv, max_len - recv,
+                               (t_now < t_end) ? (uint32_t)(t_end - t_now) : 1);
+        if (ret < 0) {
+            return (recv > 0) ? recv : ret;
+        } else if (ret == 0) {
+            break;
+        }
+        recv += ret;
+    }
+
+    return recv;
+}
+#endif
+
 
 static int write_tcp(utils_network_pt pNetwork, const char *buffer, uint32_t len, uint32_t timeout_ms)
 {
     return HAL_TCP_Write(pNetwork->handle, buffer, len, timeout_ms);
 }
 
+#ifdef HAL_TCP_WRITEV
+static int writev_tcp(utils_network_pt pNetwork, const hal_iovec_t *iov, int iovcnt, uint32_t timeout_ms)
+{
+    return HAL_TCP_Writev(pNetwork->handle, iov, iovcnt, timeout_ms);
+}
+#endif
+
 static int disconnect_tcp(utils_network_pt pNetwork)
 {
     if (pNetwork->handle == (uintptr_t)(-1)) {
@@ -259,6 +303,74 @@ int utils_net_write(utils_network_pt pNetwork, const char *buffer, uint32_t len,
     return ret;
 }
 
+int utils_net_read_some(utils_network_pt pNetwork, char *buffer, uint32_t min_len, uint32_t max_len,
+                        uint32_t timeout_ms)
+{
+    if (NULL == buffer || min_len > max_len) {
+        net_err("parameter error! buffer=%p, min_len=%u, max_len=%u", buffer, min_len, max_len);
+        return -1;
+    }
+
+#if !defined(SUPPORT_TLS) && !defined(AT_TCP_ENABLED) && defined(HAL_TCP_READSOME)
+    if (NULL == pNetwork->ca_crt) {
+        return read_some_tcp(pNetwork, buffer, min_len, max_len, timeout_ms);
+    }
+#endif
+
+    /* without a read returning what is available, never ask for more than is surely coming */
+    return utils_net_read(pNetwork, buffer, min_len, timeout_ms);
+}
+
+/* used when the port has no native vectored write: send segments one by one within @timeout_ms */
+static int writev_by_segment(utils_network_pt pNetwork, const hal_iovec_t *iov, int iovcnt, uint32_t timeout_ms)
+{
+    int         idx = 0;
+    int         ret = 0;
+    int         sent = 0;
+    uint64_t    t_end = HAL_UptimeMs() + timeout_ms;
+    uint64_t    t_now = 0;
+
+    for (idx = 0; idx < iovcnt; idx++) {
+        if (iov[idx].len == 0) {
+            continue;
+        }
+
+        t_now = HAL_UptimeMs();
+        if (sent > 0 && t_now >= t_end) {
+            break;
+        }
+
+        ret = utils_net_write(pNetwork, (const char *)iov[idx].base, iov[idx].len,
+                              (t_now < t_end) ? (uint32_t)(t_end - t_now) : 1);
+        if (ret < 0) {
+            return (sent > 0) ? sent : ret;
+        }
+
+        sent += ret;
+        if ((uint32_t)ret < iov[idx].len) {
+            break;
+        }
+    }
+
+    return sent;
+}
+
+int utils_net_writev(utils_network_pt pNetwork, const hal_iovec_t *iov, int iovcnt, uint32_t timeout_ms)
+{
+    if (NULL == iov || iovcnt < 0) {
+        net_err("parameter error! iov=%p, iovcnt=%d", iov, iovcnt);
+        return -1;
+    }
+
+#if !defined(SUPPORT_TLS) && !defined(AT_TCP_ENABLED) && defined(HAL_TCP_WRITEV)
+    if (NULL == pNetwork->ca_crt) {
+        return writev_tcp(pNetwork, iov, iovcnt, timeout_ms);
+    }
+#endif
+
+    return writev_by_segment(pNetwork, iov, iovcnt, timeout_ms);
+}
+
 int iotx_net_disconnect(utils_network_pt pNetwork)
 {
     int     ret = 0;
@@ -317,7 +429,9 @@ int iotx_net_init(utils_network_pt pNetwork, const char *host, uint16_t port, co
 
     pNetwork->handle = 0;
     pNetwork->read = utils_net_read;
+    pNetwork->read_some = utils_net_read_some;
     pNetwork->write = utils_net_write;
+    pNetwork->writev = utils_net_writev;
     pNetwork->disconnect = iotx_net_disconnect;
     pNetwork->connect = iotx_net_connect;
 
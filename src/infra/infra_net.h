@@ -6,6 +6,7 @@
 #define _INFRA_NET_H_
 
 #include "infra_types.h"
+#include "wrappers_defs.h"
 
 /**
  * @brief The structure of network connection(TCP or SSL).
@@ -30,9 +31,15 @@ struct utils_network {
     /**< Read data from server function pointer. */
     int (*read)(utils_network_pt, char *, uint32_t, uint32_t);
 
+    /**< Read at least min_len and at most max_len bytes from server, function pointer. */
+    int (*read_some)(utils_network_pt, char *, uint32_t, uint32_t, uint32_t);
+
     /**< Send data to server function pointer. */
     int (*write)(utils_network_pt, const char *, uint32_t, uint32_t);
 
+    /**< Send several segments of data to server in one go, function pointer. */
+    int (*writev)(utils_network_pt, const hal_iovec_t *, int, uint32_t);
+
     /**< Disconnect the network */
     int (*disconnect)(utils_network_pt);
 
@@ -41,7 +48,10 @@ struct utils_network {
 };
 
 int utils_net_read(utils_network_pt pNetwork, char *buffer, uint32_t len, uint32_t timeout_ms);
+int utils_net_read_some(utils_network_pt pNetwork, char *buffer, uint32_t min_len, uint32_t max_len,
+                        uint32_t timeout_ms);
 int utils_net_write(utils_network_pt pNetwork, const char *buffer, uint32_t len, uint32_t timeout_ms);
+int utils_net_writev(utils_network_pt pNetwork, const hal_iovec_t *iov, int iovcnt, uint32_t timeout_ms);
 int iotx_net_disconnect(utils_network_pt pNetwork);
 int iotx_net_connect(utils_network_pt pNetwork);
 int iotx_net_init(utils_network_pt pNetwork, const char *host, uint16_t port, const char *ca_crt);
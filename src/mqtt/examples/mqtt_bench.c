@@ -0,0 +1,423 @@
+/*
+ * Copyright (C) 2015-2018 Alibaba Group Holding Limited
+ */
+
+/*
+ * Throughput and latency benchmark of MQTT client. It publishes to a topic it subscribes, every PUBLISH carries
+ * the time it is sent, so latency is the round trip through broker. Broker stand-in in mqtt_bench_broker.c is
+ * forked to serve on localhost unless -H is given, so its work is not counted in CPU or allocations of client.
+ *
+ *   mqtt-bench [-n messages] [-s payload size] [-q qos] [-r rate per second, 0 for no limit]
+ *              [-w messages in flight] [-a topic aliases] [-c stream piece size] [-H host] [-p port] [-B]
+ *
+ * -a needs FEATURE_MQTT_TOPIC_ALIAS and a broker understanding it, such as the stand-in.
+ * -c needs FEATURE_MQTT_STREAM_RECV, read buffer is then sized for one piece and echoes are received streamed.
+ * -B only runs broker stand-in on -p, for benchmarking from elsewhere.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "infra_types.h"
+#include "infra_defs.h"
+#include "mqtt_api.h"
+
+int mqtt_bench_broker_listen(uint16_t *port);
+int mqtt_bench_broker_run(int listen_fd);
+
+void HAL_Printf(const char *fmt, ...);
+
+#define BENCH_TRACE(fmt, ...)  \
+    do { \
+        HAL_Printf(fmt, ##__VA_ARGS__); \
+        HAL_Printf("%s", "\r\n"); \
+    } while(0)
+
+/* payload starts with the time it is sent */
+#define BENCH_STAMP_LEN         (sizeof(uint64_t))
+
+typedef struct {
+    uint32_t        count;
+    uint32_t        size;
+    int             qos;
+    uint32_t        rate;
+    uint32_t        window;
+    uint16_t        alias_max;
+    uint32_t        chunk_size;
+    const char     *host;
+    uint16_t        port;
+    int             broker_only;
+} bench_param_t;
+
+typedef struct {
+    char            topic[64];
+    uint32_t        sent;
+    uint32_t        received;
+    uint32_t        pub_fail;
+    uint32_t       *latency_us;
+    uint64_t        stream_stamp;
+} bench_state_t;
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+/* heap allocations are counted by taking over malloc() of glibc, which HAL_Malloc() calls */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static volatile unsigned long g_alloc_count = 0;
+
+void *malloc(size_t size)
+{
+    g_alloc_count++;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+    g_alloc_count++;
+    return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    g_alloc_count++;
+    return __libc_realloc(ptr, size);
+}
+#define BENCH_ALLOC_COUNT()     ((long)g_alloc_count)
+#else
+#define BENCH_ALLOC_COUNT()     (-1L)
+#endif
+
+static uint64_t _bench_now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static uint64_t _bench_cpu_us(void)
+{
+    struct rusage usage;
+
+    getrusage(RUSAGE_SELF, &usage);
+    return (uint64_t)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000 +
+           usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+static int _bench_cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void _bench_message_arrive(void *pcontext, void *pclient, iotx_mqtt_event_msg_pt msg)
+{
+    bench_state_t *state = (bench_state_t *)pcontext;
+    iotx_mqtt_topic_info_pt topic_info = (iotx_mqtt_topic_info_pt)msg->msg;
+    uint64_t stamp;
+
+    if (msg->event_type != IOTX_MQTT_EVENT_PUBLISH_RECEIVED || topic_info->payload_len < BENCH_STAMP_LEN ||
+        state->received >= state->sent) {
+        return;
+    }
+
+    memcpy(&stamp, topic_info->payload, BENCH_STAMP_LEN);
+    state->latency_us[state->received++] = (uint32_t)(_bench_now_us() - stamp);
+}
+
+static void _bench_stream_arrive(void *pcontext, void *pclient, const iotx_mqtt_stream_chunk_t *chunk)
+{
+    bench_state_t *state = (bench_state_t *)pcontext;
+
+    if (chunk->aborted || state->received >= state->sent) {
+        return;
+    }
+
+    if (chunk->offset == 0) {
+        memcpy(&state->stream_stamp, chunk->chunk, BENCH_STAMP_LEN);
+    }
+    if (chunk->offset + chunk->chunk_len == chunk->total_len) {
+        state->latency_us[state->received++] = (uint32_t)(_bench_now_us() - state->stream_stamp);
+    }
+}
+
+static void _bench_usage(const char *name)
+{
+    BENCH_TRACE("usage: %s [-n messages] [-s payload size] [-q qos] [-r rate] [-w window] [-a aliases] [-c chunk] [-H host]"
+                " [-p port] [-B]", name);
+}
+
+static int _bench_parse(int argc, char *argv[], bench_param_t *param)
+{
+    int opt;
+
+    memset(param, 0, sizeof(bench_param_t));
+    param->count = 10000;
+    param->size = 64;
+    param->window = 64;
+    param->port = 0;
+
+    while ((opt = getopt(argc, argv, "n:s:q:r:w:a:c:H:p:B")) != -1) {
+        switch (opt) {
+            case 'n':
+                param->count = strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                param->size = strtoul(optarg, NULL, 10);
+                break;
+            case 'q':
+                param->qos = atoi(optarg);
+                break;
+            case 'r':
+                param->rate = strtoul(optarg, NULL, 10);
+                break;
+            case 'w':
+                param->window = strtoul(optarg, NULL, 10);
+                break;
+            case 'a':
+                param->alias_max = (uint16_t)atoi(optarg);
+                break;
+            case 'c':
+                param->chunk_size = strtoul(optarg, NULL, 10);
+                break;
+            case 'H':
+                param->host = optarg;
+                break;
+            case 'p':
+                param->port = (uint16_t)atoi(optarg);
+                break;
+            case 'B':
+                param->broker_only = 1;
+                break;
+            default:
+                return -1;
+        }
+    }
+
+    if (param->count == 0 || param->size < BENCH_STAMP_LEN || param->qos < 0 || param->qos > 1 ||
+        param->window == 0 || (param->chunk_size > 0 && param->chunk_size < BENCH_STAMP_LEN) || (param->host != NULL && param->port == 0)) {
+        return -1;
+    }
+    return 0;
+}
+
+/* fork broker stand-in on localhost, its port is returned by @port */
+static pid_t _bench_broker_start(uint16_t *port)
+{
+    pid_t pid;
+    int fd = mqtt_bench_broker_listen(port);
+
+    if (fd < 0) {
+        BENCH_TRACE("listen on port %u failed", *port);
+        return -1;
+    }
+
+    pid = fork();
+    if (pid == 0) {
+        mqtt_bench_broker_run(fd);
+        _exit(1);
+    }
+    close(fd);
+
+    return pid;
+}
+
+static void _bench_report(const bench_param_t *param, bench_state_t *state, uint64_t elapsed_us, uint64_t cpu_us,
+                          long heap_allocs, uint32_t slab_allocs, const iotx_mqtt_stats_t *stats)
+{
+    uint32_t done = state->received;
+
+    BENCH_TRACE("qos %d, payload %u bytes, rate %u/s, window %u, topic aliases %u, stream piece %u", param->qos,
+                param->size, param->rate, param->window, param->alias_max, param->chunk_size);
+    BENCH_TRACE("sent %u, received %u, failed %u in %llu ms, %.0f msgs/sec", state->sent, done, state->pub_fail,
+                (unsigned long long)(elapsed_us / 1000), elapsed_us ? done * 1e6 / elapsed_us : 0.0);
+    if (done > 0) {
+        qsort(state->latency_us, done, sizeof(uint32_t), _bench_cmp_u32);
+        BENCH_TRACE("latency us: p50 %u, p99 %u, max %u", state->latency_us[done / 2],
+                    state->latency_us[(uint32_t)(done * 0.99)], state->latency_us[done - 1]);
+    }
+    if (state->sent > 0) {
+        /* blocks from MQTT slab never reach HAL_Malloc(), they are allocations all the same */
+        if (heap_allocs >= 0) {
+            BENCH_TRACE("per message: %.1f us cpu, %.2f allocations (%.2f from heap, %.2f from slab)",
+                        (double)cpu_us / state->sent, (double)(heap_allocs + slab_allocs) / state->sent,
+                        (double)heap_allocs / state->sent, (double)slab_allocs / state->sent);
+        } else {
+            BENCH_TRACE("per message: %.1f us cpu, %.2f allocations from slab, heap not counted",
+                        (double)cpu_us / state->sent, (double)slab_allocs / state->sent);
+        }
+    }
+    BENCH_TRACE("client: tx %llu bytes, rx %llu bytes in %u reads, %u republished, %u buffer allocations",
+                (unsigned long long)stats->tx_bytes, (unsigned long long)stats->rx_bytes, stats->rx_reads,
+                stats->republish_count, stats->tx_buf_allocs + stats->rx_buf_allocs);
+}
+
+static int _bench_run(const bench_param_t *param, void *pclient, bench_state_t *state)
+{
+    iotx_mqtt_topic_info_t topic_msg;
+    iotx_mqtt_stats_t stats;
+    uint8_t *payload = NULL;
+    uint64_t start_us, cpu_us, deadline_us;
+    long heap_allocs;
+    uint32_t slab_allocs;
+    int inflight = 0, window_size = 0;
+
+    payload = malloc(param->size);
+    if (payload == NULL) {
+        return -1;
+    }
+    memset(payload, 'x', param->size);
+    memset(&topic_msg, 0, sizeof(topic_msg));
+    topic_msg.qos = param->qos;
+    topic_msg.payload = (void *)payload;
+    topic_msg.payload_len = param->size;
+
+    IOT_MQTT_GetStats(pclient, &stats);
+    slab_allocs = stats.slab_allocs;
+    heap_allocs = BENCH_ALLOC_COUNT();
+    cpu_us = _bench_cpu_us();
+    start_us = _bench_now_us();
+    deadline_us = 0;
+
+    while (state->received < param->count) {
+        uint64_t now_us = _bench_now_us();
+
+        /* publish what rate and window allow, then read echoes */
+        while (state->sent < param->count && state->sent - state->received < param->window &&
+               (param->rate == 0 || (uint64_t)state->sent * 1000000 < (now_us - start_us) * param->rate + 1000000)) {
+            if (param->qos > 0 && IOT_MQTT_Get_Pub_Window(pclient, &inflight, &window_size) == 0 &&
+                inflight >= window_size) {
+                break;
+            }
+            memcpy(payload, &now_us, BENCH_STAMP_LEN);
+            if (IOT_MQTT_Publish(pclient, state->topic, &topic_msg) < 0) {
+                state->pub_fail++;
+                break;
+            }
+            state->sent++;
+            now_us = _bench_now_us();
+        }
+
+        IOT_MQTT_Yield(pclient, 1);
+
+        /* stop waiting for echoes lost, some seconds after all are sent */
+        if (state->sent == param->count) {
+            if (deadline_us == 0) {
+                deadline_us = _bench_now_us() + 5000000;
+            } else if (_bench_now_us() > deadline_us) {
+                break;
+            }
+        }
+        if (state->pub_fail > param->count) {
+            break;
+        }
+    }
+
+    start_us = _bench_now_us() - start_us;
+    cpu_us = _bench_cpu_us() - cpu_us;
+    heap_allocs = (heap_allocs >= 0) ? BENCH_ALLOC_COUNT() - heap_allocs : -1;
+    IOT_MQTT_GetStats(pclient, &stats);
+    slab_allocs = stats.slab_allocs - slab_allocs;
+    free(payload);
+
+    _bench_report(param, state, start_us, cpu_us, heap_allocs, slab_allocs, &stats);
+
+    return (state->received == param->count) ? 0 : -1;
+}
+
+int main(int argc, char *argv[])
+{
+    bench_param_t param;
+    bench_state_t state;
+    iotx_mqtt_param_t mqtt_params;
+    void *pclient = NULL;
+    pid_t broker = -1;
+    int res = -1;
+
+    if (_bench_parse(argc, argv, &param) < 0) {
+        _bench_usage(argv[0]);
+        return 1;
+    }
+
+    if (param.broker_only) {
+        int fd = mqtt_bench_broker_listen(&param.port);
+
+        if (fd < 0) {
+            BENCH_TRACE("listen on port %u failed", param.port);
+            return 1;
+        }
+        BENCH_TRACE("broker stand-in serving on 127.0.0.1:%u", param.port);
+        return mqtt_bench_broker_run(fd) == 0 ? 0 : 1;
+    }
+
+#ifdef SUPPORT_TLS
+    BENCH_TRACE("broker stand-in serves plain TCP, which a TLS build can only use with -H of another broker");
+#endif
+    if (param.host == NULL) {
+        broker = _bench_broker_start(&param.port);
+        if (broker < 0) {
+            return 1;
+        }
+        param.host = "127.0.0.1";
+    }
+
+    memset(&state, 0, sizeof(state));
+    snprintf(state.topic, sizeof(state.topic), "/bench/%d/data", (int)getpid());
+    state.latency_us = malloc(param.count * sizeof(uint32_t));
+    if (state.latency_us == NULL) {
+        goto EXIT;
+    }
+
+    memset(&mqtt_params, 0, sizeof(mqtt_params));
+    mqtt_params.host = param.host;
+    mqtt_params.port = param.port;
+    mqtt_params.clean_session = 1;
+    mqtt_params.request_timeout_ms = 2000;
+    mqtt_params.keepalive_interval_ms = 60000;
+    mqtt_params.read_buf_size = (param.chunk_size > 0) ? param.chunk_size + 256 : param.size + 256;
+    mqtt_params.write_buf_size = param.size + 256;
+
+    pclient = IOT_MQTT_Construct(&mqtt_params);
+    if (pclient == NULL) {
+        BENCH_TRACE("connect %s:%u failed", param.host, param.port);
+        goto EXIT;
+    }
+
+    if (param.alias_max > 0 && IOT_MQTT_Set_Topic_Alias(pclient, param.alias_max) < 0) {
+        BENCH_TRACE("topic alias %u not supported", param.alias_max);
+        goto EXIT;
+    }
+
+    if (param.chunk_size > 0 &&
+        IOT_MQTT_Set_Stream_Recv(pclient, param.chunk_size, _bench_stream_arrive, &state) < 0) {
+        BENCH_TRACE("stream receive not supported");
+        goto EXIT;
+    }
+
+    if (IOT_MQTT_Subscribe_Sync(pclient, state.topic, (iotx_mqtt_qos_t)param.qos, _bench_message_arrive, &state,
+                                2000) < 0) {
+        BENCH_TRACE("subscribe %s failed", state.topic);
+        goto EXIT;
+    }
+
+    res = _bench_run(&param, pclient, &state);
+
+EXIT:
+    if (pclient != NULL) {
+        IOT_MQTT_Destroy(&pclient);
+    }
+    free(state.latency_us);
+    if (broker > 0) {
+        kill(broker, SIGTERM);
+        waitpid(broker, NULL, 0);
+    }
+
+    return res == 0 ? 0 : 1;
+}
@@ -0,0 +1,498 @@
+/*
+ * Copyright (C) 2015-2018 Alibaba Group Holding Limited
+ */
+
+/*
+ * MQTT 3.1.1 broker stand-in which mqtt-bench runs on localhost, so that throughput and latency of MQTT client
+ * can be measured without cloud. It serves CONNECT, PUBLISH of QoS0/1, SUBSCRIBE, UNSUBSCRIBE, PINGREQ and
+ * DISCONNECT of plain TCP connections, and routes PUBLISH to every connection subscribing a matching filter.
+ * Topic alias of FEATURE_MQTT_TOPIC_ALIAS is understood, "$<alias>=<topic>" tells the alias of a connection and
+ * "$<alias>" names that topic later. There is no authentication, session, retained message or QoS2.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#define BENCH_BROKER_CONN_MAX           (16)
+#define BENCH_BROKER_SUB_MAX            (32)
+#define BENCH_BROKER_PACKET_MAX         (1024 * 1024)
+#define BENCH_BROKER_ALIAS_MAX          (1024)
+
+typedef struct {
+    char               *filter;
+    uint8_t             qos;
+} bench_sub_t;
+
+typedef struct {
+    int                 fd;
+    uint16_t            packet_id;
+    uint8_t            *in;
+    uint32_t            in_len;
+    uint32_t            in_size;
+    uint8_t            *out;
+    uint32_t            out_len;
+    uint32_t            out_size;
+    bench_sub_t         subs[BENCH_BROKER_SUB_MAX];
+    char               *aliases[BENCH_BROKER_ALIAS_MAX];
+} bench_conn_t;
+
+static bench_conn_t g_conns[BENCH_BROKER_CONN_MAX];
+
+static int _buf_reserve(uint8_t **buf, uint32_t *size, uint32_t need)
+{
+    uint8_t *grown = NULL;
+    uint32_t new_size = *size ? *size : 4096;
+
+    if (need <= *size) {
+        return 0;
+    }
+    while (new_size < need) {
+        new_size *= 2;
+    }
+    grown = realloc(*buf, new_size);
+    if (grown == NULL) {
+        return -1;
+    }
+    *buf = grown;
+    *size = new_size;
+    return 0;
+}
+
+static int _conn_write(bench_conn_t *conn, const uint8_t *data, uint32_t len)
+{
+    if (_buf_reserve(&conn->out, &conn->out_size, conn->out_len + len) < 0) {
+        return -1;
+    }
+    memcpy(conn->out + conn->out_len, data, len);
+    conn->out_len += len;
+    return 0;
+}
+
+/* fixed header of @type and @remain bytes following it */
+static int _conn_write_header(bench_conn_t *conn, uint8_t type, uint32_t remain)
+{
+    uint8_t header[5];
+    uint32_t len = 0;
+
+    header[len++] = type;
+    do {
+        header[len] = remain % 128;
+        remain /= 128;
+        if (remain > 0) {
+            header[len] |= 0x80;
+        }
+        len++;
+    } while (remain > 0);
+
+    return _conn_write(conn, header, len);
+}
+
+static int _conn_write_ack(bench_conn_t *conn, uint8_t type, const uint8_t *packet_id)
+{
+    if (_conn_write_header(conn, type, 2) < 0) {
+        return -1;
+    }
+    return _conn_write(conn, packet_id, 2);
+}
+
+static void _conn_close(bench_conn_t *conn)
+{
+    int idx;
+
+    close(conn->fd);
+    for (idx = 0; idx < BENCH_BROKER_SUB_MAX; idx++) {
+        free(conn->subs[idx].filter);
+    }
+    for (idx = 0; idx < BENCH_BROKER_ALIAS_MAX; idx++) {
+        free(conn->aliases[idx]);
+    }
+    free(conn->in);
+    free(conn->out);
+    memset(conn, 0, sizeof(bench_conn_t));
+    conn->fd = -1;
+}
+
+static int _topic_match(const char *filter, const char *topic, uint32_t topic_len)
+{
+    const char *end = topic + topic_len;
+
+    while (*filter != '\0') {
+        if (*filter == '#') {
+            return 1;
+        }
+        if (*filter == '+') {
+            while (topic < end && *topic != '/') {
+                topic++;
+            }
+            filter++;
+            continue;
+        }
+        if (topic >= end || *filter != *topic) {
+            /* "a/#" also matches "a" */
+            return (topic >= end && filter[0] == '/' && filter[1] == '#' && filter[2] == '\0');
+        }
+        filter++;
+        topic++;
+    }
+
+    return topic == end;
+}
+
+static int _conn_publish(bench_conn_t *conn, const char *topic, uint16_t topic_len, const uint8_t *payload,
+                         uint32_t payload_len, uint8_t qos)
+{
+    uint8_t packet_id[2];
+    uint8_t len[2];
+
+    len[0] = topic_len >> 8;
+    len[1] = topic_len & 0xFF;
+    if (_conn_write_header(conn, 0x30 | (qos << 1), 2 + topic_len + (qos ? 2 : 0) + payload_len) < 0 ||
+        _conn_write(conn, len, 2) < 0 || _conn_write(conn, (const uint8_t *)topic, topic_len) < 0) {
+        return -1;
+    }
+    if (qos > 0) {
+        if (++conn->packet_id == 0) {
+            conn->packet_id = 1;
+        }
+        packet_id[0] = conn->packet_id >> 8;
+        packet_id[1] = conn->packet_id & 0xFF;
+        if (_conn_write(conn, packet_id, 2) < 0) {
+            return -1;
+        }
+    }
+    return _conn_write(conn, payload, payload_len);
+}
+
+/* topic named by "$<alias>" or "$<alias>=<topic>" in @topic, the latter tells the alias, NULL if unknown */
+static const char *_topic_alias(bench_conn_t *conn, const char *topic, uint16_t *topic_len)
+{
+    uint32_t alias = 0;
+    uint16_t pos = 1;
+
+    while (pos < *topic_len && topic[pos] >= '0' && topic[pos] <= '9' && alias <= BENCH_BROKER_ALIAS_MAX) {
+        alias = alias * 10 + (topic[pos++] - '0');
+    }
+    if (pos == 1 || alias == 0 || alias > BENCH_BROKER_ALIAS_MAX) {
+        return NULL;
+    }
+
+    if (pos < *topic_len && topic[pos] == '=') {
+        free(conn->aliases[alias - 1]);
+        conn->aliases[alias - 1] = malloc(*topic_len - pos);
+        if (conn->aliases[alias - 1] == NULL) {
+            return NULL;
+        }
+        memcpy(conn->aliases[alias - 1], topic + pos + 1, *topic_len - pos - 1);
+        conn->aliases[alias - 1][*topic_len - pos - 1] = '\0';
+    } else if (pos != *topic_len) {
+        return NULL;
+    }
+
+    if (conn->aliases[alias - 1] != NULL) {
+        *topic_len = strlen(conn->aliases[alias - 1]);
+    }
+    return conn->aliases[alias - 1];
+}
+
+static int _handle_publish(bench_conn_t *conn, uint8_t flags, const uint8_t *body, uint32_t len)
+{
+    uint8_t qos = (flags >> 1) & 0x03;
+    const char *topic = (const char *)body + 2;
+    uint16_t topic_len;
+    uint32_t off;
+    int idx, sub;
+
+    if (len < 2 || qos > 1) {
+        return -1;
+    }
+    topic_len = (body[0] << 8) | body[1];
+    off = 2 + topic_len + (qos ? 2 : 0);
+    if (off > len) {
+        return -1;
+    }
+    if (qos > 0 && _conn_write_ack(conn, 0x40, body + 2 + topic_len) < 0) {
+        return -1;
+    }
+    if (topic_len > 0 && topic[0] == '$' && (topic = _topic_alias(conn, topic, &topic_len)) == NULL) {
+        /* alias never told on this connection */
+        return -1;
+    }
+
+    for (idx = 0; idx < BENCH_BROKER_CONN_MAX; idx++) {
+        int granted = -1;
+
+        if (g_conns[idx].fd < 0) {
+            continue;
+        }
+        for (sub = 0; sub < BENCH_BROKER_SUB_MAX; sub++) {
+            bench_sub_t *s = &g_conns[idx].subs[sub];
+
+            if (s->filter != NULL && s->qos > granted && _topic_match(s->filter, topic, topic_len)) {
+                granted = s->qos;
+            }
+        }
+        if (granted >= 0 &&
+            _conn_publish(&g_conns[idx], topic, topic_len, body + off, len - off, qos < granted ? qos : granted) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static void _sub_del(bench_conn_t *conn, const uint8_t *filter, uint16_t len)
+{
+    int idx;
+
+    for (idx = 0; idx < BENCH_BROKER_SUB_MAX; idx++) {
+        if (conn->subs[idx].filter != NULL && strlen(conn->subs[idx].filter) == len &&
+            memcmp(conn->subs[idx].filter, filter, len) == 0) {
+            free(conn->subs[idx].filter);
+            conn->subs[idx].filter = NULL;
+        }
+    }
+}
+
+static int _sub_add(bench_conn_t *conn, const uint8_t *filter, uint16_t len, uint8_t qos)
+{
+    int idx;
+
+    _sub_del(conn, filter, len);
+    for (idx = 0; idx < BENCH_BROKER_SUB_MAX; idx++) {
+        if (conn->subs[idx].filter == NULL) {
+            conn->subs[idx].filter = malloc(len + 1);
+            if (conn->subs[idx].filter == NULL) {
+                return -1;
+            }
+            memcpy(conn->subs[idx].filter, filter, len);
+            conn->subs[idx].filter[len] = '\0';
+            conn->subs[idx].qos = qos;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/* SUBSCRIBE when @subscribe, or UNSUBSCRIBE */
+static int _handle_subscribe(bench_conn_t *conn, const uint8_t *body, uint32_t len, int subscribe)
+{
+    uint8_t granted[BENCH_BROKER_SUB_MAX];
+    uint32_t count = 0, off = 2;
+    uint16_t filter_len;
+
+    if (len < 2) {
+        return -1;
+    }
+    while (off + 2 <= len) {
+        filter_len = (body[off] << 8) | body[off + 1];
+        if (off + 2 + filter_len + (subscribe ? 1 : 0) > len) {
+            return -1;
+        }
+        if (subscribe) {
+            uint8_t qos = body[off + 2 + filter_len] > 1 ? 1 : body[off + 2 + filter_len];
+
+            granted[count % BENCH_BROKER_SUB_MAX] = _sub_add(conn, body + off + 2, filter_len, qos) < 0 ? 0x80 : qos;
+            off += 2 + filter_len + 1;
+        } else {
+            _sub_del(conn, body + off + 2, filter_len);
+            off += 2 + filter_len;
+        }
+        count++;
+    }
+
+    if (!subscribe) {
+        return _conn_write_ack(conn, 0xB0, body);
+    }
+    if (count > BENCH_BROKER_SUB_MAX) {
+        return -1;
+    }
+    if (_conn_write_header(conn, 0x90, 2 + count) < 0 || _conn_write(conn, body, 2) < 0) {
+        return -1;
+    }
+    return _conn_write(conn, granted, count);
+}
+
+static int _handle_packet(bench_conn_t *conn, uint8_t header, const uint8_t *body, uint32_t len)
+{
+    static const uint8_t connack[] = {0x20, 0x02, 0x00, 0x00};
+    static const uint8_t pingresp[] = {0xD0, 0x00};
+
+    switch (header >> 4) {
+        case 1:
+            return _conn_write(conn, connack, sizeof(connack));
+        case 3:
+            return _handle_publish(conn, header & 0x0F, body, len);
+        case 4:
+            /* PUBACK of PUBLISH routed to client, nothing is kept for it */
+            return 0;
+        case 8:
+            return _handle_subscribe(conn, body, len, 1);
+        case 10:
+            return _handle_subscribe(conn, body, len, 0);
+        case 12:
+            return _conn_write(conn, pingresp, sizeof(pingresp));
+        default:
+            /* DISCONNECT and what is not served */
+            return -1;
+    }
+}
+
+/* handle all complete packets in input buffer */
+static int _conn_parse(bench_conn_t *conn)
+{
+    uint32_t pos = 0;
+
+    while (pos + 2 <= conn->in_len) {
+        uint32_t remain = 0, mult = 1, off = pos + 1;
+
+        do {
+            if (off >= conn->in_len) {
+                goto WAIT_MORE;
+            }
+            remain += (conn->in[off] & 0x7F) * mult;
+            mult *= 128;
+        } while ((conn->in[off++] & 0x80) && mult <= 128 * 128 * 128);
+        if (remain > BENCH_BROKER_PACKET_MAX) {
+            return -1;
+        }
+        if (off + remain > conn->in_len) {
+            break;
+        }
+        if (_handle_packet(conn, conn->in[pos], conn->in + off, remain) < 0) {
+            return -1;
+        }
+        pos = off + remain;
+    }
+
+WAIT_MORE:
+    memmove(conn->in, conn->in + pos, conn->in_len - pos);
+    conn->in_len -= pos;
+    return 0;
+}
+
+static int _conn_read(bench_conn_t *conn)
+{
+    ssize_t len;
+
+    if (_buf_reserve(&conn->in, &conn->in_size, conn->in_len + 4096) < 0) {
+        return -1;
+    }
+    len = recv(conn->fd, conn->in + conn->in_len, conn->in_size - conn->in_len, 0);
+    if (len <= 0) {
+        return (len < 0 && (errno == EAGAIN || errno == EINTR)) ? 0 : -1;
+    }
+    conn->in_len += len;
+
+    return _conn_parse(conn);
+}
+
+static int _conn_flush(bench_conn_t *conn)
+{
+    ssize_t len;
+
+    while (conn->out_len > 0) {
+        len = send(conn->fd, conn->out, conn->out_len, MSG_NOSIGNAL);
+        if (len < 0) {
+            return (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+        }
+        memmove(conn->out, conn->out + len, conn->out_len - len);
+        conn->out_len -= len;
+    }
+
+    return 0;
+}
+
+/* listen on 127.0.0.1:@port, the port given by system is returned by @port when it is 0 */
+int mqtt_bench_broker_listen(uint16_t *port)
+{
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    int fd, opt = 1;
+
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(*port);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, BENCH_BROKER_CONN_MAX) < 0 ||
+        getsockname(fd, (struct sockaddr *)&addr, &addr_len) < 0) {
+        close(fd);
+        return -1;
+    }
+    *port = ntohs(addr.sin_port);
+
+    return fd;
+}
+
+/* serve connections accepted on @listen_fd, never returns unless polling fails */
+int mqtt_bench_broker_run(int listen_fd)
+{
+    struct pollfd fds[BENCH_BROKER_CONN_MAX + 1];
+    int idx, opt = 1;
+
+    for (idx = 0; idx < BENCH_BROKER_CONN_MAX; idx++) {
+        g_conns[idx].fd = -1;
+    }
+
+    for (;;) {
+        fds[0].fd = listen_fd;
+        fds[0].events = POLLIN;
+        for (idx = 0; idx < BENCH_BROKER_CONN_MAX; idx++) {
+            fds[idx + 1].fd = g_conns[idx].fd;
+            fds[idx + 1].events = POLLIN | (g_conns[idx].out_len > 0 ? POLLOUT : 0);
+            fds[idx + 1].revents = 0;
+        }
+        if (poll(fds, BENCH_BROKER_CONN_MAX + 1, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int fd = accept(listen_fd, NULL, NULL);
+
+            for (idx = 0; fd >= 0 && idx < BENCH_BROKER_CONN_MAX; idx++) {
+                if (g_conns[idx].fd < 0) {
+                    g_conns[idx].fd = fd;
+                    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+                    fd = -1;
+                }
+            }
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+
+        for (idx = 0; idx < BENCH_BROKER_CONN_MAX; idx++) {
+            if (g_conns[idx].fd < 0 || fds[idx + 1].fd != g_conns[idx].fd) {
+                continue;
+            }
+            if ((fds[idx + 1].revents & (POLLIN | POLLHUP | POLLERR)) && _conn_read(&g_conns[idx]) < 0) {
+                _conn_close(&g_conns[idx]);
+            }
+        }
+        /* PUBLISH read from one connection may be routed to any other */
+        for (idx = 0; idx < BENCH_BROKER_CONN_MAX; idx++) {
+            if (g_conns[idx].fd >= 0 && _conn_flush(&g_conns[idx]) < 0) {
+                _conn_close(&g_conns[idx]);
+            }
+        }
+    }
+}
@@ -73,13 +73,13 @@ typedef union {
     unsigned char all;  /**< all connack flags */
 #if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
     struct {
-        unsigned int sessionpresent : 1;    /**< session present flag */
-        unsigned int : 7;                 /**< unused */
+        unsigned int : 7;                   /**< unused */
+        unsigned int sessionpresent : 1;    /**< session present flag, bit 0 */
     } bits;
 #else
     struct {
-        unsigned int : 7;                   /**< unused */
-        unsigned int sessionpresent : 1;    /**< session present flag */
+        unsigned int sessionpresent : 1;    /**< session present flag, bit 0 */
+        unsigned int : 7;                 /**< unused */
     } bits;
 #endif
 } MQTTConnackFlags; /**< connack flags byte */
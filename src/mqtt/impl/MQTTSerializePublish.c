@@ -77,6 +77,44 @@ exit:
 }
 
 
+/**
+  * Serializes the part of publish packet in front of topic name into the supplied buffer, so topic name,
+  * packet identifier and payload can be sent from where they are
+  * @param buf the buffer into which the header will be serialized
+  * @param buflen the length in bytes of the supplied buffer
+  * @param dup integer - the MQTT dup flag
+  * @param qos integer - the MQTT QoS value
+  * @param retained integer - the MQTT retained flag
+  * @param topicName MQTTString - the MQTT topic in the publish
+  * @param payloadlen integer - the length of the MQTT payload
+  * @return the length of the serialized header.  <= 0 indicates error
+  */
+int MQTTSerialize_publishHeader(unsigned char *buf, int buflen, unsigned char dup, int qos, unsigned char retained,
+                                MQTTString topicName, int payloadlen)
+{
+    unsigned char *ptr = buf;
+    MQTTHeader header = {0};
+    int rem_len = MQTTSerialize_publishLength(qos, topicName, payloadlen);
+
+    /* fixed header, remaining length and the 2 bytes length of topic name */
+    if (MQTTPacket_len(rem_len) - rem_len + 2 > buflen) {
+        return MQTTPACKET_BUFFER_TOO_SHORT;
+    }
+
+    MQTT_HEADER_SET_TYPE(header.byte, PUBLISH);
+    MQTT_HEADER_SET_DUP(header.byte, dup);
+    MQTT_HEADER_SET_QOS(header.byte, qos);
+    MQTT_HEADER_SET_RETAIN(header.byte, retained);
+    writeChar(&ptr, header.byte); /* write header */
+
+    ptr += MQTTPacket_encode(ptr, rem_len); /* write remaining length */
+
+    writeInt(&ptr, MQTTstrlen(topicName));
+
+    return ptr - buf;
+}
+
+
 
 /**
   * Serializes the ack packet into the supplied buffer.
@@ -12,10 +12,18 @@ static int _in_yield_cb;
 iotx_mc_client_t g_iotx_mc_client[IOTX_MC_CLIENT_MAX_COUNT] = {0};
 #endif
 
+#define IOTX_MC_PUB_WINDOW_IDX(id)      ((id) & (IOTX_MC_PUB_WINDOW_SIZE - 1))
+#define IOTX_MC_TIME_LEFT_NONE          (0xFFFFFFFF)    /* no timed work pending */
+
 static void iotx_mc_release(iotx_mc_client_t *pclient)
 {
 #ifdef PLATFORM_HAS_DYNMEM
-    mqtt_free(pclient);
+    if (pclient != NULL) {
+        mqtt_free(pclient);
+    }
+#if WITH_MQTT_SLAB && !defined(INFRA_MEM_STATS)
+    iotx_mc_slab_deinit();
+#endif
 #else
     memset(pclient, 0, sizeof(iotx_mc_client_t));
 #endif
@@ -25,7 +33,9 @@ static void iotx_mc_release(iotx_mc_client_t *pclient)
 static void iotx_mc_pub_wait_list_init(iotx_mc_client_t *pClient)
 {
 #ifdef PLATFORM_HAS_DYNMEM
-    INIT_LIST_HEAD(&pClient->list_pub_wait_ack);
+    memset(pClient->pub_heap, 0, sizeof(pClient->pub_heap));
+    memset(pClient->pub_window, 0, sizeof(pClient->pub_window));
+    pClient->pub_inflight = 0;
 #else
     memset(pClient->list_pub_wait_ack, 0, sizeof(iotx_mc_pub_info_t) * IOTX_MC_PUBWAIT_LIST_MAX_LEN);
 #endif
@@ -34,11 +44,14 @@ static void iotx_mc_pub_wait_list_init(iotx_mc_client_t *pClient)
 static void iotx_mc_pub_wait_list_deinit(iotx_mc_client_t *pClient)
 {
 #ifdef PLATFORM_HAS_DYNMEM
-    iotx_mc_pub_info_t *node = NULL, *next_node = NULL;
-    list_for_each_entry_safe(node, next_node, &pClient->list_pub_wait_ack, linked_list, iotx_mc_pub_info_t) {
-        list_del(&node->linked_list);
-        mqtt_free(node);
+    uint32_t idx;
+
+    for (idx = 0; idx < pClient->pub_inflight; idx++) {
+        mqtt_free(pClient->pub_heap[idx]);
     }
+    memset(pClient->pub_heap, 0, sizeof(pClient->pub_heap));
+    memset(pClient->pub_window, 0, sizeof(pClient->pub_window));
+    pClient->pub_inflight = 0;
 #else
     memset(pClient->list_pub_wait_ack, 0, sizeof(iotx_mc_pub_info_t) * IOTX_MC_PUBWAIT_LIST_MAX_LEN);
 #endif
@@ -94,21 +107,89 @@ static int iotx_mc_set_connect_params(iotx_mc_client_t *pClient, MQTTPacket_conn
 /* set state of MQTT client */
 static void iotx_mc_set_client_state(iotx_mc_client_t *pClient, iotx_mc_state_t newState)
 {
+#if WITH_MQTT_ATOMIC
+    IOTX_MC_ATOMIC_STORE(&pClient->client_state, newState);
+#else
     HAL_MutexLock(pClient->lock_generic);
     pClient->client_state = newState;
     HAL_MutexUnlock(pClient->lock_generic);
+#endif
 }
 
 static iotx_mc_state_t iotx_mc_get_client_state(iotx_mc_client_t *pClient)
 {
     iotx_mc_state_t state;
+#if WITH_MQTT_ATOMIC
+    state = IOTX_MC_ATOMIC_LOAD(&pClient->client_state);
+#else
     HAL_MutexLock(pClient->lock_generic);
     state = pClient->client_state;
     HAL_MutexUnlock(pClient->lock_generic);
+#endif
 
     return state;
 }
 
+/* default policy of each reconnect class, which are used by fields left 0 in user policy */
+static void iotx_mc_backoff_set_policy(iotx_mc_client_t *pClient, const iotx_mqtt_backoff_policy_t *policy)
+{
+    static const iotx_mqtt_backoff_policy_t policy_default[IOTX_MQTT_RECONNECT_CLASS_MAX] = {
+        {IOTX_MC_RECONNECT_INTERVAL_MIN_MS, IOTX_MC_RECONNECT_INTERVAL_MAX_MS},
+        {IOTX_MC_RECONNECT_UNAVAILABLE_MIN_MS, IOTX_MC_RECONNECT_UNAVAILABLE_MAX_MS},
+        {IOTX_MC_RECONNECT_REJECTED_MIN_MS, IOTX_MC_RECONNECT_REJECTED_MAX_MS}
+    };
+    iotx_mqtt_backoff_policy_t *dst = NULL;
+    int idx;
+
+    for (idx = 0; idx < IOTX_MQTT_RECONNECT_CLASS_MAX; idx++) {
+        dst = &pClient->reconnect_param.policy[idx];
+        dst->base_ms = (policy && policy[idx].base_ms) ? policy[idx].base_ms : policy_default[idx].base_ms;
+        dst->cap_ms = (policy && policy[idx].cap_ms) ? policy[idx].cap_ms : policy_default[idx].cap_ms;
+        if (dst->cap_ms < dst->base_ms) {
+            dst->cap_ms = dst->base_ms;
+        }
+    }
+}
+
+/* keepalive parameter with fields left 0 as default, probing learned so far is dropped */
+static void iotx_mc_keepalive_set_param(iotx_mc_client_t *pClient, const iotx_mqtt_keepalive_param_t *param)
+{
+    uint32_t interval_ms = pClient->connect_data.keepAliveInterval * 1000;
+    uint32_t limit_ms = interval_ms * 2;
+
+    /* server drops the link after 1.5 times of keepalive in CONNECT, which is twice of the interval */
+    if (limit_ms > CONFIG_MQTT_KEEPALIVE_INTERVAL_MAX * 1000) {
+        limit_ms = CONFIG_MQTT_KEEPALIVE_INTERVAL_MAX * 1000;
+    }
+
+    pClient->keepalive_probe_max = (param && param->probe_max) ? param->probe_max : IOTX_MC_KEEPALIVE_PROBE_MAX;
+    pClient->keepalive_min_ms = (param && param->min_ms) ? param->min_ms : interval_ms;
+    pClient->keepalive_max_ms = (param && param->max_ms) ? param->max_ms : pClient->keepalive_min_ms;
+    pClient->keepalive_step_ms = (param && param->step_ms) ? param->step_ms : IOTX_MC_KEEPALIVE_STEP_MS;
+    if (pClient->keepalive_max_ms > limit_ms) {
+        pClient->keepalive_max_ms = limit_ms;
+    }
+    if (pClient->keepalive_min_ms > pClient->keepalive_max_ms) {
+        pClient->keepalive_min_ms = pClient->keepalive_max_ms;
+    }
+
+    pClient->keepalive_ms = pClient->keepalive_min_ms;
+    pClient->keepalive_good_ms = 0;
+    pClient->keepalive_bad_ms = 0;
+    pClient->keepalive_idle_ping = 0;
+    IOTX_MC_STATS_SET(pClient, keepalive_ms, pClient->keepalive_ms);
+}
+
+/* a packet goes through the link, which wakes radio up if nothing went for the radio tail */
+static void iotx_mc_link_active(iotx_mc_client_t *pClient, iotx_time_t *last)
+{
+    if (utils_time_spend(&pClient->last_tx_time) >= IOTX_MC_RADIO_TAIL_MS &&
+        utils_time_spend(&pClient->last_rx_time) >= IOTX_MC_RADIO_TAIL_MS) {
+        IOTX_MC_STATS_ADD(pClient, radio_wakeups, 1);
+    }
+    iotx_time_start(last);
+}
+
 /* Initialize MQTT client */
 static int iotx_mc_init(iotx_mc_client_t *pClient, iotx_mqtt_param_t *pInitParams)
 {
@@ -140,10 +221,12 @@ static int iotx_mc_init(iotx_mc_client_t *pClient, iotx_mqtt_param_t *pInitParam
         goto RETURN;
     }
 
-    pClient->lock_read_buf = HAL_MutexCreate();
-    if (!pClient->lock_read_buf) {
+#ifdef MQTT_OFFLINE_QUEUE
+    pClient->lock_offline = HAL_MutexCreate();
+    if (!pClient->lock_offline) {
         goto RETURN;
     }
+#endif
 
     connectdata.MQTTVersion = IOTX_MC_MQTT_VERSION;
     connectdata.keepAliveInterval = pInitParams->keepalive_interval_ms / 1000;
@@ -198,6 +281,12 @@ static int iotx_mc_init(iotx_mc_client_t *pClient, iotx_mqtt_param_t *pInitParam
 #ifdef PLATFORM_HAS_DYNMEM
     INIT_LIST_HEAD(&pClient->list_sub_handle);
     INIT_LIST_HEAD(&pClient->list_sub_sync_ack);
+#if WITH_MQTT_TOPIC_TRIE
+    iotx_mc_trie_init(&pClient->topic_trie);
+#endif
+#ifdef MQTT_FAST_RECONNECT
+    INIT_LIST_HEAD(&pClient->list_sub_replay);
+#endif
 #endif
     /* Initialize MQTT connect parameter */
     rc = iotx_mc_set_connect_params(pClient, &connectdata);
@@ -206,9 +295,24 @@ static int iotx_mc_init(iotx_mc_client_t *pClient, iotx_mqtt_param_t *pInitParam
         goto RETURN;
     }
 
+    iotx_mc_keepalive_set_param(pClient, NULL);
     iotx_time_init(&pClient->next_ping_time);
     iotx_time_init(&pClient->reconnect_param.reconnect_next_time);
 
+    /* seed differs between devices and boots, so that their jitter does */
+    iotx_mc_backoff_set_policy(pClient, NULL);
+    pClient->reconnect_param.seed = HAL_UptimeMs() ^ (uint32_t)(uintptr_t)pClient;
+    if (pClient->connect_data.clientID.cstring != NULL) {
+        const char *id = pClient->connect_data.clientID.cstring;
+
+        while (*id != '\0') {
+            pClient->reconnect_param.seed = pClient->reconnect_param.seed * 31 + (uint8_t)*id++;
+        }
+    }
+    if (pClient->reconnect_param.seed == 0) {
+        pClient->reconnect_param.seed = 1;
+    }
+
     memset(&pClient->ipstack, 0, sizeof(utils_network_t));
     rc = iotx_net_init(&pClient->ipstack, pInitParams->host, pInitParams->port, pInitParams->pub_key);
 
@@ -242,14 +346,16 @@ RETURN :
             HAL_MutexDestroy(pClient->lock_write_buf);
             pClient->lock_write_buf = NULL;
         }
-        if (pClient->lock_read_buf) {
-            HAL_MutexDestroy(pClient->lock_read_buf);
-            pClient->lock_read_buf = NULL;
-        }
         if (pClient->lock_yield) {
             HAL_MutexDestroy(pClient->lock_yield);
             pClient->lock_yield = NULL;
         }
+#ifdef MQTT_OFFLINE_QUEUE
+        if (pClient->lock_offline) {
+            HAL_MutexDestroy(pClient->lock_offline);
+            pClient->lock_offline = NULL;
+        }
+#endif
     }
 
     return rc;
@@ -295,23 +401,109 @@ static int _reset_send_buffer(iotx_mc_client_t *c)
 #endif
 }
 
+/* drop @len bytes from the head of receive buffer, bytes after them are moved to the head */
+static void _drop_recv_bytes(iotx_mc_client_t *c, uint32_t len)
+{
+    c->rx_len -= len;
+    if (c->rx_len > 0) {
+        memmove(c->buf_read, c->buf_read + len, c->rx_len);
+    }
+}
+
+/* drop bytes of the packet which is too long for receive buffer, as many as have been received */
+static void _skip_recv_bytes(iotx_mc_client_t *c)
+{
+    uint32_t len = (c->rx_skip < c->rx_len) ? c->rx_skip : c->rx_len;
+
+    _drop_recv_bytes(c, len);
+    c->rx_skip -= len;
+}
+
+/* release the packet handled last time, packets received behind it are kept */
 static int _reset_recv_buffer(iotx_mc_client_t *c)
 {
-#ifdef PLATFORM_HAS_DYNMEM
-#if  WITH_MQTT_DYN_BUF
-    if (c == NULL || c->buf_read == NULL) {
+    if (c == NULL) {
         return FAIL_RETURN;
     }
 
-    mqtt_free(c->buf_read);
-    c->buf_read = NULL;
-    c->buf_size_read = 0;
-    return 0;
-#else
-    return 0;
+    if (c->rx_packet_len > 0) {
+        if (c->rx_packet_len < c->buf_size_read) {
+            c->buf_read[c->rx_packet_len] = c->rx_saved;
+        }
+        _drop_recv_bytes(c, c->rx_packet_len);
+        c->rx_packet_len = 0;
+    }
+
+#ifdef PLATFORM_HAS_DYNMEM
+#if  WITH_MQTT_DYN_BUF
+    if (c->rx_len == 0 && c->buf_read != NULL) {
+        mqtt_free(c->buf_read);
+        c->buf_read = NULL;
+        c->buf_size_read = 0;
+    }
+#endif
 #endif
-#else
     return 0;
+}
+
+#ifdef MQTT_STREAM_RECV
+/* pass @len bytes behind header of the PUBLISH being streamed to stream handler */
+static void iotx_mc_stream_call(iotx_mc_client_t *c, uint32_t len, uint8_t aborted)
+{
+    iotx_mqtt_stream_chunk_t chunk;
+    MQTTHeader header = {0};
+    uint32_t pos = 1;
+
+    if (c->stream_handle == NULL) {
+        return;
+    }
+
+    /* header has been checked by iotx_mc_stream_start(), skip remaining length to topic name */
+    while (c->buf_read[pos++] & 0x80) {
+    }
+    header.byte = c->buf_read[0];
+
+    memset(&chunk, 0, sizeof(chunk));
+    chunk.topic_len = ((uint8_t)c->buf_read[pos] << 8) | (uint8_t)c->buf_read[pos + 1];
+    chunk.ptopic = c->buf_read + pos + 2;
+    chunk.qos = MQTT_HEADER_GET_QOS(header.byte);
+    chunk.retain = MQTT_HEADER_GET_RETAIN(header.byte);
+    if (chunk.qos > IOTX_MQTT_QOS0) {
+        pos += 2 + chunk.topic_len;
+        chunk.packet_id = ((uint8_t)c->buf_read[pos] << 8) | (uint8_t)c->buf_read[pos + 1];
+    }
+    chunk.aborted = aborted;
+    chunk.total_len = c->rx_stream_offset + c->rx_stream_left;
+    chunk.offset = c->rx_stream_offset;
+    chunk.chunk = c->buf_read + c->rx_stream_hdr;
+    chunk.chunk_len = len;
+
+    _in_yield_cb = 1;
+    c->stream_handle(c->stream_context, c, &chunk);
+    _in_yield_cb = 0;
+}
+#endif
+
+/* discard everything received, used when the connection is broken or established again */
+static void _clear_recv_buffer(iotx_mc_client_t *c)
+{
+#ifdef MQTT_STREAM_RECV
+    if (c->rx_stream_hdr > 0) {
+        iotx_mc_stream_call(c, 0, 1);
+        c->rx_stream_hdr = 0;
+    }
+#endif
+    c->rx_len = 0;
+    c->rx_packet_len = 0;
+    c->rx_skip = 0;
+#ifdef PLATFORM_HAS_DYNMEM
+#if  WITH_MQTT_DYN_BUF
+    if (c->buf_read != NULL) {
+        mqtt_free(c->buf_read);
+        c->buf_read = NULL;
+        c->buf_size_read = 0;
+    }
+#endif
 #endif
 }
 
@@ -339,6 +531,7 @@ static int _alloc_send_buffer(iotx_mc_client_t *c, int len)
     }
     memset(c->buf_send, 0, tmp_len);
     c->buf_size_send = tmp_len;
+    IOTX_MC_STATS_ADD(c, tx_buf_allocs, 1);
     return SUCCESS_RETURN;
 #else
     return 0;
@@ -348,10 +541,9 @@ static int _alloc_send_buffer(iotx_mc_client_t *c, int len)
 #endif
 }
 
+#if defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_DYN_BUF
 static int _alloc_recv_buffer(iotx_mc_client_t *c, int len)
 {
-#ifdef PLATFORM_HAS_DYNMEM
-#if  WITH_MQTT_DYN_BUF
     int tmp_len;
 
     if (c == NULL) {
@@ -381,12 +573,32 @@ static int _alloc_recv_buffer(iotx_mc_client_t *c, int len)
         memset(c->buf_read, 0, tmp_len);
     }
     c->buf_size_read = tmp_len;
+    IOTX_MC_STATS_ADD(c, rx_buf_allocs, 1);
     return SUCCESS_RETURN;
+}
+#endif
+
+/* the longest packet receive buffer can hold */
+static uint32_t _recv_buffer_capacity(iotx_mc_client_t *c)
+{
+#if defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_DYN_BUF
+    return c->buf_size_read_max;
 #else
-    return 0;
+    return c->buf_size_read;
 #endif
+}
+
+/* make sure receive buffer holds at least @len bytes, grown buffer also leaves room to read ahead */
+static int _prepare_recv_buffer(iotx_mc_client_t *c, uint32_t len)
+{
+#if defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_DYN_BUF
+    if (c->buf_read != NULL && c->buf_size_read >= len) {
+        return SUCCESS_RETURN;
+    }
+
+    return _alloc_recv_buffer(c, len + IOTX_MC_RX_READAHEAD_LEN);
 #else
-    return 0;
+    return SUCCESS_RETURN;
 #endif
 }
 
@@ -408,6 +620,8 @@ static int iotx_mc_send_packet(iotx_mc_client_t *c, char *buf, int length, iotx_
             break;
         }
         sent += rc;
+        IOTX_MC_STATS_ADD(c, tx_bytes, rc);
+        iotx_mc_link_active(c, &c->last_tx_time);
     }
 
     if (sent == length) {
@@ -418,6 +632,54 @@ static int iotx_mc_send_packet(iotx_mc_client_t *c, char *buf, int length, iotx_
     return rc;
 }
 
+#if defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_VECTORED_PUB
+/* send segments of one packet in order, @iov is consumed as data being sent */
+static int iotx_mc_send_packet_vec(iotx_mc_client_t *c, hal_iovec_t *iov, int iovcnt, iotx_time_t *time)
+{
+    int rc = FAIL_RETURN;
+    int idx = 0;
+    unsigned int left_t = 0;
+
+    if (!c || !iov || !time) {
+        return rc;
+    }
+
+    if (c->ipstack.writev == NULL) {
+        for (idx = 0; idx < iovcnt; idx++) {
+            rc = iotx_mc_send_packet(c, (char *)iov[idx].base, iov[idx].len, time);
+            if (rc != SUCCESS_RETURN) {
+                return rc;
+            }
+        }
+        return SUCCESS_RETURN;
+    }
+
+    while (iovcnt > 0 && !utils_time_is_expired(time)) {
+        left_t = iotx_time_left(time);
+        left_t = (left_t == 0) ? 1 : left_t;
+        rc = c->ipstack.writev(&c->ipstack, iov, iovcnt, left_t);
+        if (rc < 0) { /* there was an error writing the data */
+            break;
+        }
+        IOTX_MC_STATS_ADD(c, tx_bytes, rc);
+        iotx_mc_link_active(c, &c->last_tx_time);
+
+        /* skip segments sent completely, and the sent part of the next one */
+        while (iovcnt > 0 && (uint32_t)rc >= iov->len) {
+            rc -= iov->len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->base = (const char *)iov->base + rc;
+            iov->len -= rc;
+        }
+    }
+
+    return (iovcnt == 0) ? SUCCESS_RETURN : MQTT_NETWORK_ERROR;
+}
+#endif
+
 int MQTTConnect(iotx_mc_client_t *pClient)
 {
     MQTTPacket_connectData *pConnectParams;
@@ -459,9 +721,10 @@ int MQTTConnect(iotx_mc_client_t *pClient)
     return SUCCESS_RETURN;
 }
 
-static int iotx_mc_decode_packet(iotx_mc_client_t *c, int *value, int timeout)
+/* decode remaining length of the packet at the head of receive buffer, return length of fixed header, 0 if incomplete */
+static int iotx_mc_decode_packet(iotx_mc_client_t *c, int *value)
 {
-    char i;
+    unsigned char i;
     int multiplier = 1;
     int len = 0;
     const int MAX_NO_OF_REMAINING_LENGTH_BYTES = 4;
@@ -472,24 +735,34 @@ static int iotx_mc_decode_packet(iotx_mc_client_t *c, int *value, int timeout)
 
     *value = 0;
     do {
-        int rc = MQTTPACKET_READ_ERROR;
-
         if (++len > MAX_NO_OF_REMAINING_LENGTH_BYTES) {
             return MQTTPACKET_READ_ERROR; /* bad data */
         }
 
-        rc = c->ipstack.read(&c->ipstack, &i, 1, timeout == 0 ? 1 : timeout);
-        if (rc == 0) {
-            return FAIL_RETURN;
-        } else if (rc != 1) {
-            return MQTT_NETWORK_ERROR;
+        if (len >= c->rx_len) {
+            return 0;
         }
 
+        i = (unsigned char)c->buf_read[len];
         *value += (i & 127) * multiplier;
         multiplier *= 128;
     } while ((i & 128) != 0);
 
-    return len;
+    return len + 1;
+}
+
+/* whether a whole packet is already in receive buffer, so it can be handled without waiting for network */
+static int iotx_mc_packet_buffered(iotx_mc_client_t *c)
+{
+    int len = 0;
+    int rem_len = 0;
+
+    if (c->rx_skip > 0 || c->rx_packet_len > 0) {
+        return 0;
+    }
+
+    len = iotx_mc_decode_packet(c, &rem_len);
+    return (len > 0 && len + rem_len <= c->rx_len);
 }
 
 static int _handle_event(iotx_mqtt_event_handle_pt handle, iotx_mc_client_t *c, iotx_mqtt_event_msg_pt msg)
@@ -504,125 +777,203 @@ static int _handle_event(iotx_mqtt_event_handle_pt handle, iotx_mc_client_t *c,
     return 0;
 }
 
-static int iotx_mc_read_packet(iotx_mc_client_t *c, iotx_time_t *timer, unsigned int *packet_type)
+#ifdef MQTT_STREAM_RECV
+static int MQTTPuback(iotx_mc_client_t *c, unsigned int msgId, enum msgTypes type);
+
+/*
+ * Whether the packet at the head of receive buffer, @len bytes of fixed header and @rem_len more, which is too long
+ * for receive buffer, can be streamed: it is PUBLISH, and buffer holds its topic name and at least one payload byte.
+ */
+static int iotx_mc_stream_wanted(iotx_mc_client_t *c, int len, int rem_len)
 {
     MQTTHeader header = {0};
-    int len = 0;
-    int rem_len = 0;
-    int rc = 0;
-    unsigned int left_t = 0;
+    uint32_t hdr = len + 2;
 
-    if (!c || !timer || !packet_type) {
-        return FAIL_RETURN;
+    header.byte = c->buf_read[0];
+    if (c->stream_handle == NULL || MQTT_HEADER_GET_TYPE(header.byte) != PUBLISH) {
+        return 0;
     }
-    HAL_MutexLock(c->lock_read_buf);
-    rc = _alloc_recv_buffer(c, 0);
-    if (rc < 0) {
-        HAL_MutexUnlock(c->lock_read_buf);
-        return FAIL_RETURN;
+
+    /* topic length not received yet, it is checked when it is */
+    if (c->rx_len < hdr) {
+        return hdr + CONFIG_MQTT_TOPIC_MAXLEN + 2 < _recv_buffer_capacity(c);
     }
-    /* 1. read the header byte.  This has the packet type in it */
-    left_t = iotx_time_left(timer);
-    left_t = (left_t == 0) ? 1 : left_t;
-    rc = c->ipstack.read(&c->ipstack, c->buf_read, 1, left_t);
-    if (0 == rc) { /* timeout */
-        *packet_type = MQTT_CPT_RESERVED;
-        HAL_MutexUnlock(c->lock_read_buf);
-        return SUCCESS_RETURN;
-    } else if (1 != rc) {
-        mqtt_err("mqtt read error, rc=%d", rc);
-        HAL_MutexUnlock(c->lock_read_buf);
-        return MQTT_NETWORK_ERROR;
+
+    hdr += ((uint8_t)c->buf_read[len] << 8) | (uint8_t)c->buf_read[len + 1];
+    hdr += (MQTT_HEADER_GET_QOS(header.byte) > IOTX_MQTT_QOS0) ? 2 : 0;
+    return hdr < len + rem_len && hdr < _recv_buffer_capacity(c);
+}
+
+/* start streaming PUBLISH checked by iotx_mc_stream_wanted(), return bytes to receive before it starts, 0 once it does */
+static uint32_t iotx_mc_stream_start(iotx_mc_client_t *c, int len, int rem_len)
+{
+    MQTTHeader header = {0};
+    uint32_t hdr = len + 2;
+
+    if (c->rx_len < hdr) {
+        return hdr;
     }
 
-    len = 1;
+    header.byte = c->buf_read[0];
+    hdr += ((uint8_t)c->buf_read[len] << 8) | (uint8_t)c->buf_read[len + 1];
+    hdr += (MQTT_HEADER_GET_QOS(header.byte) > IOTX_MQTT_QOS0) ? 2 : 0;
+    if (c->rx_len < hdr) {
+        return hdr;
+    }
 
-    /* 2. read the remaining length.  This is variable in itself */
-    left_t = iotx_time_left(timer);
-    left_t = (left_t == 0) ? 1 : left_t;
-    if ((rc = iotx_mc_decode_packet(c, &rem_len, left_t)) < 0) {
-        mqtt_err("decodePacket error,rc = %d", rc);
-        HAL_MutexUnlock(c->lock_read_buf);
-        return rc;
+    c->rx_stream_hdr = hdr;
+    c->rx_stream_left = len + rem_len - hdr;
+    c->rx_stream_offset = 0;
+    return 0;
+}
+
+/*
+ * Pass received payload of the PUBLISH being streamed to stream handler, a piece of stream_chunk_size bytes at a time.
+ * @need is set to bytes receive buffer has to hold for next piece, or 0 when the whole PUBLISH has been passed.
+ */
+static int iotx_mc_stream_deliver(iotx_mc_client_t *c, uint32_t *need)
+{
+    uint32_t piece = 0;
+    uint16_t packet_id = 0;
+    int rc = SUCCESS_RETURN;
+
+    for (;;) {
+        piece = _recv_buffer_capacity(c) - c->rx_stream_hdr;
+        piece = (c->stream_chunk_size < piece) ? c->stream_chunk_size : piece;
+        piece = (c->rx_stream_left < piece) ? c->rx_stream_left : piece;
+        if (c->rx_len - c->rx_stream_hdr < piece) {
+            *need = c->rx_stream_hdr + piece;
+            return SUCCESS_RETURN;
+        }
+
+        iotx_mc_stream_call(c, piece, 0);
+        c->rx_stream_offset += piece;
+        c->rx_stream_left -= piece;
+        c->rx_len -= piece;
+        if (c->rx_len > c->rx_stream_hdr) {
+            memmove(c->buf_read + c->rx_stream_hdr, c->buf_read + c->rx_stream_hdr + piece,
+                    c->rx_len - c->rx_stream_hdr);
+        }
+
+        if (c->rx_stream_left == 0) {
+            break;
+        }
+    }
+
+    /* packet id is right before payload */
+    if (MQTT_HEADER_GET_QOS((uint8_t)c->buf_read[0]) > IOTX_MQTT_QOS0) {
+        packet_id = ((uint8_t)c->buf_read[c->rx_stream_hdr - 2] << 8) | (uint8_t)c->buf_read[c->rx_stream_hdr - 1];
     }
+    _drop_recv_bytes(c, c->rx_stream_hdr);
+    c->rx_stream_hdr = 0;
+    IOTX_MC_STATS_ADD(c, rx_packets, 1);
+    IOTX_MC_STATS_ADD(c, recv_count, 1);
 
-    len += MQTTPacket_encode((unsigned char *)c->buf_read + 1,
-                             rem_len); /* put the original remaining length back into the buffer */
+    if (packet_id > 0) {
+        rc = MQTTPuback(c, packet_id, PUBACK);
+    }
+    *need = 0;
+    return rc;
+}
+#endif
 
-    rc = _alloc_recv_buffer(c, rem_len + len);
-    if (rc < 0) {
-        HAL_MutexUnlock(c->lock_read_buf);
+/*
+ * Get next packet into the head of receive buffer. Network is read only when the buffer does not hold a whole
+ * packet, and then as much as is available is read, so packets coming in a burst are read by one call.
+ * Read buffer is only touched by the thread holding lock_yield, or by the one connecting before client is in use.
+ */
+static int iotx_mc_read_packet(iotx_mc_client_t *c, iotx_time_t *timer, unsigned int *packet_type)
+{
+    MQTTHeader header = {0};
+    int len = 0;
+    int rem_len = 0;
+    int rc = 0;
+    int overflow = 0;
+    uint32_t need = 0;
+    unsigned int left_t = 0;
+
+    if (!c || !timer || !packet_type) {
         return FAIL_RETURN;
     }
+    *packet_type = MQTT_CPT_RESERVED;
 
-    /* Check if the received data length exceeds mqtt read buffer length */
-    if ((rem_len > 0) && ((rem_len + len) > c->buf_size_read)) {
-        int needReadLen;
-        int remainDataLen;
-#ifdef PLATFORM_HAS_DYNMEM
-        char *remainDataBuf;
-#else
-        char remainDataBuf[IOTX_MC_RX_MAX_LEN] = {0};
+    _reset_recv_buffer(c);
+
+    for (;;) {
+        _skip_recv_bytes(c);
+
+        need = 2;   /* the shortest packet */
+        if (c->rx_skip > 0) {
+            need = 1;
+#ifdef MQTT_STREAM_RECV
+        } else if (c->rx_stream_hdr > 0) {
+            rc = iotx_mc_stream_deliver(c, &need);
+            if (rc != SUCCESS_RETURN) {
+                _clear_recv_buffer(c);
+                return rc;
+            }
+            if (need == 0) {
+                continue;
+            }
 #endif
-        mqtt_err("mqtt read buffer is too short, mqttReadBufLen : %u, remainDataLen : %d", c->buf_size_read, rem_len);
-        needReadLen = c->buf_size_read - len;
-        left_t = iotx_time_left(timer);
-        left_t = (left_t == 0) ? 1 : left_t;
-        rc = c->ipstack.read(&c->ipstack, c->buf_read + len, needReadLen, left_t);
-        if (rc < 0) {
-            mqtt_err("mqtt read error");
-            HAL_MutexUnlock(c->lock_read_buf);
-            return MQTT_NETWORK_ERROR;
-        } else if (rc != needReadLen) {
-            mqtt_warning("mqtt read timeout");
-            HAL_MutexUnlock(c->lock_read_buf);
-            return FAIL_RETURN;
+        } else if (c->rx_len >= 2) {
+            len = iotx_mc_decode_packet(c, &rem_len);
+            if (len < 0) {
+                mqtt_err("decodePacket error,rc = %d", len);
+                _clear_recv_buffer(c);
+                return len;
+            } else if (len == 0) {
+                need = c->rx_len + 1;
+#ifdef MQTT_STREAM_RECV
+            } else if (len + rem_len > _recv_buffer_capacity(c) && iotx_mc_stream_wanted(c, len, rem_len)) {
+                /* streaming starts once topic name is received */
+                need = iotx_mc_stream_start(c, len, rem_len);
+                if (need == 0) {
+                    continue;
+                }
+#endif
+            } else if (len + rem_len > _recv_buffer_capacity(c)) {
+                mqtt_err("mqtt read buffer is too short, mqttReadBufLen : %u, remainDataLen : %d",
+                         _recv_buffer_capacity(c), rem_len);
+                c->rx_skip = len + rem_len;
+                _skip_recv_bytes(c);
+                overflow = 1;
+                break;
+            } else if (len + rem_len <= c->rx_len) {
+                break;
+            } else {
+                need = len + rem_len;
+            }
         }
 
-        /* drop data whitch over the length of mqtt buffer */
-        remainDataLen = rem_len - needReadLen;
-#ifdef PLATFORM_HAS_DYNMEM
-        remainDataBuf = mqtt_malloc(remainDataLen + 1);
-        if (!remainDataBuf) {
-            mqtt_err("allocate remain buffer failed");
-            HAL_MutexUnlock(c->lock_read_buf);
-            return FAIL_RETURN;
-        }
-#else
-        if (remainDataLen >= IOTX_MC_RX_MAX_LEN) {
-            mqtt_err("IOTX_MC_RX_MAX_LEN too short, remainDataLen: %d, IOTX_MC_RX_MAX_LEN: %d", remainDataLen, IOTX_MC_RX_MAX_LEN);
-            HAL_MutexUnlock(c->lock_read_buf);
+        rc = _prepare_recv_buffer(c, need);
+        if (rc < 0) {
             return FAIL_RETURN;
         }
-#endif
 
         left_t = iotx_time_left(timer);
         left_t = (left_t == 0) ? 1 : left_t;
-        rc = c->ipstack.read(&c->ipstack, remainDataBuf, remainDataLen, left_t);
-        if (rc < 0) {
-            mqtt_err("mqtt read error");
-#ifdef PLATFORM_HAS_DYNMEM
-            mqtt_free(remainDataBuf);
-            remainDataBuf = NULL;
-#endif
-            HAL_MutexUnlock(c->lock_read_buf);
+        if (c->ipstack.read_some != NULL) {
+            rc = c->ipstack.read_some(&c->ipstack, c->buf_read + c->rx_len, need - c->rx_len,
+                                      c->buf_size_read - c->rx_len, left_t);
+        } else {
+            rc = c->ipstack.read(&c->ipstack, c->buf_read + c->rx_len, need - c->rx_len, left_t);
+        }
+        if (0 == rc) { /* timeout, what has been received is kept for next time */
+            return SUCCESS_RETURN;
+        } else if (rc < 0) {
+            mqtt_err("mqtt read error, rc=%d", rc);
+            _clear_recv_buffer(c);
             return MQTT_NETWORK_ERROR;
-        } else if (rc != remainDataLen) {
-            mqtt_warning("mqtt read timeout");
-#ifdef PLATFORM_HAS_DYNMEM
-            mqtt_free(remainDataBuf);
-            remainDataBuf = NULL;
-#endif
-            HAL_MutexUnlock(c->lock_read_buf);
-            return FAIL_RETURN;
         }
 
-#ifdef PLATFORM_HAS_DYNMEM
-        mqtt_free(remainDataBuf);
-        remainDataBuf = NULL;
-#endif
-        HAL_MutexUnlock(c->lock_read_buf);
-        *packet_type = MQTT_CPT_RESERVED;
+        c->rx_len += rc;
+        IOTX_MC_STATS_ADD(c, rx_bytes, rc);
+        IOTX_MC_STATS_ADD(c, rx_reads, 1);
+        iotx_mc_link_active(c, &c->last_rx_time);
+    }
+
+    if (overflow) {
         if (NULL != c->handle_event.h_fp) {
             iotx_mqtt_event_msg_t msg;
 
@@ -632,32 +983,18 @@ static int iotx_mc_read_packet(iotx_mc_client_t *c, iotx_time_t *timer, unsigned
         }
 
         return SUCCESS_RETURN;
-
     }
 
-    /* 3. read the rest of the buffer using a callback to supply the rest of the data */
-    left_t = iotx_time_left(timer);
-    left_t = (left_t == 0) ? 1 : left_t;
-
-    rc = c->ipstack.read(&c->ipstack, c->buf_read + len, rem_len, left_t);
-    if (rem_len > 0) {
-        if (rc < 0) {
-            mqtt_err("mqtt read error");
-            HAL_MutexUnlock(c->lock_read_buf);
-            return MQTT_NETWORK_ERROR;
-        } else if (rc != rem_len) {
-            mqtt_warning("mqtt read timeout");
-            HAL_MutexUnlock(c->lock_read_buf);
-            return FAIL_RETURN;
-        }
+    /* terminate the packet, the byte overwritten belongs to next packet and is restored on release */
+    c->rx_packet_len = len + rem_len;
+    if (c->rx_packet_len < c->buf_size_read) {
+        c->rx_saved = c->buf_read[c->rx_packet_len];
+        c->buf_read[c->rx_packet_len] = '\0';
     }
+    IOTX_MC_STATS_ADD(c, rx_packets, 1);
 
     header.byte = c->buf_read[0];
     *packet_type = MQTT_HEADER_GET_TYPE(header.byte);
-    if ((len + rem_len) < c->buf_size_read) {
-        c->buf_read[len + rem_len] = '\0';
-    }
-    HAL_MutexUnlock(c->lock_read_buf);
     return SUCCESS_RETURN;
 }
 
@@ -680,6 +1017,7 @@ static int iotx_mc_handle_recv_CONNACK(iotx_mc_client_t *c)
     switch (connack_rc) {
         case IOTX_MC_CONNECTION_ACCEPTED:
             rc = SUCCESS_RETURN;
+            c->session_present = (sessionPresent != 0);
             break;
         case IOTX_MC_CONNECTION_REFUSED_UNACCEPTABLE_PROTOCOL_VERSION:
             rc = MQTT_CONANCK_UNACCEPTABLE_PROTOCOL_VERSION_ERROR;
@@ -725,25 +1063,19 @@ static int iotx_mc_wait_CONNACK(iotx_mc_client_t *c)
         rc = iotx_mc_read_packet(c, &timer, &packetType);
         if (rc != SUCCESS_RETURN) {
             mqtt_err("readPacket error,result = %d", rc);
-            HAL_MutexLock(c->lock_read_buf);
             _reset_recv_buffer(c);
-            HAL_MutexUnlock(c->lock_read_buf);
             return rc;
         }
 
         if (++wait_connack > WAIT_CONNACK_MAX) {
             mqtt_err("wait connack timeout");
-            HAL_MutexLock(c->lock_read_buf);
             _reset_recv_buffer(c);
-            HAL_MutexUnlock(c->lock_read_buf);
             return MQTT_NETWORK_ERROR;
         }
     } while (packetType != CONNACK);
-    HAL_MutexLock(c->lock_read_buf);
 
     rc = iotx_mc_handle_recv_CONNACK(c);
     _reset_recv_buffer(c);
-    HAL_MutexUnlock(c->lock_read_buf);
 
     if (SUCCESS_RETURN != rc) {
         mqtt_err("recvConnackProc error,result = %d", rc);
@@ -752,21 +1084,192 @@ static int iotx_mc_wait_CONNACK(iotx_mc_client_t *c)
     return rc;
 }
 
-static int _mqtt_connect(void *client)
+#ifdef MQTT_TOPIC_ALIAS
+static uint32_t iotx_mc_topic_alias_hash(const char *topic, uint32_t len)
 {
-#define RETRY_TIME_LIMIT    (8+1)
-#define RETRY_INTV_PERIOD   (2000)
-    int rc = FAIL_RETURN;
-    int try_count = 1;
-    iotx_mc_client_t *pClient = (iotx_mc_client_t *)client;
-    int userKeepAliveInterval = 0;
+    uint32_t hash = 2166136261u;
 
-    if (NULL == pClient) {
-        return NULL_VALUE_ERROR;
+    /* FNV-1a */
+    while (len-- > 0) {
+        hash = (hash ^ (uint8_t)*topic++) * 16777619u;
     }
-    userKeepAliveInterval = pClient->connect_data.keepAliveInterval;
-    pClient->connect_data.keepAliveInterval = (userKeepAliveInterval * 2);
-    if(pClient->connect_data.keepAliveInterval > CONFIG_MQTT_KEEPALIVE_INTERVAL_MAX) {
+    return hash;
+}
+
+/*
+ * Topic name to send for @topicName, which is @topicName itself, or "$<alias>" or "$<alias>=<topic>" made in @wire
+ * of IOTX_MC_TOPIC_ALIAS_PREFIX_MAXLEN + CONFIG_MQTT_TOPIC_MAXLEN + 1 bytes. Length of "$<alias>" or "$<alias>="
+ * is returned by @prefix_len, the alias by @alias, which are 0 when topic name is sent as it is.
+ * Called with lock_list_pub held.
+ */
+static const char *iotx_mc_topic_alias_wire(iotx_mc_client_t *c, const char *topicName, char *wire, int *prefix_len,
+        uint16_t *alias)
+{
+    uint32_t len = strlen(topicName);
+    uint32_t hash;
+    iotx_mc_topic_alias_t *entry = NULL, *free_entry = NULL;
+    int idx;
+
+    *prefix_len = 0;
+    *alias = 0;
+    if (c->topic_alias_max == 0 || topicName[0] == '$' || len > CONFIG_MQTT_TOPIC_MAXLEN ||
+        len <= IOTX_MC_TOPIC_ALIAS_PREFIX_MAXLEN) {
+        return topicName;
+    }
+
+    hash = iotx_mc_topic_alias_hash(topicName, len);
+    for (idx = 0; idx < c->topic_alias_max; idx++) {
+        if (c->topic_alias[idx].topic == NULL) {
+            if (free_entry == NULL) {
+                free_entry = &c->topic_alias[idx];
+            }
+            continue;
+        }
+        if (c->topic_alias[idx].hash == hash && c->topic_alias[idx].topic_len == len &&
+            memcmp(c->topic_alias[idx].topic, topicName, len) == 0) {
+            entry = &c->topic_alias[idx];
+            break;
+        }
+    }
+
+    if (entry == NULL) {
+        /* aliases are never taken back, so a PUBLISH waiting PUBACK always names the topic it was made for */
+        if (free_entry == NULL || (free_entry->topic = mqtt_malloc(len + 1)) == NULL) {
+            return topicName;
+        }
+        memcpy(free_entry->topic, topicName, len + 1);
+        free_entry->hash = hash;
+        free_entry->topic_len = len;
+        free_entry->state = IOTX_MC_TOPIC_ALIAS_UNKNOWN;
+        entry = free_entry;
+    }
+    *alias = entry - c->topic_alias + 1;
+
+    if (entry->state == IOTX_MC_TOPIC_ALIAS_KNOWN) {
+        *prefix_len = HAL_Snprintf(wire, IOTX_MC_TOPIC_ALIAS_PREFIX_MAXLEN + 1, "$%u", *alias);
+        return wire;
+    }
+
+    /* alias is not used alone until the PUBLISH telling it has been sent */
+    entry->state = IOTX_MC_TOPIC_ALIAS_DEFINING;
+    *prefix_len = HAL_Snprintf(wire, IOTX_MC_TOPIC_ALIAS_PREFIX_MAXLEN + 1, "$%u=", *alias);
+    memcpy(wire + *prefix_len, topicName, len + 1);
+    return wire;
+}
+
+/* PUBLISH of @alias has been sent, called with lock_list_pub held */
+static void iotx_mc_topic_alias_sent(iotx_mc_client_t *c, uint16_t alias)
+{
+    if (alias > 0 && c->topic_alias[alias - 1].state == IOTX_MC_TOPIC_ALIAS_DEFINING) {
+        c->topic_alias[alias - 1].state = IOTX_MC_TOPIC_ALIAS_KNOWN;
+    }
+}
+
+#if !WITH_MQTT_ONLY_QOS0
+/* PUBLISH waiting PUBACK which names topic by alias alone is made again to tell the alias, called with lock_list_pub held */
+static void iotx_mc_topic_alias_redefine(iotx_mc_client_t *c, iotx_mc_pub_info_t *node)
+{
+    uint32_t pos = 1, remain = 0, mult = 1, topic_len, tail, alias = 0;
+    iotx_mc_topic_alias_t *entry = NULL;
+    iotx_mc_pub_info_t *renew = NULL;
+    unsigned char *ptr = NULL;
+
+    do {
+        if (pos >= node->len || pos > 4) {
+            return;
+        }
+        remain += (node->buf[pos] & 0x7F) * mult;
+        mult *= 128;
+    } while (node->buf[pos++] & 0x80);
+    if (pos + 2 > node->len) {
+        return;
+    }
+    topic_len = (node->buf[pos] << 8) | node->buf[pos + 1];
+    if (topic_len < 2 || pos + 2 + topic_len > node->len || node->buf[pos + 2] != '$') {
+        return;
+    }
+    for (ptr = node->buf + pos + 3; ptr < node->buf + pos + 2 + topic_len; ptr++) {
+        if (*ptr < '0' || *ptr > '9') {
+            /* "$<alias>=<topic>" is understood on any connection */
+            return;
+        }
+        alias = alias * 10 + (*ptr - '0');
+    }
+    if (alias == 0 || alias > IOTX_MC_TOPIC_ALIAS_NUM || c->topic_alias[alias - 1].topic == NULL) {
+        return;
+    }
+    entry = &c->topic_alias[alias - 1];
+
+    remain += 1 + entry->topic_len;
+    tail = node->len - (pos + 2 + topic_len);
+    renew = mqtt_malloc(sizeof(iotx_mc_pub_info_t) + MQTTPacket_len(remain));
+    if (renew == NULL) {
+        return;
+    }
+    memcpy(renew, node, sizeof(iotx_mc_pub_info_t));
+    renew->buf = (unsigned char *)renew + sizeof(iotx_mc_pub_info_t);
+    renew->len = MQTTPacket_len(remain);
+    renew->in_tx = 0;
+    renew->dropped = 0;
+
+    ptr = renew->buf;
+    *ptr++ = node->buf[0];
+    ptr += MQTTPacket_encode(ptr, remain);
+    topic_len += 1 + entry->topic_len;
+    *ptr++ = (unsigned char)(topic_len >> 8);
+    *ptr++ = (unsigned char)(topic_len & 0xFF);
+    topic_len -= 1 + entry->topic_len;
+    memcpy(ptr, node->buf + pos + 2, topic_len);
+    ptr += topic_len;
+    *ptr++ = '=';
+    memcpy(ptr, entry->topic, entry->topic_len);
+    ptr += entry->topic_len;
+    memcpy(ptr, node->buf + node->len - tail, tail);
+
+    c->pub_heap[renew->heap_idx] = renew;
+    c->pub_window[IOTX_MC_PUB_WINDOW_IDX(renew->msg_id)] = renew;
+    if (node->in_tx) {
+        /* buf is still queued for writing, iotx_mc_send_publish() frees it afterwards */
+        node->dropped = 1;
+        return;
+    }
+    mqtt_free(node);
+}
+#endif
+
+/* server knows no alias on a new connection */
+static void iotx_mc_topic_alias_reset(iotx_mc_client_t *c)
+{
+    int idx;
+
+    HAL_MutexLock(c->lock_list_pub);
+    for (idx = 0; idx < IOTX_MC_TOPIC_ALIAS_NUM; idx++) {
+        c->topic_alias[idx].state = IOTX_MC_TOPIC_ALIAS_UNKNOWN;
+    }
+#if !WITH_MQTT_ONLY_QOS0
+    for (idx = 0; idx < c->pub_inflight; idx++) {
+        iotx_mc_topic_alias_redefine(c, c->pub_heap[idx]);
+    }
+#endif
+    HAL_MutexUnlock(c->lock_list_pub);
+}
+#endif
+
+static int _mqtt_connect(void *client)
+{
+#define RETRY_TIME_LIMIT    (8+1)
+#define RETRY_INTV_PERIOD   (2000)
+    int rc = FAIL_RETURN;
+    int try_count = 1;
+    iotx_mc_client_t *pClient = (iotx_mc_client_t *)client;
+    int userKeepAliveInterval = 0;
+
+    if (NULL == pClient) {
+        return NULL_VALUE_ERROR;
+    }
+    userKeepAliveInterval = pClient->connect_data.keepAliveInterval;
+    pClient->connect_data.keepAliveInterval = (userKeepAliveInterval * 2);
+    if(pClient->connect_data.keepAliveInterval > CONFIG_MQTT_KEEPALIVE_INTERVAL_MAX) {
         pClient->connect_data.keepAliveInterval = CONFIG_MQTT_KEEPALIVE_INTERVAL_MAX;
     }
     mqtt_info("connect params: MQTTVersion=%d, clientID=%s, keepAliveInterval=%d, username=%s",
@@ -777,6 +1280,9 @@ static int _mqtt_connect(void *client)
 
     /* Establish TCP or TLS connection */
     do {
+        /* nothing received on former connection is valid any more */
+        _clear_recv_buffer(pClient);
+
         rc = MQTTConnect(pClient);
         pClient->connect_data.keepAliveInterval = userKeepAliveInterval;
 
@@ -791,7 +1297,7 @@ static int _mqtt_connect(void *client)
         if (rc <= MQTT_CONNACK_NOT_AUTHORIZED_ERROR && rc >= MQTT_CONANCK_UNACCEPTABLE_PROTOCOL_VERSION_ERROR) {
             mqtt_err("received reject ACK from MQTT server! rc = %d", rc);
             pClient->ipstack.disconnect(&pClient->ipstack);
-            return MQTT_CONNECT_ERROR;
+            return rc;
         }
 
         if (SUCCESS_RETURN != rc) {
@@ -813,22 +1319,193 @@ static int _mqtt_connect(void *client)
         return MQTT_CONNECT_ERROR;
     }
     pClient->keepalive_probes = 0;
+    pClient->keepalive_idle_ping = 0;
+    HAL_MutexLock(pClient->lock_generic);
+    pClient->reconnect_param.link_up = 0;
+    HAL_MutexUnlock(pClient->lock_generic);
+#ifdef MQTT_TOPIC_ALIAS
+    iotx_mc_topic_alias_reset(pClient);
+#endif
     iotx_mc_set_client_state(pClient, IOTX_MC_STATE_CONNECTED);
 
-    utils_time_countdown_ms(&pClient->next_ping_time, pClient->connect_data.keepAliveInterval * 1000);
+    /* idle time learned is kept over reconnect, the NAT on the way is likely the same */
+    iotx_time_start(&pClient->last_tx_time);
+    iotx_time_start(&pClient->last_rx_time);
+    utils_time_countdown_ms(&pClient->next_ping_time, pClient->keepalive_ms);
+
+    if (pClient->reconnect_timing) {
+        uint32_t spent = utils_time_spend(&pClient->disconnect_time);
+
+        pClient->reconnect_timing = 0;
+        IOTX_MC_STATS_SET(pClient, reconnect_time_ms, spent);
+        if (spent > pClient->stats.reconnect_time_max_ms) {
+            IOTX_MC_STATS_SET(pClient, reconnect_time_max_ms, spent);
+        }
+        if (pClient->session_present) {
+            IOTX_MC_STATS_ADD(pClient, session_resumed, 1);
+        }
+        mqtt_info("reconnected in %u ms, session present: %d", spent, pClient->session_present);
+#ifdef MQTT_FAST_RECONNECT
+        /* filters are subscribed again only when server keeps no session */
+        pClient->sub_replay_pending = !pClient->session_present;
+#endif
+    }
+#ifdef MQTT_FAST_RECONNECT
+    /* later connections ask server to keep session, so that nothing needs to be subscribed again */
+    pClient->connect_data.cleansession = 0;
+#endif
 
     mqtt_info("mqtt connect success!");
     return SUCCESS_RETURN;
 }
 
 #if !WITH_MQTT_ONLY_QOS0
-static int iotx_mc_push_pubInfo_to(iotx_mc_client_t *c, int len, unsigned short msgId, iotx_mc_pub_info_t **node)
+/* first republish of @node is due twice of request timeout after it is sent */
+static void iotx_mc_pub_retry_start(iotx_mc_client_t *c, iotx_mc_pub_info_t *node)
+{
+    iotx_time_start(&node->pub_start_time);
+    node->retry_interval_ms = c->request_timeout_ms * 2;
+    iotx_time_init(&node->retry_time);
+    utils_time_countdown_ms(&node->retry_time, node->retry_interval_ms);
+}
+
+/* each republish of @node doubles the wait for next one, so a slow link is not flooded by retransmits */
+static void iotx_mc_pub_retry_backoff(iotx_mc_pub_info_t *node)
+{
+    iotx_time_start(&node->pub_start_time);
+    if (node->retry_interval_ms < IOTX_MC_REPUB_INTERVAL_MAX_MS / 2) {
+        node->retry_interval_ms *= 2;
+    } else if (node->retry_interval_ms < IOTX_MC_REPUB_INTERVAL_MAX_MS) {
+        node->retry_interval_ms = IOTX_MC_REPUB_INTERVAL_MAX_MS;
+    }
+    utils_time_countdown_ms(&node->retry_time, node->retry_interval_ms);
+}
+
+#ifdef PLATFORM_HAS_DYNMEM
+/* retry deadline of @a is earlier than that of @b, wrap-around of uptime taken into account */
+#define IOTX_MC_PUB_RETRY_BEFORE(a, b)  ((int32_t)((a)->retry_time.time - (b)->retry_time.time) < 0)
+
+/* move pub_heap[@idx] towards root until its parent is due earlier, called with lock_list_pub held */
+static void iotx_mc_pub_heap_up(iotx_mc_client_t *c, uint32_t idx)
+{
+    iotx_mc_pub_info_t *node = c->pub_heap[idx];
+    uint32_t parent;
+
+    while (idx > 0) {
+        parent = (idx - 1) / 2;
+        if (!IOTX_MC_PUB_RETRY_BEFORE(node, c->pub_heap[parent])) {
+            break;
+        }
+        c->pub_heap[idx] = c->pub_heap[parent];
+        c->pub_heap[idx]->heap_idx = idx;
+        idx = parent;
+    }
+    c->pub_heap[idx] = node;
+    node->heap_idx = idx;
+}
+
+/* move pub_heap[@idx] towards leaves until its children are due later, called with lock_list_pub held */
+static void iotx_mc_pub_heap_down(iotx_mc_client_t *c, uint32_t idx)
+{
+    iotx_mc_pub_info_t *node = c->pub_heap[idx];
+    uint32_t child;
+
+    for (;;) {
+        child = idx * 2 + 1;
+        if (child >= c->pub_inflight) {
+            break;
+        }
+        if (child + 1 < c->pub_inflight && IOTX_MC_PUB_RETRY_BEFORE(c->pub_heap[child + 1], c->pub_heap[child])) {
+            child++;
+        }
+        if (!IOTX_MC_PUB_RETRY_BEFORE(c->pub_heap[child], node)) {
+            break;
+        }
+        c->pub_heap[idx] = c->pub_heap[child];
+        c->pub_heap[idx]->heap_idx = idx;
+        idx = child;
+    }
+    c->pub_heap[idx] = node;
+    node->heap_idx = idx;
+}
+#endif
+
+#if !defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_PUB_SLAB
+/*
+ * Find @len bytes in pub_slab for a QoS1 publish and return the offset, called with lock_list_pub held.
+ * Records are few, so when no gap between them is large enough they are just packed to the head of slab.
+ */
+static int iotx_mc_pub_slab_alloc(iotx_mc_client_t *c, uint32_t len)
+{
+    iotx_mc_pub_info_t *node = NULL;
+    iotx_mc_pub_info_t *lowest = NULL;
+    uint32_t offset = 0;
+    int moved = 0;
+    int idx;
+
+    /* acked ones do not hold their bytes till the next cycle clears them */
+    for (idx = 0; idx < IOTX_MC_PUBWAIT_LIST_MAX_LEN; idx++) {
+        node = &c->list_pub_wait_ack[idx];
+        if (node->used && IOTX_MC_NODE_STATE_INVALID == node->node_state) {
+            memset(node, 0, sizeof(iotx_mc_pub_info_t));
+        }
+    }
+
+    /* first fit, @offset moves past every record it overlaps */
+    do {
+        moved = 0;
+        for (idx = 0; idx < IOTX_MC_PUBWAIT_LIST_MAX_LEN; idx++) {
+            node = &c->list_pub_wait_ack[idx];
+            if (node->used && offset < node->offset + node->len && node->offset < offset + len) {
+                offset = node->offset + node->len;
+                moved = 1;
+            }
+        }
+    } while (moved && offset + len <= IOTX_MC_PUB_SLAB_LEN);
+
+    if (offset + len <= IOTX_MC_PUB_SLAB_LEN) {
+        return offset;
+    }
+
+    /* pack records in order of offset, each one not packed yet lies beyond @offset */
+    offset = 0;
+    for (;;) {
+        lowest = NULL;
+        for (idx = 0; idx < IOTX_MC_PUBWAIT_LIST_MAX_LEN; idx++) {
+            node = &c->list_pub_wait_ack[idx];
+            if (node->used && node->offset >= offset && (lowest == NULL || node->offset < lowest->offset)) {
+                lowest = node;
+            }
+        }
+        if (lowest == NULL) {
+            break;
+        }
+        if (lowest->offset != offset) {
+            memmove(c->pub_slab + offset, c->pub_slab + lowest->offset, lowest->len);
+            lowest->offset = offset;
+        }
+        offset += lowest->len;
+    }
+
+    if (offset + len > IOTX_MC_PUB_SLAB_LEN) {
+        mqtt_err("IOTX_MC_PUB_SLAB_LEN is too short, %u bytes wait for ack", offset);
+        return FAIL_RETURN;
+    }
+    return offset;
+}
+#endif
+
+/* @buf is copied into the node, or the caller fills node->buf itself when @buf is NULL */
+static int iotx_mc_push_pubInfo_to(iotx_mc_client_t *c, const char *buf, int len, unsigned short msgId,
+                                   iotx_mc_pub_info_t **node)
 {
 #ifdef PLATFORM_HAS_DYNMEM
-    int list_number;
     iotx_mc_pub_info_t *repubInfo;
 #else
     int idx;
+#if WITH_MQTT_PUB_SLAB
+    int offset;
+#endif
 #endif
 
     if (!c || !node) {
@@ -836,7 +1513,7 @@ static int iotx_mc_push_pubInfo_to(iotx_mc_client_t *c, int len, unsigned short
         return FAIL_RETURN;
     }
 
-    if ((len < 0) || (len > c->buf_size_send)) {
+    if ((len < 0) || (buf != NULL && len > c->buf_size_send)) {
         mqtt_err("the param of len is error!");
 #ifndef PLATFORM_HAS_DYNMEM
         if (len >= c->buf_size_send) {
@@ -847,11 +1524,10 @@ static int iotx_mc_push_pubInfo_to(iotx_mc_client_t *c, int len, unsigned short
     }
 
 #ifdef PLATFORM_HAS_DYNMEM
-    list_number = list_entry_number(&c->list_pub_wait_ack);
-
-    if (list_number >= IOTX_MC_REPUB_NUM_MAX) {
-        mqtt_err("more than %u elements in republish list. List overflow!", list_number);
-        return FAIL_RETURN;
+    /* slot of @msgId still taken means packet id has wrapped around the window */
+    if (c->pub_inflight >= IOTX_MC_PUB_WINDOW_SIZE || c->pub_window[IOTX_MC_PUB_WINDOW_IDX(msgId)] != NULL) {
+        mqtt_warning("publish window is full, %u publishes wait for ack", c->pub_inflight);
+        return MQTT_PUB_WINDOW_FULL;
     }
 
     repubInfo = (iotx_mc_pub_info_t *)mqtt_malloc(sizeof(iotx_mc_pub_info_t) + len);
@@ -863,24 +1539,41 @@ static int iotx_mc_push_pubInfo_to(iotx_mc_client_t *c, int len, unsigned short
     repubInfo->node_state = IOTX_MC_NODE_STATE_NORMANL;
     repubInfo->msg_id = msgId;
     repubInfo->len = len;
-    iotx_time_start(&repubInfo->pub_start_time);
+    repubInfo->in_tx = 0;
+    repubInfo->dropped = 0;
+    iotx_mc_pub_retry_start(c, repubInfo);
     repubInfo->buf = (unsigned char *)repubInfo + sizeof(iotx_mc_pub_info_t);
 
-    memcpy(repubInfo->buf, c->buf_send, len);
-    INIT_LIST_HEAD(&repubInfo->linked_list);
+    if (buf != NULL) {
+        memcpy(repubInfo->buf, buf, len);
+    }
 
-    list_add_tail(&repubInfo->linked_list, &c->list_pub_wait_ack);
+    c->pub_heap[c->pub_inflight] = repubInfo;
+    repubInfo->heap_idx = c->pub_inflight++;
+    iotx_mc_pub_heap_up(c, repubInfo->heap_idx);
+    c->pub_window[IOTX_MC_PUB_WINDOW_IDX(msgId)] = repubInfo;
 
     *node = repubInfo;
     return SUCCESS_RETURN;
 #else
+#if WITH_MQTT_PUB_SLAB
+    offset = iotx_mc_pub_slab_alloc(c, len);
+    if (offset < 0) {
+        return FAIL_RETURN;
+    }
+#endif
     for (idx = 0; idx < IOTX_MC_PUBWAIT_LIST_MAX_LEN; idx++) {
         if (c->list_pub_wait_ack[idx].used == 0) {
             c->list_pub_wait_ack[idx].node_state = IOTX_MC_NODE_STATE_NORMANL;
             c->list_pub_wait_ack[idx].msg_id = msgId;
             c->list_pub_wait_ack[idx].len = len;
-            iotx_time_start(&c->list_pub_wait_ack[idx].pub_start_time);
-            memcpy(c->list_pub_wait_ack[idx].buf, c->buf_send, len);
+#if WITH_MQTT_PUB_SLAB
+            c->list_pub_wait_ack[idx].offset = offset;
+#endif
+            iotx_mc_pub_retry_start(c, &c->list_pub_wait_ack[idx]);
+            if (buf != NULL) {
+                memcpy(IOTX_MC_PUB_BUF(c, &c->list_pub_wait_ack[idx]), buf, len);
+            }
             c->list_pub_wait_ack[idx].used = 1;
             *node = &c->list_pub_wait_ack[idx];
             return SUCCESS_RETURN;
@@ -893,6 +1586,47 @@ static int iotx_mc_push_pubInfo_to(iotx_mc_client_t *c, int len, unsigned short
 #endif
 }
 
+#ifdef PLATFORM_HAS_DYNMEM
+/* called with lock_list_pub held, a node still being written is freed by its writer */
+static void iotx_mc_drop_pubInfo(iotx_mc_client_t *c, iotx_mc_pub_info_t *node)
+{
+    uint32_t idx = node->heap_idx;
+    iotx_mc_pub_info_t *last = c->pub_heap[--c->pub_inflight];
+
+    c->pub_heap[c->pub_inflight] = NULL;
+    if (last != node) {
+        c->pub_heap[idx] = last;
+        last->heap_idx = idx;
+        iotx_mc_pub_heap_down(c, idx);
+        iotx_mc_pub_heap_up(c, last->heap_idx);
+    }
+    c->pub_window[IOTX_MC_PUB_WINDOW_IDX(node->msg_id)] = NULL;
+    if (node->in_tx) {
+        node->dropped = 1;
+        return;
+    }
+    mqtt_free(node);
+}
+#endif
+
+/* count PUBACK of publish which has waited @rtt_ms since it was sent last time */
+static void _stats_count_puback(iotx_mc_client_t *c, uint32_t rtt_ms)
+{
+    int idx = 0;
+    uint32_t bound = 4;
+
+    while (idx < IOTX_MQTT_RTT_HIST_NUM - 1 && rtt_ms >= bound) {
+        idx++;
+        bound *= 4;
+    }
+    IOTX_MC_STATS_ADD(c, rtt_hist[idx], 1);
+    IOTX_MC_STATS_ADD(c, rtt_sum_ms, rtt_ms);
+    if (rtt_ms > c->stats.rtt_max_ms) {
+        IOTX_MC_STATS_SET(c, rtt_max_ms, rtt_ms);
+    }
+    IOTX_MC_STATS_ADD(c, puback_count, 1);
+}
+
 static int iotx_mc_mask_pubInfo_from(iotx_mc_client_t *c, uint16_t msgId)
 {
 #ifdef PLATFORM_HAS_DYNMEM
@@ -902,11 +1636,12 @@ static int iotx_mc_mask_pubInfo_from(iotx_mc_client_t *c, uint16_t msgId)
         return FAIL_RETURN;
     }
 
+    /* acked node is released at once, or by its writer when PUBACK beats the end of writing */
     HAL_MutexLock(c->lock_list_pub);
-    list_for_each_entry(node, &c->list_pub_wait_ack, linked_list, iotx_mc_pub_info_t) {
-        if (node->msg_id == msgId) {
-            node->node_state = IOTX_MC_NODE_STATE_INVALID; /* mark as invalid node */
-        }
+    node = c->pub_window[IOTX_MC_PUB_WINDOW_IDX(msgId)];
+    if (node != NULL && node->msg_id == msgId) {
+        _stats_count_puback(c, utils_time_spend(&node->pub_start_time));
+        iotx_mc_drop_pubInfo(c, node);
     }
     HAL_MutexUnlock(c->lock_list_pub);
 #else
@@ -914,7 +1649,9 @@ static int iotx_mc_mask_pubInfo_from(iotx_mc_client_t *c, uint16_t msgId)
 
     for (idx = 0; idx < IOTX_MC_PUBWAIT_LIST_MAX_LEN; idx++) {
         if (c->list_pub_wait_ack[idx].used &&
-            c->list_pub_wait_ack[idx].msg_id == msgId) {
+            c->list_pub_wait_ack[idx].msg_id == msgId &&
+            c->list_pub_wait_ack[idx].node_state == IOTX_MC_NODE_STATE_NORMANL) {
+            _stats_count_puback(c, utils_time_spend(&c->list_pub_wait_ack[idx].pub_start_time));
             c->list_pub_wait_ack[idx].node_state = IOTX_MC_NODE_STATE_INVALID; /* mark as invalid node */
         }
     }
@@ -922,6 +1659,34 @@ static int iotx_mc_mask_pubInfo_from(iotx_mc_client_t *c, uint16_t msgId)
     return SUCCESS_RETURN;
 }
 
+#ifdef PLATFORM_HAS_DYNMEM
+/*
+ * Release @num nodes pinned for writing, called with lock_list_pub held. Nodes dropped during the write are freed,
+ * and with @drop set the others are given up too.
+ */
+static void iotx_mc_pub_unpin(iotx_mc_client_t *c, void **pinned, int num, int drop)
+{
+    int idx = 0;
+    iotx_mc_pub_info_t *node = NULL;
+
+    for (idx = 0; idx < num; idx++) {
+        node = (iotx_mc_pub_info_t *)pinned[idx];
+        if (node == NULL) {
+            continue;
+        }
+        node->in_tx = 0;
+        if (node->dropped) {
+            mqtt_free(node);
+        } else if (drop) {
+            iotx_mc_drop_pubInfo(c, node);
+        }
+    }
+}
+#endif
+
+#if defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_VECTORED_PUB
+static int iotx_mc_tx_write(iotx_mc_client_t *c, hal_iovec_t *iov, int iovcnt);
+#else
 static int MQTTRePublish(iotx_mc_client_t *c, char *buf, int len)
 {
     iotx_time_t timer;
@@ -938,15 +1703,25 @@ static int MQTTRePublish(iotx_mc_client_t *c, char *buf, int len)
     HAL_MutexUnlock(c->lock_write_buf);
     return SUCCESS_RETURN;
 }
+#endif
 
+/*
+ * Republish QoS1 publishes whose PUBACK have not arrived before their retry deadline.
+ * Only due ones are visited, and no more than IOTX_MC_REPUB_NUM_PER_CYCLE of them in one cycle,
+ * so a backlog built up by a network hiccup is retransmitted gradually.
+ */
 static int MQTTPubInfoProc(iotx_mc_client_t *pClient)
 {
     int rc = 0;
-    iotx_mc_state_t state = IOTX_MC_STATE_INVALID;
-#ifdef PLATFORM_HAS_DYNMEM
-    iotx_mc_pub_info_t *node = NULL, *next_node = NULL;
-#else
+    int count = 0;
     int idx;
+#ifdef PLATFORM_HAS_DYNMEM
+    iotx_mc_pub_info_t *node = NULL;
+    void *pinned[IOTX_MC_REPUB_NUM_PER_CYCLE];
+#if WITH_MQTT_VECTORED_PUB
+    hal_iovec_t iov[IOTX_MC_REPUB_NUM_PER_CYCLE];
+#endif
+    int num = 0;
 #endif
 
     if (!pClient) {
@@ -954,36 +1729,63 @@ static int MQTTPubInfoProc(iotx_mc_client_t *pClient)
     }
 
     HAL_MutexLock(pClient->lock_list_pub);
+    if (iotx_mc_get_client_state(pClient) != IOTX_MC_STATE_CONNECTED) {
+        HAL_MutexUnlock(pClient->lock_list_pub);
+        return SUCCESS_RETURN;
+    }
+
 #ifdef PLATFORM_HAS_DYNMEM
-    list_for_each_entry_safe(node, next_node, &pClient->list_pub_wait_ack, linked_list, iotx_mc_pub_info_t) {
-        /* remove invalid node */
-        if (IOTX_MC_NODE_STATE_INVALID == node->node_state) {
-            list_del(&node->linked_list);
-            mqtt_free(node);
-            continue;
+    /* due nodes are pinned under the lock and written without it, so PUBACK and new publishes are not held up */
+    while (pClient->pub_inflight > 0 && count < IOTX_MC_REPUB_NUM_PER_CYCLE) {
+        node = pClient->pub_heap[0];
+        if (!utils_time_is_expired(&node->retry_time)) {
+            break;
         }
 
-        state = iotx_mc_get_client_state(pClient);
-        if (state != IOTX_MC_STATE_CONNECTED) {
-            continue;
-        }
+        iotx_mc_pub_retry_backoff(node);
+        iotx_mc_pub_heap_down(pClient, 0);
+        count++;
 
-        /* check the request if timeout or not */
-        if (utils_time_spend(&node->pub_start_time) <= (pClient->request_timeout_ms * 2)) {
+        /* its publisher is still writing it, it is not sent twice at once */
+        if (node->in_tx) {
             continue;
         }
+        node->in_tx = 1;
+        pinned[num++] = node;
+    }
+    HAL_MutexUnlock(pClient->lock_list_pub);
 
-        /* If wait ACK timeout, republish */
+    if (num == 0) {
+        return SUCCESS_RETURN;
+    }
+
+    /* If wait ACK timeout, republish */
+#if WITH_MQTT_VECTORED_PUB
+    for (idx = 0; idx < num; idx++) {
+        node = (iotx_mc_pub_info_t *)pinned[idx];
+        iov[idx].base = node->buf;
+        iov[idx].len = node->len;
+    }
+    rc = iotx_mc_tx_write(pClient, iov, num);
+#else
+    for (idx = 0; idx < num && rc == SUCCESS_RETURN; idx++) {
+        node = (iotx_mc_pub_info_t *)pinned[idx];
         rc = MQTTRePublish(pClient, (char *)node->buf, node->len);
-        iotx_time_start(&node->pub_start_time);
+    }
+#endif
+    IOTX_MC_STATS_ADD(pClient, republish_count, num);
 
-        if (MQTT_NETWORK_ERROR == rc) {
-            iotx_mc_set_client_state(pClient, IOTX_MC_STATE_DISCONNECTED);
-            break;
-        }
+    /* nodes are kept on failure, they are republished once connected again */
+    HAL_MutexLock(pClient->lock_list_pub);
+    iotx_mc_pub_unpin(pClient, pinned, num, 0);
+    HAL_MutexUnlock(pClient->lock_list_pub);
+
+    if (rc != SUCCESS_RETURN) {
+        iotx_mc_set_client_state(pClient, IOTX_MC_STATE_DISCONNECTED);
     }
 #else
-    for (idx = 0; idx < IOTX_MC_PUBWAIT_LIST_MAX_LEN; idx++) {
+    /* slots are reused and packed by publishers under lock_list_pub, which also send with it held */
+    for (idx = 0; idx < IOTX_MC_PUBWAIT_LIST_MAX_LEN && count < IOTX_MC_REPUB_NUM_PER_CYCLE; idx++) {
         if (pClient->list_pub_wait_ack[idx].used == 0) {
             continue;
         }
@@ -993,27 +1795,24 @@ static int MQTTPubInfoProc(iotx_mc_client_t *pClient)
             continue;
         }
 
-        state = iotx_mc_get_client_state(pClient);
-        if (state != IOTX_MC_STATE_CONNECTED) {
-            continue;
-        }
-
-        /* check the request if timeout or not */
-        if (utils_time_spend(&pClient->list_pub_wait_ack[idx].pub_start_time) <= (pClient->request_timeout_ms * 2)) {
+        if (!utils_time_is_expired(&pClient->list_pub_wait_ack[idx].retry_time)) {
             continue;
         }
 
         /* If wait ACK timeout, republish */
-        rc = MQTTRePublish(pClient, (char *)pClient->list_pub_wait_ack[idx].buf, pClient->list_pub_wait_ack[idx].len);
-        iotx_time_start(&pClient->list_pub_wait_ack[idx].pub_start_time);
+        rc = MQTTRePublish(pClient, (char *)IOTX_MC_PUB_BUF(pClient, &pClient->list_pub_wait_ack[idx]),
+                           pClient->list_pub_wait_ack[idx].len);
+        iotx_mc_pub_retry_backoff(&pClient->list_pub_wait_ack[idx]);
+        IOTX_MC_STATS_ADD(pClient, republish_count, 1);
+        count++;
 
         if (MQTT_NETWORK_ERROR == rc) {
             iotx_mc_set_client_state(pClient, IOTX_MC_STATE_DISCONNECTED);
             break;
         }
     }
-#endif
     HAL_MutexUnlock(pClient->lock_list_pub);
+#endif
 
     return SUCCESS_RETURN;
 }
@@ -1085,6 +1884,43 @@ static void _iotx_mqtt_event_handle_sub(void *pcontext, void *pclient, iotx_mqtt
     HAL_MutexUnlock(client->lock_generic);
 }
 
+/* hand granted QoS of each filter to the multi-filter subscribe waiting for SUBACK @packet_id */
+static void _iotx_mqtt_sub_granted(iotx_mc_client_t *client, uintptr_t packet_id, int *grantedQoS, int count)
+{
+    mqtt_sub_sync_node_t *node = NULL;
+    int idx;
+#ifdef PLATFORM_HAS_DYNMEM
+    mqtt_sub_sync_node_t *next = NULL;
+#endif
+
+    HAL_MutexLock(client->lock_generic);
+#ifdef PLATFORM_HAS_DYNMEM
+    list_for_each_entry_safe(node, next, &client->list_sub_sync_ack, linked_list, mqtt_sub_sync_node_t) {
+        if (node->packet_id == packet_id && node->sub_info != NULL) {
+            break;
+        }
+    }
+    if (&node->linked_list == &client->list_sub_sync_ack) {
+        node = NULL;
+    }
+#else
+    for (idx = 0; idx < IOTX_MC_SUBSYNC_LIST_MAX_LEN; idx++) {
+        if (client->list_sub_sync_ack[idx].used && client->list_sub_sync_ack[idx].packet_id == packet_id &&
+            client->list_sub_sync_ack[idx].sub_info != NULL) {
+            node = &client->list_sub_sync_ack[idx];
+            break;
+        }
+    }
+#endif
+    if (node != NULL) {
+        /* return codes of SUBACK are in the order of filters in SUBSCRIBE */
+        for (idx = 0; idx < count && idx < node->sub_count; idx++) {
+            node->sub_info[idx].granted = ((uint8_t)grantedQoS[idx] == 0x80) ? -1 : grantedQoS[idx];
+        }
+    }
+    HAL_MutexUnlock(client->lock_generic);
+}
+
 static int iotx_mc_handle_recv_SUBACK(iotx_mc_client_t *c)
 {
     unsigned short mypacketid;
@@ -1112,14 +1948,15 @@ static int iotx_mc_handle_recv_SUBACK(iotx_mc_client_t *c)
         mqtt_debug("%16s[%02d] : %d", "Granted QoS", i, grantedQoS[i]);
     }
 
+    fail_flag = 0;
     for (j = 0; j <  count; j++) {
-        fail_flag = 0;
         /* In negative case, grantedQoS will be 0xFFFF FF80, which means -128 */
         if ((uint8_t)grantedQoS[j] == 0x80) {
             fail_flag = 1;
             mqtt_err("MQTT SUBSCRIBE failed, ack code is 0x80");
         }
     }
+    _iotx_mqtt_sub_granted(c, mypacketid, grantedQoS, count);
 
     /* call callback function to notify that SUBSCRIBE is successful */
     msg.msg = (void *)(uintptr_t)mypacketid;
@@ -1155,6 +1992,8 @@ static int iotx_mc_get_zip_topic(const char *path, int len, char outbuf[], int o
 }
 #endif
 
+/* list walk of delivering and unsubscribing are its only callers */
+#if !(defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_TOPIC_TRIE) || WITH_MQTT_UNSUBSCRIBE
 static char iotx_mc_is_topic_matched(char *topicFilter, MQTTString *topicName)
 {
     char *curf;
@@ -1193,14 +2032,76 @@ static char iotx_mc_is_topic_matched(char *topicFilter, MQTTString *topicName)
 
     return (curn == curn_end) && (*curf == '\0');
 }
+#endif
 
+#if defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_TOPIC_TRIE
 static void iotx_mc_deliver_message(iotx_mc_client_t *c, MQTTString *topicName, iotx_mqtt_topic_info_pt topic_msg)
 {
     int flag_matched = 0;
-    MQTTString *compare_topic = NULL;
-#ifdef PLATFORM_HAS_DYNMEM
-    iotx_mc_topic_handle_t *node = NULL;
-#else
+    int idx = 0;
+    int match_num = 0;
+    iotx_mc_trie_match_t match_buf[IOTX_MC_TOPIC_MATCH_NUM];
+    iotx_mc_trie_match_t *matches = match_buf;
+
+    if (!c || !topicName || !topic_msg) {
+        return;
+    }
+
+    topic_msg->ptopic = topicName->lenstring.data;
+    topic_msg->topic_len = topicName->lenstring.len;
+
+    /* collect all handles matched by topic in one pass, then call them without lock */
+    HAL_MutexLock(c->lock_generic);
+    match_num = iotx_mc_trie_match(&c->topic_trie, topicName->lenstring.data, topicName->lenstring.len,
+                                   match_buf, IOTX_MC_TOPIC_MATCH_NUM);
+    if (match_num > IOTX_MC_TOPIC_MATCH_NUM) {
+        matches = mqtt_malloc(sizeof(iotx_mc_trie_match_t) * match_num);
+        if (matches == NULL) {
+            mqtt_err("too many matched handles: %d, deliver to first %d", match_num, IOTX_MC_TOPIC_MATCH_NUM);
+            matches = match_buf;
+            match_num = IOTX_MC_TOPIC_MATCH_NUM;
+        } else {
+            match_num = iotx_mc_trie_match(&c->topic_trie, topicName->lenstring.data, topicName->lenstring.len,
+                                           matches, match_num);
+        }
+    }
+    HAL_MutexUnlock(c->lock_generic);
+
+    for (idx = 0; idx < match_num; idx++) {
+        mqtt_debug("topic be matched");
+        if (NULL != matches[idx].handle.h_fp) {
+            iotx_mqtt_event_msg_t msg;
+            msg.event_type = IOTX_MQTT_EVENT_PUBLISH_RECEIVED;
+            msg.msg = (void *)topic_msg;
+            _handle_event(&matches[idx].handle, c, &msg);
+            flag_matched = 1;
+        }
+    }
+
+    if (matches != match_buf) {
+        mqtt_free(matches);
+    }
+
+    if (0 == flag_matched) {
+        mqtt_info("NO matching any topic, call default handle function");
+
+        if (NULL != c->handle_event.h_fp) {
+            iotx_mqtt_event_msg_t msg;
+
+            msg.event_type = IOTX_MQTT_EVENT_PUBLISH_RECEIVED;
+            msg.msg = topic_msg;
+            _handle_event(&c->handle_event, c, &msg);
+        }
+    }
+}
+#else
+static void iotx_mc_deliver_message(iotx_mc_client_t *c, MQTTString *topicName, iotx_mqtt_topic_info_pt topic_msg)
+{
+    int flag_matched = 0;
+    MQTTString *compare_topic = NULL;
+#ifdef PLATFORM_HAS_DYNMEM
+    iotx_mc_topic_handle_t *node = NULL;
+#else
     int idx = 0;
 #endif
 
@@ -1287,6 +2188,30 @@ static void iotx_mc_deliver_message(iotx_mc_client_t *c, MQTTString *topicName,
         }
     }
 }
+#endif  /* #if defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_TOPIC_TRIE */
+
+#ifdef MQTT_DISPATCH
+/* called by dispatch worker with a PUBLISH copied out of read buffer */
+static void iotx_mc_dispatch_deliver(void *client, iotx_mc_dispatch_msg_t *msg)
+{
+    MQTTString topicName;
+    iotx_mqtt_topic_info_t topic_msg;
+
+    memset(&topicName, 0, sizeof(MQTTString));
+    topicName.lenstring.data = (char *)(msg + 1);
+    topicName.lenstring.len = msg->topic_len;
+
+    memset(&topic_msg, 0, sizeof(iotx_mqtt_topic_info_t));
+    topic_msg.packet_id = msg->packet_id;
+    topic_msg.qos = msg->qos;
+    topic_msg.dup = msg->dup;
+    topic_msg.retain = msg->retain;
+    topic_msg.payload = (char *)(msg + 1) + msg->topic_len + 1;
+    topic_msg.payload_len = msg->payload_len;
+
+    iotx_mc_deliver_message((iotx_mc_client_t *)client, &topicName, &topic_msg);
+}
+#endif
 
 static int MQTTPuback(iotx_mc_client_t *c, unsigned int msgId, enum msgTypes type)
 {
@@ -1383,6 +2308,7 @@ static int iotx_mc_handle_recv_PUBLISH(iotx_mc_client_t *c)
         mqtt_err("Null topicName");
         return MQTT_PUBLISH_PACKET_ERROR;
     }
+    IOTX_MC_STATS_ADD(c, recv_count, 1);
 
 #ifdef INFRA_LOG_NETWORK_PAYLOAD
 
@@ -1441,7 +2367,23 @@ static int iotx_mc_handle_recv_PUBLISH(iotx_mc_client_t *c)
     }
 #endif
 
+#ifdef MQTT_DISPATCH
+    if (c->dispatch != NULL) {
+        /* handlers run on worker, PUBLISH is only acknowledged here once it is queued */
+        if (iotx_mc_dispatch_push(c->dispatch, topicName.lenstring.data, topicName.lenstring.len,
+                                  &topic_msg) != SUCCESS_RETURN) {
+            mqtt_warning("dispatch queue full, drop PUBLISH of '%.*s'", topicName.lenstring.len,
+                         topicName.lenstring.data);
+            IOTX_MC_STATS_ADD(c, dispatch_dropped, 1);
+            /* no PUBACK, so that QoS1 PUBLISH is sent again by server */
+            return SUCCESS_RETURN;
+        }
+    } else {
+        iotx_mc_deliver_message(c, &topicName, &topic_msg);
+    }
+#else
     iotx_mc_deliver_message(c, &topicName, &topic_msg);
+#endif
 
     if (topic_msg.qos == IOTX_MQTT_QOS0) {
         return SUCCESS_RETURN;
@@ -1457,6 +2399,7 @@ static int iotx_mc_handle_recv_PUBLISH(iotx_mc_client_t *c)
     return result;
 }
 
+#if WITH_MQTT_UNSUBSCRIBE
 static int iotx_mc_handle_recv_UNSUBACK(iotx_mc_client_t *c)
 {
     unsigned short mypacketid = 0;  /* should be the same as the packetid above */
@@ -1477,55 +2420,60 @@ static int iotx_mc_handle_recv_UNSUBACK(iotx_mc_client_t *c)
 
     return SUCCESS_RETURN;
 }
+#endif
 
-static int iotx_mc_cycle(iotx_mc_client_t *c, iotx_time_t *timer)
+/* PINGREQ after a whole idle time is answered, so the NAT keeps mapping for that long and longer is tried */
+static void iotx_mc_keepalive_survived(iotx_mc_client_t *c)
 {
-    unsigned int packetType;
-    iotx_mc_state_t state;
-    int rc = SUCCESS_RETURN;
+    uint32_t next_ms;
 
-    if (!c) {
-        return FAIL_RETURN;
+    if (!c->keepalive_idle_ping) {
+        return;
     }
+    c->keepalive_idle_ping = 0;
 
-    state = iotx_mc_get_client_state(c);
-    if (state != IOTX_MC_STATE_CONNECTED) {
-        mqtt_debug("state = %d", state);
-        return MQTT_STATE_ERROR;
+    if (c->keepalive_good_ms < c->keepalive_ms) {
+        c->keepalive_good_ms = c->keepalive_ms;
     }
-
-    if (IOTX_MC_KEEPALIVE_PROBE_MAX < c->keepalive_probes) {
-        iotx_mc_set_client_state(c, IOTX_MC_STATE_DISCONNECTED);
-        c->keepalive_probes = 0;
-        mqtt_debug("keepalive_probes more than %u, disconnected\n", IOTX_MC_KEEPALIVE_PROBE_MAX);
+    next_ms = c->keepalive_ms + c->keepalive_step_ms;
+    if (next_ms > c->keepalive_max_ms) {
+        next_ms = c->keepalive_max_ms;
     }
-
-    /* read the socket, see what work is due */
-    rc = iotx_mc_read_packet(c, timer, &packetType);
-    if (rc != SUCCESS_RETURN) {
-        HAL_MutexLock(c->lock_read_buf);
-        _reset_recv_buffer(c);
-        HAL_MutexUnlock(c->lock_read_buf);
-        if (rc == MQTT_NETWORK_ERROR) {
-            iotx_mc_set_client_state(c, IOTX_MC_STATE_DISCONNECTED);
-        }
-        mqtt_err("readPacket error,result = %d", rc);
-        return MQTT_NETWORK_ERROR;
+    if (c->keepalive_bad_ms != 0 && next_ms >= c->keepalive_bad_ms) {
+        next_ms = c->keepalive_ms;
     }
-
-    if (MQTT_CPT_RESERVED == packetType) {
-        /* mqtt_debug("wait data timeout"); */
-        HAL_MutexLock(c->lock_read_buf);
-        _reset_recv_buffer(c);
-        HAL_MutexUnlock(c->lock_read_buf);
-        return SUCCESS_RETURN;
+    if (next_ms != c->keepalive_ms) {
+        mqtt_debug("keepalive %u ms survived, try %u ms", c->keepalive_ms, next_ms);
+        c->keepalive_ms = next_ms;
+        IOTX_MC_STATS_SET(c, keepalive_ms, next_ms);
     }
+}
+
+/* PINGREQ not answered, idle time probed is taken as too long for the NAT when the link was idle for it */
+static void iotx_mc_keepalive_lost(iotx_mc_client_t *c)
+{
+    iotx_mc_set_client_state(c, IOTX_MC_STATE_DISCONNECTED);
 
-    /* clear ping mark when any data received from MQTT broker */
     HAL_MutexLock(c->lock_generic);
     c->keepalive_probes = 0;
+    IOTX_MC_STATS_ADD(c, keepalive_fail, 1);
+    if (c->keepalive_idle_ping && c->keepalive_ms > c->keepalive_min_ms) {
+        c->keepalive_bad_ms = c->keepalive_ms;
+        c->keepalive_ms = (c->keepalive_good_ms > c->keepalive_min_ms) ? c->keepalive_good_ms : c->keepalive_min_ms;
+        IOTX_MC_STATS_SET(c, keepalive_ms, c->keepalive_ms);
+        mqtt_debug("keepalive %u ms lost, back to %u ms", c->keepalive_bad_ms, c->keepalive_ms);
+    }
+    c->keepalive_idle_ping = 0;
     HAL_MutexUnlock(c->lock_generic);
-    HAL_MutexLock(c->lock_read_buf);
+
+    mqtt_debug("keepalive_probes more than %u, disconnected\n", c->keepalive_probe_max);
+}
+
+/* handle the packet at the head of receive buffer, called with lock_yield held */
+static int iotx_mc_handle_packet(iotx_mc_client_t *c, unsigned int packetType)
+{
+    int rc = SUCCESS_RETURN;
+
     switch (packetType) {
         case CONNACK: {
             mqtt_debug("CONNACK");
@@ -1560,6 +2508,7 @@ static int iotx_mc_cycle(iotx_mc_client_t *c, iotx_time_t *timer)
             }
             break;
         }
+#if WITH_MQTT_UNSUBSCRIBE
         case UNSUBACK: {
             mqtt_debug("UNSUBACK");
             rc = iotx_mc_handle_recv_UNSUBACK(c);
@@ -1568,19 +2517,72 @@ static int iotx_mc_cycle(iotx_mc_client_t *c, iotx_time_t *timer)
             }
             break;
         }
+#endif
         case PINGRESP: {
             rc = SUCCESS_RETURN;
             mqtt_info("receive ping response!");
+            HAL_MutexLock(c->lock_generic);
+            iotx_mc_keepalive_survived(c);
+            HAL_MutexUnlock(c->lock_generic);
             break;
         }
         default:
             mqtt_err("INVALID TYPE");
-            _reset_recv_buffer(c);
-            HAL_MutexUnlock(c->lock_read_buf);
             return FAIL_RETURN;
     }
-    _reset_recv_buffer(c);
-    HAL_MutexUnlock(c->lock_read_buf);
+
+    return rc;
+}
+
+static int iotx_mc_cycle(iotx_mc_client_t *c, iotx_time_t *timer)
+{
+    unsigned int packetType;
+    iotx_mc_state_t state;
+    int rc = SUCCESS_RETURN;
+    int buffered = 0;
+
+    if (!c) {
+        return FAIL_RETURN;
+    }
+
+    state = iotx_mc_get_client_state(c);
+    if (state != IOTX_MC_STATE_CONNECTED) {
+        mqtt_debug("state = %d", state);
+        return MQTT_STATE_ERROR;
+    }
+
+    if (c->keepalive_probe_max < c->keepalive_probes) {
+        iotx_mc_keepalive_lost(c);
+    }
+
+    /* handle all the packets received by one read, rather than one packet a cycle */
+    do {
+        /* read the socket, see what work is due */
+        rc = iotx_mc_read_packet(c, timer, &packetType);
+        if (rc != SUCCESS_RETURN) {
+            _reset_recv_buffer(c);
+            if (rc == MQTT_NETWORK_ERROR) {
+                iotx_mc_set_client_state(c, IOTX_MC_STATE_DISCONNECTED);
+            }
+            mqtt_err("readPacket error,result = %d", rc);
+            return MQTT_NETWORK_ERROR;
+        }
+
+        if (MQTT_CPT_RESERVED == packetType) {
+            /* mqtt_debug("wait data timeout"); */
+            _reset_recv_buffer(c);
+            return SUCCESS_RETURN;
+        }
+
+        /* clear ping mark when any data received from MQTT broker */
+        HAL_MutexLock(c->lock_generic);
+        c->keepalive_probes = 0;
+        HAL_MutexUnlock(c->lock_generic);
+        rc = iotx_mc_handle_packet(c, packetType);
+        _reset_recv_buffer(c);
+        buffered = iotx_mc_packet_buffered(c);
+    } while (rc == SUCCESS_RETURN && buffered);
+
     return rc;
 }
 
@@ -1672,6 +2674,9 @@ static int iotx_mc_keepalive_sub(iotx_mc_client_t *pClient)
 {
 
     int rc = SUCCESS_RETURN;
+    uint32_t idle_ms;
+    uint32_t tx_idle;
+    uint32_t rx_idle;
 
     if (NULL == pClient) {
         return NULL_VALUE_ERROR;
@@ -1687,8 +2692,28 @@ static int iotx_mc_keepalive_sub(iotx_mc_client_t *pClient)
         return SUCCESS_RETURN;
     }
 
+    /*
+     * Server only needs something sent in keepalive, and receiving proves the link, so PINGREQ is left out
+     * while packets are sent within the idle time, or received within twice of it.
+     */
+    HAL_MutexLock(pClient->lock_generic);
+    idle_ms = pClient->keepalive_ms;
+    HAL_MutexUnlock(pClient->lock_generic);
+    tx_idle = utils_time_spend(&pClient->last_tx_time);
+    rx_idle = utils_time_spend(&pClient->last_rx_time);
+    if (tx_idle < idle_ms && rx_idle < idle_ms * 2) {
+        uint32_t next_ms = idle_ms - tx_idle;
+
+        if (next_ms > idle_ms * 2 - rx_idle) {
+            next_ms = idle_ms * 2 - rx_idle;
+        }
+        utils_time_countdown_ms(&pClient->next_ping_time, next_ms);
+        IOTX_MC_STATS_ADD(pClient, ping_skipped, 1);
+        return SUCCESS_RETURN;
+    }
+
     /* update to next time sending MQTT keep-alive */
-    utils_time_countdown_ms(&pClient->next_ping_time, pClient->connect_data.keepAliveInterval * 1000);
+    utils_time_countdown_ms(&pClient->next_ping_time, idle_ms);
 
     rc = MQTTKeepalive(pClient);
     if (SUCCESS_RETURN != rc) {
@@ -1703,6 +2728,11 @@ static int iotx_mc_keepalive_sub(iotx_mc_client_t *pClient)
 
     HAL_MutexLock(pClient->lock_generic);
     pClient->keepalive_probes++;
+    IOTX_MC_STATS_ADD(pClient, ping_count, 1);
+    /* only a PINGREQ after the link was idle for the whole time tells how long NAT keeps mapping */
+    if (pClient->keepalive_probes == 1) {
+        pClient->keepalive_idle_ping = (tx_idle >= idle_ms && rx_idle >= idle_ms);
+    }
     HAL_MutexUnlock(pClient->lock_generic);
 
     return SUCCESS_RETURN;
@@ -1733,18 +2763,122 @@ static int iotx_mc_attempt_reconnect(iotx_mc_client_t *pClient)
     return rc;
 }
 
+static uint32_t iotx_mc_backoff_random(iotx_mc_client_t *pClient, uint32_t low, uint32_t high)
+{
+    uint32_t x = pClient->reconnect_param.seed;
+
+    /* xorshift32 */
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    pClient->reconnect_param.seed = x;
+
+    return (high > low) ? low + x % (high - low + 1) : low;
+}
+
+/* decorrelated jitter: random between base and 3 times the last interval, within cap */
+static uint32_t iotx_mc_backoff_jitter(iotx_mc_client_t *pClient, uint32_t last_ms,
+                                       const iotx_mqtt_backoff_policy_t *policy)
+{
+    uint32_t high = (last_ms > policy->cap_ms / 3) ? policy->cap_ms : last_ms * 3;
+
+    if (high < policy->base_ms) {
+        high = policy->base_ms;
+    }
+    return iotx_mc_backoff_random(pClient, policy->base_ms, high);
+}
+
+static iotx_mqtt_reconnect_class_t iotx_mc_reconnect_class(int rc)
+{
+    switch (rc) {
+        case MQTT_CONNACK_SERVER_UNAVAILABLE_ERROR:
+            return IOTX_MQTT_RECONNECT_UNAVAILABLE;
+        case MQTT_CONANCK_UNACCEPTABLE_PROTOCOL_VERSION_ERROR:
+        case MQTT_CONNACK_IDENTIFIER_REJECTED_ERROR:
+        case MQTT_CONNACK_BAD_USERDATA_ERROR:
+        case MQTT_CONNACK_NOT_AUTHORIZED_ERROR:
+            return IOTX_MQTT_RECONNECT_REJECTED;
+        default:
+            return IOTX_MQTT_RECONNECT_NETWORK;
+    }
+}
+
+/* connection is lost, the first reconnect is at a random time within base interval, not at once by all devices */
+static void iotx_mc_backoff_start(iotx_mc_client_t *pClient)
+{
+    iotx_mc_reconnect_param_t *param = &pClient->reconnect_param;
+    uint32_t base_ms;
+
+    HAL_MutexLock(pClient->lock_generic);
+    param->attempts = 0;
+    param->err_class = IOTX_MQTT_RECONNECT_NETWORK;
+    base_ms = param->policy[IOTX_MQTT_RECONNECT_NETWORK].base_ms;
+    param->reconnect_time_interval_ms = iotx_mc_backoff_random(pClient, 0, base_ms);
+    HAL_MutexUnlock(pClient->lock_generic);
+
+    utils_time_countdown_ms(&param->reconnect_next_time, param->reconnect_time_interval_ms);
+}
+
+/* reconnect failed with @rc, schedule the next one by policy of its class */
+static void iotx_mc_backoff_next(iotx_mc_client_t *pClient, int rc)
+{
+    iotx_mc_reconnect_param_t *param = &pClient->reconnect_param;
+    iotx_mqtt_reconnect_class_t err_class = iotx_mc_reconnect_class(rc);
+    iotx_mqtt_backoff_policy_t policy;
+    iotx_mqtt_backoff_fpt backoff;
+    void *pcontext;
+    uint32_t last_ms, interval_ms;
+
+    HAL_MutexLock(pClient->lock_generic);
+    if (param->attempts == 0 || param->err_class != err_class) {
+        param->attempts = 0;
+        param->err_class = err_class;
+        param->reconnect_time_interval_ms = param->policy[err_class].base_ms;
+    }
+    param->attempts++;
+    policy = param->policy[err_class];
+    backoff = param->backoff;
+    pcontext = param->backoff_context;
+    last_ms = param->reconnect_time_interval_ms;
+    HAL_MutexUnlock(pClient->lock_generic);
+
+    if (backoff != NULL) {
+        interval_ms = backoff(pcontext, err_class, param->attempts, last_ms, &policy);
+    } else {
+        interval_ms = iotx_mc_backoff_jitter(pClient, last_ms, &policy);
+    }
+    param->reconnect_time_interval_ms = interval_ms;
+    utils_time_countdown_ms(&param->reconnect_next_time, interval_ms);
+
+    mqtt_info("reconnect failed %u times for class %d, next in %u ms", param->attempts, err_class, interval_ms);
+}
+
 static int iotx_mc_handle_reconnect(iotx_mc_client_t *pClient)
 {
     int             rc = FAIL_RETURN;
-    uint32_t        interval_ms = 0;
+    uint8_t         link_up;
 
     if (NULL == pClient) {
         return NULL_VALUE_ERROR;
     }
     mqtt_info("Waiting to reconnect...");
+    HAL_MutexLock(pClient->lock_generic);
+    link_up = pClient->reconnect_param.link_up;
+    pClient->reconnect_param.link_up = 0;
+    HAL_MutexUnlock(pClient->lock_generic);
+    if (link_up) {
+        /* link is back, what the network class waited for is gone */
+        if (pClient->reconnect_param.err_class == IOTX_MQTT_RECONNECT_NETWORK &&
+            iotx_mc_get_client_state(pClient) == IOTX_MC_STATE_DISCONNECTED_RECONNECTING) {
+            mqtt_info("link is up, reconnect at once");
+            utils_time_countdown_ms(&pClient->reconnect_param.reconnect_next_time, 0);
+        }
+    }
     if (!utils_time_is_expired(&(pClient->reconnect_param.reconnect_next_time))) {
         /* Timer has not expired. Not time to attempt reconnect yet. Return attempting reconnect */
+#ifndef ASYNC_PROTOCOL_STACK
         HAL_SleepMs(100);
+#endif
         return FAIL_RETURN;
     }
 
@@ -1757,6 +2891,7 @@ static int iotx_mc_handle_reconnect(iotx_mc_client_t *pClient)
         }
     */
     rc = iotx_mc_attempt_reconnect(pClient);
+    IOTX_MC_STATS_ADD(pClient, reconnect_count, 1);
     if (SUCCESS_RETURN == rc) {
         iotx_mc_set_client_state(pClient, IOTX_MC_STATE_CONNECTED);
         /*
@@ -1766,22 +2901,12 @@ static int iotx_mc_handle_reconnect(iotx_mc_client_t *pClient)
     } else if (MQTT_CONNECT_BLOCK == rc) {
         return rc;
     } else {
-        /* if reconnect network failed, then increase currentReconnectWaitInterval */
-        /* e.g. init currentReconnectWaitInterval=1s, reconnect failed, then 2s..4s..8s */
-        if (IOTX_MC_RECONNECT_INTERVAL_MAX_MS > pClient->reconnect_param.reconnect_time_interval_ms) {
-            pClient->reconnect_param.reconnect_time_interval_ms *= 2;
-        } else {
-            pClient->reconnect_param.reconnect_time_interval_ms = IOTX_MC_RECONNECT_INTERVAL_MAX_MS;
-        }
+        IOTX_MC_STATS_ADD(pClient, reconnect_fail, 1);
     }
     /*
         _conn_info_dynamic_reload_clear(pClient);
     */
-    interval_ms = pClient->reconnect_param.reconnect_time_interval_ms;
-    if (IOTX_MC_RECONNECT_INTERVAL_MAX_MS < interval_ms) {
-        interval_ms = IOTX_MC_RECONNECT_INTERVAL_MAX_MS;
-    }
-    utils_time_countdown_ms(&(pClient->reconnect_param.reconnect_next_time), interval_ms);
+    iotx_mc_backoff_next(pClient, rc);
 
     mqtt_err("mqtt reconnect failed rc = %d", rc);
 
@@ -1805,6 +2930,9 @@ static void iotx_mc_reconnect_callback(iotx_mc_client_t *pClient)
 
 static void iotx_mc_disconnect_callback(iotx_mc_client_t *pClient)
 {
+    IOTX_MC_STATS_ADD(pClient, disconnect_count, 1);
+    iotx_time_start(&pClient->disconnect_time);
+    pClient->reconnect_timing = 1;
 
     if (NULL != pClient->handle_event.h_fp) {
         iotx_mqtt_event_msg_t msg;
@@ -1843,7 +2971,7 @@ static void iotx_mc_keepalive(iotx_mc_client_t *pClient)
             } else {
                 mqtt_info("network is reconnected!");
                 iotx_mc_reconnect_callback(pClient);
-                pClient->reconnect_param.reconnect_time_interval_ms = IOTX_MC_RECONNECT_INTERVAL_MIN_MS;
+                pClient->reconnect_param.attempts = 0;
             }
 
             break;
@@ -1854,9 +2982,7 @@ static void iotx_mc_keepalive(iotx_mc_client_t *pClient)
             mqtt_err("network is disconnected!");
             iotx_mc_disconnect_callback(pClient);
 
-            pClient->reconnect_param.reconnect_time_interval_ms = IOTX_MC_RECONNECT_INTERVAL_MIN_MS;
-            utils_time_countdown_ms(&(pClient->reconnect_param.reconnect_next_time),
-                                    pClient->reconnect_param.reconnect_time_interval_ms);
+            iotx_mc_backoff_start(pClient);
 
             pClient->ipstack.disconnect(&pClient->ipstack);
             iotx_mc_set_client_state(pClient, IOTX_MC_STATE_DISCONNECTED_RECONNECTING);
@@ -1937,31 +3063,16 @@ static int iotx_mc_check_handle_is_identical(iotx_mc_topic_handle_t *messageHand
     return 0;
 }
 
-static int MQTTSubscribe(iotx_mc_client_t *c, const char *topicFilter, iotx_mqtt_qos_t qos, unsigned int msgId,
-                         iotx_mqtt_event_handle_func_fpt messageHandler, void *pcontext)
+/* make handle of @topicFilter, which is added to list_sub_handle by iotx_mc_add_sub_handle() */
+static int iotx_mc_new_sub_handle(iotx_mc_client_t *c, const char *topicFilter,
+                                  iotx_mqtt_event_handle_func_fpt messageHandler, void *pcontext,
+                                  iotx_mc_topic_handle_t **handle)
 {
-    int                         len = 0;
-    iotx_time_t                 timer;
-    MQTTString                  topic = MQTTString_initializer;
-    /*iotx_mc_topic_handle_t handler = {topicFilter, {messageHandler, pcontext}};*/
     iotx_mc_topic_handle_t     *handler = NULL;
 #ifndef PLATFORM_HAS_DYNMEM
     int idx = 0;
 #endif
 
-    if (!c || !topicFilter || !messageHandler) {
-        return FAIL_RETURN;
-    }
-#if !( WITH_MQTT_DYN_BUF)
-    if (!c->buf_send) {
-        return FAIL_RETURN;
-    }
-#endif
-
-    topic.cstring = (char *)topicFilter;
-    iotx_time_init(&timer);
-    utils_time_countdown_ms(&timer, c->request_timeout_ms);
-
 #ifdef PLATFORM_HAS_DYNMEM
     handler = mqtt_malloc(sizeof(iotx_mc_topic_handle_t));
     if (NULL == handler) {
@@ -2050,106 +3161,153 @@ static int MQTTSubscribe(iotx_mc_client_t *c, const char *topicFilter, iotx_mqtt
     handler->handle.h_fp = messageHandler;
     handler->handle.pcontext = pcontext;
 
-#ifdef SUB_PERSISTENCE_ENABLED
-    if (qos == IOTX_MQTT_QOS3_SUB_LOCAL) {
-        uint8_t dup = 0;
+    *handle = handler;
+    return SUCCESS_RETURN;
+}
+
+static void iotx_mc_free_sub_handle(iotx_mc_topic_handle_t *handler)
+{
 #ifdef PLATFORM_HAS_DYNMEM
-        iotx_mc_topic_handle_t *node;
+    mqtt_free(handler->topic_filter);
+    mqtt_free(handler);
+#else
+    memset(handler, 0, sizeof(iotx_mc_topic_handle_t));
 #endif
-        HAL_MutexLock(c->lock_generic);
+}
+
+/* add @handler to list_sub_handle, it is freed if the same topic and callback function are subscribed already */
+static int iotx_mc_add_sub_handle(iotx_mc_client_t *c, iotx_mc_topic_handle_t *handler, const char *topicFilter)
+{
+    uint8_t dup = 0;
+#ifdef PLATFORM_HAS_DYNMEM
+    iotx_mc_topic_handle_t *node;
+#else
+    int idx = 0;
+#endif
+
+    HAL_MutexLock(c->lock_generic);
 #ifdef PLATFORM_HAS_DYNMEM
 #if defined(INSPECT_MQTT_FLOW) && defined (INFRA_LOG)
 #if WITH_MQTT_ZIP_TOPIC
-        HEXDUMP_DEBUG(handler->topic_filter, MQTT_ZIP_PATH_DEFAULT_LEN);
+    HEXDUMP_DEBUG(handler->topic_filter, MQTT_ZIP_PATH_DEFAULT_LEN);
 #else
-        mqtt_warning("handler->topic: %s", handler->topic_filter);
+    mqtt_warning("handler->topic: %s", handler->topic_filter);
 #endif
 #endif
-        list_for_each_entry(node, &c->list_sub_handle, linked_list, iotx_mc_topic_handle_t) {
-            /* If subscribe the same topic and callback function, then ignore */
+    list_for_each_entry(node, &c->list_sub_handle, linked_list, iotx_mc_topic_handle_t) {
+        /* If subscribe the same topic and callback function, then ignore */
 #if defined(INSPECT_MQTT_FLOW) && defined (INFRA_LOG)
 #if WITH_MQTT_ZIP_TOPIC
-            HEXDUMP_DEBUG(node->topic_filter, MQTT_ZIP_PATH_DEFAULT_LEN);
+        HEXDUMP_DEBUG(node->topic_filter, MQTT_ZIP_PATH_DEFAULT_LEN);
 #else
-            mqtt_warning("node->topic: %s", node->topic_filter);
+        mqtt_warning("node->topic: %s", node->topic_filter);
 #endif
 #endif
-            if (0 == iotx_mc_check_handle_is_identical(node, handler)) {
-                mqtt_warning("dup sub,topic = %s", topicFilter);
-                dup = 1;
-            }
+        if (0 == iotx_mc_check_handle_is_identical(node, handler)) {
+            mqtt_warning("dup sub,topic = %s", topicFilter);
+            dup = 1;
         }
+    }
 #else
-        for (idx = 0; idx < IOTX_MC_SUBHANDLE_LIST_MAX_LEN; idx++) {
-            /* If subscribe the same topic and callback function, then ignore */
-            if (&c->list_sub_handle[idx] != handler &&
-                0 == iotx_mc_check_handle_is_identical(&c->list_sub_handle[idx], handler)) {
-                mqtt_warning("dup sub,topic = %s", topicFilter);
-                dup = 1;
-            }
+    for (idx = 0; idx < IOTX_MC_SUBHANDLE_LIST_MAX_LEN; idx++) {
+        /* If subscribe the same topic and callback function, then ignore */
+        if (&c->list_sub_handle[idx] != handler &&
+            0 == iotx_mc_check_handle_is_identical(&c->list_sub_handle[idx], handler)) {
+            mqtt_warning("dup sub,topic = %s", topicFilter);
+            dup = 1;
         }
+    }
 #endif
-        if (dup == 0) {
+    if (dup == 0) {
 #ifdef PLATFORM_HAS_DYNMEM
-            list_add_tail(&handler->linked_list, &c->list_sub_handle);
+        list_add_tail(&handler->linked_list, &c->list_sub_handle);
+#if WITH_MQTT_TOPIC_TRIE
+        if (iotx_mc_trie_insert(&c->topic_trie, topicFilter, handler) != SUCCESS_RETURN) {
+            list_del(&handler->linked_list);
+            iotx_mc_free_sub_handle(handler);
+            HAL_MutexUnlock(c->lock_generic);
+            return FAIL_RETURN;
+        }
 #endif
-        } else {
-#ifdef PLATFORM_HAS_DYNMEM
-            mqtt_free(handler->topic_filter);
-            mqtt_free(handler);
-#else
-            memset(handler, 0, sizeof(iotx_mc_topic_handle_t));
 #endif
-        }
-        HAL_MutexUnlock(c->lock_generic);
-        return SUCCESS_RETURN;
+    } else {
+        iotx_mc_free_sub_handle(handler);
     }
-#endif
+    HAL_MutexUnlock(c->lock_generic);
 
-    HAL_MutexLock(c->lock_write_buf);
+    return SUCCESS_RETURN;
+}
 
-    if (_alloc_send_buffer(c, strlen(topicFilter)) < 0) {
-        HAL_MutexUnlock(c->lock_write_buf);
-#ifdef PLATFORM_HAS_DYNMEM
-        mqtt_free(handler->topic_filter);
-        mqtt_free(handler);
+/* number of filters from @sub_info which fit in one SUBSCRIBE, at least one */
+static int iotx_mc_sub_multi_fit(iotx_mc_client_t *c, iotx_mutli_sub_info_t *sub_info, int count)
+{
+    MQTTString topic[MUTLI_SUBSCIRBE_MAX];
+    uint32_t capacity;
+    int num;
+
+#if defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_DYN_BUF
+    capacity = c->buf_size_send_max;
 #else
-        memset(handler, 0, sizeof(iotx_mc_topic_handle_t));
+    capacity = c->buf_size_send;
 #endif
-        return FAIL_RETURN;
-    }
 
-    len = MQTTSerialize_subscribe((unsigned char *)c->buf_send, c->buf_size_send, 0, (unsigned short)msgId, 1, &topic,
-                                  (int *)&qos);
-    if (len <= 0) {
-#ifdef PLATFORM_HAS_DYNMEM
-        mqtt_free(handler->topic_filter);
-        mqtt_free(handler);
-#else
-        memset(handler, 0, sizeof(iotx_mc_topic_handle_t));
+    memset(topic, 0, sizeof(topic));
+    for (num = 0; num < count && num < MUTLI_SUBSCIRBE_MAX; num++) {
+#ifdef SUB_PERSISTENCE_ENABLED
+        /* local subscription is not sent to broker */
+        if (sub_info[num].qos == IOTX_MQTT_QOS3_SUB_LOCAL) {
+            break;
+        }
 #endif
+        topic[num].cstring = (char *)sub_info[num].topicFilter;
+        if (num > 0 && MQTTPacket_len(MQTTSerialize_subscribeLength(num + 1, topic)) > capacity) {
+            break;
+        }
+    }
+
+    return (num > 0) ? num : 1;
+}
+
+/* send one SUBSCRIBE carrying the @count filters of @topic and @qos */
+static int iotx_mc_send_subscribe(iotx_mc_client_t *c, MQTTString *topic, int *qos, int count, unsigned int msgId)
+{
+    int                         idx, rc, len = 0, topic_len = 0;
+    iotx_time_t                 timer;
+
+    for (idx = 0; idx < count; idx++) {
+        topic_len += strlen(topic[idx].cstring) + 3;
+    }
+
+    iotx_time_init(&timer);
+    utils_time_countdown_ms(&timer, c->request_timeout_ms);
+
+    HAL_MutexLock(c->lock_write_buf);
+
+    rc = MQTT_SUBSCRIBE_PACKET_ERROR;
+    if (_alloc_send_buffer(c, topic_len) < 0) {
+        rc = FAIL_RETURN;
+    } else {
+        len = MQTTSerialize_subscribe((unsigned char *)c->buf_send, c->buf_size_send, 0, (unsigned short)msgId, count,
+                                      topic, qos);
+    }
+    if (len <= 0) {
         _reset_send_buffer(c);
         HAL_MutexUnlock(c->lock_write_buf);
-        return MQTT_SUBSCRIBE_PACKET_ERROR;
+        return rc;
     }
 
     mqtt_debug("%20s : %08d", "Packet Ident", msgId);
-    mqtt_debug("%20s : %s", "Topic", topicFilter);
-    mqtt_debug("%20s : %d", "QoS", (int)qos);
+    for (idx = 0; idx < count; idx++) {
+        mqtt_debug("%20s : %s", "Topic", topic[idx].cstring);
+        mqtt_debug("%20s : %d", "QoS", qos[idx]);
+    }
     mqtt_debug("%20s : %d", "Packet Length", len);
 #if defined(INSPECT_MQTT_FLOW) && defined (INFRA_LOG)
     HEXDUMP_DEBUG(c->buf_send, len);
 #endif
 
     if ((iotx_mc_send_packet(c, c->buf_send, len, &timer)) != SUCCESS_RETURN) { /* send the subscribe packet */
-        /* If send failed, remove it */
         mqtt_err("run sendPacket error!");
-#ifdef PLATFORM_HAS_DYNMEM
-        mqtt_free(handler->topic_filter);
-        mqtt_free(handler);
-#else
-        memset(handler, 0, sizeof(iotx_mc_topic_handle_t));
-#endif
         _reset_send_buffer(c);
         HAL_MutexUnlock(c->lock_write_buf);
         return MQTT_NETWORK_ERROR;
@@ -2157,90 +3315,245 @@ static int MQTTSubscribe(iotx_mc_client_t *c, const char *topicFilter, iotx_mqtt
     _reset_send_buffer(c);
     HAL_MutexUnlock(c->lock_write_buf);
 
-    {
-        uint8_t dup = 0;
-#ifdef PLATFORM_HAS_DYNMEM
-        iotx_mc_topic_handle_t *node;
-#endif
-        HAL_MutexLock(c->lock_generic);
-#ifdef PLATFORM_HAS_DYNMEM
-#if defined(INSPECT_MQTT_FLOW) && defined (INFRA_LOG)
-#if WITH_MQTT_ZIP_TOPIC
-        HEXDUMP_DEBUG(handler->topic_filter, MQTT_ZIP_PATH_DEFAULT_LEN);
-#else
-        mqtt_warning("handler->topic: %s", handler->topic_filter);
-#endif
-#endif
-        list_for_each_entry(node, &c->list_sub_handle, linked_list, iotx_mc_topic_handle_t) {
-            /* If subscribe the same topic and callback function, then ignore */
-#if defined(INSPECT_MQTT_FLOW) && defined (INFRA_LOG)
-#if WITH_MQTT_ZIP_TOPIC
-            HEXDUMP_DEBUG(node->topic_filter, MQTT_ZIP_PATH_DEFAULT_LEN);
-#else
-            mqtt_warning("node->topic: %s", node->topic_filter);
-#endif
-#endif
-            if (0 == iotx_mc_check_handle_is_identical(node, handler)) {
-                mqtt_warning("dup sub,topic = %s", topicFilter);
-                dup = 1;
-            }
+    return SUCCESS_RETURN;
+}
+
+#ifdef MQTT_FAST_RECONNECT
+/* remember @topicFilter is subscribed on server, for replaying it when server loses session */
+static void iotx_mc_sub_replay_add(iotx_mc_client_t *c, const char *topicFilter, iotx_mqtt_qos_t qos)
+{
+    iotx_mc_sub_replay_t *node = NULL;
+
+    HAL_MutexLock(c->lock_generic);
+    list_for_each_entry(node, &c->list_sub_replay, linked_list, iotx_mc_sub_replay_t) {
+        if (!strcmp((char *)(node + 1), topicFilter)) {
+            node->qos = (uint8_t)qos;
+            HAL_MutexUnlock(c->lock_generic);
+            return;
         }
-#else
-        for (idx = 0; idx < IOTX_MC_SUBHANDLE_LIST_MAX_LEN; idx++) {
-            /* If subscribe the same topic and callback function, then ignore */
-            if (&c->list_sub_handle[idx] != handler &&
-                0 == iotx_mc_check_handle_is_identical(&c->list_sub_handle[idx], handler)) {
-                mqtt_warning("dup sub,topic = %s", topicFilter);
-                dup = 1;
-            }
+    }
+
+    node = mqtt_malloc(sizeof(iotx_mc_sub_replay_t) + strlen(topicFilter) + 1);
+    if (node == NULL) {
+        HAL_MutexUnlock(c->lock_generic);
+        mqtt_warning("%s is not replayed when session is lost", topicFilter);
+        return;
+    }
+    node->qos = (uint8_t)qos;
+    memcpy((char *)(node + 1), topicFilter, strlen(topicFilter) + 1);
+    list_add_tail(&node->linked_list, &c->list_sub_replay);
+    HAL_MutexUnlock(c->lock_generic);
+}
+
+static void iotx_mc_sub_replay_del(iotx_mc_client_t *c, const char *topicFilter)
+{
+    iotx_mc_sub_replay_t *node = NULL, *next = NULL;
+
+    HAL_MutexLock(c->lock_generic);
+    list_for_each_entry_safe(node, next, &c->list_sub_replay, linked_list, iotx_mc_sub_replay_t) {
+        if (topicFilter == NULL || !strcmp((char *)(node + 1), topicFilter)) {
+            list_del(&node->linked_list);
+            mqtt_free(node);
         }
+    }
+    HAL_MutexUnlock(c->lock_generic);
+}
 #endif
-        if (dup == 0) {
-#ifdef PLATFORM_HAS_DYNMEM
-            list_add_tail(&handler->linked_list, &c->list_sub_handle);
+
+/* send one SUBSCRIBE carrying all the @count filters of @sub_info, at most MUTLI_SUBSCIRBE_MAX */
+static int MQTTSubscribeMulti(iotx_mc_client_t *c, iotx_mutli_sub_info_t *sub_info, int count, unsigned int msgId)
+{
+    int                         idx, rc;
+    MQTTString                  topic[MUTLI_SUBSCIRBE_MAX];
+    int                         qos[MUTLI_SUBSCIRBE_MAX];
+    iotx_mc_topic_handle_t     *handler[MUTLI_SUBSCIRBE_MAX];
+
+    if (!c || !sub_info || count <= 0 || count > MUTLI_SUBSCIRBE_MAX) {
+        return FAIL_RETURN;
+    }
+#if !( WITH_MQTT_DYN_BUF)
+    if (!c->buf_send) {
+        return FAIL_RETURN;
+    }
 #endif
+
+    memset(topic, 0, sizeof(topic));
+    for (idx = 0; idx < count; idx++) {
+        if (!sub_info[idx].topicFilter || !sub_info[idx].messageHandler) {
+            rc = FAIL_RETURN;
         } else {
-#ifdef PLATFORM_HAS_DYNMEM
-            mqtt_free(handler->topic_filter);
-            mqtt_free(handler);
-#else
-            memset(handler, 0, sizeof(iotx_mc_topic_handle_t));
+            rc = iotx_mc_new_sub_handle(c, sub_info[idx].topicFilter, sub_info[idx].messageHandler,
+                                        sub_info[idx].pcontext, &handler[idx]);
+        }
+        if (rc != SUCCESS_RETURN) {
+            while (idx-- > 0) {
+                iotx_mc_free_sub_handle(handler[idx]);
+            }
+            return rc;
+        }
+        topic[idx].cstring = (char *)sub_info[idx].topicFilter;
+        qos[idx] = (int)sub_info[idx].qos;
+    }
+
+    rc = iotx_mc_send_subscribe(c, topic, qos, count, msgId);
+    if (rc != SUCCESS_RETURN) {
+        for (idx = 0; idx < count; idx++) {
+            iotx_mc_free_sub_handle(handler[idx]);
+        }
+        return rc;
+    }
+
+    for (idx = 0; idx < count; idx++) {
+        if (iotx_mc_add_sub_handle(c, handler[idx], sub_info[idx].topicFilter) != SUCCESS_RETURN) {
+            rc = FAIL_RETURN;
+        }
+#ifdef MQTT_FAST_RECONNECT
+        iotx_mc_sub_replay_add(c, sub_info[idx].topicFilter, sub_info[idx].qos);
 #endif
+    }
+
+    return rc;
+}
+
+static int MQTTSubscribe(iotx_mc_client_t *c, const char *topicFilter, iotx_mqtt_qos_t qos, unsigned int msgId,
+                         iotx_mqtt_event_handle_func_fpt messageHandler, void *pcontext)
+{
+    iotx_mutli_sub_info_t sub_info;
+
+    if (!c || !topicFilter || !messageHandler) {
+        return FAIL_RETURN;
+    }
+
+#ifdef SUB_PERSISTENCE_ENABLED
+    if (qos == IOTX_MQTT_QOS3_SUB_LOCAL) {
+        iotx_mc_topic_handle_t *handler = NULL;
+        int rc = iotx_mc_new_sub_handle(c, topicFilter, messageHandler, pcontext, &handler);
+
+        if (rc != SUCCESS_RETURN) {
+            return rc;
         }
-        HAL_MutexUnlock(c->lock_generic);
+        return iotx_mc_add_sub_handle(c, handler, topicFilter);
     }
+#endif
 
-    return SUCCESS_RETURN;
+    memset(&sub_info, 0, sizeof(iotx_mutli_sub_info_t));
+    sub_info.topicFilter = topicFilter;
+    sub_info.qos = qos;
+    sub_info.messageHandler = messageHandler;
+    sub_info.pcontext = pcontext;
+
+    return MQTTSubscribeMulti(c, &sub_info, 1, msgId);
 }
 
 static int iotx_mc_get_next_packetid(iotx_mc_client_t *c)
 {
     unsigned int id = 0;
+#if WITH_MQTT_ATOMIC
+    uint32_t last = 0;
+#endif
 
     if (!c) {
         return FAIL_RETURN;
     }
 
+#if WITH_MQTT_ATOMIC
+    last = IOTX_MC_ATOMIC_LOAD(&c->packet_id);
+    do {
+        id = (last == IOTX_MC_PACKET_ID_MAX) ? 1 : last + 1;
+    } while (!IOTX_MC_ATOMIC_CAS(&c->packet_id, &last, id));
+#else
     HAL_MutexLock(c->lock_generic);
     c->packet_id = (c->packet_id == IOTX_MC_PACKET_ID_MAX) ? 1 : c->packet_id + 1;
     id = c->packet_id;
     HAL_MutexUnlock(c->lock_generic);
+#endif
 
     return id;
 }
 
-static int iotx_mc_check_rule(char *iterm, iotx_mc_topic_type_t type)
+#ifdef MQTT_FAST_RECONNECT
+/* subscribe all filters again on the connection made while server kept no session for this client */
+static void iotx_mc_sub_replay(iotx_mc_client_t *c)
+{
+    iotx_mc_sub_replay_t *node = NULL;
+    iotx_mutli_sub_info_t *sub_info = NULL;
+    MQTTString topic[MUTLI_SUBSCIRBE_MAX];
+    int qos[MUTLI_SUBSCIRBE_MAX];
+    char *filter = NULL;
+    int count = 0, idx = 0, num = 0, rc;
+    uint32_t size = 0;
+
+    if (!c->sub_replay_pending || !wrapper_mqtt_check_state(c)) {
+        return;
+    }
+    c->sub_replay_pending = 0;
+
+    /* filters are copied, for they may be unsubscribed by other threads while sending */
+    HAL_MutexLock(c->lock_generic);
+    list_for_each_entry(node, &c->list_sub_replay, linked_list, iotx_mc_sub_replay_t) {
+        size += sizeof(iotx_mutli_sub_info_t) + strlen((char *)(node + 1)) + 1;
+        count++;
+    }
+    if (count > 0) {
+        sub_info = mqtt_malloc(size);
+    }
+    if (sub_info != NULL) {
+        filter = (char *)(sub_info + count);
+        list_for_each_entry(node, &c->list_sub_replay, linked_list, iotx_mc_sub_replay_t) {
+            memset(&sub_info[idx], 0, sizeof(iotx_mutli_sub_info_t));
+            memcpy(filter, (char *)(node + 1), strlen((char *)(node + 1)) + 1);
+            sub_info[idx].topicFilter = filter;
+            sub_info[idx].qos = (iotx_mqtt_qos_t)node->qos;
+            filter += strlen(filter) + 1;
+            idx++;
+        }
+    }
+    HAL_MutexUnlock(c->lock_generic);
+
+    if (sub_info == NULL) {
+        if (count > 0) {
+            mqtt_err("no memory to replay %d filters", count);
+            c->sub_replay_pending = 1;
+        }
+        return;
+    }
+
+    mqtt_info("session is lost by server, subscribe %d filters again", count);
+    for (idx = 0; idx < count; idx += num) {
+        int i;
+
+        num = iotx_mc_sub_multi_fit(c, &sub_info[idx], count - idx);
+        memset(topic, 0, sizeof(topic));
+        for (i = 0; i < num; i++) {
+            topic[i].cstring = (char *)sub_info[idx + i].topicFilter;
+            qos[i] = (int)sub_info[idx + i].qos;
+        }
+
+        rc = iotx_mc_send_subscribe(c, topic, qos, num, iotx_mc_get_next_packetid(c));
+        if (rc == MQTT_NETWORK_ERROR) {
+            /* they are replayed after next reconnect if server still has no session */
+            iotx_mc_set_client_state(c, IOTX_MC_STATE_DISCONNECTED);
+            break;
+        }
+        if (rc != SUCCESS_RETURN) {
+            mqtt_err("replay of %s fails, rc = %d", topic[0].cstring, rc);
+            continue;
+        }
+        IOTX_MC_STATS_ADD(c, sub_replayed, num);
+    }
+    mqtt_free(sub_info);
+}
+#endif
+
+static int iotx_mc_check_rule(const char *iterm, int len, iotx_mc_topic_type_t type)
 {
     int i = 0;
-    int len = 0;
 
     if (NULL == iterm) {
         mqtt_err("iterm is NULL");
         return FAIL_RETURN;
     }
 
-    len = strlen(iterm);
-
     for (i = 0; i < len; i++) {
         if (TOPIC_FILTER_TYPE == type) {
             if ('+' == iterm[i] || '#' == iterm[i]) {
@@ -2263,12 +3576,13 @@ static int iotx_mc_check_rule(char *iterm, iotx_mc_topic_type_t type)
     return SUCCESS_RETURN;
 }
 
+/* levels are checked where they are rather than by strtok, since threads publishing check topics at the same time */
 static int iotx_mc_check_topic(const char *topicName, iotx_mc_topic_type_t type)
 {
     int mask = 0;
-    char *delim = "/";
-    char *iterm = NULL;
-    char topicString[CONFIG_MQTT_TOPIC_MAXLEN];
+    const char *iterm = NULL;
+    const char *end = NULL;
+
     if (NULL == topicName || '/' != topicName[0]) {
         return FAIL_RETURN;
     }
@@ -2278,22 +3592,15 @@ static int iotx_mc_check_topic(const char *topicName, iotx_mc_topic_type_t type)
         return FAIL_RETURN;
     }
 
-    memset(topicString, 0x0, CONFIG_MQTT_TOPIC_MAXLEN);
-    strncpy(topicString, topicName, CONFIG_MQTT_TOPIC_MAXLEN - 1);
-
-    iterm = infra_strtok(topicString, delim);
-
-    if (SUCCESS_RETURN != iotx_mc_check_rule(iterm, type)) {
-        mqtt_err("run iotx_check_rule error");
-        return FAIL_RETURN;
-    }
-
-    for (;;) {
-        iterm = infra_strtok(NULL, delim);
-
-        if (iterm == NULL) {
+    for (end = topicName;;) {
+        /* empty levels are skipped */
+        for (iterm = end; *iterm == '/'; iterm++) {
+        }
+        if (*iterm == '\0') {
             break;
         }
+        for (end = iterm; *end != '/' && *end != '\0'; end++) {
+        }
 
         /* The character '#' is not in the last */
         if (1 == mask) {
@@ -2301,7 +3608,7 @@ static int iotx_mc_check_topic(const char *topicName, iotx_mc_topic_type_t type)
             return FAIL_RETURN;
         }
 
-        if (SUCCESS_RETURN != iotx_mc_check_rule(iterm, type)) {
+        if (SUCCESS_RETURN != iotx_mc_check_rule(iterm, end - iterm, type)) {
             mqtt_err("run iotx_check_rule error");
             return FAIL_RETURN;
         }
@@ -2311,6 +3618,12 @@ static int iotx_mc_check_topic(const char *topicName, iotx_mc_topic_type_t type)
         }
     }
 
+    if (end == topicName) {
+        /* no level at all */
+        mqtt_err("run iotx_check_rule error");
+        return FAIL_RETURN;
+    }
+
     return SUCCESS_RETURN;
 }
 
@@ -2319,6 +3632,7 @@ static inline int _is_in_yield_cb()
     return _in_yield_cb;
 }
 
+#if WITH_MQTT_UNSUBSCRIBE
 static int MQTTUnsubscribe(iotx_mc_client_t *c, const char *topicFilter, unsigned int msgId)
 {
     MQTTString cur_topic;
@@ -2462,6 +3776,9 @@ static int MQTTUnsubscribe(iotx_mc_client_t *c, const char *topicFilter, unsigne
         if (MQTTPacket_equals(&cur_topic, (char *)node->topic_filter)
             || iotx_mc_is_topic_matched((char *)node->topic_filter, &cur_topic)) {
             mqtt_debug("topic be matched");
+#if WITH_MQTT_TOPIC_TRIE
+            iotx_mc_trie_remove(&c->topic_trie, node);
+#endif
             list_del(&node->linked_list);
             mqtt_free(node->topic_filter);
             mqtt_free(node);
@@ -2484,102 +3801,400 @@ static int MQTTUnsubscribe(iotx_mc_client_t *c, const char *topicFilter, unsigne
     HAL_MutexUnlock(c->lock_write_buf);
     return SUCCESS_RETURN;
 }
+#endif
 
-int MQTTPublish(iotx_mc_client_t *c, const char *topicName, iotx_mqtt_topic_info_pt topic_msg)
-
+#if defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_VECTORED_PUB
+/*
+ * Prepare segments of one PUBLISH into @iov, return number of segments.
+ * QoS0: only @header is serialized, topic name and payload are sent from where they are.
+ * QoS1: the packet is serialized once into its republish node, which is sent as it is. The node is returned by
+ * @pinned, NULL for QoS0, and is not freed until iotx_mc_send_publish() is done with it.
+ * Topic alias in use is returned by @alias, 0 for none. Called with lock_list_pub held.
+ */
+static int iotx_mc_pack_publish(iotx_mc_client_t *c, const char *topicName, iotx_mqtt_topic_info_pt topic_msg,
+                                unsigned char *header, hal_iovec_t *iov, uint16_t *alias, void **pinned)
 {
-    iotx_time_t         timer;
     MQTTString          topic = MQTTString_initializer;
     int                 len = 0;
+    int                 prefix_len = 0;
 #if !WITH_MQTT_ONLY_QOS0
-    iotx_mc_pub_info_t  *node = NULL;
-#endif
-#ifdef INFRA_LOG_NETWORK_PAYLOAD
-    const char     *json_payload = NULL;
+    int                 rc = 0;
+    iotx_mc_pub_info_t *node = NULL;
 #endif
+#ifdef MQTT_TOPIC_ALIAS
+    char                wire[IOTX_MC_TOPIC_ALIAS_PREFIX_MAXLEN + CONFIG_MQTT_TOPIC_MAXLEN + 1];
 
-    if (!c || !topicName || !topic_msg) {
-        return FAIL_RETURN;
-    }
-
+    topic.cstring = (char *)iotx_mc_topic_alias_wire(c, topicName, wire, &prefix_len, alias);
+#else
+    *alias = 0;
     topic.cstring = (char *)topicName;
-    iotx_time_init(&timer);
-    utils_time_countdown_ms(&timer, c->request_timeout_ms);
-
-    HAL_MutexLock(c->lock_list_pub);
-    HAL_MutexLock(c->lock_write_buf);
+#endif
+    *pinned = NULL;
 
-    if (_alloc_send_buffer(c, strlen(topicName) + topic_msg->payload_len) < 0) {
-        HAL_MutexUnlock(c->lock_write_buf);
-        HAL_MutexUnlock(c->lock_list_pub);
-        return FAIL_RETURN;
+    len = MQTTPacket_len(MQTTSerialize_publishLength(topic_msg->qos, topic, topic_msg->payload_len));
+#if WITH_MQTT_DYN_BUF
+    if (len > c->buf_size_send_max) {
+        mqtt_err("publish packet is too long, len=%d, buf_size_send_max=%u", len, c->buf_size_send_max);
+        return MQTT_PUBLISH_PACKET_ERROR;
     }
-
-    len = MQTTSerialize_publish((unsigned char *)c->buf_send,
-                                c->buf_size_send,
-                                0,
-                                topic_msg->qos,
-                                topic_msg->retain,
-                                topic_msg->packet_id,
-                                topic,
-                                (unsigned char *)topic_msg->payload,
-                                topic_msg->payload_len);
-    if (len <= 0) {
-        mqtt_err("MQTTSerialize_publish is error, len=%d, buf_size_send=%u, payloadlen=%u",
-                 len,
-                 c->buf_size_send,
-                 topic_msg->payload_len);
-        _reset_send_buffer(c);
-        HAL_MutexUnlock(c->lock_write_buf);
-        HAL_MutexUnlock(c->lock_list_pub);
+#else
+    if (len > c->buf_size_send) {
+        mqtt_err("publish packet is too long, len=%d, buf_size_send=%u", len, c->buf_size_send);
         return MQTT_PUBLISH_PACKET_ERROR;
     }
+#endif
 
 #if !WITH_MQTT_ONLY_QOS0
-    node = NULL;
-    /* If the QOS >1, push the information into list of wait publish ACK */
     if (topic_msg->qos > IOTX_MQTT_QOS0) {
-        /* push into list */
-        if (SUCCESS_RETURN != iotx_mc_push_pubInfo_to(c, len, topic_msg->packet_id, &node)) {
+        rc = iotx_mc_push_pubInfo_to(c, NULL, len, topic_msg->packet_id, &node);
+        if (SUCCESS_RETURN != rc) {
             mqtt_err("push publish into to pubInfolist failed!");
-            _reset_send_buffer(c);
-            HAL_MutexUnlock(c->lock_write_buf);
-            HAL_MutexUnlock(c->lock_list_pub);
-            return MQTT_PUSH_TO_LIST_ERROR;
+            return (rc == MQTT_PUB_WINDOW_FULL) ? rc : MQTT_PUSH_TO_LIST_ERROR;
         }
-    }
-#endif
-    /* send the publish packet */
-    if (iotx_mc_send_packet(c, c->buf_send, len, &timer) != SUCCESS_RETURN) {
-#if !WITH_MQTT_ONLY_QOS0
-        if (topic_msg->qos > IOTX_MQTT_QOS0) {
-            /* If not even successfully sent to IP stack, meaningless to wait QOS1 ack, give up waiting */
-#ifdef PLATFORM_HAS_DYNMEM
-            list_del(&node->linked_list);
-            mqtt_free(node);
-#else
-            memset(node, 0, sizeof(iotx_mc_pub_info_t));
-#endif
+
+        len = MQTTSerialize_publish(node->buf, len, 0, topic_msg->qos, topic_msg->retain, topic_msg->packet_id,
+                                    topic, (unsigned char *)topic_msg->payload, topic_msg->payload_len);
+        if (len <= 0) {
+            mqtt_err("MQTTSerialize_publish is error, len=%d, payloadlen=%u", len, topic_msg->payload_len);
+            iotx_mc_drop_pubInfo(c, node);
+            return MQTT_PUBLISH_PACKET_ERROR;
         }
+        node->len = len;
+        node->in_tx = 1;
+        *pinned = node;
+
+        iov[0].base = node->buf;
+        iov[0].len = len;
+        return 1;
+    }
 #endif
-        _reset_send_buffer(c);
-        HAL_MutexUnlock(c->lock_write_buf);
-        HAL_MutexUnlock(c->lock_list_pub);
-        return MQTT_NETWORK_ERROR;
+
+    len = MQTTSerialize_publishHeader(header, IOTX_MC_PUB_HEADER_MAXLEN, 0, topic_msg->qos, topic_msg->retain, topic,
+                                      topic_msg->payload_len);
+    if (len <= 0) {
+        mqtt_err("MQTTSerialize_publishHeader is error, len=%d", len);
+        return MQTT_PUBLISH_PACKET_ERROR;
     }
 
-#ifdef INFRA_LOG_NETWORK_PAYLOAD
-    json_payload = (const char *)topic_msg->payload;
+    /* "$<alias>" or "$<alias>=" follows header, then what is left of topic name is @topicName or nothing */
+    memcpy(header + len, topic.cstring, prefix_len);
+    iov[0].base = header;
+    iov[0].len = len + prefix_len;
+    iov[1].base = topicName;
+    iov[1].len = strlen(topic.cstring) - prefix_len;
+    iov[2].base = topic_msg->payload;
+    iov[2].len = topic_msg->payload_len;
+    return 3;
+}
 
-    mqtt_info("Upstream Topic: '%s'", topicName);
-    mqtt_info("Upstream Payload:");
-    iotx_facility_json_print(json_payload, LOG_INFO_LEVEL, '>');
+/* submit @req to be sent by whichever thread gets lock_write_buf first, without taking any lock */
+static void iotx_mc_tx_push(iotx_mc_client_t *c, iotx_mc_tx_req_t *req)
+{
+#if WITH_MQTT_ATOMIC
+    req->next = IOTX_MC_ATOMIC_LOAD(&c->tx_queue);
+    while (!IOTX_MC_ATOMIC_CAS(&c->tx_queue, &req->next, req)) {
+    }
+#else
+    HAL_MutexLock(c->lock_generic);
+    req->next = c->tx_queue;
+    c->tx_queue = req;
+    HAL_MutexUnlock(c->lock_generic);
+#endif
+}
 
-#endif  /* #ifdef INFRA_LOG */
+/* take all requests submitted so far, oldest first */
+static iotx_mc_tx_req_t *iotx_mc_tx_take(iotx_mc_client_t *c)
+{
+    iotx_mc_tx_req_t *list = NULL, *req = NULL, *next = NULL;
+
+#if WITH_MQTT_ATOMIC
+    req = IOTX_MC_ATOMIC_XCHG(&c->tx_queue, NULL);
+#else
+    HAL_MutexLock(c->lock_generic);
+    req = c->tx_queue;
+    c->tx_queue = NULL;
+    HAL_MutexUnlock(c->lock_generic);
+#endif
+
+    while (req != NULL) {
+        next = req->next;
+        req->next = list;
+        list = req;
+        req = next;
+    }
+    return list;
+}
+
+/*
+ * Send what is submitted by all threads, called with lock_write_buf held. Publishes of several threads go out by
+ * one write of up to IOTX_MC_TX_IOV_MAX segments, so threads waiting for lock_write_buf mostly find theirs done.
+ */
+static void iotx_mc_tx_flush(iotx_mc_client_t *c, iotx_time_t *timer)
+{
+    hal_iovec_t         iov[IOTX_MC_TX_IOV_MAX];
+    iotx_mc_tx_req_t   *req = iotx_mc_tx_take(c);
+    iotx_mc_tx_req_t   *first = NULL;
+    int                 iovcnt = 0;
+    int                 rc = SUCCESS_RETURN;
+
+    while (req != NULL) {
+        first = req;
+        iovcnt = 0;
+        do {
+            memcpy(&iov[iovcnt], req->iov, req->iovcnt * sizeof(hal_iovec_t));
+            iovcnt += req->iovcnt;
+            req = req->next;
+        } while (req != NULL && iovcnt + req->iovcnt <= IOTX_MC_TX_IOV_MAX);
+
+        /* once writing fails, the rest is not tried on the broken connection */
+        if (rc == SUCCESS_RETURN) {
+            rc = iotx_mc_send_packet_vec(c, iov, iovcnt, timer);
+        }
+        while (first != req) {
+            first->rc = rc;
+            first->done = 1;
+            first = first->next;
+        }
+    }
+}
+
+/* write @iov along with what other threads have submitted, by whichever of them gets lock_write_buf first */
+static int iotx_mc_tx_write(iotx_mc_client_t *c, hal_iovec_t *iov, int iovcnt)
+{
+    iotx_time_t         timer;
+    iotx_mc_tx_req_t    req;
+
+    iotx_time_init(&timer);
+    utils_time_countdown_ms(&timer, c->request_timeout_ms);
+
+    memset(&req, 0, sizeof(req));
+    req.iov = iov;
+    req.iovcnt = iovcnt;
+    iotx_mc_tx_push(c, &req);
+
+    /* the thread holding lock_write_buf before may have sent it already */
+    HAL_MutexLock(c->lock_write_buf);
+    if (!req.done) {
+        iotx_mc_tx_flush(c, &timer);
+    }
+    HAL_MutexUnlock(c->lock_write_buf);
+
+    return (req.rc == SUCCESS_RETURN) ? SUCCESS_RETURN : MQTT_NETWORK_ERROR;
+}
+
+/*
+ * Send publishes packed by iotx_mc_pack_publish() in one write, @pinned are the nodes it returned, NULL for QoS0.
+ * lock_list_pub is not held meanwhile, so PUBACK of earlier publishes can be handled during the write.
+ */
+static int iotx_mc_send_publish(iotx_mc_client_t *c, void **pinned, int num, hal_iovec_t *iov, int iovcnt)
+{
+    int rc = iotx_mc_tx_write(c, iov, iovcnt);
+
+#if !WITH_MQTT_ONLY_QOS0
+    /* If not even successfully sent to IP stack, meaningless to wait QOS1 ack, give up waiting */
+    HAL_MutexLock(c->lock_list_pub);
+    iotx_mc_pub_unpin(c, pinned, num, rc != SUCCESS_RETURN);
+    HAL_MutexUnlock(c->lock_list_pub);
+#endif
+
+    return rc;
+}
+
+static int MQTTPublishVec(iotx_mc_client_t *c, const char *topicName, iotx_mqtt_topic_info_pt topic_msg)
+{
+    unsigned char       header[IOTX_MC_PUB_HEADER_MAXLEN + IOTX_MC_TOPIC_ALIAS_PREFIX_MAXLEN];
+    hal_iovec_t         iov[3];
+    void               *pinned = NULL;
+    uint16_t            alias = 0;
+    int                 rc = 0;
+
+    HAL_MutexLock(c->lock_list_pub);
+    rc = iotx_mc_pack_publish(c, topicName, topic_msg, header, iov, &alias, &pinned);
+    HAL_MutexUnlock(c->lock_list_pub);
+    if (rc < 0) {
+        return rc;
+    }
+
+    rc = iotx_mc_send_publish(c, &pinned, 1, iov, rc);
+#ifdef MQTT_TOPIC_ALIAS
+    if (rc == SUCCESS_RETURN && alias > 0) {
+        HAL_MutexLock(c->lock_list_pub);
+        iotx_mc_topic_alias_sent(c, alias);
+        HAL_MutexUnlock(c->lock_list_pub);
+    }
+#endif
+    return rc;
+}
+
+/* publish @count messages in batches of IOTX_MC_PUB_BATCH_NUM, each batch is sent by one write */
+static int MQTTPublishBatch(iotx_mc_client_t *c, iotx_mqtt_topic_info_pt topic_msgs, int count)
+{
+    unsigned char       header[IOTX_MC_PUB_BATCH_NUM][IOTX_MC_PUB_HEADER_MAXLEN + IOTX_MC_TOPIC_ALIAS_PREFIX_MAXLEN];
+    void               *pinned[IOTX_MC_PUB_BATCH_NUM];
+    uint16_t            aliases[IOTX_MC_PUB_BATCH_NUM];
+    hal_iovec_t         iov[IOTX_MC_PUB_BATCH_NUM * 3];
+    iotx_mqtt_topic_info_pt topic_msg = NULL;
+    int                 iovcnt = 0;
+    int                 num = 0;
+    int                 sent = 0;
+    int                 rc = SUCCESS_RETURN;
+
+    while (sent < count && rc >= 0) {
+        iovcnt = 0;
+        HAL_MutexLock(c->lock_list_pub);
+        for (num = 0; num < IOTX_MC_PUB_BATCH_NUM && sent + num < count; num++) {
+            topic_msg = &topic_msgs[sent + num];
+            if (topic_msg->qos > IOTX_MQTT_QOS0) {
+                topic_msg->packet_id = iotx_mc_get_next_packetid(c);
+            }
+
+            rc = iotx_mc_pack_publish(c, topic_msg->ptopic, topic_msg, header[num], &iov[iovcnt], &aliases[num],
+                                      &pinned[num]);
+            if (rc < 0) {
+                break;
+            }
+            iovcnt += rc;
+        }
+        HAL_MutexUnlock(c->lock_list_pub);
+
+        if (num > 0) {
+            if (iotx_mc_send_publish(c, pinned, num, iov, iovcnt) != SUCCESS_RETURN) {
+                IOTX_MC_STATS_ADD(c, pub_fail, num);
+                rc = MQTT_NETWORK_ERROR;
+                break;
+            }
+            IOTX_MC_STATS_ADD(c, pub_count, num);
+            sent += num;
+#ifdef MQTT_TOPIC_ALIAS
+            HAL_MutexLock(c->lock_list_pub);
+            while (num-- > 0) {
+                iotx_mc_topic_alias_sent(c, aliases[num]);
+            }
+            HAL_MutexUnlock(c->lock_list_pub);
+#endif
+        }
+    }
+
+    return (sent > 0) ? sent : rc;
+}
+#endif
+
+int MQTTPublish(iotx_mc_client_t *c, const char *topicName, iotx_mqtt_topic_info_pt topic_msg)
+
+{
+    int                 len = 0;
+#if !(defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_VECTORED_PUB)
+    iotx_time_t         timer;
+    MQTTString          topic = MQTTString_initializer;
+#if !WITH_MQTT_ONLY_QOS0
+    int                 rc = 0;
+    iotx_mc_pub_info_t  *node = NULL;
+#endif
+#ifdef MQTT_TOPIC_ALIAS
+    char                wire[IOTX_MC_TOPIC_ALIAS_PREFIX_MAXLEN + CONFIG_MQTT_TOPIC_MAXLEN + 1];
+    int                 prefix_len = 0;
+    uint16_t            alias = 0;
+#endif
+#endif
+#ifdef INFRA_LOG_NETWORK_PAYLOAD
+    const char     *json_payload = NULL;
+#endif
+
+    if (!c || !topicName || !topic_msg) {
+        return FAIL_RETURN;
+    }
+
+#if defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_VECTORED_PUB
+    len = MQTTPublishVec(c, topicName, topic_msg);
+    if (len != SUCCESS_RETURN) {
+        return len;
+    }
+#else
+    topic.cstring = (char *)topicName;
+    iotx_time_init(&timer);
+    utils_time_countdown_ms(&timer, c->request_timeout_ms);
+
+    HAL_MutexLock(c->lock_list_pub);
+    HAL_MutexLock(c->lock_write_buf);
+#ifdef MQTT_TOPIC_ALIAS
+    topic.cstring = (char *)iotx_mc_topic_alias_wire(c, topicName, wire, &prefix_len, &alias);
+#endif
+
+    if (_alloc_send_buffer(c, strlen(topic.cstring) + topic_msg->payload_len) < 0) {
+        HAL_MutexUnlock(c->lock_write_buf);
+        HAL_MutexUnlock(c->lock_list_pub);
+        return FAIL_RETURN;
+    }
+
+    len = MQTTSerialize_publish((unsigned char *)c->buf_send,
+                                c->buf_size_send,
+                                0,
+                                topic_msg->qos,
+                                topic_msg->retain,
+                                topic_msg->packet_id,
+                                topic,
+                                (unsigned char *)topic_msg->payload,
+                                topic_msg->payload_len);
+    if (len <= 0) {
+        mqtt_err("MQTTSerialize_publish is error, len=%d, buf_size_send=%u, payloadlen=%u",
+                 len,
+                 c->buf_size_send,
+                 topic_msg->payload_len);
+        _reset_send_buffer(c);
+        HAL_MutexUnlock(c->lock_write_buf);
+        HAL_MutexUnlock(c->lock_list_pub);
+        return MQTT_PUBLISH_PACKET_ERROR;
+    }
+
+#if !WITH_MQTT_ONLY_QOS0
+    node = NULL;
+    /* If the QOS >1, push the information into list of wait publish ACK */
+    if (topic_msg->qos > IOTX_MQTT_QOS0) {
+        /* push into list */
+        rc = iotx_mc_push_pubInfo_to(c, c->buf_send, len, topic_msg->packet_id, &node);
+        if (SUCCESS_RETURN != rc) {
+            mqtt_err("push publish into to pubInfolist failed!");
+            _reset_send_buffer(c);
+            HAL_MutexUnlock(c->lock_write_buf);
+            HAL_MutexUnlock(c->lock_list_pub);
+            return (rc == MQTT_PUB_WINDOW_FULL) ? rc : MQTT_PUSH_TO_LIST_ERROR;
+        }
+    }
+#endif
+    /* send the publish packet */
+    if (iotx_mc_send_packet(c, c->buf_send, len, &timer) != SUCCESS_RETURN) {
+#if !WITH_MQTT_ONLY_QOS0
+        if (topic_msg->qos > IOTX_MQTT_QOS0) {
+            /* If not even successfully sent to IP stack, meaningless to wait QOS1 ack, give up waiting */
+#ifdef PLATFORM_HAS_DYNMEM
+            iotx_mc_drop_pubInfo(c, node);
+#else
+            memset(node, 0, sizeof(iotx_mc_pub_info_t));
+#endif
+        }
+#endif
+        _reset_send_buffer(c);
+        HAL_MutexUnlock(c->lock_write_buf);
+        HAL_MutexUnlock(c->lock_list_pub);
+        return MQTT_NETWORK_ERROR;
+    }
+#ifdef MQTT_TOPIC_ALIAS
+    iotx_mc_topic_alias_sent(c, alias);
+#endif
 
     _reset_send_buffer(c);
     HAL_MutexUnlock(c->lock_write_buf);
     HAL_MutexUnlock(c->lock_list_pub);
+#endif
+
+#ifdef INFRA_LOG_NETWORK_PAYLOAD
+    json_payload = (const char *)topic_msg->payload;
+
+    mqtt_info("Upstream Topic: '%s'", topicName);
+    mqtt_info("Upstream Payload:");
+    iotx_facility_json_print(json_payload, LOG_INFO_LEVEL, '>');
+
+#endif  /* #ifdef INFRA_LOG */
 
     return SUCCESS_RETURN;
 }
@@ -2647,9 +4262,15 @@ void *wrapper_mqtt_init(iotx_mqtt_param_t *mqtt_params)
 #endif
 
 #ifdef PLATFORM_HAS_DYNMEM
+#if WITH_MQTT_SLAB && !defined(INFRA_MEM_STATS)
+    if (iotx_mc_slab_init() != SUCCESS_RETURN) {
+        return NULL;
+    }
+#endif
     pclient = (iotx_mc_client_t *)mqtt_malloc(sizeof(iotx_mc_client_t));
     if (NULL == pclient) {
         mqtt_err("not enough memory.");
+        iotx_mc_release(pclient);
         return NULL;
     }
     memset(pclient, 0, sizeof(iotx_mc_client_t));
@@ -2730,6 +4351,9 @@ int wrapper_mqtt_release(void **c)
     iotx_mc_client_t *pClient;
 #ifdef PLATFORM_HAS_DYNMEM
     iotx_mc_topic_handle_t *node = NULL, *next = NULL;
+#endif
+#ifdef MQTT_TOPIC_ALIAS
+    int idx;
 #endif
     if (NULL == c) {
         return NULL_VALUE_ERROR;
@@ -2745,6 +4369,11 @@ int wrapper_mqtt_release(void **c)
     iotx_mc_disconnect(pClient);
     iotx_mc_set_client_state(pClient, IOTX_MC_STATE_INVALID);
     HAL_SleepMs(100);
+#ifdef MQTT_DISPATCH
+    /* handlers still queued are called before handles are freed */
+    iotx_mc_dispatch_close(pClient->dispatch);
+    pClient->dispatch = NULL;
+#endif
 
 #ifdef PLATFORM_HAS_DYNMEM
     list_for_each_entry_safe(node, next, &pClient->list_sub_handle, linked_list, iotx_mc_topic_handle_t) {
@@ -2752,6 +4381,19 @@ int wrapper_mqtt_release(void **c)
         mqtt_free(node->topic_filter);
         mqtt_free(node);
     }
+#if WITH_MQTT_TOPIC_TRIE
+    iotx_mc_trie_deinit(&pClient->topic_trie);
+#endif
+#ifdef MQTT_FAST_RECONNECT
+    iotx_mc_sub_replay_del(pClient, NULL);
+#endif
+#ifdef MQTT_TOPIC_ALIAS
+    for (idx = 0; idx < IOTX_MC_TOPIC_ALIAS_NUM; idx++) {
+        if (pClient->topic_alias[idx].topic != NULL) {
+            mqtt_free(pClient->topic_alias[idx].topic);
+        }
+    }
+#endif
 #else
     memset(pClient->list_sub_handle, 0, sizeof(iotx_mc_topic_handle_t) * IOTX_MC_SUBHANDLE_LIST_MAX_LEN);
 #endif
@@ -2759,7 +4401,10 @@ int wrapper_mqtt_release(void **c)
     HAL_MutexDestroy(pClient->lock_list_pub);
     HAL_MutexDestroy(pClient->lock_write_buf);
     HAL_MutexDestroy(pClient->lock_yield);
-    HAL_MutexDestroy(pClient->lock_read_buf);
+#ifdef MQTT_OFFLINE_QUEUE
+    iotx_mc_offline_close(&pClient->offline_queue);
+    HAL_MutexDestroy(pClient->lock_offline);
+#endif
 
 #if !WITH_MQTT_ONLY_QOS0
     iotx_mc_pub_wait_list_deinit(pClient);
@@ -2773,69 +4418,231 @@ int wrapper_mqtt_release(void **c)
         mqtt_free(pClient->buf_read);
         pClient->buf_read = NULL;
     }
-    mqtt_free(pClient);
-#else
-    memset(pClient, 0, sizeof(iotx_mc_client_t));
 #endif
+    iotx_mc_release(pClient);
     *c = NULL;
     mqtt_info("mqtt release!");
     return SUCCESS_RETURN;
 }
 
-int wrapper_mqtt_yield(void *client, int timeout_ms)
+/* dump statistics by user's handle or into log, when it is time to */
+static void iotx_mc_stats_dump(iotx_mc_client_t *pClient)
 {
-    iotx_mc_client_t *pClient = (iotx_mc_client_t *)client;
+    iotx_mqtt_stats_t stats;
 
-    if (pClient == NULL) {
-        return NULL_VALUE_ERROR;
-    }
-
-    if (timeout_ms < 0) {
-        mqtt_err("Invalid argument, timeout_ms = %d", timeout_ms);
-        return -1;
-    }
-    if (timeout_ms == 0) {
-        timeout_ms = 10;
+    if (pClient->stats_interval_ms == 0 || !utils_time_is_expired(&pClient->stats_next_time)) {
+        return;
     }
+    utils_time_countdown_ms(&pClient->stats_next_time, pClient->stats_interval_ms);
 
-    HAL_MutexLock(pClient->lock_yield);
-    pClient->cycle_timeout_ms = timeout_ms;
-    /* Keep MQTT alive or reconnect if connection abort */
-    iotx_mc_keepalive(pClient);
-    HAL_MutexUnlock(pClient->lock_yield);
-
-#ifndef ASYNC_PROTOCOL_STACK
-    _mqtt_cycle(client);
-#else
-    if (pClient->client_state == IOTX_MC_STATE_CONNECTED) {
-#if !WITH_MQTT_ONLY_QOS0
-        /* check list of wait publish ACK to remove node that is ACKED or timeout */
-        MQTTPubInfoProc(pClient);
-#endif
+    wrapper_mqtt_get_stats(pClient, &stats);
+    if (pClient->stats_dump != NULL) {
+        pClient->stats_dump(pClient->stats_context, pClient, &stats);
+        return;
     }
-    HAL_SleepMs(timeout_ms);
-#endif
 
-    return 0;
+    mqtt_info("stats: pub=%u/%u republish=%u puback=%u recv=%u tx=%lu rx=%lu reads=%u packets=%u",
+              stats.pub_count, stats.pub_fail, stats.republish_count, stats.puback_count, stats.recv_count,
+              (unsigned long)stats.tx_bytes, (unsigned long)stats.rx_bytes, stats.rx_reads, stats.rx_packets);
+    mqtt_info("stats: rtt avg=%lu max=%u ms, keepalive_fail=%u disconnect=%u reconnect=%u/%u",
+              (unsigned long)(stats.puback_count ? stats.rtt_sum_ms / stats.puback_count : 0), stats.rtt_max_ms,
+              stats.keepalive_fail, stats.disconnect_count, stats.reconnect_count, stats.reconnect_fail);
+    mqtt_info("stats: reconnect time=%u max=%u ms, session resumed=%u, filters replayed=%u",
+              stats.reconnect_time_ms, stats.reconnect_time_max_ms, stats.session_resumed, stats.sub_replayed);
+    mqtt_info("stats: ping=%u skipped=%u keepalive=%u ms, radio wakeups=%u",
+              stats.ping_count, stats.ping_skipped, stats.keepalive_ms, stats.radio_wakeups);
 }
 
-
-/* check MQTT client is in normal state */
-/* 0, in abnormal state; 1, in normal state */
-int wrapper_mqtt_check_state(void *client)
+static int _mqtt_publish(iotx_mc_client_t *c, const char *topicName, iotx_mqtt_topic_info_pt topic_msg)
 {
-    if (!client) {
-        return 0;
-    }
+    uint16_t msg_id = 0;
+    int rc = FAIL_RETURN;
 
-    if (iotx_mc_get_client_state((iotx_mc_client_t *)client) == IOTX_MC_STATE_CONNECTED) {
-        return 1;
+    if (!wrapper_mqtt_check_state(c)) {
+        mqtt_err("mqtt client state is error,state = %d", iotx_mc_get_client_state(c));
+        return MQTT_STATE_ERROR;
     }
 
-    return 0;
-}
+#if !WITH_MQTT_ONLY_QOS0
+    if (topic_msg->qos == IOTX_MQTT_QOS1 || topic_msg->qos == IOTX_MQTT_QOS2) {
+        msg_id = iotx_mc_get_next_packetid(c);
+        topic_msg->packet_id = msg_id;
+    }
+    if (topic_msg->qos == IOTX_MQTT_QOS2) {
+        mqtt_err("MQTTPublish return error,MQTT_QOS2 is now not supported.");
+        return MQTT_PUBLISH_QOS_ERROR;
+    }
+#else
+    topic_msg->qos = IOTX_MQTT_QOS0;
+#endif
 
-int wrapper_mqtt_subscribe(void *client,
+#if defined(INSPECT_MQTT_FLOW) && defined(INFRA_LOG)
+    HEXDUMP_DEBUG(topicName, strlen(topicName));
+    HEXDUMP_DEBUG(topic_msg->payload, topic_msg->payload_len);
+#endif
+
+    rc = MQTTPublish(c, topicName, topic_msg);
+    if (rc != SUCCESS_RETURN) { /* send the subscribe packet */
+        IOTX_MC_STATS_ADD(c, pub_fail, 1);
+        if (rc == MQTT_NETWORK_ERROR) {
+            iotx_mc_set_client_state(c, IOTX_MC_STATE_DISCONNECTED);
+        }
+        mqtt_err("MQTTPublish is error, rc = %d", rc);
+        return rc;
+    }
+
+    IOTX_MC_STATS_ADD(c, pub_count, 1);
+
+    return (int)msg_id;
+}
+
+#ifdef MQTT_OFFLINE_QUEUE
+/*
+ * Store @topic_msg into offline queue when client is disconnected, or when earlier ones are still queued
+ * so that publishes go out in order. @stored tells whether it has been stored.
+ */
+static int iotx_mc_offline_store(iotx_mc_client_t *c, const char *topicName, iotx_mqtt_topic_info_pt topic_msg,
+                                 int *stored)
+{
+    uint32_t dropped = 0;
+    int rc = SUCCESS_RETURN;
+
+    *stored = 0;
+    HAL_MutexLock(c->lock_offline);
+    if (c->offline_queue.segment == NULL || (wrapper_mqtt_check_state(c) && c->offline_queue.count == 0)) {
+        HAL_MutexUnlock(c->lock_offline);
+        return SUCCESS_RETURN;
+    }
+
+    rc = iotx_mc_offline_push(&c->offline_queue, topicName, topic_msg, &dropped);
+    IOTX_MC_STATS_ADD(c, offline_dropped, dropped);
+    if (rc == SUCCESS_RETURN) {
+        IOTX_MC_STATS_ADD(c, offline_queued, 1);
+        *stored = 1;
+    } else {
+        IOTX_MC_STATS_ADD(c, offline_dropped, 1);
+        mqtt_warning("offline queue is full, publish dropped");
+    }
+    HAL_MutexUnlock(c->lock_offline);
+
+    return rc;
+}
+
+/* send publishes stored in offline queue, no faster than offline_drain_rate per second */
+static void iotx_mc_offline_drain(iotx_mc_client_t *c)
+{
+    iotx_mqtt_topic_info_t topic_msg;
+    uint32_t now = (uint32_t)HAL_UptimeMs();
+    uint32_t quota = IOTX_MC_OFFLINE_DRAIN_BURST;
+    int rc = 0;
+
+    HAL_MutexLock(c->lock_offline);
+    /* quota is counted from reconnect, not accumulated while disconnected */
+    if (c->offline_queue.count == 0 || !wrapper_mqtt_check_state(c)) {
+        c->offline_drain_time = now;
+        HAL_MutexUnlock(c->lock_offline);
+        return;
+    }
+
+    if (c->offline_drain_rate != 0) {
+        quota = (uint32_t)((uint64_t)(now - c->offline_drain_time) * c->offline_drain_rate / 1000);
+        if (quota == 0) {
+            HAL_MutexUnlock(c->lock_offline);
+            return;
+        }
+        if (quota > IOTX_MC_OFFLINE_DRAIN_BURST) {
+            quota = IOTX_MC_OFFLINE_DRAIN_BURST;
+        }
+        c->offline_drain_time = now;
+    }
+
+    while (quota-- > 0 && iotx_mc_offline_peek(&c->offline_queue, &topic_msg) == SUCCESS_RETURN) {
+        rc = _mqtt_publish(c, topic_msg.ptopic, &topic_msg);
+        /* leave it in queue when it can be sent later */
+        if (rc == MQTT_NETWORK_ERROR || rc == MQTT_PUB_WINDOW_FULL || rc == MQTT_STATE_ERROR) {
+            break;
+        }
+        if (rc < 0) {
+            IOTX_MC_STATS_ADD(c, offline_dropped, 1);
+        } else {
+            IOTX_MC_STATS_ADD(c, offline_sent, 1);
+        }
+        iotx_mc_offline_pop(&c->offline_queue);
+    }
+    HAL_MutexUnlock(c->lock_offline);
+}
+#endif
+
+int wrapper_mqtt_yield(void *client, int timeout_ms)
+{
+    iotx_mc_client_t *pClient = (iotx_mc_client_t *)client;
+#ifdef ASYNC_PROTOCOL_STACK
+    int sleep_ms = timeout_ms;
+#endif
+
+    if (pClient == NULL) {
+        return NULL_VALUE_ERROR;
+    }
+
+    if (timeout_ms < 0) {
+        mqtt_err("Invalid argument, timeout_ms = %d", timeout_ms);
+        return -1;
+    }
+    if (timeout_ms == 0) {
+        timeout_ms = 10;
+    }
+
+    HAL_MutexLock(pClient->lock_yield);
+    pClient->cycle_timeout_ms = timeout_ms;
+    /* Keep MQTT alive or reconnect if connection abort */
+    iotx_mc_keepalive(pClient);
+#ifdef MQTT_FAST_RECONNECT
+    iotx_mc_sub_replay(pClient);
+#endif
+    HAL_MutexUnlock(pClient->lock_yield);
+
+#ifndef ASYNC_PROTOCOL_STACK
+    _mqtt_cycle(client);
+#else
+    if (iotx_mc_get_client_state(pClient) == IOTX_MC_STATE_CONNECTED) {
+        /* nothing may be read for long when server is gone, so unanswered pings are checked here */
+        if (pClient->keepalive_probe_max < pClient->keepalive_probes) {
+            iotx_mc_keepalive_lost(pClient);
+        }
+#if !WITH_MQTT_ONLY_QOS0
+        /* check list of wait publish ACK to remove node that is ACKED or timeout */
+        MQTTPubInfoProc(pClient);
+#endif
+    }
+    /* yield of 0ms only does the timed work, as a reactor does when it is due */
+    HAL_SleepMs(sleep_ms);
+#endif
+
+#ifdef MQTT_OFFLINE_QUEUE
+    iotx_mc_offline_drain(pClient);
+#endif
+    iotx_mc_stats_dump(pClient);
+
+    return 0;
+}
+
+
+/* check MQTT client is in normal state */
+/* 0, in abnormal state; 1, in normal state */
+int wrapper_mqtt_check_state(void *client)
+{
+    if (!client) {
+        return 0;
+    }
+
+    if (iotx_mc_get_client_state((iotx_mc_client_t *)client) == IOTX_MC_STATE_CONNECTED) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int wrapper_mqtt_subscribe(void *client,
                            const char *topicFilter,
                            iotx_mqtt_qos_t qos,
                            iotx_mqtt_event_handle_func_fpt topic_handle_func,
@@ -2945,6 +4752,9 @@ int wrapper_mqtt_subscribe_sync(void *c,
 #endif
 #ifdef PLATFORM_HAS_DYNMEM
             node = (mqtt_sub_sync_node_t *)mqtt_malloc(sizeof(mqtt_sub_sync_node_t));
+            if (node != NULL) {
+                memset(node, 0, sizeof(mqtt_sub_sync_node_t));
+            }
 #else
             for (idx = 0; idx < IOTX_MC_SUBSYNC_LIST_MAX_LEN; idx++) {
                 if (client->list_sub_sync_ack[idx].used == 0) {
@@ -3045,8 +4855,186 @@ int wrapper_mqtt_subscribe_sync(void *c,
     return -1;
 }
 
+/* take sync nodes of the multi-filter subscribe of @sub_info which got SUBACK, or all of them if @all */
+static int iotx_mc_sub_multi_reap(iotx_mc_client_t *c, iotx_mutli_sub_info_t *sub_info, int count, int all)
+{
+    int reaped = 0;
+#ifdef PLATFORM_HAS_DYNMEM
+    mqtt_sub_sync_node_t *node = NULL;
+    mqtt_sub_sync_node_t *next = NULL;
+#else
+    int idx;
+#endif
+
+    HAL_MutexLock(c->lock_generic);
+#ifdef PLATFORM_HAS_DYNMEM
+    list_for_each_entry_safe(node, next, &c->list_sub_sync_ack, linked_list, mqtt_sub_sync_node_t) {
+        if (node->sub_info >= sub_info && node->sub_info < sub_info + count &&
+            (all || node->ack_type != IOTX_MQTT_EVENT_UNDEF)) {
+            list_del(&node->linked_list);
+            mqtt_free(node);
+            reaped++;
+        }
+    }
+#else
+    for (idx = 0; idx < IOTX_MC_SUBSYNC_LIST_MAX_LEN; idx++) {
+        mqtt_sub_sync_node_t *node = &c->list_sub_sync_ack[idx];
+
+        if (node->used && node->sub_info >= sub_info && node->sub_info < sub_info + count &&
+            (all || node->ack_type != IOTX_MQTT_EVENT_UNDEF)) {
+            memset(node, 0, sizeof(mqtt_sub_sync_node_t));
+            reaped++;
+        }
+    }
+#endif
+    HAL_MutexUnlock(c->lock_generic);
+
+    return reaped;
+}
+
+int wrapper_mqtt_subscribe_multi(void *client, iotx_mutli_sub_info_t *sub_info, int count, int timeout_ms)
+{
+    int                 rc = SUCCESS_RETURN;
+    int                 idx, num, sent = 0, pending = 0, granted = 0;
+    int                 in_yield_cb = _is_in_yield_cb();
+    unsigned int        msgId;
+    iotx_time_t         timer;
+    iotx_mc_client_t   *c = (iotx_mc_client_t *)client;
+    mqtt_sub_sync_node_t *node = NULL;
+
+    if (NULL == c || NULL == sub_info || count <= 0) {
+        mqtt_err(" paras error");
+        return NULL_VALUE_ERROR;
+    }
+
+    for (idx = 0; idx < count; idx++) {
+        sub_info[idx].granted = -1;
+        if (NULL == sub_info[idx].topicFilter || strlen(sub_info[idx].topicFilter) == 0 ||
+            !sub_info[idx].messageHandler) {
+            mqtt_err(" paras error");
+            return NULL_VALUE_ERROR;
+        }
+        if (0 != iotx_mc_check_topic(sub_info[idx].topicFilter, TOPIC_FILTER_TYPE)) {
+            mqtt_err("topic format is error,topicFilter = %s", sub_info[idx].topicFilter);
+            return MQTT_TOPIC_FORMAT_ERROR;
+        }
+    }
+
+    if (!wrapper_mqtt_check_state(c)) {
+        mqtt_err("mqtt client state is error,state = %d", iotx_mc_get_client_state(c));
+        return MQTT_STATE_ERROR;
+    }
+
+    iotx_time_init(&timer);
+    utils_time_countdown_ms(&timer, timeout_ms);
+
+    do {
+        /* SUBSCRIBE packets are pipelined, as many as there are sync nodes to correlate their SUBACK */
+        while (sent < count) {
+#ifdef SUB_PERSISTENCE_ENABLED
+            if (sub_info[sent].qos == IOTX_MQTT_QOS3_SUB_LOCAL) {
+                if (MQTTSubscribe(c, sub_info[sent].topicFilter, sub_info[sent].qos, 0, sub_info[sent].messageHandler,
+                                  sub_info[sent].pcontext) == SUCCESS_RETURN) {
+                    sub_info[sent].granted = IOTX_MQTT_QOS3_SUB_LOCAL;
+                }
+                sent++;
+                continue;
+            }
+#endif
+            num = iotx_mc_sub_multi_fit(c, sub_info + sent, count - sent);
+
+            node = NULL;
+            if (!in_yield_cb) {
+#ifdef PLATFORM_HAS_DYNMEM
+                node = (mqtt_sub_sync_node_t *)mqtt_malloc(sizeof(mqtt_sub_sync_node_t));
+                if (node == NULL) {
+                    break;
+                }
+                memset(node, 0, sizeof(mqtt_sub_sync_node_t));
+#else
+                for (idx = 0; idx < IOTX_MC_SUBSYNC_LIST_MAX_LEN; idx++) {
+                    if (c->list_sub_sync_ack[idx].used == 0) {
+                        node = &c->list_sub_sync_ack[idx];
+                        break;
+                    }
+                }
+                if (node == NULL) {
+                    break;
+                }
+#endif
+            }
+
+            msgId = iotx_mc_get_next_packetid(c);
+            if (node != NULL) {
+                HAL_MutexLock(c->lock_generic);
+#ifndef PLATFORM_HAS_DYNMEM
+                memset(node, 0, sizeof(mqtt_sub_sync_node_t));
+                node->used = 1;
+#endif
+                node->packet_id = msgId;
+                node->ack_type = IOTX_MQTT_EVENT_UNDEF;
+                node->sub_info = sub_info + sent;
+                node->sub_count = num;
+#ifdef PLATFORM_HAS_DYNMEM
+                list_add_tail(&node->linked_list, &c->list_sub_sync_ack);
+#endif
+                HAL_MutexUnlock(c->lock_generic);
+            }
+
+            mqtt_debug("PERFORM subscribe to %d filters (msgId=%d)", num, msgId);
+            rc = MQTTSubscribeMulti(c, sub_info + sent, num, msgId);
+            if (rc != SUCCESS_RETURN) {
+                mqtt_err("run MQTTSubscribeMulti error, rc = %d", rc);
+                if (node != NULL) {
+                    HAL_MutexLock(c->lock_generic);
+#ifdef PLATFORM_HAS_DYNMEM
+                    list_del(&node->linked_list);
+                    mqtt_free(node);
+#else
+                    memset(node, 0, sizeof(mqtt_sub_sync_node_t));
+#endif
+                    HAL_MutexUnlock(c->lock_generic);
+                }
+                if (rc == MQTT_NETWORK_ERROR) {
+                    iotx_mc_set_client_state(c, IOTX_MC_STATE_DISCONNECTED);
+                    break;
+                }
+            } else if (node != NULL) {
+                pending++;
+            }
+            sent += num;
+        }
+
+        if (rc == MQTT_NETWORK_ERROR || in_yield_cb || pending == 0) {
+            break;
+        }
+
+        wrapper_mqtt_yield(c, 100);
+        pending -= iotx_mc_sub_multi_reap(c, sub_info, count, 0);
+    } while (!utils_time_is_expired(&timer));
+
+    if (pending > 0) {
+        mqtt_warning("multi subscribe time out, %d SUBACK missing", pending);
+        iotx_mc_sub_multi_reap(c, sub_info, count, 1);
+    }
+
+    if (rc == MQTT_NETWORK_ERROR) {
+        return rc;
+    }
+
+    for (idx = 0; idx < count; idx++) {
+        if (sub_info[idx].granted >= 0) {
+            granted++;
+        }
+    }
+    mqtt_info("mqtt multi subscribe done, %d of %d filters granted", granted, count);
+
+    return granted;
+}
+
 int wrapper_mqtt_unsubscribe(void *client, const char *topicFilter)
 {
+#if WITH_MQTT_UNSUBSCRIBE
     int rc = FAIL_RETURN;
     iotx_mc_client_t *c = (iotx_mc_client_t *)client;
     unsigned int msgId;
@@ -3075,16 +5063,26 @@ int wrapper_mqtt_unsubscribe(void *client, const char *topicFilter)
         mqtt_err("run MQTTUnsubscribe error!, rc = %d", rc);
         return rc;
     }
+#ifdef MQTT_FAST_RECONNECT
+    iotx_mc_sub_replay_del(c, topicFilter);
+#endif
 
     mqtt_info("mqtt unsubscribe packet sent,topic = %s!", topicFilter);
     return (int)msgId;
+#else
+    mqtt_err("unsubscribe is not built in, FEATURE_MQTT_NO_UNSUBSCRIBE is set");
+    return FAIL_RETURN;
+#endif
 }
 
 int wrapper_mqtt_publish(void *client, const char *topicName, iotx_mqtt_topic_info_pt topic_msg)
 {
-    uint16_t msg_id = 0;
-    int rc = FAIL_RETURN;
     iotx_mc_client_t *c = (iotx_mc_client_t *)client;
+#ifdef MQTT_OFFLINE_QUEUE
+    int stored = 0;
+    int rc = FAIL_RETURN;
+#endif
+
     if (c == NULL || topicName == NULL || topic_msg == NULL || topic_msg->payload == NULL) {
         return NULL_VALUE_ERROR;
     }
@@ -3094,39 +5092,351 @@ int wrapper_mqtt_publish(void *client, const char *topicName, iotx_mqtt_topic_in
         return MQTT_TOPIC_FORMAT_ERROR;
     }
 
+#ifdef MQTT_OFFLINE_QUEUE
+    rc = iotx_mc_offline_store(c, topicName, topic_msg, &stored);
+    if (rc != SUCCESS_RETURN || stored) {
+        return rc;
+    }
+#endif
+
+    return _mqtt_publish(c, topicName, topic_msg);
+}
+
+int wrapper_mqtt_publish_batch(void *client, iotx_mqtt_topic_info_pt topic_msgs, int count)
+{
+    int idx = 0;
+    int rc = FAIL_RETURN;
+    iotx_mc_client_t *c = (iotx_mc_client_t *)client;
+#ifdef MQTT_OFFLINE_QUEUE
+    int stored = 0;
+    int stored_num = 0;
+#endif
+    if (c == NULL || topic_msgs == NULL || count <= 0) {
+        return NULL_VALUE_ERROR;
+    }
+
+    for (idx = 0; idx < count; idx++) {
+        if (topic_msgs[idx].ptopic == NULL || topic_msgs[idx].payload == NULL) {
+            return NULL_VALUE_ERROR;
+        }
+        if (0 != iotx_mc_check_topic(topic_msgs[idx].ptopic, TOPIC_NAME_TYPE)) {
+            mqtt_err("topic format is error,topicFilter = %s", topic_msgs[idx].ptopic);
+            return MQTT_TOPIC_FORMAT_ERROR;
+        }
+#if !WITH_MQTT_ONLY_QOS0
+        if (topic_msgs[idx].qos == IOTX_MQTT_QOS2) {
+            mqtt_err("MQTTPublish return error,MQTT_QOS2 is now not supported.");
+            return MQTT_PUBLISH_QOS_ERROR;
+        }
+#else
+        topic_msgs[idx].qos = IOTX_MQTT_QOS0;
+#endif
+    }
+
+#ifdef MQTT_OFFLINE_QUEUE
+    /* like single publishes, messages go behind the ones still in offline queue instead of overtaking them */
+    for (stored_num = 0; stored_num < count; stored_num++) {
+        rc = iotx_mc_offline_store(c, topic_msgs[stored_num].ptopic, &topic_msgs[stored_num], &stored);
+        if (rc != SUCCESS_RETURN) {
+            return (stored_num > 0) ? stored_num : rc;
+        }
+        if (!stored) {
+            break;
+        }
+    }
+    if (stored_num == count) {
+        return count;
+    }
+    /* queue has been drained meanwhile, the rest is sent at once */
+    topic_msgs += stored_num;
+    count -= stored_num;
+#endif
+
     if (!wrapper_mqtt_check_state(c)) {
         mqtt_err("mqtt client state is error,state = %d", iotx_mc_get_client_state(c));
+#ifdef MQTT_OFFLINE_QUEUE
+        if (stored_num > 0) {
+            return stored_num;
+        }
+#endif
         return MQTT_STATE_ERROR;
     }
 
-#if !WITH_MQTT_ONLY_QOS0
-    if (topic_msg->qos == IOTX_MQTT_QOS1 || topic_msg->qos == IOTX_MQTT_QOS2) {
-        msg_id = iotx_mc_get_next_packetid(c);
-        topic_msg->packet_id = msg_id;
+#if defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_VECTORED_PUB
+    rc = MQTTPublishBatch(c, topic_msgs, count);
+#else
+    for (idx = 0; idx < count; idx++) {
+        rc = wrapper_mqtt_publish(c, topic_msgs[idx].ptopic, &topic_msgs[idx]);
+        if (rc < 0) {
+            break;
+        }
     }
-    if (topic_msg->qos == IOTX_MQTT_QOS2) {
-        mqtt_err("MQTTPublish return error,MQTT_QOS2 is now not supported.");
-        return MQTT_PUBLISH_QOS_ERROR;
+    rc = (idx > 0) ? idx : rc;
+#endif
+    if (rc == MQTT_NETWORK_ERROR) {
+        iotx_mc_set_client_state(c, IOTX_MC_STATE_DISCONNECTED);
+    }
+
+#ifdef MQTT_OFFLINE_QUEUE
+    if (stored_num > 0) {
+        rc = (rc > 0) ? (rc + stored_num) : stored_num;
+    }
+#endif
+    return rc;
+}
+
+int wrapper_mqtt_get_stats(void *client, iotx_mqtt_stats_t *stats)
+{
+    iotx_mc_client_t *c = (iotx_mc_client_t *)client;
+#if WITH_MQTT_ATOMIC
+    int idx;
+#endif
+
+    if (c == NULL || stats == NULL) {
+        return NULL_VALUE_ERROR;
+    }
+
+#if WITH_MQTT_ATOMIC
+    memset(stats, 0, sizeof(iotx_mqtt_stats_t));
+    IOTX_MC_STATS_LOAD(stats, c, pub_count);
+    IOTX_MC_STATS_LOAD(stats, c, pub_fail);
+    IOTX_MC_STATS_LOAD(stats, c, republish_count);
+    IOTX_MC_STATS_LOAD(stats, c, puback_count);
+    IOTX_MC_STATS_LOAD(stats, c, recv_count);
+    IOTX_MC_STATS_LOAD(stats, c, tx_bytes);
+    IOTX_MC_STATS_LOAD(stats, c, rx_bytes);
+    IOTX_MC_STATS_LOAD(stats, c, rx_reads);
+    IOTX_MC_STATS_LOAD(stats, c, rx_packets);
+    IOTX_MC_STATS_LOAD(stats, c, tx_buf_allocs);
+    IOTX_MC_STATS_LOAD(stats, c, rx_buf_allocs);
+    IOTX_MC_STATS_LOAD(stats, c, keepalive_fail);
+    IOTX_MC_STATS_LOAD(stats, c, ping_count);
+    IOTX_MC_STATS_LOAD(stats, c, ping_skipped);
+    IOTX_MC_STATS_LOAD(stats, c, keepalive_ms);
+    IOTX_MC_STATS_LOAD(stats, c, radio_wakeups);
+    IOTX_MC_STATS_LOAD(stats, c, disconnect_count);
+    IOTX_MC_STATS_LOAD(stats, c, reconnect_count);
+    IOTX_MC_STATS_LOAD(stats, c, reconnect_fail);
+    IOTX_MC_STATS_LOAD(stats, c, reconnect_time_ms);
+    IOTX_MC_STATS_LOAD(stats, c, reconnect_time_max_ms);
+    IOTX_MC_STATS_LOAD(stats, c, session_resumed);
+    IOTX_MC_STATS_LOAD(stats, c, sub_replayed);
+    IOTX_MC_STATS_LOAD(stats, c, rtt_max_ms);
+    IOTX_MC_STATS_LOAD(stats, c, rtt_sum_ms);
+    IOTX_MC_STATS_LOAD(stats, c, offline_queued);
+    IOTX_MC_STATS_LOAD(stats, c, offline_dropped);
+    IOTX_MC_STATS_LOAD(stats, c, offline_sent);
+    IOTX_MC_STATS_LOAD(stats, c, dispatch_dropped);
+    for (idx = 0; idx < IOTX_MQTT_RTT_HIST_NUM; idx++) {
+        IOTX_MC_STATS_LOAD(stats, c, rtt_hist[idx]);
     }
 #else
-    topic_msg->qos = IOTX_MQTT_QOS0;
+    memcpy(stats, &c->stats, sizeof(iotx_mqtt_stats_t));
 #endif
+#if defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_SLAB
+    stats->slab_allocs = iotx_mc_slab_alloc_count();
+#endif
+    return SUCCESS_RETURN;
+}
 
-#if defined(INSPECT_MQTT_FLOW) && defined(INFRA_LOG)
-    HEXDUMP_DEBUG(topicName, strlen(topicName));
-    HEXDUMP_DEBUG(topic_msg->payload, topic_msg->payload_len);
+int wrapper_mqtt_set_stats_dump(void *client, uint32_t interval_ms, iotx_mqtt_stats_dump_fpt dump, void *pcontext)
+{
+    iotx_mc_client_t *c = (iotx_mc_client_t *)client;
+
+    if (c == NULL) {
+        return NULL_VALUE_ERROR;
+    }
+
+    HAL_MutexLock(c->lock_yield);
+    c->stats_dump = dump;
+    c->stats_context = pcontext;
+    c->stats_interval_ms = interval_ms;
+    iotx_time_init(&c->stats_next_time);
+    utils_time_countdown_ms(&c->stats_next_time, interval_ms);
+    HAL_MutexUnlock(c->lock_yield);
+
+    return SUCCESS_RETURN;
+}
+
+#ifdef MQTT_TOPIC_ALIAS
+int wrapper_mqtt_set_topic_alias(void *client, uint16_t alias_max)
+{
+    iotx_mc_client_t *c = (iotx_mc_client_t *)client;
+
+    if (c == NULL) {
+        return NULL_VALUE_ERROR;
+    }
+    if (alias_max > IOTX_MC_TOPIC_ALIAS_NUM) {
+        mqtt_err("topic alias table holds %d, %u is too many", IOTX_MC_TOPIC_ALIAS_NUM, alias_max);
+        return FAIL_RETURN;
+    }
+
+    /* entries out of @alias_max are kept, PUBLISH waiting PUBACK may still name them */
+    HAL_MutexLock(c->lock_list_pub);
+    c->topic_alias_max = alias_max;
+    HAL_MutexUnlock(c->lock_list_pub);
+
+    return SUCCESS_RETURN;
+}
 #endif
 
-    rc = MQTTPublish(c, topicName, topic_msg);
-    if (rc != SUCCESS_RETURN) { /* send the subscribe packet */
-        if (rc == MQTT_NETWORK_ERROR) {
-            iotx_mc_set_client_state(c, IOTX_MC_STATE_DISCONNECTED);
+int wrapper_mqtt_set_backoff(void *client, const iotx_mqtt_backoff_param_t *param)
+{
+    iotx_mc_client_t *c = (iotx_mc_client_t *)client;
+
+    if (c == NULL) {
+        return NULL_VALUE_ERROR;
+    }
+
+    HAL_MutexLock(c->lock_generic);
+    iotx_mc_backoff_set_policy(c, param ? param->policy : NULL);
+    c->reconnect_param.backoff = param ? param->backoff : NULL;
+    c->reconnect_param.backoff_context = param ? param->pcontext : NULL;
+    HAL_MutexUnlock(c->lock_generic);
+
+    return SUCCESS_RETURN;
+}
+
+int wrapper_mqtt_set_keepalive(void *client, const iotx_mqtt_keepalive_param_t *param)
+{
+    iotx_mc_client_t *c = (iotx_mc_client_t *)client;
+
+    if (c == NULL) {
+        return NULL_VALUE_ERROR;
+    }
+
+    HAL_MutexLock(c->lock_generic);
+    iotx_mc_keepalive_set_param(c, param);
+    HAL_MutexUnlock(c->lock_generic);
+
+    return SUCCESS_RETURN;
+}
+
+int wrapper_mqtt_link_up(void *client)
+{
+    iotx_mc_client_t *c = (iotx_mc_client_t *)client;
+
+    if (c == NULL) {
+        return NULL_VALUE_ERROR;
+    }
+
+    /* taken by next reconnect check in yield, which owns the timer */
+    HAL_MutexLock(c->lock_generic);
+    c->reconnect_param.link_up = 1;
+    HAL_MutexUnlock(c->lock_generic);
+
+    return SUCCESS_RETURN;
+}
+
+#ifdef MQTT_OFFLINE_QUEUE
+int wrapper_mqtt_set_offline_queue(void *client, const iotx_mqtt_offline_param_t *param)
+{
+    iotx_mc_client_t *c = (iotx_mc_client_t *)client;
+    int rc = SUCCESS_RETURN;
+
+    if (c == NULL) {
+        return NULL_VALUE_ERROR;
+    }
+
+    HAL_MutexLock(c->lock_offline);
+    iotx_mc_offline_close(&c->offline_queue);
+    if (param != NULL) {
+        rc = iotx_mc_offline_open(&c->offline_queue, param);
+        c->offline_drain_rate = param->drain_rate;
+        c->offline_drain_time = (uint32_t)HAL_UptimeMs();
+    }
+    HAL_MutexUnlock(c->lock_offline);
+
+    return rc;
+}
+#endif
+
+#ifdef MQTT_DISPATCH
+int wrapper_mqtt_set_dispatch(void *client, const iotx_mqtt_dispatch_param_t *param)
+{
+    iotx_mc_client_t *c = (iotx_mc_client_t *)client;
+    iotx_mc_dispatch_t *dispatch = NULL;
+
+    if (c == NULL) {
+        return NULL_VALUE_ERROR;
+    }
+
+    /* take old workers away from reading thread, then stop them without lock since handlers may yield */
+    HAL_MutexLock(c->lock_yield);
+    dispatch = c->dispatch;
+    c->dispatch = NULL;
+    HAL_MutexUnlock(c->lock_yield);
+    iotx_mc_dispatch_close(dispatch);
+
+    if (param == NULL || param->worker_num == 0) {
+        return SUCCESS_RETURN;
+    }
+
+    dispatch = iotx_mc_dispatch_open(param, iotx_mc_dispatch_deliver, c);
+    if (dispatch == NULL) {
+        return FAIL_RETURN;
+    }
+
+    HAL_MutexLock(c->lock_yield);
+    c->dispatch = dispatch;
+    HAL_MutexUnlock(c->lock_yield);
+
+    return SUCCESS_RETURN;
+}
+#endif
+
+#ifdef MQTT_STREAM_RECV
+int wrapper_mqtt_set_stream_recv(void *client, uint32_t chunk_size, iotx_mqtt_stream_fpt handler, void *pcontext)
+{
+    iotx_mc_client_t *c = (iotx_mc_client_t *)client;
+
+    if (c == NULL) {
+        return NULL_VALUE_ERROR;
+    }
+
+    /* a PUBLISH being streamed is still received to its end, without handler it is dropped */
+    HAL_MutexLock(c->lock_yield);
+    c->stream_chunk_size = (chunk_size > 0) ? chunk_size : IOTX_MC_STREAM_CHUNK_DEFAULT;
+    c->stream_handle = handler;
+    c->stream_context = pcontext;
+    HAL_MutexUnlock(c->lock_yield);
+
+    return SUCCESS_RETURN;
+}
+#endif
+
+int wrapper_mqtt_get_pub_window(void *client, int *inflight, int *window_size)
+{
+    iotx_mc_client_t *c = (iotx_mc_client_t *)client;
+#if !WITH_MQTT_ONLY_QOS0 && !defined(PLATFORM_HAS_DYNMEM)
+    int idx = 0;
+#endif
+
+    if (c == NULL || inflight == NULL || window_size == NULL) {
+        return NULL_VALUE_ERROR;
+    }
+
+#if WITH_MQTT_ONLY_QOS0
+    *inflight = 0;
+    *window_size = 0;
+#elif defined(PLATFORM_HAS_DYNMEM)
+    HAL_MutexLock(c->lock_list_pub);
+    *inflight = c->pub_inflight;
+    HAL_MutexUnlock(c->lock_list_pub);
+    *window_size = IOTX_MC_PUB_WINDOW_SIZE;
+#else
+    *inflight = 0;
+    HAL_MutexLock(c->lock_list_pub);
+    for (idx = 0; idx < IOTX_MC_PUBWAIT_LIST_MAX_LEN; idx++) {
+        if (c->list_pub_wait_ack[idx].used) {
+            (*inflight)++;
         }
-        mqtt_err("MQTTPublish is error, rc = %d", rc);
-        return rc;
     }
+    HAL_MutexUnlock(c->lock_list_pub);
+    *window_size = IOTX_MC_PUBWAIT_LIST_MAX_LEN;
+#endif
 
-    return (int)msg_id;
+    return SUCCESS_RETURN;
 }
 
 #ifdef ASYNC_PROTOCOL_STACK
@@ -3140,9 +5450,16 @@ int wrapper_mqtt_nwk_event_handler(void *client, iotx_mqtt_nwk_event_t event, io
 
     switch (event) {
         case IOTX_MQTT_SOC_CONNECTED: {
+            /* read buffer is free to read CONNACK, iotx_mc_cycle() does not read until state is connected */
             rc = _mqtt_connect(pClient);
             if (rc == SUCCESS_RETURN) {
                 iotx_mc_set_client_state(pClient, IOTX_MC_STATE_CONNECTED);
+            } else {
+                /* leave it to reconnect timer, rather than connecting again on next event at once */
+                pClient->ipstack.disconnect(&pClient->ipstack);
+                IOTX_MC_STATS_ADD(pClient, reconnect_fail, 1);
+                iotx_mc_backoff_next(pClient, rc);
+                iotx_mc_set_client_state(pClient, IOTX_MC_STATE_DISCONNECTED_RECONNECTING);
             }
         }
         break;
@@ -3151,8 +5468,13 @@ int wrapper_mqtt_nwk_event_handler(void *client, iotx_mqtt_nwk_event_t event, io
         }
         break;
         case IOTX_MQTT_SOC_READ: {
+            iotx_time_t timer;
+
+            /* handle what has arrived without waiting for more, the stack reports again when there is */
+            iotx_time_init(&timer);
+            utils_time_countdown_ms(&timer, 0);
             HAL_MutexLock(pClient->lock_yield);
-            _mqtt_cycle(pClient);
+            iotx_mc_cycle(pClient, &timer);
             HAL_MutexUnlock(pClient->lock_yield);
             rc = SUCCESS_RETURN;
         }
@@ -3167,7 +5489,103 @@ int wrapper_mqtt_nwk_event_handler(void *client, iotx_mqtt_nwk_event_t event, io
         break;
     }
 
+
+
     return rc;
 }
+
+#if !WITH_MQTT_ONLY_QOS0
+/* time left before the earliest publish waiting for PUBACK is due to be republished by MQTTPubInfoProc() */
+static uint32_t iotx_mc_pub_wait_time_left(iotx_mc_client_t *pClient)
+{
+    uint32_t left = IOTX_MC_TIME_LEFT_NONE;
+#ifndef PLATFORM_HAS_DYNMEM
+    uint32_t node_left = 0;
+    int idx;
+#endif
+
+    HAL_MutexLock(pClient->lock_list_pub);
+#ifdef PLATFORM_HAS_DYNMEM
+    if (pClient->pub_inflight > 0) {
+        left = iotx_time_left(&pClient->pub_heap[0]->retry_time);
+    }
+#else
+    for (idx = 0; idx < IOTX_MC_PUBWAIT_LIST_MAX_LEN; idx++) {
+        if (pClient->list_pub_wait_ack[idx].used == 0) {
+            continue;
+        }
+        node_left = iotx_time_left(&pClient->list_pub_wait_ack[idx].retry_time);
+        if (node_left < left) {
+            left = node_left;
+        }
+    }
+#endif
+    HAL_MutexUnlock(pClient->lock_list_pub);
+
+    return left;
+}
+#endif
+
+int wrapper_mqtt_nwk_status(void *client, iotx_mqtt_nwk_param_t *param, int *connecting, uint32_t *timeout_ms)
+{
+    iotx_mc_client_t *pClient = (iotx_mc_client_t *)client;
+#if !WITH_MQTT_ONLY_QOS0 || defined(MQTT_OFFLINE_QUEUE)
+    uint32_t left = 0;
 #endif
 
+    if (client == NULL || param == NULL || connecting == NULL || timeout_ms == NULL) {
+        return NULL_VALUE_ERROR;
+    }
+
+    param->fd = (uintptr_t)(-1);
+    *connecting = 0;
+    *timeout_ms = IOTX_MC_TIME_LEFT_NONE;
+
+    switch (iotx_mc_get_client_state(pClient)) {
+        case IOTX_MC_STATE_CONNECTED: {
+            param->fd = pClient->ipstack.handle;
+            *timeout_ms = iotx_time_left(&pClient->next_ping_time);
+#if !WITH_MQTT_ONLY_QOS0
+            left = iotx_mc_pub_wait_time_left(pClient);
+            if (left < *timeout_ms) {
+                *timeout_ms = left;
+            }
+#endif
+            if (pClient->stats_interval_ms != 0 && iotx_time_left(&pClient->stats_next_time) < *timeout_ms) {
+                *timeout_ms = iotx_time_left(&pClient->stats_next_time);
+            }
+#ifdef MQTT_OFFLINE_QUEUE
+            if (pClient->offline_queue.count > 0) {
+                left = (pClient->offline_drain_rate != 0) ? 1000 / pClient->offline_drain_rate + 1 : 0;
+                if (left < *timeout_ms) {
+                    *timeout_ms = left;
+                }
+            }
+#endif
+        }
+        break;
+        case IOTX_MC_STATE_CONNECT_BLOCK: {
+            param->fd = pClient->ipstack.handle;
+            *connecting = 1;
+            *timeout_ms = iotx_time_left(&pClient->reconnect_param.reconnect_next_time);
+        }
+        break;
+        case IOTX_MC_STATE_DISCONNECTED_RECONNECTING: {
+            HAL_MutexLock(pClient->lock_generic);
+            *timeout_ms = pClient->reconnect_param.link_up ? 0 :
+                          iotx_time_left(&pClient->reconnect_param.reconnect_next_time);
+            HAL_MutexUnlock(pClient->lock_generic);
+        }
+        break;
+        case IOTX_MC_STATE_DISCONNECTED: {
+            /* yield at once to start reconnecting */
+            *timeout_ms = 0;
+        }
+        break;
+        default:
+            break;
+    }
+
+    return SUCCESS_RETURN;
+}
+#endif
@@ -14,11 +14,18 @@
 #include "mqtt_api.h"
 
 #include "MQTTPacket.h"
+#include "iotx_mqtt_topic_trie.h"
+#include "iotx_mqtt_offline.h"
+#include "iotx_mqtt_slab.h"
+#include "iotx_mqtt_dispatch.h"
 
 #ifdef INFRA_MEM_STATS
     #include "infra_mem_stats.h"
     #define mqtt_malloc(size)            LITE_malloc(size, MEM_MAGIC, "mqtt")
     #define mqtt_free(ptr)               LITE_free(ptr)
+#elif defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_SLAB
+    #define mqtt_malloc(size)            iotx_mc_slab_malloc(size)
+    #define mqtt_free(ptr)               {iotx_mc_slab_free((void *)ptr);ptr = NULL;}
 #else
     #define mqtt_malloc(size)            HAL_Malloc(size)
     #define mqtt_free(ptr)               {HAL_Free((void *)ptr);ptr = NULL;}
@@ -64,6 +71,11 @@ typedef struct iotx_mc_topic_handle_s {
 #ifdef PLATFORM_HAS_DYNMEM
     const char *topic_filter;
     struct list_head linked_list;
+#if WITH_MQTT_TOPIC_TRIE
+    void *trie_node;                                /* trie node where this handle hangs */
+    struct list_head trie_list;
+    uint32_t sub_seq;
+#endif
 #else
     const char topic_filter[CONFIG_MQTT_TOPIC_MAXLEN];
     int used;
@@ -74,28 +86,50 @@ typedef struct iotx_mc_topic_handle_s {
 /* Information structure of published topic */
 typedef struct REPUBLISH_INFO {
     iotx_time_t                 pub_start_time;     /* start time of publish request */
+    iotx_time_t                 retry_time;         /* deadline of next republish */
+    uint32_t                    retry_interval_ms;  /* wait for PUBACK before next republish, doubled by each one */
     iotx_mc_node_t              node_state;         /* state of this node */
     uint16_t                    msg_id;             /* packet id of publish */
     uint32_t                    len;                /* length of publish message */
 #ifdef PLATFORM_HAS_DYNMEM
     unsigned char              *buf;                /* publish message */
-    struct list_head            linked_list;
+    uint32_t                    heap_idx;           /* position in pub_heap */
+    uint8_t                     in_tx;              /* buf is queued to be written by iotx_mc_send_publish() */
+    uint8_t                     dropped;            /* out of pub_heap while in_tx, freed once written */
+#elif WITH_MQTT_PUB_SLAB
+    uint32_t                    offset;             /* publish message is at this offset of pub_slab */
+    int                         used;
 #else
     unsigned char               buf[IOTX_MC_TX_MAX_LEN];  /* publish message */
     int                         used;
 #endif
 } iotx_mc_pub_info_t, *iotx_mc_pub_info_pt;
+
+#if !defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_PUB_SLAB
+    #define IOTX_MC_PUB_BUF(c, node)    ((c)->pub_slab + (node)->offset)
+#else
+    #define IOTX_MC_PUB_BUF(c, node)    ((node)->buf)
+#endif
 #endif
 /* Reconnected parameter of MQTT client */
 typedef struct {
     iotx_time_t         reconnect_next_time;        /* the next time point of reconnect */
     uint32_t            reconnect_time_interval_ms; /* time interval of this reconnect */
+    uint32_t            attempts;                   /* reconnects failed in a row for err_class */
+    uint32_t            seed;                       /* state of random for jitter */
+    iotx_mqtt_reconnect_class_t err_class;          /* why the last reconnect failed */
+    iotx_mqtt_backoff_policy_t policy[IOTX_MQTT_RECONNECT_CLASS_MAX];
+    iotx_mqtt_backoff_fpt backoff;                  /* user strategy, NULL for decorrelated jitter */
+    void               *backoff_context;
+    uint8_t             link_up;                    /* link is up again, reconnect without waiting */
 } iotx_mc_reconnect_param_t;
 
 typedef struct {
     uintptr_t packet_id;
     uint8_t ack_type;
     iotx_mqtt_event_handle_func_fpt sub_state_cb;
+    iotx_mutli_sub_info_t *sub_info;    /* filters of a multi-filter SUBSCRIBE, their granted QoS is set by SUBACK */
+    int sub_count;
 #ifdef PLATFORM_HAS_DYNMEM
     struct list_head linked_list;
 #else
@@ -103,6 +137,61 @@ typedef struct {
 #endif
 } mqtt_sub_sync_node_t;
 
+#ifdef MQTT_FAST_RECONNECT
+/* Filter sent to server by SUBSCRIBE, followed by the filter terminated by '\0' */
+typedef struct {
+    struct list_head linked_list;
+    uint8_t qos;
+} iotx_mc_sub_replay_t;
+#endif
+
+#ifdef MQTT_TOPIC_ALIAS
+/* What server knows about an alias on current connection */
+typedef enum {
+    IOTX_MC_TOPIC_ALIAS_UNKNOWN,
+    IOTX_MC_TOPIC_ALIAS_DEFINING,                   /* PUBLISH telling it is being sent */
+    IOTX_MC_TOPIC_ALIAS_KNOWN
+} iotx_mc_topic_alias_state_t;
+
+/* Topic named by alias, which is index in table plus 1 */
+typedef struct {
+    char                       *topic;              /* NULL for free entry */
+    uint32_t                    hash;
+    uint16_t                    topic_len;
+    uint8_t                     state;              /* iotx_mc_topic_alias_state_t */
+} iotx_mc_topic_alias_t;
+#endif
+
+#if WITH_MQTT_ATOMIC
+#define IOTX_MC_ATOMIC_LOAD(ptr)                    __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#define IOTX_MC_ATOMIC_STORE(ptr, val)              __atomic_store_n(ptr, val, __ATOMIC_RELEASE)
+#define IOTX_MC_ATOMIC_XCHG(ptr, val)               __atomic_exchange_n(ptr, val, __ATOMIC_ACQ_REL)
+#define IOTX_MC_ATOMIC_CAS(ptr, expected, val)      \
+    __atomic_compare_exchange_n(ptr, expected, val, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#define IOTX_MC_ATOMIC_ADD(ptr, val)                __atomic_add_fetch(ptr, val, __ATOMIC_RELAXED)
+#endif
+
+/* statistics are updated by publishing threads as well as yield, none of which holds a lock for them */
+#if WITH_MQTT_ATOMIC
+#define IOTX_MC_STATS_ADD(c, field, val)            IOTX_MC_ATOMIC_ADD(&(c)->stats.field, val)
+#define IOTX_MC_STATS_SET(c, field, val)            IOTX_MC_ATOMIC_STORE(&(c)->stats.field, val)
+#define IOTX_MC_STATS_LOAD(dst, c, field)           ((dst)->field = IOTX_MC_ATOMIC_LOAD(&(c)->stats.field))
+#else
+#define IOTX_MC_STATS_ADD(c, field, val)            ((c)->stats.field += (val))
+#define IOTX_MC_STATS_SET(c, field, val)            ((c)->stats.field = (val))
+#endif
+
+#if defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_VECTORED_PUB
+/* PUBLISH submitted to be sent, on stack of the thread publishing it until it is done */
+typedef struct iotx_mc_tx_req_s {
+    struct iotx_mc_tx_req_s    *next;
+    hal_iovec_t                *iov;
+    int                         iovcnt;
+    int                         rc;                 /* result of sending */
+    uint8_t                     done;               /* set with lock_write_buf held by the thread sending it */
+} iotx_mc_tx_req_t;
+#endif
+
 /* structure of MQTT client */
 typedef struct Client {
     void                           *lock_generic;                               /* generic lock */
@@ -118,15 +207,41 @@ typedef struct Client {
 #endif
     uint32_t                        buf_size_read;                              /* read buffer size in byte */
     uint8_t                         keepalive_probes;                           /* keepalive probes */
+    uint8_t                         keepalive_probe_max;                        /* probes unanswered before disconnect */
+    uint8_t                         keepalive_idle_ping;                        /* PINGREQ outstanding followed whole idle time */
+    uint32_t                        keepalive_ms;                               /* idle time before PINGREQ */
+    uint32_t                        keepalive_min_ms;
+    uint32_t                        keepalive_max_ms;
+    uint32_t                        keepalive_step_ms;
+    uint32_t                        keepalive_good_ms;                          /* longest idle time survived, 0 for none */
+    uint32_t                        keepalive_bad_ms;                           /* idle time which lost connection, 0 for none */
+    iotx_time_t                     last_tx_time;                               /* when a packet was sent last time */
+    iotx_time_t                     last_rx_time;                               /* when a packet was received last time */
 #ifdef PLATFORM_HAS_DYNMEM
     char                           *buf_send;                                   /* pointer of send buffer */
     char                           *buf_read;                                   /* pointer of read buffer */
 #else
     char                            buf_send[IOTX_MC_TX_MAX_LEN];
     char                            buf_read[IOTX_MC_RX_MAX_LEN];
+#endif
+    /* read buffer and rx_* below are only touched by the thread holding lock_yield */
+    uint32_t                        rx_len;                                     /* bytes received in read buffer */
+    uint32_t                        rx_packet_len;                              /* length of packet being handled */
+    uint32_t                        rx_skip;                                    /* bytes to drop of too long packet */
+    char                            rx_saved;                                   /* byte overwritten by packet end */
+#ifdef MQTT_STREAM_RECV
+    uint32_t                        rx_stream_hdr;                              /* header of PUBLISH being streamed, 0 for none */
+    uint32_t                        rx_stream_left;                             /* payload bytes of it not delivered */
+    uint32_t                        rx_stream_offset;                           /* payload bytes of it delivered */
+    uint32_t                        stream_chunk_size;
+    iotx_mqtt_stream_fpt            stream_handle;                              /* PUBLISH too long for read buffer */
+    void                           *stream_context;
 #endif
 #ifdef PLATFORM_HAS_DYNMEM
     struct list_head                list_sub_handle;                            /* list of subscribe handle */
+#if WITH_MQTT_TOPIC_TRIE
+    iotx_mc_topic_trie_t            topic_trie;                                 /* index of list_sub_handle for dispatch */
+#endif
 #else
     iotx_mc_topic_handle_t          list_sub_handle[IOTX_MC_SUBHANDLE_LIST_MAX_LEN];
 #endif
@@ -134,12 +249,20 @@ typedef struct Client {
     iotx_time_t                     next_ping_time;                             /* next ping time */
     iotx_mc_state_t                 client_state;                               /* state of MQTT client */
     iotx_mc_reconnect_param_t       reconnect_param;                            /* reconnect parameter */
+    iotx_time_t                     disconnect_time;                            /* when connection is found lost */
+    uint8_t                         reconnect_timing;                           /* disconnect_time is counting */
+    uint8_t                         session_present;                            /* session present flag of CONNACK */
     MQTTPacket_connectData          connect_data;                               /* connection parameter */
 #if !WITH_MQTT_ONLY_QOS0
 #ifdef PLATFORM_HAS_DYNMEM
-    struct list_head                list_pub_wait_ack;                          /* list of wait publish ack */
+    iotx_mc_pub_info_t             *pub_heap[IOTX_MC_PUB_WINDOW_SIZE];          /* publishes wait for ack, min-heap of retry_time */
+    iotx_mc_pub_info_t             *pub_window[IOTX_MC_PUB_WINDOW_SIZE];        /* pub_heap indexed by packet id */
+    uint32_t                        pub_inflight;                               /* number of nodes in pub_heap */
 #else
     iotx_mc_pub_info_t              list_pub_wait_ack[IOTX_MC_PUBWAIT_LIST_MAX_LEN];
+#if WITH_MQTT_PUB_SLAB
+    unsigned char                   pub_slab[IOTX_MC_PUB_SLAB_LEN];             /* messages of list_pub_wait_ack */
+#endif
 #endif
 #endif
 #ifdef PLATFORM_HAS_DYNMEM
@@ -149,22 +272,38 @@ typedef struct Client {
 #endif
     void                           *lock_list_pub;                              /* lock for list of QoS1 pub */
     void                           *lock_write_buf;                             /* lock of write */
-    void                           *lock_read_buf;                             /* lock of write */
-    void                           *lock_yield;
+    void                           *lock_yield;                                 /* held by the thread reading */
+#if defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_VECTORED_PUB
+    iotx_mc_tx_req_t               *tx_queue;                                   /* PUBLISH to send, newest first */
+#endif
     iotx_mqtt_event_handle_t        handle_event;                               /* event handle */
+    iotx_mqtt_stats_t               stats;                                      /* statistics */
+    uint32_t                        stats_interval_ms;                          /* interval of dumping stats */
+    iotx_time_t                     stats_next_time;                            /* next time of dumping stats */
+    iotx_mqtt_stats_dump_fpt        stats_dump;                                 /* stats dump handle */
+    void                           *stats_context;
+#ifdef MQTT_OFFLINE_QUEUE
+    iotx_mc_offline_queue_t         offline_queue;                              /* publishes stored while disconnected */
+    uint32_t                        offline_drain_rate;                         /* publishes sent from queue per second */
+    uint32_t                        offline_drain_time;                         /* uptime when draining quota is counted */
+    void                           *lock_offline;                               /* lock of offline queue */
+#endif
+#ifdef MQTT_FAST_RECONNECT
+    struct list_head                list_sub_replay;                            /* filters subscribed on server */
+    uint8_t                         sub_replay_pending;                         /* server lost session, replay filters */
+#endif
+#ifdef MQTT_TOPIC_ALIAS
+    iotx_mc_topic_alias_t           topic_alias[IOTX_MC_TOPIC_ALIAS_NUM];       /* guarded by lock_list_pub */
+    uint16_t                        topic_alias_max;                            /* aliases to use, 0 for none */
+#endif
+#ifdef MQTT_DISPATCH
+    iotx_mc_dispatch_t             *dispatch;                                   /* workers calling PUBLISH handlers */
+#endif
 #ifndef PLATFORM_HAS_DYNMEM
     int                            used;
 #endif
 } iotx_mc_client_t, *iotx_mc_client_pt;
 
-/* Information structure of mutli-subscribe */
-typedef struct {
-    const char                                    *topicFilter;
-    iotx_mqtt_qos_t                                qos;
-    iotx_mqtt_event_handle_func_fpt                messageHandler;
-} iotx_mutli_sub_info_t, *iotx_mutli_sub_info_pt;
-
-
 #endif  /* __IOTX_MQTT_H__ */
 
 
@@ -17,10 +17,33 @@
     #define WITH_MQTT_FLOW_CTRL                 (0)
 #endif
 
+/* packets left out of build by FEATURE_MQTT_ONLY_QOS0 and FEATURE_MQTT_NO_UNSUBSCRIBE in make.settings */
+#if defined(MQTT_ONLY_QOS0) && !defined(WITH_MQTT_ONLY_QOS0)
+    #define WITH_MQTT_ONLY_QOS0                 (1)
+#endif
+
+#if defined(MQTT_NO_UNSUBSCRIBE) && !defined(WITH_MQTT_UNSUBSCRIBE)
+    #define WITH_MQTT_UNSUBSCRIBE               (0)
+#endif
+
 #ifndef WITH_MQTT_ONLY_QOS0
     #define WITH_MQTT_ONLY_QOS0                 (0)
 #endif
 
+/* UNSUBSCRIBE and UNSUBACK, IOT_MQTT_Unsubscribe() fails without them */
+#ifndef WITH_MQTT_UNSUBSCRIBE
+    #define WITH_MQTT_UNSUBSCRIBE               (1)
+#endif
+
+/* QoS1 publishes waiting for PUBACK share one slab instead of a IOTX_MC_TX_MAX_LEN buffer each, only without PLATFORM_HAS_DYNMEM */
+#if defined(MQTT_PUB_SLAB) && !defined(WITH_MQTT_PUB_SLAB)
+    #define WITH_MQTT_PUB_SLAB                  (1)
+#endif
+
+#ifndef WITH_MQTT_PUB_SLAB
+    #define WITH_MQTT_PUB_SLAB                  (0)
+#endif
+
 #ifndef WITH_MQTT_DYN_CONNINFO
     #define WITH_MQTT_DYN_CONNINFO              (1)
 #endif
@@ -29,8 +52,88 @@
     #define WITH_MQTT_ZIP_TOPIC                 (0)
 #endif
 
-/* maximum republish elements in list */
-#define IOTX_MC_REPUB_NUM_MAX                   (20)
+/* dispatch PUBLISH through topic trie instead of walking subscribe list, only when PLATFORM_HAS_DYNMEM */
+#ifndef WITH_MQTT_TOPIC_TRIE
+    #define WITH_MQTT_TOPIC_TRIE                (1)
+#endif
+
+/* serve mqtt_malloc() from size-class slab instead of heap, only when PLATFORM_HAS_DYNMEM */
+#ifndef WITH_MQTT_SLAB
+    #define WITH_MQTT_SLAB                      (1)
+#endif
+
+/* send PUBLISH as header/topic/payload segments instead of joining them in send buffer, only when PLATFORM_HAS_DYNMEM */
+#ifndef WITH_MQTT_VECTORED_PUB
+    #define WITH_MQTT_VECTORED_PUB              (1)
+#endif
+
+/* client state, packet id and queue of publishes to send are updated by compiler atomics instead of locks */
+#ifndef WITH_MQTT_ATOMIC
+    #if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+        #define WITH_MQTT_ATOMIC                (1)
+    #else
+        #define WITH_MQTT_ATOMIC                (0)
+    #endif
+#endif
+
+/* handles matched by one PUBLISH which can be dispatched without allocating memory */
+#define IOTX_MC_TOPIC_MATCH_NUM                 (8)
+
+/* fixed header, remaining length and length of topic name in front of topic name of PUBLISH */
+#define IOTX_MC_PUB_HEADER_MAXLEN               (7)
+
+#ifdef MQTT_TOPIC_ALIAS
+/* size of topic alias table, alias is from 1 to this */
+#ifndef IOTX_MC_TOPIC_ALIAS_NUM
+    #define IOTX_MC_TOPIC_ALIAS_NUM             (32)
+#endif
+/* "$<alias>=" in front of topic name, "$65535=" at most */
+#define IOTX_MC_TOPIC_ALIAS_PREFIX_MAXLEN       (7)
+#else
+#define IOTX_MC_TOPIC_ALIAS_PREFIX_MAXLEN       (0)
+#endif
+
+/* maximum QoS1 publishes waiting for PUBACK when PLATFORM_HAS_DYNMEM, power of 2 and no more than 32768 */
+#ifndef IOTX_MC_PUB_WINDOW_SIZE
+    #define IOTX_MC_PUB_WINDOW_SIZE             (128)
+#endif
+
+/* maximum interval of republishing one QoS1 publish, it starts from twice of request timeout and doubles each time */
+#define IOTX_MC_REPUB_INTERVAL_MAX_MS           (60000)
+
+/* maximum QoS1 publishes republished in one cycle, the rest wait for next cycle */
+#define IOTX_MC_REPUB_NUM_PER_CYCLE             (8)
+
+/* maximum publishes sent from offline queue in one cycle */
+#define IOTX_MC_OFFLINE_DRAIN_BURST             (16)
+
+/* maximum worker threads handling received PUBLISH, queue of each worker holds 64 messages unless specified */
+#define IOTX_MC_DISPATCH_WORKER_MAX             (16)
+#define IOTX_MC_DISPATCH_QUEUE_DEFAULT          (64)
+#define IOTX_MC_DISPATCH_STACK_SIZE             (4096)
+
+/* slab classes of 32, 64, ... bytes blocks, each one doubles the previous, head of 8 bytes included */
+#define IOTX_MC_SLAB_BLOCK_MIN                  (32)
+#define IOTX_MC_SLAB_CLASS_NUM                  (7)
+
+/* bytes of blocks of one slab page, a page holds IOTX_MC_SLAB_PAGE_BLOCK_MIN blocks at least */
+#define IOTX_MC_SLAB_PAGE_SIZE                  (4096)
+#define IOTX_MC_SLAB_PAGE_BLOCK_MIN             (4)
+
+/* empty pages kept by each slab class rather than returned to heap */
+#define IOTX_MC_SLAB_EMPTY_KEEP                 (1)
+
+/* maximum publishes coalesced into one write by IOT_MQTT_Publish_Batch() */
+#define IOTX_MC_PUB_BATCH_NUM                   (16)
+
+/* maximum segments of queued publishes coalesced into one write by the thread sending them, one batch at least */
+#define IOTX_MC_TX_IOV_MAX                      (IOTX_MC_PUB_BATCH_NUM * 3)
+
+/* bytes of each piece of streamed PUBLISH unless specified */
+#define IOTX_MC_STREAM_CHUNK_DEFAULT            (1024)
+
+/* bytes read beyond the packet being parsed when read buffer is allocated on demand, lets a burst of packets in by one read */
+#define IOTX_MC_RX_READAHEAD_LEN                (512)
 
 /* MQTT client version number */
 #define IOTX_MC_MQTT_VERSION                    (4)
@@ -47,9 +150,23 @@
 /* Maximum interval of MQTT reconnect in millisecond */
 #define IOTX_MC_RECONNECT_INTERVAL_MAX_MS       (60000)
 
+/* Interval range of reconnect after server refused for being unavailable, which needs time to recover */
+#define IOTX_MC_RECONNECT_UNAVAILABLE_MIN_MS    (5000)
+#define IOTX_MC_RECONNECT_UNAVAILABLE_MAX_MS    (300000)
+
+/* Interval range of reconnect after server rejected the client, which is seldom solved by retrying soon */
+#define IOTX_MC_RECONNECT_REJECTED_MIN_MS       (30000)
+#define IOTX_MC_RECONNECT_REJECTED_MAX_MS       (1800000)
+
 /* Max times of keepalive which has been send and did not received response package */
 #define IOTX_MC_KEEPALIVE_PROBE_MAX             (2)
 
+/* Idle time before PINGREQ grows by this each time it is survived, when probing is enabled without step */
+#define IOTX_MC_KEEPALIVE_STEP_MS               (15000)
+
+/* Link idle for this long lets cellular radio drop to idle state, so the next packet wakes it up */
+#define IOTX_MC_RADIO_TAIL_MS                   (10000)
+
 
 /* Linked List Params When PLATFORM_HAS_DYNMEN Disabled */
 #ifndef PLATFORM_HAS_DYNMEN
@@ -82,6 +199,11 @@
         #define IOTX_MC_RX_MAX_LEN                      (512)
     #endif
 
+    /* bytes shared by QoS1 publishes waiting for PUBACK when WITH_MQTT_PUB_SLAB, one IOTX_MC_TX_MAX_LEN publish at least */
+    #ifndef IOTX_MC_PUB_SLAB_LEN
+        #define IOTX_MC_PUB_SLAB_LEN                    (IOTX_MC_TX_MAX_LEN * 2)
+    #endif
+
 #endif /* PLATFORM_HAS_DYNMEM */
 
 #endif  /* IOTX_MQTT_CONFIG_H__ */
@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2015-2018 Alibaba Group Holding Limited
+ */
+#include "mqtt_internal.h"
+
+#ifdef MQTT_DISPATCH
+
+static void *_dispatch_worker_routine(void *arg)
+{
+    iotx_mc_dispatch_worker_t *worker = (iotx_mc_dispatch_worker_t *)arg;
+    iotx_mc_dispatch_t *dispatch = worker->dispatch;
+    iotx_mc_dispatch_msg_t *msg = NULL;
+    uint8_t stop = 0;
+
+    while (1) {
+        HAL_SemaphoreWait(worker->sem, PLATFORM_WAIT_INFINITE);
+
+        HAL_MutexLock(worker->lock);
+        msg = worker->head;
+        if (msg != NULL) {
+            worker->head = msg->next;
+            if (worker->head == NULL) {
+                worker->tail = NULL;
+            }
+            worker->count--;
+        }
+        stop = worker->stop;
+        HAL_MutexUnlock(worker->lock);
+
+        if (msg == NULL) {
+            /* queue is drained when the stop is seen, for it is posted after all messages */
+            if (stop) {
+                break;
+            }
+            continue;
+        }
+
+        dispatch->deliver(dispatch->client, msg);
+        mqtt_free(msg);
+    }
+
+    HAL_MutexLock(worker->lock);
+    worker->running = 0;
+    HAL_MutexUnlock(worker->lock);
+
+    return NULL;
+}
+
+static void _dispatch_worker_deinit(iotx_mc_dispatch_worker_t *worker)
+{
+    if (worker->sem != NULL) {
+        HAL_SemaphoreDestroy(worker->sem);
+    }
+    if (worker->lock != NULL) {
+        HAL_MutexDestroy(worker->lock);
+    }
+    memset(worker, 0, sizeof(iotx_mc_dispatch_worker_t));
+}
+
+static void _dispatch_worker_stop(iotx_mc_dispatch_worker_t *worker)
+{
+    uint8_t running = 1;
+
+    HAL_MutexLock(worker->lock);
+    worker->stop = 1;
+    HAL_MutexUnlock(worker->lock);
+    HAL_SemaphorePost(worker->sem);
+
+    while (running) {
+        HAL_MutexLock(worker->lock);
+        running = worker->running;
+        HAL_MutexUnlock(worker->lock);
+        if (running) {
+            HAL_SleepMs(10);
+        }
+    }
+    HAL_ThreadDelete(worker->thread);
+}
+
+iotx_mc_dispatch_t *iotx_mc_dispatch_open(const iotx_mqtt_dispatch_param_t *param, iotx_mc_dispatch_fpt deliver,
+        void *client)
+{
+    uint32_t idx;
+    int stack_used = 0;
+    iotx_mc_dispatch_t *dispatch = NULL;
+    hal_os_thread_param_t thread_param;
+
+    if (param == NULL || deliver == NULL) {
+        return NULL;
+    }
+    if (param->worker_num == 0 || param->worker_num > IOTX_MC_DISPATCH_WORKER_MAX) {
+        mqtt_err("dispatch workers should be 1 ~ %d", IOTX_MC_DISPATCH_WORKER_MAX);
+        return NULL;
+    }
+
+    dispatch = mqtt_malloc(sizeof(iotx_mc_dispatch_t) + sizeof(iotx_mc_dispatch_worker_t) * param->worker_num);
+    if (dispatch == NULL) {
+        return NULL;
+    }
+    memset(dispatch, 0, sizeof(iotx_mc_dispatch_t) + sizeof(iotx_mc_dispatch_worker_t) * param->worker_num);
+    dispatch->workers = (iotx_mc_dispatch_worker_t *)(dispatch + 1);
+    dispatch->queue_max = (param->queue_max + param->worker_num - 1) / param->worker_num;
+    if (dispatch->queue_max == 0) {
+        dispatch->queue_max = IOTX_MC_DISPATCH_QUEUE_DEFAULT;
+    }
+    dispatch->deliver = deliver;
+    dispatch->client = client;
+
+    memset(&thread_param, 0, sizeof(hal_os_thread_param_t));
+    thread_param.stack_size = (param->stack_size > 0) ? param->stack_size : IOTX_MC_DISPATCH_STACK_SIZE;
+    thread_param.name = "mqtt_dispatch";
+
+    for (idx = 0; idx < param->worker_num; idx++) {
+        iotx_mc_dispatch_worker_t *worker = &dispatch->workers[idx];
+
+        worker->dispatch = dispatch;
+        worker->lock = HAL_MutexCreate();
+        worker->sem = HAL_SemaphoreCreate();
+        worker->running = 1;
+        if (worker->lock == NULL || worker->sem == NULL ||
+            HAL_ThreadCreate(&worker->thread, _dispatch_worker_routine, worker, &thread_param, &stack_used) != 0) {
+            mqtt_err("create dispatch worker %u failed", idx);
+            worker->running = 0;
+            _dispatch_worker_deinit(worker);
+            dispatch->worker_num = idx;
+            iotx_mc_dispatch_close(dispatch);
+            return NULL;
+        }
+    }
+    dispatch->worker_num = param->worker_num;
+
+    return dispatch;
+}
+
+void iotx_mc_dispatch_close(iotx_mc_dispatch_t *dispatch)
+{
+    uint32_t idx;
+
+    if (dispatch == NULL) {
+        return;
+    }
+
+    for (idx = 0; idx < dispatch->worker_num; idx++) {
+        _dispatch_worker_stop(&dispatch->workers[idx]);
+        _dispatch_worker_deinit(&dispatch->workers[idx]);
+    }
+    mqtt_free(dispatch);
+}
+
+int iotx_mc_dispatch_push(iotx_mc_dispatch_t *dispatch, const char *topic, uint32_t topic_len,
+                          iotx_mqtt_topic_info_pt topic_msg)
+{
+    uint32_t idx, hash = 2166136261u;
+    iotx_mc_dispatch_worker_t *worker = NULL;
+    iotx_mc_dispatch_msg_t *msg = NULL;
+
+    if (topic_len > 0xFFFF) {
+        return FAIL_RETURN;
+    }
+
+    /* FNV-1a of topic picks the worker */
+    for (idx = 0; idx < topic_len; idx++) {
+        hash ^= (unsigned char)topic[idx];
+        hash *= 16777619u;
+    }
+    worker = &dispatch->workers[hash % dispatch->worker_num];
+
+    HAL_MutexLock(worker->lock);
+    if (worker->count >= dispatch->queue_max) {
+        HAL_MutexUnlock(worker->lock);
+        return MQTT_DISPATCH_QUEUE_FULL;
+    }
+    HAL_MutexUnlock(worker->lock);
+
+    msg = mqtt_malloc(sizeof(iotx_mc_dispatch_msg_t) + topic_len + 1 + topic_msg->payload_len);
+    if (msg == NULL) {
+        return ERROR_MALLOC;
+    }
+    msg->next = NULL;
+    msg->payload_len = topic_msg->payload_len;
+    msg->topic_len = (uint16_t)topic_len;
+    msg->packet_id = topic_msg->packet_id;
+    msg->qos = topic_msg->qos;
+    msg->dup = topic_msg->dup;
+    msg->retain = topic_msg->retain;
+    memcpy((char *)(msg + 1), topic, topic_len);
+    ((char *)(msg + 1))[topic_len] = '\0';
+    memcpy((char *)(msg + 1) + topic_len + 1, topic_msg->payload, topic_msg->payload_len);
+
+    HAL_MutexLock(worker->lock);
+    if (worker->tail != NULL) {
+        worker->tail->next = msg;
+    } else {
+        worker->head = msg;
+    }
+    worker->tail = msg;
+    worker->count++;
+    HAL_MutexUnlock(worker->lock);
+    HAL_SemaphorePost(worker->sem);
+
+    return SUCCESS_RETURN;
+}
+
+#endif  /* #ifdef MQTT_DISPATCH */
+
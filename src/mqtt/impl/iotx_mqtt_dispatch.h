@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2015-2018 Alibaba Group Holding Limited
+ */
+
+#ifndef __IOTX_MQTT_DISPATCH_H__
+#define __IOTX_MQTT_DISPATCH_H__
+
+#include "infra_types.h"
+#include "mqtt_api.h"
+
+#ifdef MQTT_DISPATCH
+
+/* Received PUBLISH copied for a worker, followed by topic name terminated by '\0' and payload */
+typedef struct iotx_mc_dispatch_msg_s {
+    struct iotx_mc_dispatch_msg_s  *next;
+    uint32_t                        payload_len;
+    uint16_t                        topic_len;
+    uint16_t                        packet_id;
+    uint8_t                         qos;
+    uint8_t                         dup;
+    uint8_t                         retain;
+} iotx_mc_dispatch_msg_t;
+
+/* called by worker for each message, in the order messages of a topic are pushed */
+typedef void (*iotx_mc_dispatch_fpt)(void *client, iotx_mc_dispatch_msg_t *msg);
+
+/* One worker thread and its queue, which is filled by any thread reading network */
+typedef struct {
+    void                           *lock;
+    void                           *sem;                /* posted once per message pushed, and once to stop */
+    void                           *thread;
+    iotx_mc_dispatch_msg_t         *head;
+    iotx_mc_dispatch_msg_t         *tail;
+    uint32_t                        count;
+    uint8_t                         running;            /* cleared by worker when it leaves */
+    uint8_t                         stop;
+    struct iotx_mc_dispatch_s      *dispatch;
+} iotx_mc_dispatch_worker_t;
+
+/*
+ * Pool of workers calling PUBLISH handlers out of the thread reading network. Messages of a topic always go
+ * to the same worker, so they are handled in the order received while different topics run in parallel.
+ */
+typedef struct iotx_mc_dispatch_s {
+    iotx_mc_dispatch_worker_t      *workers;            /* follow this struct in the same block */
+    uint32_t                        worker_num;
+    uint32_t                        queue_max;          /* messages waiting in queue of one worker */
+    iotx_mc_dispatch_fpt            deliver;
+    void                           *client;
+} iotx_mc_dispatch_t;
+
+/* start workers of @param, return NULL on failure */
+iotx_mc_dispatch_t *iotx_mc_dispatch_open(const iotx_mqtt_dispatch_param_t *param, iotx_mc_dispatch_fpt deliver,
+        void *client);
+
+/* stop workers after messages queued are handled, then free the pool */
+void iotx_mc_dispatch_close(iotx_mc_dispatch_t *dispatch);
+
+/**
+ * @brief Copy a received PUBLISH into queue of the worker serving its topic.
+ *
+ * @param [in] dispatch: the worker pool.
+ * @param [in] topic: topic name of the PUBLISH, not terminated.
+ * @param [in] topic_len: length of topic name.
+ * @param [in] topic_msg: qos, packet id, flags and payload of the PUBLISH.
+ *
+ * @return SUCCESS_RETURN, or MQTT_DISPATCH_QUEUE_FULL when the queue of worker is full.
+ */
+int iotx_mc_dispatch_push(iotx_mc_dispatch_t *dispatch, const char *topic, uint32_t topic_len,
+                          iotx_mqtt_topic_info_pt topic_msg);
+
+#endif  /* #ifdef MQTT_DISPATCH */
+
+#endif  /* __IOTX_MQTT_DISPATCH_H__ */
+
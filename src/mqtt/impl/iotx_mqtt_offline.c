@@ -0,0 +1,326 @@
+/*
+ * Copyright (C) 2015-2018 Alibaba Group Holding Limited
+ */
+#include "mqtt_internal.h"
+
+#ifdef MQTT_OFFLINE_QUEUE
+
+#define IOTX_MC_OFFLINE_MAGIC                   (0x514f434d)    /* "MCOQ" */
+
+/* record area smaller than this can hardly hold a PUBLISH */
+#define IOTX_MC_OFFLINE_AREA_MIN                (64)
+
+/* length of a wrap record, which tells the next record is at the beginning of area */
+#define IOTX_MC_OFFLINE_WRAP                    (0xFFFFFFFF)
+
+#define IOTX_MC_OFFLINE_ALIGN(len)              (((len) + 3) & ~((uint32_t)3))
+
+/* Record head, followed by topic name terminated by '\0' and payload, padded to 4 bytes */
+typedef struct {
+    uint32_t                        seq;
+    uint32_t                        len;                /* bytes of topic name, its '\0' and payload */
+    uint16_t                        topic_len;
+    uint8_t                         qos;
+    uint8_t                         retain;
+    uint32_t                        crc;                /* CRC32 of fields above and the bytes of @len */
+} iotx_mc_offline_record_t;
+
+static uint32_t _offline_crc32(uint32_t crc, const void *data, uint32_t len)
+{
+    static const uint32_t table[16] = {
+        0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+        0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+    };
+    const uint8_t *p = (const uint8_t *)data;
+
+    crc = ~crc;
+    while (len-- > 0) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ table[crc & 0x0f];
+        crc = (crc >> 4) ^ table[crc & 0x0f];
+    }
+
+    return ~crc;
+}
+
+static uint32_t _offline_record_crc(iotx_mc_offline_record_t *record)
+{
+    uint32_t crc = _offline_crc32(0, record, offsetof(iotx_mc_offline_record_t, crc));
+
+    if (record->len != IOTX_MC_OFFLINE_WRAP) {
+        crc = _offline_crc32(crc, (uint8_t *)record + sizeof(iotx_mc_offline_record_t), record->len);
+    }
+    return crc;
+}
+
+static void _offline_sync(iotx_mc_offline_queue_t *queue, void *addr, uint32_t len)
+{
+    HAL_Segment_Sync(queue->segment, (uint32_t)((uint8_t *)addr - queue->segment), len);
+}
+
+static void _offline_write_head(iotx_mc_offline_queue_t *queue)
+{
+    queue->head->crc = _offline_crc32(0, queue->head, offsetof(iotx_mc_offline_head_t, crc));
+    _offline_sync(queue, queue->head, sizeof(iotx_mc_offline_head_t));
+}
+
+/*
+ * Find record @seq which is at @pos, or at the beginning of area when the rest of area after @pos is skipped.
+ * Return offset of the record and bytes skipped by @skip, or -1 when there is no such record.
+ */
+static int _offline_locate(iotx_mc_offline_queue_t *queue, uint32_t pos, uint32_t seq, uint32_t *skip)
+{
+    uint32_t size = queue->head->size;
+    iotx_mc_offline_record_t *record = NULL;
+
+    *skip = 0;
+    if (size - pos < sizeof(iotx_mc_offline_record_t)) {
+        *skip = size - pos;
+        pos = 0;
+    } else {
+        record = (iotx_mc_offline_record_t *)(queue->area + pos);
+        if (record->len == IOTX_MC_OFFLINE_WRAP && record->seq == seq && record->crc == _offline_record_crc(record)) {
+            *skip = size - pos;
+            pos = 0;
+        }
+    }
+
+    record = (iotx_mc_offline_record_t *)(queue->area + pos);
+    if (record->seq != seq || record->len == IOTX_MC_OFFLINE_WRAP ||
+        record->len > size - pos - sizeof(iotx_mc_offline_record_t) ||
+        record->topic_len >= record->len || record->crc != _offline_record_crc(record)) {
+        return -1;
+    }
+
+    return (int)pos;
+}
+
+static uint32_t _offline_record_size(uint32_t len)
+{
+    return sizeof(iotx_mc_offline_record_t) + IOTX_MC_OFFLINE_ALIGN(len);
+}
+
+/* drop all records, sequence numbers go on so that stale records are never taken as new ones */
+static void _offline_reset(iotx_mc_offline_queue_t *queue)
+{
+    queue->tail = 0;
+    queue->used = 0;
+    queue->count = 0;
+    queue->head->head = 0;
+    queue->head->head_seq = queue->tail_seq;
+    _offline_write_head(queue);
+}
+
+/* offset where a record of @need bytes fits, with bytes skipped at end of area by @skip, or -1 */
+static int _offline_reserve(iotx_mc_offline_queue_t *queue, uint32_t need, uint32_t *skip)
+{
+    uint32_t size = queue->head->size;
+    uint32_t head = queue->head->head;
+
+    *skip = 0;
+    if (queue->count == 0) {
+        _offline_reset(queue);
+        return (need <= size) ? 0 : -1;
+    }
+
+    if (queue->tail > head) {
+        if (size - queue->tail >= need) {
+            return (int)queue->tail;
+        }
+        if (head >= need) {
+            *skip = size - queue->tail;
+            return 0;
+        }
+        return -1;
+    }
+
+    /* tail equals head only when queue is full */
+    if (queue->used < size && head - queue->tail >= need) {
+        return (int)queue->tail;
+    }
+    return -1;
+}
+
+int iotx_mc_offline_open(iotx_mc_offline_queue_t *queue, const iotx_mqtt_offline_param_t *param)
+{
+    uint32_t size, pos, seq, skip = 0;
+    int off;
+
+    if (queue == NULL || param == NULL || param->path == NULL) {
+        return NULL_VALUE_ERROR;
+    }
+
+    size = IOTX_MC_OFFLINE_ALIGN(param->max_bytes);
+    if (size < IOTX_MC_OFFLINE_AREA_MIN) {
+        mqtt_err("offline queue of %u bytes is too small", param->max_bytes);
+        return FAIL_RETURN;
+    }
+
+    memset(queue, 0, sizeof(iotx_mc_offline_queue_t));
+    queue->segment_size = sizeof(iotx_mc_offline_head_t) + size;
+    queue->segment = HAL_Segment_Map(param->path, queue->segment_size);
+    if (queue->segment == NULL) {
+        mqtt_err("map offline queue %s failed", param->path);
+        return FAIL_RETURN;
+    }
+    queue->head = (iotx_mc_offline_head_t *)queue->segment;
+    queue->area = queue->segment + sizeof(iotx_mc_offline_head_t);
+    queue->drop_policy = param->drop_policy;
+
+    if (queue->head->magic != IOTX_MC_OFFLINE_MAGIC || queue->head->size != size || queue->head->head >= size ||
+        queue->head->crc != _offline_crc32(0, queue->head, offsetof(iotx_mc_offline_head_t, crc))) {
+        mqtt_info("init offline queue %s", param->path);
+        memset(queue->segment, 0, queue->segment_size);
+        queue->head->magic = IOTX_MC_OFFLINE_MAGIC;
+        queue->head->size = size;
+        queue->tail_seq = 1;
+        _offline_reset(queue);
+        return SUCCESS_RETURN;
+    }
+
+    /* walk from head to find tail left by last run */
+    pos = queue->head->head;
+    seq = queue->head->head_seq;
+    while ((off = _offline_locate(queue, pos, seq, &skip)) >= 0) {
+        uint32_t record_size = _offline_record_size(((iotx_mc_offline_record_t *)(queue->area + off))->len);
+
+        if (queue->used + skip + record_size > size) {
+            break;
+        }
+        queue->used += skip + record_size;
+        queue->count++;
+        pos = off + record_size;
+        seq++;
+    }
+    queue->tail = pos;
+    queue->tail_seq = seq;
+    if (queue->count == 0) {
+        _offline_reset(queue);
+    }
+    mqtt_info("offline queue %s holds %u publishes", param->path, queue->count);
+
+    return SUCCESS_RETURN;
+}
+
+void iotx_mc_offline_close(iotx_mc_offline_queue_t *queue)
+{
+    if (queue == NULL || queue->segment == NULL) {
+        return;
+    }
+
+    HAL_Segment_Sync(queue->segment, 0, queue->segment_size);
+    HAL_Segment_Unmap(queue->segment, queue->segment_size);
+    memset(queue, 0, sizeof(iotx_mc_offline_queue_t));
+}
+
+int iotx_mc_offline_push(iotx_mc_offline_queue_t *queue, const char *topic, iotx_mqtt_topic_info_pt topic_msg,
+                         uint32_t *dropped)
+{
+    uint32_t topic_len = strlen(topic);
+    uint32_t len = topic_len + 1 + topic_msg->payload_len;
+    uint32_t need = _offline_record_size(len);
+    uint32_t skip = 0;
+    int pos;
+    iotx_mc_offline_record_t *record = NULL;
+
+    *dropped = 0;
+    if (topic_len > 0xFFFF || need > queue->head->size) {
+        return MQTT_OFFLINE_QUEUE_FULL;
+    }
+
+    while ((pos = _offline_reserve(queue, need, &skip)) < 0) {
+        if (queue->drop_policy != IOTX_MQTT_OFFLINE_DROP_OLD) {
+            return MQTT_OFFLINE_QUEUE_FULL;
+        }
+        iotx_mc_offline_pop(queue);
+        (*dropped)++;
+    }
+
+    if (skip >= sizeof(iotx_mc_offline_record_t)) {
+        record = (iotx_mc_offline_record_t *)(queue->area + queue->tail);
+        memset(record, 0, sizeof(iotx_mc_offline_record_t));
+        record->seq = queue->tail_seq;
+        record->len = IOTX_MC_OFFLINE_WRAP;
+        record->crc = _offline_record_crc(record);
+        _offline_sync(queue, record, sizeof(iotx_mc_offline_record_t));
+    }
+
+    record = (iotx_mc_offline_record_t *)(queue->area + pos);
+    record->seq = queue->tail_seq;
+    record->len = len;
+    record->topic_len = (uint16_t)topic_len;
+    record->qos = topic_msg->qos;
+    record->retain = topic_msg->retain;
+    memcpy((char *)record + sizeof(iotx_mc_offline_record_t), topic, topic_len + 1);
+    memcpy((char *)record + sizeof(iotx_mc_offline_record_t) + topic_len + 1, topic_msg->payload,
+           topic_msg->payload_len);
+    record->crc = _offline_record_crc(record);
+    _offline_sync(queue, record, need);
+
+    queue->used += skip + need;
+    queue->tail = pos + need;
+    queue->tail_seq++;
+    queue->count++;
+
+    return SUCCESS_RETURN;
+}
+
+int iotx_mc_offline_peek(iotx_mc_offline_queue_t *queue, iotx_mqtt_topic_info_pt topic_msg)
+{
+    uint32_t skip = 0;
+    int pos;
+    iotx_mc_offline_record_t *record = NULL;
+
+    if (queue->count == 0) {
+        return FAIL_RETURN;
+    }
+
+    pos = _offline_locate(queue, queue->head->head, queue->head->head_seq, &skip);
+    if (pos < 0) {
+        mqtt_err("offline queue is corrupted, %u publishes lost", queue->count);
+        _offline_reset(queue);
+        return FAIL_RETURN;
+    }
+
+    record = (iotx_mc_offline_record_t *)(queue->area + pos);
+    memset(topic_msg, 0, sizeof(iotx_mqtt_topic_info_t));
+    topic_msg->qos = record->qos;
+    topic_msg->retain = record->retain;
+    topic_msg->topic_len = record->topic_len;
+    topic_msg->ptopic = (const char *)record + sizeof(iotx_mc_offline_record_t);
+    topic_msg->payload = topic_msg->ptopic + record->topic_len + 1;
+    topic_msg->payload_len = record->len - record->topic_len - 1;
+
+    return SUCCESS_RETURN;
+}
+
+void iotx_mc_offline_pop(iotx_mc_offline_queue_t *queue)
+{
+    uint32_t skip = 0, record_size;
+    int pos;
+
+    if (queue->count == 0) {
+        return;
+    }
+
+    pos = _offline_locate(queue, queue->head->head, queue->head->head_seq, &skip);
+    if (pos < 0) {
+        _offline_reset(queue);
+        return;
+    }
+
+    record_size = _offline_record_size(((iotx_mc_offline_record_t *)(queue->area + pos))->len);
+    queue->count--;
+    if (queue->count == 0) {
+        _offline_reset(queue);
+        return;
+    }
+
+    queue->used -= skip + record_size;
+    queue->head->head = (pos + record_size < queue->head->size) ? pos + record_size : 0;
+    queue->head->head_seq++;
+    _offline_write_head(queue);
+}
+
+#endif  /* #ifdef MQTT_OFFLINE_QUEUE */
+
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2015-2018 Alibaba Group Holding Limited
+ */
+
+#ifndef __IOTX_MQTT_OFFLINE_H__
+#define __IOTX_MQTT_OFFLINE_H__
+
+#include "infra_types.h"
+#include "mqtt_api.h"
+
+#ifdef MQTT_OFFLINE_QUEUE
+
+/* Head of segment file, followed by the record area */
+typedef struct {
+    uint32_t                        magic;
+    uint32_t                        size;               /* bytes of record area */
+    uint32_t                        head;               /* offset of oldest record */
+    uint32_t                        head_seq;           /* sequence number of oldest record */
+    uint32_t                        crc;                /* CRC32 of fields above */
+} iotx_mc_offline_head_t;
+
+/*
+ * Ring of PUBLISH records appended to a memory mapped segment. Records carry consecutive sequence numbers
+ * and a CRC32, so the tail is found again after restart by walking records from head until one does not check.
+ * Not thread safe, the client serializes access.
+ */
+typedef struct {
+    uint8_t                        *segment;            /* mapped segment, NULL when queue is closed */
+    uint32_t                        segment_size;
+    iotx_mc_offline_head_t         *head;
+    uint8_t                        *area;               /* record area */
+    uint32_t                        tail;               /* offset where next record is appended */
+    uint32_t                        tail_seq;           /* sequence number of next record */
+    uint32_t                        used;               /* bytes from head to tail, including skipped end of area */
+    uint32_t                        count;              /* records in queue */
+    iotx_mqtt_offline_drop_t        drop_policy;
+} iotx_mc_offline_queue_t;
+
+int iotx_mc_offline_open(iotx_mc_offline_queue_t *queue, const iotx_mqtt_offline_param_t *param);
+void iotx_mc_offline_close(iotx_mc_offline_queue_t *queue);
+
+/**
+ * @brief Append a PUBLISH to queue, making room for it by @drop_policy.
+ *
+ * @param [in] queue: the offline queue.
+ * @param [in] topic: topic name of the PUBLISH.
+ * @param [in] topic_msg: qos, retain and payload of the PUBLISH.
+ * @param [out] dropped: number of old records dropped for it.
+ *
+ * @return SUCCESS_RETURN, or MQTT_OFFLINE_QUEUE_FULL when the PUBLISH is refused.
+ */
+int iotx_mc_offline_push(iotx_mc_offline_queue_t *queue, const char *topic, iotx_mqtt_topic_info_pt topic_msg,
+                         uint32_t *dropped);
+
+/* point @topic_msg at the oldest record, which stays valid until the queue is changed */
+int iotx_mc_offline_peek(iotx_mc_offline_queue_t *queue, iotx_mqtt_topic_info_pt topic_msg);
+void iotx_mc_offline_pop(iotx_mc_offline_queue_t *queue);
+
+#endif  /* #ifdef MQTT_OFFLINE_QUEUE */
+
+#endif  /* __IOTX_MQTT_OFFLINE_H__ */
+
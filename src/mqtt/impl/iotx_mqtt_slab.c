@@ -0,0 +1,288 @@
+/*
+ * Copyright (C) 2015-2018 Alibaba Group Holding Limited
+ */
+#include "mqtt_internal.h"
+
+#if defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_SLAB
+
+#define IOTX_MC_SLAB_ALIGN(len)                 (((len) + 7) & ~((uint32_t)7))
+
+/* blocks of the biggest class, larger requests go to heap without taking the lock */
+#define IOTX_MC_SLAB_BLOCK_MAX                  (IOTX_MC_SLAB_BLOCK_MIN << (IOTX_MC_SLAB_CLASS_NUM - 1))
+
+struct iotx_mc_slab_page_s;
+
+/* Head of every block, the page is NULL for block allocated from heap directly */
+typedef union {
+    struct iotx_mc_slab_page_s     *page;
+    uint64_t                        align;
+} iotx_mc_slab_head_t;
+
+typedef struct {
+    uint32_t                        block_size;         /* including iotx_mc_slab_head_t */
+    uint32_t                        block_num;          /* blocks per page */
+    uint32_t                        empty_num;          /* pages without used block */
+    struct list_head                partial_list;       /* pages having free block */
+} iotx_mc_slab_class_t;
+
+typedef struct iotx_mc_slab_page_s {
+    iotx_mc_slab_class_t           *slab_class;
+    struct list_head                linked_list;        /* in partial_list of its class when not full */
+    iotx_mc_slab_head_t            *free_list;          /* free blocks, linked by their page field */
+    uint32_t                        used;
+} iotx_mc_slab_page_t;
+
+/* the lock is made by the first client and kept, refs, allocs and pages are all guarded by it */
+static iotx_mc_slab_class_t g_slab_classes[IOTX_MC_SLAB_CLASS_NUM];
+static void *g_slab_lock = NULL;
+static int g_slab_ready = 0;
+static int g_slab_refs = 0;
+static uint32_t g_slab_allocs = 0;
+
+static iotx_mc_slab_class_t *_slab_class_of(uint32_t size)
+{
+    int idx;
+
+    for (idx = 0; idx < IOTX_MC_SLAB_CLASS_NUM; idx++) {
+        if (size + sizeof(iotx_mc_slab_head_t) <= g_slab_classes[idx].block_size) {
+            return &g_slab_classes[idx];
+        }
+    }
+
+    return NULL;
+}
+
+static iotx_mc_slab_page_t *_slab_page_new(iotx_mc_slab_class_t *slab_class)
+{
+    uint32_t idx;
+    uint8_t *block;
+    iotx_mc_slab_page_t *page;
+
+    page = HAL_Malloc(IOTX_MC_SLAB_ALIGN(sizeof(iotx_mc_slab_page_t)) + slab_class->block_size * slab_class->block_num);
+    if (page == NULL) {
+        return NULL;
+    }
+
+    page->slab_class = slab_class;
+    page->free_list = NULL;
+    page->used = 0;
+    block = (uint8_t *)page + IOTX_MC_SLAB_ALIGN(sizeof(iotx_mc_slab_page_t));
+    for (idx = 0; idx < slab_class->block_num; idx++) {
+        iotx_mc_slab_head_t *head = (iotx_mc_slab_head_t *)(block + idx * slab_class->block_size);
+        head->page = (iotx_mc_slab_page_t *)page->free_list;
+        page->free_list = head;
+    }
+    list_add_tail(&page->linked_list, &slab_class->partial_list);
+    slab_class->empty_num++;
+
+    return page;
+}
+
+/* release empty pages of all classes, called with g_slab_lock held */
+static int _slab_trim(void)
+{
+    int idx, busy = 0;
+    iotx_mc_slab_page_t *page = NULL, *next = NULL;
+
+    for (idx = 0; idx < IOTX_MC_SLAB_CLASS_NUM; idx++) {
+        list_for_each_entry_safe(page, next, &g_slab_classes[idx].partial_list, linked_list, iotx_mc_slab_page_t) {
+            if (page->used == 0) {
+                list_del(&page->linked_list);
+                HAL_Free(page);
+            } else {
+                busy++;
+            }
+        }
+        g_slab_classes[idx].empty_num = 0;
+    }
+
+    return busy;
+}
+
+static void *_slab_lock_get(void)
+{
+#if WITH_MQTT_ATOMIC
+    return IOTX_MC_ATOMIC_LOAD(&g_slab_lock);
+#else
+    return g_slab_lock;
+#endif
+}
+
+/*
+ * Make g_slab_lock if it is not made yet, a lock made by a racing client is discarded. Without compiler atomics
+ * the first client has to be made before others are made concurrently.
+ */
+static void *_slab_lock_make(void)
+{
+    void *lock = _slab_lock_get();
+#if WITH_MQTT_ATOMIC
+    void *expected = NULL;
+#endif
+
+    if (lock != NULL) {
+        return lock;
+    }
+
+    lock = HAL_MutexCreate();
+    if (lock == NULL) {
+        return NULL;
+    }
+#if WITH_MQTT_ATOMIC
+    if (!IOTX_MC_ATOMIC_CAS(&g_slab_lock, &expected, lock)) {
+        HAL_MutexDestroy(lock);
+        return expected;
+    }
+#else
+    g_slab_lock = lock;
+#endif
+
+    return lock;
+}
+
+int iotx_mc_slab_init(void)
+{
+    int idx;
+    uint32_t block_size = IOTX_MC_SLAB_BLOCK_MIN;
+    void *lock = _slab_lock_make();
+
+    if (lock == NULL) {
+        return FAIL_RETURN;
+    }
+
+    HAL_MutexLock(lock);
+    if (!g_slab_ready) {
+        for (idx = 0; idx < IOTX_MC_SLAB_CLASS_NUM; idx++) {
+            g_slab_classes[idx].block_size = block_size;
+            g_slab_classes[idx].block_num = IOTX_MC_SLAB_PAGE_SIZE / block_size;
+            if (g_slab_classes[idx].block_num < IOTX_MC_SLAB_PAGE_BLOCK_MIN) {
+                g_slab_classes[idx].block_num = IOTX_MC_SLAB_PAGE_BLOCK_MIN;
+            }
+            g_slab_classes[idx].empty_num = 0;
+            INIT_LIST_HEAD(&g_slab_classes[idx].partial_list);
+            block_size *= 2;
+        }
+        g_slab_ready = 1;
+    }
+    g_slab_refs++;
+    HAL_MutexUnlock(lock);
+
+    return SUCCESS_RETURN;
+}
+
+void iotx_mc_slab_deinit(void)
+{
+    void *lock = _slab_lock_get();
+
+    if (lock == NULL) {
+        return;
+    }
+
+    HAL_MutexLock(lock);
+    if (g_slab_refs > 0 && --g_slab_refs == 0 && _slab_trim() > 0) {
+        /* pages of blocks not freed yet are kept till they are freed */
+        mqtt_warning("mqtt slab is still in use after all clients released");
+    }
+    HAL_MutexUnlock(lock);
+}
+
+void *iotx_mc_slab_malloc(uint32_t size)
+{
+    iotx_mc_slab_class_t *slab_class = NULL;
+    iotx_mc_slab_page_t *page = NULL;
+    iotx_mc_slab_head_t *head = NULL;
+    void *lock = NULL;
+
+    if (size + sizeof(iotx_mc_slab_head_t) <= IOTX_MC_SLAB_BLOCK_MAX) {
+        lock = _slab_lock_get();
+    }
+    if (lock != NULL) {
+        HAL_MutexLock(lock);
+        slab_class = g_slab_ready ? _slab_class_of(size) : NULL;
+        if (slab_class == NULL) {
+            HAL_MutexUnlock(lock);
+        }
+    }
+    if (slab_class == NULL) {
+        head = HAL_Malloc(sizeof(iotx_mc_slab_head_t) + size);
+        if (head == NULL) {
+            return NULL;
+        }
+        head->page = NULL;
+        return head + 1;
+    }
+
+    if (list_empty(&slab_class->partial_list)) {
+        page = _slab_page_new(slab_class);
+    } else {
+        page = list_first_entry(&slab_class->partial_list, iotx_mc_slab_page_t, linked_list);
+    }
+    if (page == NULL) {
+        HAL_MutexUnlock(lock);
+        return NULL;
+    }
+
+    head = page->free_list;
+    page->free_list = (iotx_mc_slab_head_t *)head->page;
+    if (page->used++ == 0) {
+        slab_class->empty_num--;
+    }
+    if (page->free_list == NULL) {
+        list_del_init(&page->linked_list);
+    }
+    head->page = page;
+    g_slab_allocs++;
+    HAL_MutexUnlock(lock);
+
+    return head + 1;
+}
+
+void iotx_mc_slab_free(void *ptr)
+{
+    iotx_mc_slab_head_t *head = NULL;
+    iotx_mc_slab_page_t *page = NULL;
+    iotx_mc_slab_class_t *slab_class = NULL;
+
+    if (ptr == NULL) {
+        return;
+    }
+
+    head = (iotx_mc_slab_head_t *)ptr - 1;
+    page = head->page;
+    if (page == NULL) {
+        HAL_Free(head);
+        return;
+    }
+    slab_class = page->slab_class;
+
+    HAL_MutexLock(g_slab_lock);
+    if (page->free_list == NULL) {
+        list_add_tail(&page->linked_list, &slab_class->partial_list);
+    }
+    head->page = (iotx_mc_slab_page_t *)page->free_list;
+    page->free_list = head;
+
+    /* one empty page per class is kept for the next burst, more are returned to heap */
+    if (--page->used == 0 && slab_class->empty_num++ >= IOTX_MC_SLAB_EMPTY_KEEP) {
+        slab_class->empty_num--;
+        list_del(&page->linked_list);
+        HAL_Free(page);
+    }
+    HAL_MutexUnlock(g_slab_lock);
+}
+
+uint32_t iotx_mc_slab_alloc_count(void)
+{
+    uint32_t count = 0;
+    void *lock = _slab_lock_get();
+
+    if (lock != NULL) {
+        HAL_MutexLock(lock);
+        count = g_slab_allocs;
+        HAL_MutexUnlock(lock);
+    }
+
+    return count;
+}
+
+#endif  /* #if defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_SLAB */
+
@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2015-2018 Alibaba Group Holding Limited
+ */
+
+#ifndef __IOTX_MQTT_SLAB_H__
+#define __IOTX_MQTT_SLAB_H__
+
+#include "infra_types.h"
+#include "iotx_mqtt_config.h"
+
+#if defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_SLAB
+
+/*
+ * Size-class slab behind mqtt_malloc()/mqtt_free(). Requests fitting the biggest class are served from
+ * pages of same-sized blocks, so records, subscribe nodes and packet buffers which come and go all the time
+ * reuse the same memory instead of fragmenting heap. Pages are shared by all MQTT clients.
+ */
+
+/* called when a MQTT client is made or released, empty pages are returned to heap after the last one is released */
+int iotx_mc_slab_init(void);
+void iotx_mc_slab_deinit(void);
+
+void *iotx_mc_slab_malloc(uint32_t size);
+void iotx_mc_slab_free(void *ptr);
+
+/* blocks served from pages so far, which never reach HAL_Malloc() */
+uint32_t iotx_mc_slab_alloc_count(void);
+
+#endif  /* #if defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_SLAB */
+
+#endif  /* __IOTX_MQTT_SLAB_H__ */
+
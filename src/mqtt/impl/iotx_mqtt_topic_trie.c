@@ -0,0 +1,298 @@
+/*
+ * Copyright (C) 2015-2018 Alibaba Group Holding Limited
+ */
+#include "mqtt_internal.h"
+
+#if defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_TOPIC_TRIE
+
+#define IOTX_MC_TRIE_BUCKET_NUM_MIN             (16)
+
+typedef struct {
+    iotx_mc_trie_match_t   *matches;
+    int                     matches_max;
+    int                     count;
+} iotx_mc_trie_match_ctx_t;
+
+static uint32_t _trie_hash(iotx_mc_trie_node_t *parent, const char *level, uint16_t level_len)
+{
+    uint32_t hash = 2166136261u ^ (uint32_t)((uintptr_t)parent >> 3);
+    uint16_t i;
+
+    for (i = 0; i < level_len; i++) {
+        hash ^= (unsigned char)level[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static iotx_mc_trie_node_t *_trie_find_child(iotx_mc_topic_trie_t *trie, iotx_mc_trie_node_t *parent,
+        const char *level, uint16_t level_len)
+{
+    uint32_t hash;
+    iotx_mc_trie_node_t *node;
+
+    if (trie->bucket_num == 0 || parent->child_num == 0) {
+        return NULL;
+    }
+
+    hash = _trie_hash(parent, level, level_len);
+    for (node = trie->buckets[hash & (trie->bucket_num - 1)]; node != NULL; node = node->hash_next) {
+        if (node->hash == hash && node->parent == parent && node->level_len == level_len &&
+            0 == memcmp(node->level, level, level_len)) {
+            return node;
+        }
+    }
+
+    return NULL;
+}
+
+static int _trie_grow(iotx_mc_topic_trie_t *trie)
+{
+    uint32_t idx;
+    uint32_t bucket_num;
+    iotx_mc_trie_node_t **buckets;
+
+    bucket_num = (trie->bucket_num == 0) ? IOTX_MC_TRIE_BUCKET_NUM_MIN : trie->bucket_num * 2;
+    buckets = mqtt_malloc(sizeof(iotx_mc_trie_node_t *) * bucket_num);
+    if (buckets == NULL) {
+        return ERROR_MALLOC;
+    }
+    memset(buckets, 0, sizeof(iotx_mc_trie_node_t *) * bucket_num);
+
+    for (idx = 0; idx < trie->bucket_num; idx++) {
+        iotx_mc_trie_node_t *node = trie->buckets[idx];
+        while (node != NULL) {
+            iotx_mc_trie_node_t *next = node->hash_next;
+            node->hash_next = buckets[node->hash & (bucket_num - 1)];
+            buckets[node->hash & (bucket_num - 1)] = node;
+            node = next;
+        }
+    }
+
+    if (trie->buckets != NULL) {
+        mqtt_free(trie->buckets);
+    }
+    trie->buckets = buckets;
+    trie->bucket_num = bucket_num;
+
+    return SUCCESS_RETURN;
+}
+
+static iotx_mc_trie_node_t *_trie_add_child(iotx_mc_topic_trie_t *trie, iotx_mc_trie_node_t *parent,
+        const char *level, uint16_t level_len)
+{
+    uint32_t idx;
+    iotx_mc_trie_node_t *node;
+
+    if (trie->node_num >= trie->bucket_num && _trie_grow(trie) != SUCCESS_RETURN) {
+        return NULL;
+    }
+
+    node = mqtt_malloc(sizeof(iotx_mc_trie_node_t) + level_len + 1);
+    if (node == NULL) {
+        return NULL;
+    }
+    memset(node, 0, sizeof(iotx_mc_trie_node_t));
+    INIT_LIST_HEAD(&node->handle_list);
+    node->parent = parent;
+    node->level = (char *)node + sizeof(iotx_mc_trie_node_t);
+    node->level_len = level_len;
+    memcpy(node->level, level, level_len);
+    node->level[level_len] = '\0';
+    node->hash = _trie_hash(parent, level, level_len);
+
+    idx = node->hash & (trie->bucket_num - 1);
+    node->hash_next = trie->buckets[idx];
+    trie->buckets[idx] = node;
+    trie->node_num++;
+
+    if (level_len == 1 && level[0] == '+') {
+        parent->plus_child = node;
+    } else if (level_len == 1 && level[0] == '#') {
+        parent->pound_child = node;
+    }
+    parent->child_num++;
+
+    return node;
+}
+
+/* release nodes which neither have handle nor child, from @node up to root */
+static void _trie_prune(iotx_mc_topic_trie_t *trie, iotx_mc_trie_node_t *node)
+{
+    while (node != &trie->root && node->child_num == 0 && list_empty(&node->handle_list)) {
+        iotx_mc_trie_node_t *parent = node->parent;
+        iotx_mc_trie_node_t **pos = &trie->buckets[node->hash & (trie->bucket_num - 1)];
+
+        while (*pos != node) {
+            pos = &(*pos)->hash_next;
+        }
+        *pos = node->hash_next;
+        trie->node_num--;
+
+        if (parent->plus_child == node) {
+            parent->plus_child = NULL;
+        } else if (parent->pound_child == node) {
+            parent->pound_child = NULL;
+        }
+        parent->child_num--;
+
+        mqtt_free(node);
+        node = parent;
+    }
+}
+
+static void _trie_collect(iotx_mc_trie_node_t *node, iotx_mc_trie_match_ctx_t *ctx)
+{
+    iotx_mc_topic_handle_t *handle = NULL;
+
+    list_for_each_entry(handle, &node->handle_list, trie_list, iotx_mc_topic_handle_t) {
+        if (ctx->count < ctx->matches_max) {
+            ctx->matches[ctx->count].sub_seq = handle->sub_seq;
+            ctx->matches[ctx->count].handle = handle->handle;
+        }
+        ctx->count++;
+    }
+}
+
+/* @level points to the first unmatched level of topic, NULL means the whole topic has been consumed */
+static void _trie_match(iotx_mc_topic_trie_t *trie, iotx_mc_trie_node_t *node, const char *level,
+                        const char *end, iotx_mc_trie_match_ctx_t *ctx)
+{
+    const char *sep;
+    const char *next;
+    uint16_t level_len;
+    iotx_mc_trie_node_t *child;
+
+    if (level == NULL) {
+        _trie_collect(node, ctx);
+        return;
+    }
+
+    sep = memchr(level, '/', end - level);
+    level_len = (uint16_t)((sep != NULL) ? (sep - level) : (end - level));
+    next = (sep != NULL) ? sep + 1 : NULL;
+
+    child = _trie_find_child(trie, node, level, level_len);
+    if (child != NULL) {
+        _trie_match(trie, child, next, end, ctx);
+    }
+
+    /* '+' matches exactly one non-empty level */
+    if (node->plus_child != NULL && level_len > 0) {
+        _trie_match(trie, node->plus_child, next, end, ctx);
+    }
+
+    /* '#' matches all the remaining levels, which should not start with an empty one */
+    if (node->pound_child != NULL && level_len > 0) {
+        _trie_collect(node->pound_child, ctx);
+    }
+}
+
+void iotx_mc_trie_init(iotx_mc_topic_trie_t *trie)
+{
+    memset(trie, 0, sizeof(iotx_mc_topic_trie_t));
+    INIT_LIST_HEAD(&trie->root.handle_list);
+}
+
+void iotx_mc_trie_deinit(iotx_mc_topic_trie_t *trie)
+{
+    uint32_t idx;
+
+    for (idx = 0; idx < trie->bucket_num; idx++) {
+        iotx_mc_trie_node_t *node = trie->buckets[idx];
+        while (node != NULL) {
+            iotx_mc_trie_node_t *next = node->hash_next;
+            mqtt_free(node);
+            node = next;
+        }
+    }
+
+    if (trie->buckets != NULL) {
+        mqtt_free(trie->buckets);
+    }
+    iotx_mc_trie_init(trie);
+}
+
+int iotx_mc_trie_insert(iotx_mc_topic_trie_t *trie, const char *topic_filter, iotx_mc_topic_handle_t *handle)
+{
+    const char *level = topic_filter;
+    iotx_mc_trie_node_t *node = &trie->root;
+
+    if (trie == NULL || topic_filter == NULL || handle == NULL) {
+        return NULL_VALUE_ERROR;
+    }
+
+    for (;;) {
+        const char *sep = strchr(level, '/');
+        uint16_t level_len = (uint16_t)((sep != NULL) ? (sep - level) : strlen(level));
+        iotx_mc_trie_node_t *child = _trie_find_child(trie, node, level, level_len);
+
+        if (child == NULL) {
+            child = _trie_add_child(trie, node, level, level_len);
+            if (child == NULL) {
+                mqtt_err("topic trie add level failed");
+                _trie_prune(trie, node);
+                return ERROR_MALLOC;
+            }
+        }
+        node = child;
+
+        if (sep == NULL) {
+            break;
+        }
+        level = sep + 1;
+    }
+
+    handle->trie_node = node;
+    handle->sub_seq = ++trie->sub_seq;
+    list_add_tail(&handle->trie_list, &node->handle_list);
+
+    return SUCCESS_RETURN;
+}
+
+void iotx_mc_trie_remove(iotx_mc_topic_trie_t *trie, iotx_mc_topic_handle_t *handle)
+{
+    iotx_mc_trie_node_t *node;
+
+    if (trie == NULL || handle == NULL || handle->trie_node == NULL) {
+        return;
+    }
+
+    node = (iotx_mc_trie_node_t *)handle->trie_node;
+    list_del(&handle->trie_list);
+    handle->trie_node = NULL;
+
+    _trie_prune(trie, node);
+}
+
+int iotx_mc_trie_match(iotx_mc_topic_trie_t *trie, const char *topic, int topic_len,
+                       iotx_mc_trie_match_t *matches, int matches_max)
+{
+    int i, j, num;
+    iotx_mc_trie_match_ctx_t ctx;
+
+    if (trie == NULL || topic == NULL || topic_len <= 0 || matches == NULL) {
+        return 0;
+    }
+
+    ctx.matches = matches;
+    ctx.matches_max = matches_max;
+    ctx.count = 0;
+    _trie_match(trie, &trie->root, topic, topic + topic_len, &ctx);
+
+    /* restore subscribe order, matches are few so insertion sort is enough */
+    num = (ctx.count < matches_max) ? ctx.count : matches_max;
+    for (i = 1; i < num; i++) {
+        iotx_mc_trie_match_t tmp = matches[i];
+        for (j = i - 1; j >= 0 && matches[j].sub_seq > tmp.sub_seq; j--) {
+            matches[j + 1] = matches[j];
+        }
+        matches[j + 1] = tmp;
+    }
+
+    return ctx.count;
+}
+
+#endif  /* #if defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_TOPIC_TRIE */
+
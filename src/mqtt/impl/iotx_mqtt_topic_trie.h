@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2015-2018 Alibaba Group Holding Limited
+ */
+
+#ifndef __IOTX_MQTT_TOPIC_TRIE_H__
+#define __IOTX_MQTT_TOPIC_TRIE_H__
+
+#include "infra_types.h"
+#include "infra_list.h"
+#include "iotx_mqtt_config.h"
+#include "mqtt_api.h"
+
+#if defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_TOPIC_TRIE
+
+struct iotx_mc_topic_handle_s;
+
+/* One level of a subscribed topic filter, e.g. "thing" of "/sys/pk/dn/thing/#" */
+typedef struct iotx_mc_trie_node_s {
+    struct iotx_mc_trie_node_s     *parent;
+    struct iotx_mc_trie_node_s     *hash_next;          /* next node in the same bucket */
+    struct iotx_mc_trie_node_s     *plus_child;         /* child of level '+' */
+    struct iotx_mc_trie_node_s     *pound_child;        /* child of level '#' */
+    struct list_head                handle_list;        /* subscribe handles whose filter ends here */
+    uint32_t                        hash;
+    uint32_t                        child_num;
+    uint16_t                        level_len;
+    char                           *level;
+} iotx_mc_trie_node_t;
+
+/* Level-indexed trie of topic filters, children of all nodes are kept in one hash table */
+typedef struct {
+    iotx_mc_trie_node_t             root;
+    iotx_mc_trie_node_t           **buckets;
+    uint32_t                        bucket_num;
+    uint32_t                        node_num;
+    uint32_t                        sub_seq;            /* subscribe order, keeps dispatch order of the list */
+} iotx_mc_topic_trie_t;
+
+/* Handle matched by a topic name, copied out so it stays valid after lock released */
+typedef struct {
+    uint32_t                        sub_seq;
+    iotx_mqtt_event_handle_t        handle;
+} iotx_mc_trie_match_t;
+
+void iotx_mc_trie_init(iotx_mc_topic_trie_t *trie);
+void iotx_mc_trie_deinit(iotx_mc_topic_trie_t *trie);
+int iotx_mc_trie_insert(iotx_mc_topic_trie_t *trie, const char *topic_filter, struct iotx_mc_topic_handle_s *handle);
+void iotx_mc_trie_remove(iotx_mc_topic_trie_t *trie, struct iotx_mc_topic_handle_s *handle);
+
+/**
+ * @brief Find all subscribe handles whose topic filter matches @topic, in subscribe order.
+ *
+ * @param [in] trie: the topic trie.
+ * @param [in] topic: topic name, not necessarily terminated by '\0'.
+ * @param [in] topic_len: length of @topic.
+ * @param [out] matches: matched handles.
+ * @param [in] matches_max: room of @matches.
+ *
+ * @return total number of matched handles, which may be bigger than @matches_max.
+ */
+int iotx_mc_trie_match(iotx_mc_topic_trie_t *trie, const char *topic, int topic_len,
+                       iotx_mc_trie_match_t *matches, int matches_max);
+
+#endif  /* #if defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_TOPIC_TRIE */
+
+#endif  /* __IOTX_MQTT_TOPIC_TRIE_H__ */
+
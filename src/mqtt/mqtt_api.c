@@ -361,23 +361,32 @@ static int _iotx_preauth(iotx_mqtt_region_types_t region, iotx_dev_meta_info_t *
 
 extern int _sign_get_clientid(char *clientid_string, const char *device_id, const char *custom_kv, uint8_t enable_itls);
 
-/************************  Public Interface ************************/
-void *IOT_MQTT_Construct(iotx_mqtt_param_t *pInitParams)
+#ifdef PLATFORM_HAS_DYNMEM
+/* Sign of MQTT client made by IOT_MQTT_Construct_Conn(), which must live as long as the client */
+typedef struct {
+    void *client;
+    iotx_sign_mqtt_t sign;
+    struct list_head linked_list;
+} iotx_mqtt_conn_t;
+
+static struct list_head g_mqtt_conn_list = LIST_HEAD_INIT(g_mqtt_conn_list);
+#endif
+
+/*
+ * Sign the device into @sign and connect with it, @conn_id other than 0 is appended to client id as "conn=N",
+ * so that clients of the same device are told apart.
+ */
+static void *_mqtt_construct(iotx_mqtt_param_t *pInitParams, iotx_sign_mqtt_t *sign, int conn_id)
 {
     void *pclient;
     iotx_dev_meta_info_t meta_info;
     iotx_mqtt_param_t mqtt_params;
     char device_id[IOTX_PRODUCT_KEY_LEN + IOTX_DEVICE_NAME_LEN + 1] = {0};
+    char custom_kv[DEV_SIGN_CLIENT_ID_MAXLEN] = {0};
     int region = 0;
     int dynamic = 0;
     uint8_t enable_itls = 0;
     int ret;
-    void *callback;
-
-    if (g_mqtt_client != NULL) {
-        mqtt_err("Already exist default MQTT connection, won't proceed another one");
-        return g_mqtt_client;
-    }
 
     /* get region */
     IOT_Ioctl(IOTX_IOCTL_GET_REGION, (void *)&region);
@@ -428,13 +437,13 @@ void *IOT_MQTT_Construct(iotx_mqtt_param_t *pInitParams)
 #endif /* #ifdef DYNAMIC_REGISTER */
 
 #ifdef MQTT_PRE_AUTH /* preauth mode through https */
-    ret = _iotx_preauth(region, &meta_info, (iotx_sign_mqtt_t *)&g_default_sign); /* type convert */
+    ret = _iotx_preauth(region, &meta_info, sign); /* type convert */
     if (ret < SUCCESS_RETURN) {
         mqtt_err("ret = _iotx_preauth() = %d, abort", ret);
         return NULL;
     }
 #else /* direct mode */
-    ret = IOT_Sign_MQTT(region, &meta_info, &g_default_sign);
+    ret = IOT_Sign_MQTT(region, &meta_info, sign);
     if (ret < SUCCESS_RETURN) {
         mqtt_err("ret = IOT_Sign_MQTT() = %d, abort", ret);
         return NULL;
@@ -456,8 +465,20 @@ void *IOT_MQTT_Construct(iotx_mqtt_param_t *pInitParams)
         }
     }
 
-    if (_sign_get_clientid(g_default_sign.clientid, device_id,
-                           (pInitParams != NULL) ? pInitParams->customize_info : NULL, enable_itls) != SUCCESS_RETURN) {
+    if (pInitParams != NULL && pInitParams->customize_info != NULL) {
+        if (strlen(pInitParams->customize_info) >= sizeof(custom_kv) - 16) {
+            mqtt_err("customize_info too long");
+            return NULL;
+        }
+        memcpy(custom_kv, pInitParams->customize_info, strlen(pInitParams->customize_info));
+    }
+    if (conn_id != 0) {
+        HAL_Snprintf(custom_kv + strlen(custom_kv), sizeof(custom_kv) - strlen(custom_kv), "%sconn=%d",
+                     (custom_kv[0] != '\0') ? "," : "", conn_id);
+    }
+
+    if (_sign_get_clientid(sign->clientid, device_id, (custom_kv[0] != '\0') ? custom_kv : NULL,
+                           enable_itls) != SUCCESS_RETURN) {
         return NULL;
     }
 
@@ -491,29 +512,29 @@ void *IOT_MQTT_Construct(iotx_mqtt_param_t *pInitParams)
         if (pInitParams->host && strlen(pInitParams->host)) {
             mqtt_params.host = pInitParams->host;
         } else {
-            mqtt_warning("Using default hostname: '%s'", g_default_sign.hostname);
-            mqtt_params.host = g_default_sign.hostname;
+            mqtt_warning("Using default hostname: '%s'", sign->hostname);
+            mqtt_params.host = sign->hostname;
         }
 
         if (pInitParams->port) {
             mqtt_params.port = pInitParams->port;
         } else {
-            mqtt_warning("Using default port: [%d]", g_default_sign.port);
-            mqtt_params.port = g_default_sign.port;
+            mqtt_warning("Using default port: [%d]", sign->port);
+            mqtt_params.port = sign->port;
         }
 
         if (pInitParams->client_id && strlen(pInitParams->client_id)) {
             mqtt_params.client_id = pInitParams->client_id;
         } else {
-            mqtt_warning("Using default client_id: %s", g_default_sign.clientid);
-            mqtt_params.client_id = g_default_sign.clientid;
+            mqtt_warning("Using default client_id: %s", sign->clientid);
+            mqtt_params.client_id = sign->clientid;
         }
 
         if (pInitParams->username && strlen(pInitParams->username)) {
             mqtt_params.username = pInitParams->username;
         } else {
-            mqtt_warning("Using default username: %s", g_default_sign.username);
-            mqtt_params.username = g_default_sign.username;
+            mqtt_warning("Using default username: %s", sign->username);
+            mqtt_params.username = sign->username;
         }
 
         if (pInitParams->password && strlen(pInitParams->password)) {
@@ -522,9 +543,9 @@ void *IOT_MQTT_Construct(iotx_mqtt_param_t *pInitParams)
 #if 1
             mqtt_warning("Using default password: %s", "******");
 #else
-            mqtt_warning("Using default password: %s", g_default_sign.password);
+            mqtt_warning("Using default password: %s", sign->password);
 #endif
-            mqtt_params.password = g_default_sign.password;
+            mqtt_params.password = sign->password;
         }
 
         if (pInitParams->request_timeout_ms < CONFIG_MQTT_REQ_TIMEOUT_MIN ||
@@ -573,24 +594,24 @@ void *IOT_MQTT_Construct(iotx_mqtt_param_t *pInitParams)
             mqtt_params.handle_event.pcontext = pInitParams->handle_event.pcontext;
         }
     } else {
-        mqtt_warning("Using default port: [%d]", g_default_sign.port);
-        mqtt_params.port = g_default_sign.port;
+        mqtt_warning("Using default port: [%d]", sign->port);
+        mqtt_params.port = sign->port;
 
-        mqtt_warning("Using default hostname: '%s'", g_default_sign.hostname);
-        mqtt_params.host = g_default_sign.hostname;
+        mqtt_warning("Using default hostname: '%s'", sign->hostname);
+        mqtt_params.host = sign->hostname;
 
-        mqtt_warning("Using default client_id: %s", g_default_sign.clientid);
-        mqtt_params.client_id = g_default_sign.clientid;
+        mqtt_warning("Using default client_id: %s", sign->clientid);
+        mqtt_params.client_id = sign->clientid;
 
-        mqtt_warning("Using default username: %s", g_default_sign.username);
-        mqtt_params.username = g_default_sign.username;
+        mqtt_warning("Using default username: %s", sign->username);
+        mqtt_params.username = sign->username;
 
 #if 1
         mqtt_warning("Using default password: %s", "******");
 #else
-        mqtt_warning("Using default password: %s", g_default_sign.password);
+        mqtt_warning("Using default password: %s", sign->password);
 #endif
-        mqtt_params.password = g_default_sign.password;
+        mqtt_params.password = sign->password;
     }
 
     pclient = wrapper_mqtt_init(&mqtt_params);
@@ -608,6 +629,25 @@ void *IOT_MQTT_Construct(iotx_mqtt_param_t *pInitParams)
         }
     }
 
+    return pclient;
+}
+
+/************************  Public Interface ************************/
+void *IOT_MQTT_Construct(iotx_mqtt_param_t *pInitParams)
+{
+    void *pclient;
+    void *callback;
+
+    if (g_mqtt_client != NULL) {
+        mqtt_err("Already exist default MQTT connection, won't proceed another one");
+        return g_mqtt_client;
+    }
+
+    pclient = _mqtt_construct(pInitParams, &g_default_sign, 0);
+    if (pclient == NULL) {
+        return NULL;
+    }
+
 #ifndef ASYNC_PROTOCOL_STACK
     iotx_mqtt_report_funcs(pclient);
 #endif
@@ -623,6 +663,34 @@ void *IOT_MQTT_Construct(iotx_mqtt_param_t *pInitParams)
     return pclient;
 }
 
+#ifdef PLATFORM_HAS_DYNMEM
+void *IOT_MQTT_Construct_Conn(iotx_mqtt_param_t *pInitParams, int conn_id)
+{
+    iotx_mqtt_conn_t *conn = NULL;
+
+    if (conn_id <= 0) {
+        mqtt_err("Invalid conn_id: %d", conn_id);
+        return NULL;
+    }
+
+    conn = mqtt_api_malloc(sizeof(iotx_mqtt_conn_t));
+    if (conn == NULL) {
+        mqtt_err("malloc conn failed");
+        return NULL;
+    }
+    memset(conn, 0, sizeof(iotx_mqtt_conn_t));
+
+    conn->client = _mqtt_construct(pInitParams, &conn->sign, conn_id);
+    if (conn->client == NULL) {
+        mqtt_api_free(conn);
+        return NULL;
+    }
+    list_add_tail(&conn->linked_list, &g_mqtt_conn_list);
+
+    return conn->client;
+}
+#endif
+
 int IOT_MQTT_Destroy(void **phandler)
 {
     void *client;
@@ -638,6 +706,21 @@ int IOT_MQTT_Destroy(void **phandler)
         return NULL_VALUE_ERROR;
     }
 
+#ifdef PLATFORM_HAS_DYNMEM
+    {
+        iotx_mqtt_conn_t *conn = NULL, *next = NULL;
+
+        list_for_each_entry_safe(conn, next, &g_mqtt_conn_list, linked_list, iotx_mqtt_conn_t) {
+            if (conn->client == client) {
+                wrapper_mqtt_release(&client);
+                list_del(&conn->linked_list);
+                mqtt_api_free(conn);
+                return SUCCESS_RETURN;
+            }
+        }
+    }
+#endif
+
     wrapper_mqtt_release(&client);
     g_mqtt_client = NULL;
 
@@ -739,6 +822,54 @@ int IOT_MQTT_Subscribe_Sync(void *handle,
     return wrapper_mqtt_subscribe_sync(client, topic_filter, qos, topic_handle_func, pcontext, timeout_ms);
 }
 
+int IOT_MQTT_Subscribe_Multi(void *handle, iotx_mutli_sub_info_t *sub_list, int count, int timeout_ms)
+{
+    void *client = handle ? handle : g_mqtt_client;
+    int idx, granted = 0;
+
+    if (sub_list == NULL || count <= 0) {
+        mqtt_err("params err");
+        return NULL_VALUE_ERROR;
+    }
+
+    for (idx = 0; idx < count; idx++) {
+        if (sub_list[idx].topicFilter == NULL || strlen(sub_list[idx].topicFilter) == 0 ||
+            sub_list[idx].messageHandler == NULL) {
+            mqtt_err("params err");
+            return NULL_VALUE_ERROR;
+        }
+#ifdef SUB_PERSISTENCE_ENABLED
+        if (sub_list[idx].qos > IOTX_MQTT_QOS3_SUB_LOCAL) {
+            mqtt_warning("Invalid qos(%d) out of [%d, %d], using %d",
+                         sub_list[idx].qos,
+                         IOTX_MQTT_QOS0, IOTX_MQTT_QOS3_SUB_LOCAL, IOTX_MQTT_QOS0);
+            sub_list[idx].qos = IOTX_MQTT_QOS0;
+        }
+#else
+        if (sub_list[idx].qos > IOTX_MQTT_QOS2) {
+            mqtt_warning("Invalid qos(%d) out of [%d, %d], using %d",
+                         sub_list[idx].qos,
+                         IOTX_MQTT_QOS0, IOTX_MQTT_QOS2, IOTX_MQTT_QOS0);
+            sub_list[idx].qos = IOTX_MQTT_QOS0;
+        }
+#endif
+    }
+
+    if (client == NULL) { /* do offline subscribe */
+        for (idx = 0; idx < count; idx++) {
+            sub_list[idx].granted = -1;
+            if (iotx_mqtt_offline_subscribe(sub_list[idx].topicFilter, sub_list[idx].qos,
+                                            sub_list[idx].messageHandler, sub_list[idx].pcontext) >= 0) {
+                sub_list[idx].granted = sub_list[idx].qos;
+                granted++;
+            }
+        }
+        return granted;
+    }
+
+    return wrapper_mqtt_subscribe_multi(client, sub_list, count, timeout_ms);
+}
+
 int IOT_MQTT_Unsubscribe(void *handle, const char *topic_filter)
 {
     void *client = handle ? handle : g_mqtt_client;
@@ -795,12 +926,156 @@ int IOT_MQTT_Publish_Simple(void *handle, const char *topic_name, int qos, void
     return rc;
 }
 
+int IOT_MQTT_Publish_Batch(void *handle, iotx_mqtt_topic_info_pt topic_msgs, int count)
+{
+    void *client = handle ? handle : g_mqtt_client;
+
+    if (client == NULL || topic_msgs == NULL || count <= 0) {
+        mqtt_err("params err");
+        return NULL_VALUE_ERROR;
+    }
+
+    return wrapper_mqtt_publish_batch(client, topic_msgs, count);
+}
+
+int IOT_MQTT_Get_Pub_Window(void *handle, int *inflight, int *window_size)
+{
+    void *client = handle ? handle : g_mqtt_client;
+
+    if (client == NULL || inflight == NULL || window_size == NULL) {
+        mqtt_err("params err");
+        return NULL_VALUE_ERROR;
+    }
+
+    return wrapper_mqtt_get_pub_window(client, inflight, window_size);
+}
+
+int IOT_MQTT_GetStats(void *handle, iotx_mqtt_stats_t *stats)
+{
+    void *client = handle ? handle : g_mqtt_client;
+
+    if (client == NULL || stats == NULL) {
+        mqtt_err("params err");
+        return NULL_VALUE_ERROR;
+    }
+
+    return wrapper_mqtt_get_stats(client, stats);
+}
+
+int IOT_MQTT_Set_Stats_Dump(void *handle, uint32_t interval_ms, iotx_mqtt_stats_dump_fpt dump, void *pcontext)
+{
+    void *client = handle ? handle : g_mqtt_client;
+
+    if (client == NULL) {
+        mqtt_err("params err");
+        return NULL_VALUE_ERROR;
+    }
+
+    return wrapper_mqtt_set_stats_dump(client, interval_ms, dump, pcontext);
+}
+
+int IOT_MQTT_Set_Offline_Queue(void *handle, const iotx_mqtt_offline_param_t *param)
+{
+#ifdef MQTT_OFFLINE_QUEUE
+    void *client = handle ? handle : g_mqtt_client;
+
+    if (client == NULL || (param != NULL && (param->path == NULL || param->max_bytes == 0))) {
+        mqtt_err("params err");
+        return NULL_VALUE_ERROR;
+    }
+
+    return wrapper_mqtt_set_offline_queue(client, param);
+#else
+    mqtt_err("FEATURE_MQTT_OFFLINE_QUEUE is not selected");
+    return FAIL_RETURN;
+#endif
+}
+
+int IOT_MQTT_Set_Topic_Alias(void *handle, uint16_t alias_max)
+{
+#ifdef MQTT_TOPIC_ALIAS
+    void *client = handle ? handle : g_mqtt_client;
+
+    if (client == NULL) {
+        mqtt_err("params err");
+        return NULL_VALUE_ERROR;
+    }
+
+    return wrapper_mqtt_set_topic_alias(client, alias_max);
+#else
+    mqtt_err("FEATURE_MQTT_TOPIC_ALIAS is not selected");
+    return FAIL_RETURN;
+#endif
+}
+
+int IOT_MQTT_Set_Backoff(void *handle, const iotx_mqtt_backoff_param_t *param)
+{
+    void *client = handle ? handle : g_mqtt_client;
+
+    if (client == NULL) {
+        mqtt_err("params err");
+        return NULL_VALUE_ERROR;
+    }
+
+    return wrapper_mqtt_set_backoff(client, param);
+}
+
+int IOT_MQTT_Set_Keepalive(void *handle, const iotx_mqtt_keepalive_param_t *param)
+{
+    void *client = handle ? handle : g_mqtt_client;
+
+    if (client == NULL || (param != NULL && param->max_ms != 0 && param->max_ms < param->min_ms)) {
+        mqtt_err("params err");
+        return NULL_VALUE_ERROR;
+    }
+
+    return wrapper_mqtt_set_keepalive(client, param);
+}
+
+int IOT_MQTT_Set_Dispatch(void *handle, const iotx_mqtt_dispatch_param_t *param)
+{
+#ifdef MQTT_DISPATCH
+    void *client = handle ? handle : g_mqtt_client;
+
+    if (client == NULL) {
+        mqtt_err("params err");
+        return NULL_VALUE_ERROR;
+    }
+
+    return wrapper_mqtt_set_dispatch(client, param);
+#else
+    mqtt_err("FEATURE_MQTT_DISPATCH is not selected");
+    return FAIL_RETURN;
+#endif
+}
+
+int IOT_MQTT_Set_Stream_Recv(void *handle, uint32_t chunk_size, iotx_mqtt_stream_fpt handler, void *pcontext)
+{
+#ifdef MQTT_STREAM_RECV
+    void *client = handle ? handle : g_mqtt_client;
+
+    if (client == NULL) {
+        mqtt_err("params err");
+        return NULL_VALUE_ERROR;
+    }
+
+    return wrapper_mqtt_set_stream_recv(client, chunk_size, handler, pcontext);
+#else
+    mqtt_err("FEATURE_MQTT_STREAM_RECV is not selected");
+    return FAIL_RETURN;
+#endif
+}
+
 int IOT_MQTT_Nwk_Event_Handler(void *handle, iotx_mqtt_nwk_event_t event, iotx_mqtt_nwk_param_t *param)
 {
 #ifdef ASYNC_PROTOCOL_STACK
     void *client = handle ? handle : g_mqtt_client;
     int rc = -1;
 
+    if (event == IOTX_MQTT_NWK_LINK_UP) {
+        return (client != NULL) ? wrapper_mqtt_link_up(client) : NULL_VALUE_ERROR;
+    }
+
     if (client == NULL || event >= IOTX_MQTT_SOC_MAX || param == NULL) {
         mqtt_err("params err");
         return NULL_VALUE_ERROR;
@@ -825,6 +1100,213 @@ int IOT_MQTT_Nwk_Event_Handler(void *handle, iotx_mqtt_nwk_event_t event, iotx_m
 
     return rc;
 #else
-    return -1;
+    void *client = handle ? handle : g_mqtt_client;
+
+    if (client == NULL || event != IOTX_MQTT_NWK_LINK_UP) {
+        mqtt_err("params err");
+        return -1;
+    }
+
+    return wrapper_mqtt_link_up(client);
 #endif
 }
+
+#ifdef MQTT_REACTOR
+#define MQTT_REACTOR_EVENT_MAX      (16)
+
+typedef struct {
+    void               *client;
+    uintptr_t           fd;             /* descriptor watched by poller, (uintptr_t)(-1) if none */
+    struct list_head    linked_list;
+} iotx_mqtt_reactor_node_t;
+
+typedef struct {
+    uintptr_t           poller;
+    struct list_head    client_list;
+} iotx_mqtt_reactor_t;
+
+static void _reactor_watch(iotx_mqtt_reactor_t *reactor, iotx_mqtt_reactor_node_t *node, uintptr_t fd)
+{
+    if (node->fd == fd) {
+        return;
+    }
+
+    if (node->fd != (uintptr_t)(-1)) {
+        HAL_Poller_Del(reactor->poller, node->fd);
+        node->fd = (uintptr_t)(-1);
+    }
+
+    if (fd != (uintptr_t)(-1) && HAL_Poller_Add(reactor->poller, fd, node) == 0) {
+        node->fd = fd;
+    }
+}
+
+/*
+ * Follow connection of client after it has been called, a closed descriptor is unwatched before other clients
+ * can get the same number. Return time left before the client has timed work to do.
+ */
+static uint32_t _reactor_sync(iotx_mqtt_reactor_t *reactor, iotx_mqtt_reactor_node_t *node)
+{
+    iotx_mqtt_nwk_param_t param;
+    int connecting = 0;
+    uint32_t timeout_ms = 0;
+
+    if (wrapper_mqtt_nwk_status(node->client, &param, &connecting, &timeout_ms) < 0) {
+        _reactor_watch(reactor, node, (uintptr_t)(-1));
+        return 0;
+    }
+
+    if (connecting) {
+        /* connection is established by blocking HAL, go on with MQTT CONNECT, which may connect again */
+        _reactor_watch(reactor, node, (uintptr_t)(-1));
+        IOT_MQTT_Nwk_Event_Handler(node->client, IOTX_MQTT_SOC_CONNECTED, &param);
+        if (wrapper_mqtt_nwk_status(node->client, &param, &connecting, &timeout_ms) < 0) {
+            return 0;
+        }
+    }
+
+    _reactor_watch(reactor, node, param.fd);
+    return timeout_ms;
+}
+
+void *IOT_MQTT_Reactor_Create(void)
+{
+    iotx_mqtt_reactor_t *reactor = NULL;
+
+    reactor = mqtt_api_malloc(sizeof(iotx_mqtt_reactor_t));
+    if (reactor == NULL) {
+        mqtt_err("malloc reactor failed");
+        return NULL;
+    }
+
+    reactor->poller = HAL_Poller_Create();
+    if (reactor->poller == (uintptr_t)(-1)) {
+        mqtt_err("create poller failed");
+        mqtt_api_free(reactor);
+        return NULL;
+    }
+    INIT_LIST_HEAD(&reactor->client_list);
+
+    return reactor;
+}
+
+int IOT_MQTT_Reactor_Add(void *reactor, void *handle)
+{
+    iotx_mqtt_reactor_t *r = (iotx_mqtt_reactor_t *)reactor;
+    iotx_mqtt_reactor_node_t *node = NULL;
+
+    if (r == NULL || handle == NULL) {
+        mqtt_err("params err");
+        return NULL_VALUE_ERROR;
+    }
+
+    list_for_each_entry(node, &r->client_list, linked_list, iotx_mqtt_reactor_node_t) {
+        if (node->client == handle) {
+            return SUCCESS_RETURN;
+        }
+    }
+
+    node = mqtt_api_malloc(sizeof(iotx_mqtt_reactor_node_t));
+    if (node == NULL) {
+        mqtt_err("malloc reactor node failed");
+        return ERROR_MALLOC;
+    }
+    node->client = handle;
+    node->fd = (uintptr_t)(-1);
+    list_add_tail(&node->linked_list, &r->client_list);
+
+    return SUCCESS_RETURN;
+}
+
+int IOT_MQTT_Reactor_Remove(void *reactor, void *handle)
+{
+    iotx_mqtt_reactor_t *r = (iotx_mqtt_reactor_t *)reactor;
+    iotx_mqtt_reactor_node_t *node = NULL, *next = NULL;
+
+    if (r == NULL || handle == NULL) {
+        mqtt_err("params err");
+        return NULL_VALUE_ERROR;
+    }
+
+    list_for_each_entry_safe(node, next, &r->client_list, linked_list, iotx_mqtt_reactor_node_t) {
+        if (node->client == handle) {
+            _reactor_watch(r, node, (uintptr_t)(-1));
+            list_del(&node->linked_list);
+            mqtt_api_free(node);
+            return SUCCESS_RETURN;
+        }
+    }
+
+    return FAIL_RETURN;
+}
+
+int IOT_MQTT_Reactor_Run(void *reactor, int timeout_ms)
+{
+    iotx_mqtt_reactor_t *r = (iotx_mqtt_reactor_t *)reactor;
+    iotx_mqtt_reactor_node_t *node = NULL;
+    iotx_mqtt_nwk_param_t param;
+    void *ready[MQTT_REACTOR_EVENT_MAX];
+    uint32_t wait_ms = 0;
+    uint32_t left = 0;
+    int num = 0;
+    int idx = 0;
+
+    if (r == NULL || timeout_ms < 0) {
+        mqtt_err("params err");
+        return NULL_VALUE_ERROR;
+    }
+
+    wait_ms = timeout_ms;
+    list_for_each_entry(node, &r->client_list, linked_list, iotx_mqtt_reactor_node_t) {
+        left = _reactor_sync(r, node);
+        if (left < wait_ms) {
+            wait_ms = left;
+        }
+    }
+
+    num = HAL_Poller_Wait(r->poller, ready, MQTT_REACTOR_EVENT_MAX, wait_ms);
+    if (num < 0) {
+        mqtt_err("poller wait failed");
+        return FAIL_RETURN;
+    }
+
+    for (idx = 0; idx < num; idx++) {
+        node = (iotx_mqtt_reactor_node_t *)ready[idx];
+        param.fd = node->fd;
+        IOT_MQTT_Nwk_Event_Handler(node->client, IOTX_MQTT_SOC_READ, &param);
+        _reactor_sync(r, node);
+    }
+
+    /* keepalive, republish and reconnect of clients whose time is up */
+    list_for_each_entry(node, &r->client_list, linked_list, iotx_mqtt_reactor_node_t) {
+        if (_reactor_sync(r, node) == 0) {
+            IOT_MQTT_Yield(node->client, 0);
+            _reactor_sync(r, node);
+        }
+    }
+
+    return num;
+}
+
+int IOT_MQTT_Reactor_Destroy(void **preactor)
+{
+    iotx_mqtt_reactor_t *r = NULL;
+    iotx_mqtt_reactor_node_t *node = NULL, *next = NULL;
+
+    if (preactor == NULL || *preactor == NULL) {
+        mqtt_err("params err");
+        return NULL_VALUE_ERROR;
+    }
+    r = (iotx_mqtt_reactor_t *)*preactor;
+
+    list_for_each_entry_safe(node, next, &r->client_list, linked_list, iotx_mqtt_reactor_node_t) {
+        list_del(&node->linked_list);
+        mqtt_api_free(node);
+    }
+    HAL_Poller_Destroy(r->poller);
+    mqtt_api_free(r);
+    *preactor = NULL;
+
+    return SUCCESS_RETURN;
+}
+#endif  /* #ifdef MQTT_REACTOR */
@@ -12,7 +12,10 @@ extern "C" {
 #include "infra_types.h"
 #include "infra_defs.h"
 
-#define MUTLI_SUBSCIRBE_MAX                                     (5)
+/* topic filters carried by one SUBSCRIBE packet */
+#ifndef MUTLI_SUBSCIRBE_MAX
+#define MUTLI_SUBSCIRBE_MAX                                     (16)
+#endif
 
 /* From mqtt_client.h */
 typedef enum {
@@ -131,6 +134,15 @@ typedef struct {
     void                               *pcontext;
 } iotx_mqtt_event_handle_t, *iotx_mqtt_event_handle_pt;
 
+/* Information structure of mutli-subscribe */
+typedef struct {
+    const char                                    *topicFilter;
+    iotx_mqtt_qos_t                                qos;
+    iotx_mqtt_event_handle_func_fpt                messageHandler;
+    void                                          *pcontext;
+    int                                            granted;         /* [out] QoS granted by SUBACK, -1 if not */
+} iotx_mutli_sub_info_t, *iotx_mutli_sub_info_pt;
+
 
 /* The structure of MQTT initial parameter */
 typedef struct {
@@ -158,11 +170,156 @@ typedef struct {
 
 } iotx_mqtt_param_t, *iotx_mqtt_param_pt;
 
+
+/* Number of buckets of PUBACK round trip histogram */
+#define IOTX_MQTT_RTT_HIST_NUM              (8)
+
+/* Statistics of MQTT client, each counter is read atomically but a copy may be off by updates in progress */
+typedef struct {
+    uint32_t                    pub_count;                /* PUBLISH sent, republish not included */
+    uint32_t                    pub_fail;                 /* PUBLISH failed to send */
+    uint32_t                    republish_count;          /* PUBLISH sent again for PUBACK timeout */
+    uint32_t                    puback_count;             /* PUBACK received for PUBLISH waiting it */
+    uint32_t                    recv_count;               /* PUBLISH received */
+    uint64_t                    tx_bytes;                 /* bytes written to network */
+    uint64_t                    rx_bytes;                 /* bytes read from network */
+    uint32_t                    rx_reads;                 /* reads done by receiving */
+    uint32_t                    rx_packets;               /* packets got by those reads */
+    uint32_t                    tx_buf_allocs;            /* times send buffer is allocated */
+    uint32_t                    rx_buf_allocs;            /* times read buffer is allocated or grown */
+    uint32_t                    slab_allocs;              /* blocks served by MQTT slab, counted for all clients */
+    uint32_t                    keepalive_fail;           /* disconnects for unanswered PINGREQ */
+    uint32_t                    ping_count;               /* PINGREQ sent */
+    uint32_t                    ping_skipped;             /* PINGREQ due but left out for traffic in the interval */
+    uint32_t                    keepalive_ms;             /* idle time before PINGREQ, as adapted by probing */
+    uint32_t                    radio_wakeups;            /* packets sent or received after link idle for IOTX_MC_RADIO_TAIL_MS */
+    uint32_t                    disconnect_count;
+    uint32_t                    reconnect_count;          /* reconnect attempts */
+    uint32_t                    reconnect_fail;
+    uint32_t                    reconnect_time_ms;        /* from losing connection to CONNACK, of the last reconnect */
+    uint32_t                    reconnect_time_max_ms;
+    uint32_t                    session_resumed;          /* reconnects finding session kept by server */
+    uint32_t                    sub_replayed;             /* filters subscribed again for session lost by server */
+    uint32_t                    rtt_max_ms;               /* longest PUBACK round trip */
+    uint64_t                    rtt_sum_ms;               /* rtt_sum_ms / puback_count is the average */
+    /* PUBACK round trip, [0] counts below 4ms, [n] counts [4^n, 4^(n+1)) ms, the last one counts all above */
+    uint32_t                    rtt_hist[IOTX_MQTT_RTT_HIST_NUM];
+    uint32_t                    offline_queued;           /* PUBLISH stored in offline queue */
+    uint32_t                    offline_dropped;          /* PUBLISH dropped by offline queue */
+    uint32_t                    offline_sent;             /* PUBLISH sent from offline queue */
+    uint32_t                    dispatch_dropped;         /* PUBLISH dropped for queue of dispatch worker is full */
+} iotx_mqtt_stats_t, *iotx_mqtt_stats_pt;
+
+
+/**
+ * @brief It define a datatype of function pointer.
+ *        This type of function will be called periodically to dump statistics of MQTT client.
+ *
+ * @param pcontext : The program context.
+ * @param pclient : The MQTT client.
+ * @param stats : Statistics of the MQTT client.
+ *
+ * @return none
+ */
+typedef void (*iotx_mqtt_stats_dump_fpt)(void *pcontext, void *pclient, const iotx_mqtt_stats_t *stats);
+
+/* What the offline queue does when a PUBLISH does not fit into it */
+typedef enum {
+    IOTX_MQTT_OFFLINE_DROP_NEW,                           /* refuse the new PUBLISH */
+    IOTX_MQTT_OFFLINE_DROP_OLD                            /* drop oldest PUBLISH until the new one fits */
+} iotx_mqtt_offline_drop_t;
+
+/* Parameter of offline queue which stores PUBLISH while MQTT client is disconnected */
+typedef struct {
+    const char                 *path;                     /* segment file holding the queue, reused after restart */
+    uint32_t                    max_bytes;                /* room of the queue, including 16 bytes per PUBLISH */
+    iotx_mqtt_offline_drop_t    drop_policy;
+    uint32_t                    drain_rate;               /* PUBLISH sent from the queue per second after reconnect, 0 for no limit */
+} iotx_mqtt_offline_param_t, *iotx_mqtt_offline_param_pt;
+
+/* Parameter of worker threads which call PUBLISH handlers instead of the thread reading network */
+typedef struct {
+    uint32_t                    worker_num;               /* worker threads, 0 to call handlers in the thread reading */
+    uint32_t                    queue_max;                /* PUBLISH waiting for all workers, 0 for default */
+    uint32_t                    stack_size;               /* stack of each worker in bytes, 0 for default */
+} iotx_mqtt_dispatch_param_t, *iotx_mqtt_dispatch_param_pt;
+
+/* Piece of a PUBLISH too long for read buffer, delivered as it is received */
+typedef struct {
+    const char                 *ptopic;                   /* topic name, not terminated by '\0' */
+    uint16_t                    topic_len;
+    uint16_t                    packet_id;
+    uint8_t                     qos;
+    uint8_t                     retain;
+    uint8_t                     aborted;                  /* connection is lost before the whole payload is received */
+    uint32_t                    total_len;                /* length of the whole payload */
+    uint32_t                    offset;                   /* where @chunk is in payload */
+    const char                 *chunk;
+    uint32_t                    chunk_len;                /* @offset + @chunk_len is @total_len for the last piece */
+} iotx_mqtt_stream_chunk_t, *iotx_mqtt_stream_chunk_pt;
+
+/**
+ * @brief It define a datatype of function pointer.
+ *        This type of function is called with each piece of a PUBLISH streamed by MQTT client.
+ *
+ * @param pcontext : The program context.
+ * @param pclient : The MQTT client.
+ * @param chunk : The piece, valid only during the call.
+ *
+ * @return none
+ */
+typedef void (*iotx_mqtt_stream_fpt)(void *pcontext, void *pclient, const iotx_mqtt_stream_chunk_t *chunk);
+
+/* Parameter of keepalive, PINGREQ is sent only when link has been idle, and idle time allowed may be probed */
+typedef struct {
+    uint32_t                    probe_max;                /* PINGREQ unanswered before disconnect, 0 for default */
+    uint32_t                    min_ms;                   /* idle time probing starts from, 0 for keepalive interval */
+    uint32_t                    max_ms;                   /* longest idle time probed, 0 for @min_ms which disables probing */
+    uint32_t                    step_ms;                  /* idle time grows by this each probe survived, 0 for default */
+} iotx_mqtt_keepalive_param_t, *iotx_mqtt_keepalive_param_pt;
+
+/* Why reconnect failed, each class backs off by its own policy */
+typedef enum {
+    IOTX_MQTT_RECONNECT_NETWORK,                          /* TCP or TLS failed, or CONNACK not received */
+    IOTX_MQTT_RECONNECT_UNAVAILABLE,                      /* CONNACK refused for server unavailable */
+    IOTX_MQTT_RECONNECT_REJECTED,                         /* CONNACK refused for version, client id or authority */
+    IOTX_MQTT_RECONNECT_CLASS_MAX
+} iotx_mqtt_reconnect_class_t;
+
+/* Range of interval between reconnects */
+typedef struct {
+    uint32_t                    base_ms;                  /* shortest interval, 0 for default */
+    uint32_t                    cap_ms;                   /* longest interval, 0 for default */
+} iotx_mqtt_backoff_policy_t;
+
+/**
+ * @brief It define a datatype of function pointer.
+ *        This type of function is called after a reconnect failed to tell how long to wait before the next one.
+ *
+ * @param pcontext : The program context.
+ * @param err_class : Why reconnect failed.
+ * @param attempts : Reconnects failed in a row for @err_class, 1 for the first one.
+ * @param last_ms : Interval before the reconnect failed.
+ * @param policy : Policy of @err_class.
+ *
+ * @return interval in millisecond.
+ */
+typedef uint32_t (*iotx_mqtt_backoff_fpt)(void *pcontext, iotx_mqtt_reconnect_class_t err_class, uint32_t attempts,
+        uint32_t last_ms, const iotx_mqtt_backoff_policy_t *policy);
+
+/* Parameter of reconnect backoff */
+typedef struct {
+    iotx_mqtt_backoff_policy_t  policy[IOTX_MQTT_RECONNECT_CLASS_MAX];
+    iotx_mqtt_backoff_fpt       backoff;                  /* NULL for decorrelated jitter within policy */
+    void                       *pcontext;                 /* context passed to @backoff */
+} iotx_mqtt_backoff_param_t, *iotx_mqtt_backoff_param_pt;
+
 typedef enum {
     IOTX_MQTT_SOC_CONNECTED,
     IOTX_MQTT_SOC_CLOSE,
     IOTX_MQTT_SOC_READ,
     IOTX_MQTT_SOC_WRITE,
+    IOTX_MQTT_NWK_LINK_UP,                                /* link of device is up again, reconnect without waiting */
     IOTX_MQTT_SOC_MAX
 } iotx_mqtt_nwk_event_t;
 
@@ -190,6 +347,21 @@ typedef struct {
  */
 void *IOT_MQTT_Construct(iotx_mqtt_param_t *pInitParams);
 
+/**
+ * @brief Construct one more MQTT client of the device besides the default one made by IOT_MQTT_Construct(),
+ *        its signed client id is tagged with "conn=@conn_id", so the broker must allow several connections per device.
+ *        It is never taken as the default client, so pass it to IOT_MQTT_XXX() explicitly.
+ *        Only available when PLATFORM_HAS_DYNMEM is defined.
+ *
+ * @param [in] pInitParams: specify the MQTT client parameter.
+ * @param [in] conn_id: positive number which tells the client apart from others of the device.
+ *
+ * @retval     NULL : Construct failed.
+ * @retval NOT_NULL : The handle of MQTT client.
+ * @see None.
+ */
+void *IOT_MQTT_Construct_Conn(iotx_mqtt_param_t *pInitParams, int conn_id);
+
 
 /**
  * @brief Deconstruct the MQTT client
@@ -272,6 +444,21 @@ int IOT_MQTT_Subscribe_Sync(void *handle,
                             void *pcontext,
                             int timeout_ms);
 
+/**
+ * @brief Subscribe a group of MQTT topics and wait their suback.
+ *        Up to MUTLI_SUBSCIRBE_MAX topic filters are packed into one SUBSCRIBE, and the packets are sent
+ *        back to back, so that a large number of topics is subscribed in a few round trips.
+ *
+ * @param [in] handle: specify the MQTT client.
+ * @param [in,out] sub_list: specify the topic filters, QoS granted to each one is returned by its 'granted'.
+ * @param [in] count: specify number of topic filters.
+ * @param [in] timeout_ms: time in ms to wait.
+ *
+ * @retval < 0 : Subscribe failed.
+ * @retval >=0 : Number of topic filters granted by broker, 'granted' of the others is -1.
+ * @see None.
+ */
+int IOT_MQTT_Subscribe_Multi(void *handle, iotx_mutli_sub_info_t *sub_list, int count, int timeout_ms);
 
 /**
  * @brief Unsubscribe MQTT topic.
@@ -320,13 +507,162 @@ int IOT_MQTT_Publish(void *handle, const char *topic_name, iotx_mqtt_topic_info_
  * @see None.
  */
 int IOT_MQTT_Publish_Simple(void *handle, const char *topic_name, int qos, void *data, int len);
+
+/**
+ * @brief Publish several messages, which are sent by as few network writes as possible.
+ *
+ * @param [in] handle: specify the MQTT client.
+ * @param [in,out] topic_msgs: specify the messages, @ptopic of each is the '\0' terminated topic name,
+ *        @packet_id of each QoS1 message is filled when it is published.
+ * @param [in] count: specify the number of messages.
+ *
+ * @retval <0 :  Publish failed, none of the messages is published.
+ * @retval >0 :  Number of leading messages published. It is less than @count when the publish window
+ *        is full or network fails in the middle, the rest should be published again later.
+ *        With FEATURE_MQTT_OFFLINE_QUEUE, messages stored in offline queue count as published.
+ * @see IOT_MQTT_Get_Pub_Window.
+ */
+int IOT_MQTT_Publish_Batch(void *handle, iotx_mqtt_topic_info_pt topic_msgs, int count);
+
+/**
+ * @brief Get occupancy of QoS1 publish window, so publishing can slow down before it is full.
+ *
+ * @param [in] handle: specify the MQTT client.
+ * @param [out] inflight: number of QoS1 publishes waiting for PUBACK.
+ * @param [out] window_size: maximum QoS1 publishes waiting for PUBACK, 0 means not limited by SDK.
+ *
+ * @retval -1 :  Failed.
+ * @retval  0 :  Successful.
+ * @see None.
+ */
+int IOT_MQTT_Get_Pub_Window(void *handle, int *inflight, int *window_size);
+
+/**
+ * @brief Get statistics of MQTT client, counted since it has been constructed.
+ *
+ * @param [in] handle: specify the MQTT client.
+ * @param [out] stats: statistics of the MQTT client.
+ *
+ * @retval -1 :  Failed.
+ * @retval  0 :  Successful.
+ * @see None.
+ */
+int IOT_MQTT_GetStats(void *handle, iotx_mqtt_stats_t *stats);
+
+/**
+ * @brief Dump statistics of MQTT client every @interval_ms, it is done in IOT_MQTT_Yield().
+ *
+ * @param [in] handle: specify the MQTT client.
+ * @param [in] interval_ms: dump interval, 0 to stop dumping.
+ * @param [in] dump: called with statistics, NULL to print them in log.
+ * @param [in] pcontext: context passed to @dump.
+ *
+ * @retval -1 :  Failed.
+ * @retval  0 :  Successful.
+ * @see None.
+ */
+int IOT_MQTT_Set_Stats_Dump(void *handle, uint32_t interval_ms, iotx_mqtt_stats_dump_fpt dump, void *pcontext);
+
+/**
+ * @brief Store PUBLISH in a segment file while MQTT client is disconnected, and send them in order after reconnect,
+ *        FEATURE_MQTT_OFFLINE_QUEUE must be selected. Once the queue holds PUBLISH, new ones are queued behind
+ *        them even if connected, IOT_MQTT_Publish() returns 0 for a queued PUBLISH instead of its packet id.
+ *
+ * @param [in] handle: specify the MQTT client.
+ * @param [in] param: parameter of the queue, NULL to close the queue, PUBLISH left in it are kept in the file.
+ *
+ * @retval -1 :  Failed.
+ * @retval  0 :  Successful.
+ * @see None.
+ */
+int IOT_MQTT_Set_Offline_Queue(void *handle, const iotx_mqtt_offline_param_t *param);
+
+/**
+ * @brief Name topic of PUBLISH by alias, FEATURE_MQTT_TOPIC_ALIAS must be selected and server must understand it.
+ *        The first PUBLISH to a topic on a connection sends "$<alias>=<topic>" as topic name, which tells server
+ *        the alias, later ones send "$<alias>" only. Aliases are learned again on each connection. Topics which
+ *        start with '$' or are longer than CONFIG_MQTT_TOPIC_MAXLEN are always sent as they are.
+ *
+ * @param [in] handle: specify the MQTT client.
+ * @param [in] alias_max: aliases to use, no more than table size of the client, 0 to stop using alias.
+ *
+ * @retval -1 :  Failed.
+ * @retval  0 :  Successful.
+ * @see None.
+ */
+int IOT_MQTT_Set_Topic_Alias(void *handle, uint16_t alias_max);
+
+/**
+ * @brief Set how long MQTT client waits between reconnects. By default, the first reconnect is made at a random time
+ *        within base_ms of network class after connection is lost, later ones wait decorrelated jitter intervals,
+ *        random between base_ms and 3 times the last interval but no longer than cap_ms, so that devices losing
+ *        connection at the same time do not reconnect at the same time.
+ *
+ * @param [in] handle: specify the MQTT client.
+ * @param [in] param: parameter of backoff, NULL to restore default.
+ *
+ * @retval -1 :  Failed.
+ * @retval  0 :  Successful.
+ * @see None.
+ */
+int IOT_MQTT_Set_Backoff(void *handle, const iotx_mqtt_backoff_param_t *param);
+
+/**
+ * @brief Set keepalive of MQTT client. PINGREQ is only sent when nothing has been sent for the idle time, or nothing
+ *        received for twice of it, so traffic in the interval saves a wakeup of radio. When max_ms is above min_ms,
+ *        the idle time starts from min_ms and grows by step_ms each time a PINGREQ sent after a whole idle time is
+ *        answered. Once one is not, the idle time goes back to the longest one survived and never reaches the lost
+ *        one again, so timeout of NAT on the way is learned. max_ms is cut to the keepalive told to server.
+ *
+ * @param [in] handle: specify the MQTT client.
+ * @param [in] param: parameter of keepalive, NULL to restore default, which is a fixed idle time of keepalive interval.
+ *
+ * @retval -1 :  Failed.
+ * @retval  0 :  Successful.
+ * @see None.
+ */
+int IOT_MQTT_Set_Keepalive(void *handle, const iotx_mqtt_keepalive_param_t *param);
+
+/**
+ * @brief Call PUBLISH handlers in a pool of worker threads, FEATURE_MQTT_DISPATCH must be selected. The thread
+ *        reading network copies a received PUBLISH into queue of the worker serving its topic and acknowledges it,
+ *        so a slow handler no longer holds up reading, keepalive and PUBACK. PUBLISH of a topic are handled in the
+ *        order received. When queue of the worker is full, PUBLISH is dropped and QoS1 one is not acknowledged.
+ *
+ * @param [in] handle: specify the MQTT client.
+ * @param [in] param: parameter of the workers, NULL or 0 workers to stop them after PUBLISH queued are handled.
+ *
+ * @retval -1 :  Failed.
+ * @retval  0 :  Successful.
+ * @see None.
+ */
+int IOT_MQTT_Set_Dispatch(void *handle, const iotx_mqtt_dispatch_param_t *param);
+
+/**
+ * @brief Stream PUBLISH too long for read buffer instead of dropping it, FEATURE_MQTT_STREAM_RECV must be selected.
+ *        Once topic name of such PUBLISH is received, its payload is passed to @handler in pieces of @chunk_size
+ *        bytes as they arrive, the last piece may be shorter, so read buffer only needs to hold topic name and one
+ *        piece. QoS1 PUBLISH is acknowledged after the last piece. @handler is called by the thread reading network
+ *        even when PUBLISH handlers run on workers of IOT_MQTT_Set_Dispatch(), and must not call this function.
+ *
+ * @param [in] handle: specify the MQTT client.
+ * @param [in] chunk_size: bytes of each piece, 0 for default, cut down to what read buffer can hold.
+ * @param [in] handler: called with each piece, NULL to drop too long PUBLISH as before.
+ * @param [in] pcontext: context passed to @handler.
+ *
+ * @retval -1 :  Failed.
+ * @retval  0 :  Successful.
+ * @see None.
+ */
+int IOT_MQTT_Set_Stream_Recv(void *handle, uint32_t chunk_size, iotx_mqtt_stream_fpt handler, void *pcontext);
 /* From mqtt_client.h */
 /** @} */ /* end of api_mqtt */
 
 /** @} */ /* end of api */
 
 /**
- * @brief Only used in async network stack and FEATURE_ASYNC_PROTOCOL_STACK must be selected
+ * @brief Only used in async network stack and FEATURE_ASYNC_PROTOCOL_STACK must be selected,
+ *        except IOTX_MQTT_NWK_LINK_UP which can be reported in any build, with NULL @param.
  *
  * @param [in] handle: specify the MQTT client.
  * @param [in] event: specify the network event.
@@ -338,6 +674,58 @@ int IOT_MQTT_Publish_Simple(void *handle, const char *topic_name, int qos, void
  */
 int IOT_MQTT_Nwk_Event_Handler(void *handle, iotx_mqtt_nwk_event_t event, iotx_mqtt_nwk_param_t *param);
 
+/**
+ * @brief Create a reactor which serves many MQTT clients of async network stack in one thread,
+ *        FEATURE_MQTT_REACTOR must be selected. Reactor is not thread safe, call IOT_MQTT_Reactor_XXX() from one thread.
+ *
+ * @return NULL, create failed; NOT NULL, handle of the reactor.
+ */
+void *IOT_MQTT_Reactor_Create(void);
+
+/**
+ * @brief Let reactor serve a MQTT client made by IOT_MQTT_Construct(),
+ *        IOT_MQTT_Yield() and IOT_MQTT_Nwk_Event_Handler() are called by reactor since then.
+ *
+ * @param [in] reactor: handle of the reactor.
+ * @param [in] handle: specify the MQTT client.
+ *
+ * @retval -1 :  Failed.
+ * @retval  0 :  Successful.
+ */
+int IOT_MQTT_Reactor_Add(void *reactor, void *handle);
+
+/**
+ * @brief Stop serving a MQTT client, which must be done before the client is destroyed.
+ *
+ * @param [in] reactor: handle of the reactor.
+ * @param [in] handle: specify the MQTT client.
+ *
+ * @retval -1 :  Failed.
+ * @retval  0 :  Successful.
+ */
+int IOT_MQTT_Reactor_Remove(void *reactor, void *handle);
+
+/**
+ * @brief Wait until some client's socket is readable or its keepalive, republish or reconnect is due, then handle it.
+ *
+ * @param [in] reactor: handle of the reactor.
+ * @param [in] timeout_ms: wait no longer than it.
+ *
+ * @retval < 0 :  Failed.
+ * @retval >=0 :  Number of clients whose socket has been read.
+ */
+int IOT_MQTT_Reactor_Run(void *reactor, int timeout_ms);
+
+/**
+ * @brief Destroy reactor, clients served by it are left as they are.
+ *
+ * @param [in] preactor: pointer of handle of the reactor.
+ *
+ * @retval -1 :  Failed.
+ * @retval  0 :  Successful.
+ */
+int IOT_MQTT_Reactor_Destroy(void **preactor);
+
 /* MQTT Configurations
  *
  * These switches will affect mqtt_api.c and IOT_MQTT_XXX() functions' behaviour
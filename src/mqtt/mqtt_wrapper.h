@@ -41,6 +41,34 @@ int HAL_Kv_Get(const char *key, void *val, int *buffer_len);
     int32_t HAL_TCP_Read(uintptr_t fd, char *buf, uint32_t len, uint32_t timeout_ms);
 #endif
 
+#ifdef MQTT_REACTOR
+uintptr_t HAL_Poller_Create(void);
+void HAL_Poller_Destroy(uintptr_t poller);
+int32_t HAL_Poller_Add(uintptr_t poller, uintptr_t fd, void *ctx);
+int32_t HAL_Poller_Del(uintptr_t poller, uintptr_t fd);
+int32_t HAL_Poller_Wait(uintptr_t poller, void **ctx, int32_t max, uint32_t timeout_ms);
+#endif
+
+#ifdef MQTT_DISPATCH
+int HAL_ThreadCreate(
+            void **thread_handle,
+            void *(*work_routine)(void *),
+            void *arg,
+            hal_os_thread_param_t *hal_os_thread_param,
+            int *stack_used);
+void HAL_ThreadDelete(void *thread_handle);
+void *HAL_SemaphoreCreate(void);
+void HAL_SemaphoreDestroy(void *sem);
+void HAL_SemaphorePost(void *sem);
+int HAL_SemaphoreWait(void *sem, uint32_t timeout_ms);
+#endif
+
+#ifdef MQTT_OFFLINE_QUEUE
+void *HAL_Segment_Map(const char *path, uint32_t size);
+int32_t HAL_Segment_Sync(void *segment, uint32_t offset, uint32_t len);
+void HAL_Segment_Unmap(void *segment, uint32_t size);
+#endif
+
 /* mqtt protocol wrapper */
 void *wrapper_mqtt_init(iotx_mqtt_param_t *mqtt_params);
 int wrapper_mqtt_connect(void *client);
@@ -57,9 +85,30 @@ int wrapper_mqtt_subscribe_sync(void *client,
                                 iotx_mqtt_event_handle_func_fpt topic_handle_func,
                                 void *pcontext,
                                 int timeout_ms);
+int wrapper_mqtt_subscribe_multi(void *client, iotx_mutli_sub_info_t *sub_info, int count, int timeout_ms);
 int wrapper_mqtt_unsubscribe(void *client, const char *topicFilter);
 int wrapper_mqtt_publish(void *client, const char *topicName, iotx_mqtt_topic_info_pt topic_msg);
+int wrapper_mqtt_publish_batch(void *client, iotx_mqtt_topic_info_pt topic_msgs, int count);
+int wrapper_mqtt_get_pub_window(void *client, int *inflight, int *window_size);
+int wrapper_mqtt_get_stats(void *client, iotx_mqtt_stats_t *stats);
+int wrapper_mqtt_set_stats_dump(void *client, uint32_t interval_ms, iotx_mqtt_stats_dump_fpt dump, void *pcontext);
+#ifdef MQTT_TOPIC_ALIAS
+int wrapper_mqtt_set_topic_alias(void *client, uint16_t alias_max);
+#endif
+int wrapper_mqtt_set_backoff(void *client, const iotx_mqtt_backoff_param_t *param);
+int wrapper_mqtt_set_keepalive(void *client, const iotx_mqtt_keepalive_param_t *param);
+int wrapper_mqtt_link_up(void *client);
+#ifdef MQTT_OFFLINE_QUEUE
+int wrapper_mqtt_set_offline_queue(void *client, const iotx_mqtt_offline_param_t *param);
+#endif
+#ifdef MQTT_DISPATCH
+int wrapper_mqtt_set_dispatch(void *client, const iotx_mqtt_dispatch_param_t *param);
+#endif
+#ifdef MQTT_STREAM_RECV
+int wrapper_mqtt_set_stream_recv(void *client, uint32_t chunk_size, iotx_mqtt_stream_fpt handler, void *pcontext);
+#endif
 int wrapper_mqtt_release(void **pclient);
 int wrapper_mqtt_nwk_event_handler(void *client, iotx_mqtt_nwk_event_t event, iotx_mqtt_nwk_param_t *param);
+int wrapper_mqtt_nwk_status(void *client, iotx_mqtt_nwk_param_t *param, int *connecting, uint32_t *timeout_ms);
 
 
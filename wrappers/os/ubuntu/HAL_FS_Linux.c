@@ -39,3 +39,48 @@ long HAL_Ftell(void *stream)
 }
 #endif
 
+
+#ifdef MQTT_OFFLINE_QUEUE
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+void *HAL_Segment_Map(const char *path, uint32_t size)
+{
+    int fd;
+    struct stat st;
+    void *segment;
+
+    fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    /* file grown by ftruncate() reads as zero */
+    if (fstat(fd, &st) != 0 || (st.st_size != (off_t)size && ftruncate(fd, (off_t)size) != 0)) {
+        close(fd);
+        return NULL;
+    }
+
+    segment = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    return (segment == MAP_FAILED) ? NULL : segment;
+}
+
+int32_t HAL_Segment_Sync(void *segment, uint32_t offset, uint32_t len)
+{
+    long page = sysconf(_SC_PAGESIZE);
+    uint32_t start = offset - offset % (uint32_t)page;
+
+    /* data is in page cache once written, which survives the process, so write back is only started here */
+    return msync((char *)segment + start, offset + len - start, MS_ASYNC);
+}
+
+void HAL_Segment_Unmap(void *segment, uint32_t size)
+{
+    munmap(segment, size);
+}
+#endif
@@ -8,11 +8,20 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/time.h>
+#include <sys/uio.h>
+#include <poll.h>
+#if defined(MQTT_REACTOR)
+#include <sys/epoll.h>
+#endif
 #include <unistd.h>
 #include <fcntl.h>
 #include <netinet/tcp.h>
 #include <netdb.h>
+#if defined(MQTT_FAST_RECONNECT)
+#include <pthread.h>
+#endif
 #include "infra_config.h"
+#include "wrappers_defs.h"
 
 static uint64_t _linux_get_time_ms(void)
 {
@@ -39,6 +48,123 @@ static uint64_t _linux_time_left(uint64_t t_end, uint64_t t_now)
     return t_left;
 }
 
+/* wait @events on @fd, poll() is used as descriptors of many connections may exceed FD_SETSIZE */
+static int _linux_wait_fd(int fd, short events, uint64_t t_left)
+{
+    struct pollfd pfd;
+
+    pfd.fd = fd;
+    pfd.events = events;
+    pfd.revents = 0;
+
+    return poll(&pfd, 1, (int)t_left);
+}
+
+#if defined(MQTT_FAST_RECONNECT)
+#define DNS_CACHE_NUM               (4)
+#define DNS_CACHE_HOST_MAXLEN       (64)
+#define DNS_CACHE_TTL_MS            (10 * 60 * 1000)
+#define DNS_CACHE_CONNECT_MS        (3000)      /* the host may have moved, resolve it again after this */
+
+/* Address each host was last connected at, tried before resolving the host again */
+typedef struct {
+    char                host[DNS_CACHE_HOST_MAXLEN];
+    uint16_t            port;
+    struct sockaddr_in  addr;
+    uint64_t            expire_ms;          /* 0 when entry is empty */
+} dns_cache_t;
+
+static dns_cache_t g_dns_cache[DNS_CACHE_NUM];
+static pthread_mutex_t g_dns_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int _dns_cache_load(const char *host, uint16_t port, struct sockaddr_in *addr)
+{
+    int idx, ret = -1;
+
+    pthread_mutex_lock(&g_dns_cache_lock);
+    for (idx = 0; idx < DNS_CACHE_NUM; idx++) {
+        if (g_dns_cache[idx].port == port && !strcmp(g_dns_cache[idx].host, host) &&
+            g_dns_cache[idx].expire_ms > _linux_get_time_ms()) {
+            memcpy(addr, &g_dns_cache[idx].addr, sizeof(struct sockaddr_in));
+            ret = 0;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_dns_cache_lock);
+
+    return ret;
+}
+
+/* remember @addr connected for @host, or forget the address of @host if @addr is NULL */
+static void _dns_cache_save(const char *host, uint16_t port, const struct sockaddr_in *addr)
+{
+    int idx;
+    dns_cache_t *entry = NULL, *oldest = &g_dns_cache[0];
+
+    if (strlen(host) >= DNS_CACHE_HOST_MAXLEN) {
+        return;
+    }
+
+    pthread_mutex_lock(&g_dns_cache_lock);
+    for (idx = 0; idx < DNS_CACHE_NUM; idx++) {
+        if (g_dns_cache[idx].port == port && !strcmp(g_dns_cache[idx].host, host)) {
+            entry = &g_dns_cache[idx];
+            break;
+        }
+        if (g_dns_cache[idx].expire_ms < oldest->expire_ms) {
+            oldest = &g_dns_cache[idx];
+        }
+    }
+    /* the entry expiring first is taken over by a new host */
+    if (entry == NULL && addr != NULL) {
+        entry = oldest;
+    }
+
+    if (entry != NULL) {
+        memset(entry, 0, sizeof(dns_cache_t));
+    }
+    if (entry != NULL && addr != NULL) {
+        strcpy(entry->host, host);
+        entry->port = port;
+        memcpy(&entry->addr, addr, sizeof(struct sockaddr_in));
+        entry->expire_ms = _linux_get_time_ms() + DNS_CACHE_TTL_MS;
+    }
+    pthread_mutex_unlock(&g_dns_cache_lock);
+}
+
+/* connect() of a blocking socket waits out SYN retries of the stack, so it is made non-blocking meanwhile */
+static int _linux_connect_within(int fd, const struct sockaddr *addr, socklen_t addr_len, uint64_t timeout_ms)
+{
+    int flags, ret, err = 0;
+    socklen_t err_len = sizeof(err);
+    uint64_t t_end = _linux_get_time_ms() + timeout_ms;
+
+    flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        return -1;
+    }
+
+    ret = connect(fd, addr, addr_len);
+    if (ret != 0 && errno == EINPROGRESS) {
+        do {
+            ret = _linux_wait_fd(fd, POLLOUT, _linux_time_left(t_end, _linux_get_time_ms()));
+        } while (ret < 0 && errno == EINTR);
+
+        if (ret > 0 && getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &err_len) == 0 && err == 0) {
+            ret = 0;
+        } else {
+            if (ret == 0) {
+                printf("connect timeout in %ums\n", (unsigned int)timeout_ms);
+            }
+            ret = -1;
+        }
+    }
+
+    fcntl(fd, F_SETFL, flags);
+    return ret;
+}
+#endif  /* #if defined(MQTT_FAST_RECONNECT) */
+
 uintptr_t HAL_TCP_Establish(const char *host, uint16_t port)
 {
     struct addrinfo hints;
@@ -53,6 +179,25 @@ uintptr_t HAL_TCP_Establish(const char *host, uint16_t port)
 
     printf("establish tcp connection with server(host='%s', port=[%u])\n", host, port);
 
+#if defined(MQTT_FAST_RECONNECT)
+    {
+        struct sockaddr_in addr;
+
+        if (_dns_cache_load(host, port, &addr) == 0) {
+            fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+            if (fd >= 0 && _linux_connect_within(fd, (struct sockaddr *)&addr, sizeof(addr), DNS_CACHE_CONNECT_MS) == 0) {
+                printf("success to establish tcp at cached address, fd=%d\n", fd);
+                return (uintptr_t)fd;
+            }
+            if (fd >= 0) {
+                close(fd);
+            }
+            /* resolve host again, for it may have moved */
+            _dns_cache_save(host, port, NULL);
+        }
+    }
+#endif
+
     hints.ai_family = AF_INET; /* only IPv4 */
     hints.ai_socktype = SOCK_STREAM;
     hints.ai_protocol = IPPROTO_TCP;
@@ -89,6 +234,9 @@ uintptr_t HAL_TCP_Establish(const char *host, uint16_t port)
         }
 
         if (connect(fd, cur->ai_addr, cur->ai_addrlen) == 0) {
+#if defined(MQTT_FAST_RECONNECT)
+            _dns_cache_save(host, port, (const struct sockaddr_in *)cur->ai_addr);
+#endif
             rc = fd;
             break;
         }
@@ -133,40 +281,96 @@ int32_t HAL_TCP_Write(uintptr_t fd, const char *buf, uint32_t len, uint32_t time
     int ret,tcp_fd;
     uint32_t len_sent;
     uint64_t t_end, t_left;
-    fd_set sets;
     int net_err = 0;
 
     t_end = _linux_get_time_ms() + timeout_ms;
     len_sent = 0;
     ret = 1; /* send one time if timeout_ms is value 0 */
 
-    if (fd >= FD_SETSIZE) {
-        return -1;
-    }
     tcp_fd = (int)fd;
 
     do {
         t_left = _linux_time_left(t_end, _linux_get_time_ms());
 
         if (0 != t_left) {
-            struct timeval timeout;
-
-            FD_ZERO(&sets);
-            FD_SET(tcp_fd, &sets);
+            ret = _linux_wait_fd(tcp_fd, POLLOUT, t_left);
+            if (ret > 0) {
+                /* writable, or error which is reported by the following send */
+            } else if (0 == ret) {
+                printf("poll-write timeout %d\n", tcp_fd);
+                break;
+            } else {
+                if (EINTR == errno) {
+                    printf("EINTR be caught\n");
+                    continue;
+                }
 
-            timeout.tv_sec = t_left / 1000;
-            timeout.tv_usec = (t_left % 1000) * 1000;
+                printf("poll-write fail, ret = poll() = %d\n", ret);
+                net_err = 1;
+                break;
+            }
+        }
 
-            ret = select(tcp_fd + 1, NULL, &sets, NULL, &timeout);
+        if (ret > 0) {
+            ret = send(tcp_fd, buf + len_sent, len - len_sent, 0);
             if (ret > 0) {
-                if (0 == FD_ISSET(tcp_fd, &sets)) {
-                    printf("Should NOT arrive\n");
-                    /* If timeout in next loop, it will not sent any data */
-                    ret = 0;
+                len_sent += ret;
+            } else if (0 == ret) {
+                printf("No data be sent\n");
+            } else {
+                if (EINTR == errno) {
+                    printf("EINTR be caught\n");
                     continue;
                 }
+
+                printf("send fail, ret = send() = %d\n", ret);
+                net_err = 1;
+                break;
+            }
+        }
+    } while (!net_err && (len_sent < len) && (_linux_time_left(t_end, _linux_get_time_ms()) > 0));
+
+    if (net_err) {
+        return -1;
+    } else {
+        return len_sent;
+    }
+}
+
+#if defined(HAL_TCP_WRITEV)
+#define HAL_TCP_IOV_MAX     (64)
+
+int32_t HAL_TCP_Writev(uintptr_t fd, const hal_iovec_t *iov, int iovcnt, uint32_t timeout_ms)
+{
+    int ret, tcp_fd, idx, cnt;
+    uint32_t len, len_sent, skip;
+    uint64_t t_end, t_left;
+    struct iovec vec[HAL_TCP_IOV_MAX];
+    int net_err = 0;
+
+    if (NULL == iov || iovcnt < 0) {
+        return -1;
+    }
+    tcp_fd = (int)fd;
+
+    len = 0;
+    for (idx = 0; idx < iovcnt; idx++) {
+        len += iov[idx].len;
+    }
+
+    t_end = _linux_get_time_ms() + timeout_ms;
+    len_sent = 0;
+    ret = 1; /* send one time if timeout_ms is value 0 */
+
+    do {
+        t_left = _linux_time_left(t_end, _linux_get_time_ms());
+
+        if (0 != t_left) {
+            ret = _linux_wait_fd(tcp_fd, POLLOUT, t_left);
+            if (ret > 0) {
+                /* writable, or error which is reported by the following send */
             } else if (0 == ret) {
-                printf("select-write timeout %d\n", tcp_fd);
+                printf("poll-write timeout %d\n", tcp_fd);
                 break;
             } else {
                 if (EINTR == errno) {
@@ -174,14 +378,28 @@ int32_t HAL_TCP_Write(uintptr_t fd, const char *buf, uint32_t len, uint32_t time
                     continue;
                 }
 
-                printf("select-write fail, ret = select() = %d\n", ret);
+                printf("poll-write fail, ret = poll() = %d\n", ret);
                 net_err = 1;
                 break;
             }
         }
 
         if (ret > 0) {
-            ret = send(tcp_fd, buf + len_sent, len - len_sent, 0);
+            /* rebuild the vector from the first byte which has not been sent */
+            skip = len_sent;
+            cnt = 0;
+            for (idx = 0; idx < iovcnt && cnt < HAL_TCP_IOV_MAX; idx++) {
+                if (skip >= iov[idx].len) {
+                    skip -= iov[idx].len;
+                    continue;
+                }
+                vec[cnt].iov_base = (char *)iov[idx].base + skip;
+                vec[cnt].iov_len = iov[idx].len - skip;
+                skip = 0;
+                cnt++;
+            }
+
+            ret = writev(tcp_fd, vec, cnt);
             if (ret > 0) {
                 len_sent += ret;
             } else if (0 == ret) {
@@ -192,7 +410,7 @@ int32_t HAL_TCP_Write(uintptr_t fd, const char *buf, uint32_t len, uint32_t time
                     continue;
                 }
 
-                printf("send fail, ret = send() = %d\n", ret);
+                printf("writev fail, ret = writev() = %d\n", ret);
                 net_err = 1;
                 break;
             }
@@ -205,22 +423,18 @@ int32_t HAL_TCP_Write(uintptr_t fd, const char *buf, uint32_t len, uint32_t time
         return len_sent;
     }
 }
+#endif  /* #if defined(HAL_TCP_WRITEV) */
 
 int32_t HAL_TCP_Read(uintptr_t fd, char *buf, uint32_t len, uint32_t timeout_ms)
 {
     int ret, err_code, tcp_fd;
     uint32_t len_recv;
     uint64_t t_end, t_left;
-    fd_set sets;
-    struct timeval timeout;
 
     t_end = _linux_get_time_ms() + timeout_ms;
     len_recv = 0;
     err_code = 0;
 
-    if (fd >= FD_SETSIZE) {
-        return -1;
-    }
     tcp_fd = (int)fd;
 
     do {
@@ -228,13 +442,8 @@ int32_t HAL_TCP_Read(uintptr_t fd, char *buf, uint32_t len, uint32_t timeout_ms)
         if (0 == t_left) {
             break;
         }
-        FD_ZERO(&sets);
-        FD_SET(tcp_fd, &sets);
-
-        timeout.tv_sec = t_left / 1000;
-        timeout.tv_usec = (t_left % 1000) * 1000;
 
-        ret = select(tcp_fd + 1, &sets, NULL, NULL, &timeout);
+        ret = _linux_wait_fd(tcp_fd, POLLIN, t_left);
         if (ret > 0) {
             ret = recv(tcp_fd, buf + len_recv, len - len_recv, 0);
             if (ret > 0) {
@@ -257,7 +466,7 @@ int32_t HAL_TCP_Read(uintptr_t fd, char *buf, uint32_t len, uint32_t timeout_ms)
             if (EINTR == errno) {
                 continue;
             }
-            printf("select-recv fail\n");
+            printf("poll-recv fail\n");
             err_code = -2;
             break;
         }
@@ -267,3 +476,112 @@ int32_t HAL_TCP_Read(uintptr_t fd, char *buf, uint32_t len, uint32_t timeout_ms)
     /* It will get error code on next calling */
     return (0 != len_recv) ? len_recv : err_code;
 }
+
+#if defined(HAL_TCP_READSOME)
+int32_t HAL_TCP_ReadSome(uintptr_t fd, char *buf, uint32_t len, uint32_t timeout_ms)
+{
+    int ret, tcp_fd;
+    uint64_t t_end;
+
+    tcp_fd = (int)fd;
+    t_end = _linux_get_time_ms() + timeout_ms;
+
+    do {
+        ret = _linux_wait_fd(tcp_fd, POLLIN, _linux_time_left(t_end, _linux_get_time_ms()));
+        if (ret > 0) {
+            /* return whatever the socket holds, do not wait for the rest of 'len' */
+            ret = recv(tcp_fd, buf, len, 0);
+            if (ret > 0) {
+                return ret;
+            } else if (0 == ret) {
+                printf("connection is closed\n");
+                return -1;
+            } else if (EINTR != errno) {
+                printf("recv fail\n");
+                return -2;
+            }
+        } else if (0 == ret) {
+            return 0;
+        } else if (EINTR != errno) {
+            printf("poll-recv fail\n");
+            return -2;
+        }
+    } while (_linux_time_left(t_end, _linux_get_time_ms()) > 0);
+
+    return 0;
+}
+#endif  /* #if defined(HAL_TCP_READSOME) */
+
+#if defined(MQTT_REACTOR)
+#define HAL_POLLER_EVENT_MAX    (64)
+
+uintptr_t HAL_Poller_Create(void)
+{
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+
+    if (epfd < 0) {
+        printf("epoll_create1 fail, errno = %d\n", errno);
+        return (uintptr_t)(-1);
+    }
+
+    return (uintptr_t)epfd;
+}
+
+void HAL_Poller_Destroy(uintptr_t poller)
+{
+    close((int)poller);
+}
+
+int32_t HAL_Poller_Add(uintptr_t poller, uintptr_t fd, void *ctx)
+{
+    struct epoll_event event;
+
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.ptr = ctx;
+
+    if (0 != epoll_ctl((int)poller, EPOLL_CTL_ADD, (int)fd, &event)) {
+        printf("epoll_ctl add %d fail, errno = %d\n", (int)fd, errno);
+        return -1;
+    }
+
+    return 0;
+}
+
+int32_t HAL_Poller_Del(uintptr_t poller, uintptr_t fd)
+{
+    struct epoll_event event;
+
+    /* a closed descriptor has left the epoll set already */
+    memset(&event, 0, sizeof(event));
+    if (0 != epoll_ctl((int)poller, EPOLL_CTL_DEL, (int)fd, &event) && EBADF != errno && ENOENT != errno) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int32_t HAL_Poller_Wait(uintptr_t poller, void **ctx, int32_t max, uint32_t timeout_ms)
+{
+    int ret, idx;
+    struct epoll_event events[HAL_POLLER_EVENT_MAX];
+
+    if (NULL == ctx || max <= 0) {
+        return -1;
+    }
+    if (max > HAL_POLLER_EVENT_MAX) {
+        max = HAL_POLLER_EVENT_MAX;
+    }
+
+    ret = epoll_wait((int)poller, events, max, (int)timeout_ms);
+    if (ret < 0) {
+        return (EINTR == errno) ? 0 : -1;
+    }
+
+    for (idx = 0; idx < ret; idx++) {
+        ctx[idx] = events[idx].data.ptr;
+    }
+
+    return ret;
+}
+#endif  /* #if defined(MQTT_REACTOR) */
@@ -18,6 +18,10 @@
     #include <signal.h>
     #include <unistd.h>
     #include <sys/time.h>
+    #include <poll.h>
+    #include <fcntl.h>
+    #include <errno.h>
+    #include <pthread.h>
 #endif
 #include "infra_config.h"
 #include "mbedtls/error.h"
@@ -139,6 +143,170 @@ static int ssl_deserialize_session(mbedtls_ssl_session *session,
 }
 #endif
 
+#if defined(MQTT_FAST_RECONNECT)
+
+#define TLS_HOST_CACHE_NUM          (4)
+#define TLS_HOST_CACHE_HOST_MAXLEN  (64)
+#define TLS_HOST_CACHE_ADDR_TTL_MS  (10 * 60 * 1000)
+
+/* What the last connection to a host left for the next one: its address and TLS session */
+typedef struct {
+    char                    host[TLS_HOST_CACHE_HOST_MAXLEN];
+    char                    port[6];
+    uint32_t                last_used;
+#if defined(_PLATFORM_IS_LINUX_)
+    struct sockaddr_storage addr;
+    socklen_t               addr_len;           /* 0 when no address is cached */
+    uint64_t                addr_expire_ms;
+#endif
+    int                     has_session;
+    mbedtls_ssl_session     session;
+} tls_host_cache_t;
+
+static tls_host_cache_t g_host_cache[TLS_HOST_CACHE_NUM];
+static uint32_t g_host_cache_clock = 0;
+
+#if defined(_PLATFORM_IS_LINUX_)
+static pthread_mutex_t g_host_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+#define TLS_HOST_CACHE_LOCK()       pthread_mutex_lock(&g_host_cache_lock)
+#define TLS_HOST_CACHE_UNLOCK()     pthread_mutex_unlock(&g_host_cache_lock)
+#else
+#define TLS_HOST_CACHE_LOCK()
+#define TLS_HOST_CACHE_UNLOCK()
+#endif
+
+/* entry of @host and @port, the least recently used one is taken over when @create and it is not found */
+static tls_host_cache_t *_host_cache_find(const char *host, const char *port, int create)
+{
+    int idx;
+    tls_host_cache_t *entry = NULL, *lru = &g_host_cache[0];
+
+    if (strlen(host) >= TLS_HOST_CACHE_HOST_MAXLEN || strlen(port) >= sizeof(lru->port)) {
+        return NULL;
+    }
+
+    for (idx = 0; idx < TLS_HOST_CACHE_NUM; idx++) {
+        if (!strcmp(g_host_cache[idx].host, host) && !strcmp(g_host_cache[idx].port, port)) {
+            entry = &g_host_cache[idx];
+            break;
+        }
+        if (g_host_cache[idx].last_used < lru->last_used) {
+            lru = &g_host_cache[idx];
+        }
+    }
+
+    if (entry == NULL) {
+        if (!create) {
+            return NULL;
+        }
+        entry = lru;
+        if (entry->has_session) {
+            mbedtls_ssl_session_free(&entry->session);
+        }
+        memset(entry, 0, sizeof(tls_host_cache_t));
+        strcpy(entry->host, host);
+        strcpy(entry->port, port);
+    }
+    entry->last_used = ++g_host_cache_clock;
+
+    return entry;
+}
+
+/* resume the session last negotiated with @host, return 1 if there is one */
+static int _host_cache_load_session(const char *host, const char *port, mbedtls_ssl_context *ssl)
+{
+    int ret = 0;
+    tls_host_cache_t *entry = NULL;
+
+    TLS_HOST_CACHE_LOCK();
+    entry = _host_cache_find(host, port, 0);
+    if (entry != NULL && entry->has_session && mbedtls_ssl_set_session(ssl, &entry->session) == 0) {
+        ret = 1;
+    }
+    TLS_HOST_CACHE_UNLOCK();
+
+    return ret;
+}
+
+/* keep the session of a finished handshake, replacing the one of former connection */
+static void _host_cache_save_session(const char *host, const char *port, const mbedtls_ssl_context *ssl)
+{
+    mbedtls_ssl_session session;
+    tls_host_cache_t *entry = NULL;
+
+    mbedtls_ssl_session_init(&session);
+    if (mbedtls_ssl_get_session(ssl, &session) != 0) {
+        mbedtls_ssl_session_free(&session);
+        return;
+    }
+
+    TLS_HOST_CACHE_LOCK();
+    entry = _host_cache_find(host, port, 1);
+    if (entry == NULL) {
+        TLS_HOST_CACHE_UNLOCK();
+        mbedtls_ssl_session_free(&session);
+        return;
+    }
+    if (entry->has_session) {
+        mbedtls_ssl_session_free(&entry->session);
+    }
+    memcpy(&entry->session, &session, sizeof(mbedtls_ssl_session));
+    entry->has_session = 1;
+    TLS_HOST_CACHE_UNLOCK();
+}
+
+#if defined(_PLATFORM_IS_LINUX_)
+static uint64_t _host_cache_time_ms(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+/* copy the address @host was last connected at, return its length or 0 if it is not known or expired */
+static socklen_t _host_cache_load_addr(const char *host, const char *port, struct sockaddr_storage *addr)
+{
+    socklen_t addr_len = 0;
+    tls_host_cache_t *entry = NULL;
+
+    TLS_HOST_CACHE_LOCK();
+    entry = _host_cache_find(host, port, 0);
+    if (entry != NULL && entry->addr_len > 0 && entry->addr_expire_ms > _host_cache_time_ms()) {
+        memcpy(addr, &entry->addr, entry->addr_len);
+        addr_len = entry->addr_len;
+    }
+    TLS_HOST_CACHE_UNLOCK();
+
+    return addr_len;
+}
+
+/* remember @addr connected for @host, or forget the address of @host if @addr is NULL */
+static void _host_cache_save_addr(const char *host, const char *port, const struct sockaddr *addr,
+                                  socklen_t addr_len)
+{
+    tls_host_cache_t *entry = NULL;
+
+    if (addr_len > sizeof(struct sockaddr_storage)) {
+        return;
+    }
+
+    TLS_HOST_CACHE_LOCK();
+    entry = _host_cache_find(host, port, addr != NULL);
+    if (entry != NULL) {
+        entry->addr_len = 0;
+        if (addr != NULL) {
+            memcpy(&entry->addr, addr, addr_len);
+            entry->addr_len = addr_len;
+            entry->addr_expire_ms = _host_cache_time_ms() + TLS_HOST_CACHE_ADDR_TTL_MS;
+        }
+    }
+    TLS_HOST_CACHE_UNLOCK();
+}
+#endif  /* #if defined(_PLATFORM_IS_LINUX_) */
+
+#endif  /* #if defined(MQTT_FAST_RECONNECT) */
+
 static unsigned int _avRandom()
 {
     return (((unsigned int)rand() << 16) + rand());
@@ -297,6 +465,41 @@ static int net_prepare(void)
     return (0);
 }
 
+/* connect() of a blocking socket may wait for the stack's own SYN retries, so it is made non-blocking meanwhile */
+static int _net_connect_within(int fd, const struct sockaddr *addr, socklen_t addr_len, unsigned int timeout)
+{
+    int flags, ret, err = 0;
+    socklen_t err_len = sizeof(err);
+    struct pollfd pfd;
+
+    flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        return connect(fd, addr, addr_len);
+    }
+
+    ret = connect(fd, addr, addr_len);
+    if (ret != 0 && errno == EINPROGRESS) {
+        /* poll() rather than select(), descriptor may be beyond FD_SETSIZE */
+        pfd.fd = fd;
+        pfd.events = POLLOUT;
+        pfd.revents = 0;
+        do {
+            ret = poll(&pfd, 1, timeout * 1000);
+        } while (ret < 0 && errno == EINTR);
+
+        if (ret > 0 && getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &err_len) == 0 && err == 0) {
+            ret = 0;
+        } else {
+            if (ret == 0) {
+                printf("connect timeout in %us\n", timeout);
+            }
+            ret = -1;
+        }
+    }
+
+    fcntl(fd, F_SETFL, flags);
+    return ret;
+}
 
 static int mbedtls_net_connect_timeout(mbedtls_net_context *ctx, const char *host,
                                        const char *port, int proto, unsigned int timeout)
@@ -310,6 +513,30 @@ static int mbedtls_net_connect_timeout(mbedtls_net_context *ctx, const char *hos
         return (ret);
     }
 
+#if defined(MQTT_FAST_RECONNECT)
+    {
+        struct sockaddr_storage addr;
+        socklen_t addr_len = _host_cache_load_addr(host, port, &addr);
+
+        if (addr_len > 0) {
+            ctx->fd = (int) socket(addr.ss_family, proto == MBEDTLS_NET_PROTO_UDP ? SOCK_DGRAM : SOCK_STREAM,
+                                   proto == MBEDTLS_NET_PROTO_UDP ? IPPROTO_UDP : IPPROTO_TCP);
+            if (ctx->fd >= 0) {
+                sendtimeout.tv_sec = timeout;
+                sendtimeout.tv_usec = 0;
+                setsockopt(ctx->fd, SOL_SOCKET, SO_SNDTIMEO, &sendtimeout, sizeof(sendtimeout));
+                if (_net_connect_within(ctx->fd, (struct sockaddr *)&addr, addr_len, timeout) == 0) {
+                    printf("connected address cached for %s\n", host);
+                    return 0;
+                }
+                close(ctx->fd);
+            }
+            /* resolve host again, for it may have moved */
+            _host_cache_save_addr(host, port, NULL, 0);
+        }
+    }
+#endif
+
     /* Do name resolution with both IPv6 and IPv4 */
     memset(&hints, 0, sizeof(hints));
     hints.ai_family = AF_UNSPEC;
@@ -355,7 +582,10 @@ static int mbedtls_net_connect_timeout(mbedtls_net_context *ctx, const char *hos
         inet_ntop(AF_INET, &((const struct sockaddr_in *)cur->ai_addr)->sin_addr, ip4_str, INET_ADDRSTRLEN);
         printf("connecting IP_ADDRESS: %s\n", ip4_str);
 
-        if (connect(ctx->fd, cur->ai_addr, cur->ai_addrlen) == 0) {
+        if (_net_connect_within(ctx->fd, cur->ai_addr, cur->ai_addrlen, timeout) == 0) {
+#if defined(MQTT_FAST_RECONNECT)
+            _host_cache_save_addr(host, port, cur->ai_addr, cur->ai_addrlen);
+#endif
             ret = 0;
             break;
         }
@@ -446,6 +676,9 @@ static int _TLSConnectNetwork(TLSDataParams_t *pTlsData, const char *addr, const
                               const char *client_pwd, size_t client_pwd_len)
 {
     int ret = -1;
+#if defined(MQTT_FAST_RECONNECT) || defined(TLS_SAVE_TICKET)
+    int resumed = 0;
+#endif
     /*
      * 0. Init
      */
@@ -524,8 +757,14 @@ static int _TLSConnectNetwork(TLSDataParams_t *pTlsData, const char *addr, const
 #endif
     mbedtls_ssl_set_bio(&(pTlsData->ssl), &(pTlsData->fd), mbedtls_net_send, mbedtls_net_recv, mbedtls_net_recv_timeout);
 
+#if defined(MQTT_FAST_RECONNECT)
+    resumed = _host_cache_load_session(addr, port, &(pTlsData->ssl));
+    if (resumed) {
+        printf("resume session of former connection\n");
+    }
+#endif
 #if defined(TLS_SAVE_TICKET)
-    if (NULL == saved_session) {
+    if (NULL == saved_session && !resumed) {
         do {
             int len = TLS_MAX_SESSION_BUF;
             unsigned char *save_buf = HAL_Malloc(TLS_MAX_SESSION_BUF);
@@ -570,7 +809,7 @@ static int _TLSConnectNetwork(TLSDataParams_t *pTlsData, const char *addr, const
         } while (0);
     }
 
-    if (NULL != saved_session) {
+    if (NULL != saved_session && !resumed) {
         mbedtls_ssl_set_session(&(pTlsData->ssl), saved_session);
         printf("use saved session!!\r\n");
     }
@@ -589,6 +828,9 @@ static int _TLSConnectNetwork(TLSDataParams_t *pTlsData, const char *addr, const
     }
     printf(" ok\n");
 
+#if defined(MQTT_FAST_RECONNECT)
+    _host_cache_save_session(addr, port, &(pTlsData->ssl));
+#endif
 #if defined(TLS_SAVE_TICKET)
     if (NULL == saved_session) {
         do {
@@ -11,6 +11,12 @@ typedef struct {
     void (*free)(void *ptr);
 } ssl_hooks_t;
 
+/* One segment of data to be sent by a vectored write */
+typedef struct {
+    const void *base;
+    uint32_t    len;
+} hal_iovec_t;
+
 typedef enum {
     os_thread_priority_idle = -3,        /* priority: idle (lowest) */
     os_thread_priority_low = -2,         /* priority: low */